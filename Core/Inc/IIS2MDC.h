@@ -11,6 +11,8 @@
  * Includes
  **************************************//**************************************//**************************************/
 #include "IIS2MDC_Hardware.h"
+#include "IIS2MDC_Convert.h"
+#include "IIS2MDC_Filter.h"
 #include <stdint.h>
 /**************************************//**************************************//**************************************
  * Typedefs / Enumerations
@@ -74,27 +76,46 @@ typedef enum{
 }IIS2MDC_IntPinMode_t;
 
 
-/*Bitwise OR these together*/
+/*Bitwise OR these together. Bit positions follow INT_CTRL_REG.*/
 typedef enum{
-	IIS2MDC_XThresholdEnabled = (1 << 0),
-	IIS2MDC_YThresholdEnabled = (1 << 1),
-	IIS2MDC_ZThresholdEnabled = (1 << 2),
-	IIS2MDC_IRQActiveHigh = (1 << 5),
-	IIS2MDC_IRQBitLatched = (1 << 6),
-	IIS2MDC_IRQEnabled = (1 << 7)
+	IIS2MDC_IRQEnabled = (1 << 0),
+	IIS2MDC_IRQBitLatched = (1 << 1),
+	IIS2MDC_IRQActiveHigh = (1 << 2),
+	IIS2MDC_ZThresholdEnabled = (1 << 5),
+	IIS2MDC_YThresholdEnabled = (1 << 6),
+	IIS2MDC_XThresholdEnabled = (1 << 7)
 }IIS2MDC_IRQConfig_t;
 
+/*INT_SOURCE_REG flags. Positive/negative flags are set while an axis is above +threshold/below -threshold.*/
+typedef enum{
+	IIS2MDC_IntActive = (1 << 0),
+	IIS2MDC_RangeOverflow = (1 << 1),
+	IIS2MDC_ZNegativeThreshold = (1 << 2),
+	IIS2MDC_YNegativeThreshold = (1 << 3),
+	IIS2MDC_XNegativeThreshold = (1 << 4),
+	IIS2MDC_ZPositiveThreshold = (1 << 5),
+	IIS2MDC_YPositiveThreshold = (1 << 6),
+	IIS2MDC_XPositiveThreshold = (1 << 7)
+}IIS2MDC_IntSource_t;
+
+typedef enum{
+	IIS2MDC_BusOk,
+	IIS2MDC_BusClearPending,
+	IIS2MDC_BusReinitPending,
+	IIS2MDC_BusReconfigPending,
+	IIS2MDC_BusWrongDevice      /*Another chip answers at the address, it is never configured. Only a new Init leaves this.*/
+}IIS2MDC_BusState_t;
+
+typedef enum{
+	IIS2MDC_DataReadyCallback,
+	IIS2MDC_ThresholdCallback,
+	IIS2MDC_OverflowCallback,
+	IIS2MDC_NumCallbacks
+}IIS2MDC_CallbackID_t;
+
 /**************************************//**************************************//**************************************
  * Driver Structs
  **************************************//**************************************//**************************************/
-typedef struct{
-	IIS2MDC_IO_Drv_t IIS2MDC_IO;
-	IIS2MDC_DataReadyStatus_t DataReadyFlag;
-	int16_t MagX;
-	int16_t MagY;
-	int16_t MagZ;
-}IIS2MDC_Handle_t;
-
 typedef struct{
 	int16_t Offset_X;
 	int16_t Offset_Y;
@@ -111,8 +132,54 @@ typedef struct{
 	IIS2MDC_DrdyPinMode_t DrdyPinMode;
 	IIS2MDC_IntPinMode_t IntPinMode;
 	IIS2MDC_IRQConfig_t IRQConfig;
+	const IIS2MDC_Calibration_t *Calibration; /*NULL selects IIS2MDC_DefaultCalibration*/
+	int16_t Declination; /*Centidegrees, east positive. Added to IIS2MDC_GetHeading results.*/
 }IIS2MDC_InitStruct_t;
 
+#define IIS2MDC_CALIBRATION_HISTORY (4U)     /*Power of 2*/
+#define IIS2MDC_CALIBRATION_EPOCH_MASK (0x7FU) /*Top bit is left free for users of the tag*/
+
+/*Copy of the writable configuration registers as last written to the chip, grouped by contiguous address block*/
+typedef struct{
+	uint8_t Offset[6];    /*OFFSET_X_REG_L..OFFSET_Z_REG_H*/
+	uint8_t Cfg[4];       /*CFG_REG_A..INT_CTRL_REG*/
+	uint8_t Threshold[2]; /*INT_THS_L_REG..INT_THS_H_REG*/
+}IIS2MDC_RegisterImage_t;
+
+struct IIS2MDC_Handle;
+
+/*IntSource holds the INT_SOURCE_REG flags behind the event, 0 for data ready*/
+typedef void (*IIS2MDC_Callback_t)(struct IIS2MDC_Handle *Dev, uint8_t IntSource);
+
+typedef struct IIS2MDC_Handle{
+	IIS2MDC_IO_Drv_t IIS2MDC_IO;
+	IIS2MDC_DataReadyStatus_t DataReadyFlag;
+	IIS2MDC_DrdyPinMode_t DrdyPinMode;
+	IIS2MDC_IntPinMode_t IntPinMode;
+	uint8_t IntSource;
+	IIS2MDC_Callback_t Callbacks[IIS2MDC_NumCallbacks];
+	IIS2MDC_InitStruct_t Settings; /*Last applied configuration, re-applied after a bus fault*/
+	IIS2MDC_RegisterImage_t Shadow; /*Register contents matching Settings, runtime setters only write the bytes that differ*/
+	IIS2MDC_BusState_t BusState;
+	struct{
+		uint32_t Retries;    /*Extra attempts that rescued a transfer*/
+		uint32_t Faults;     /*Transfers that failed every attempt and started recovery*/
+		uint32_t Recoveries;
+		IIS2MDC_Status_t LastError; /*Classification of the transfer that started the last recovery*/
+	}BusStats;
+	const IIS2MDC_Calibration_t *Calibration;
+	uint8_t CalibrationEpoch; /*Bumped on every calibration change, tags samples converted later*/
+	const IIS2MDC_Calibration_t *CalibrationHistory[IIS2MDC_CALIBRATION_HISTORY]; /*Indexed by epoch, older ones must stay valid while tagged samples exist*/
+	int16_t Declination;
+	IIS2MDC_FilterStage_t *Filter;
+	struct IIS2MDC_Decimator *Decimators;
+	struct IIS2MDC_Queue *Queue; /*Zero copy sample queue the DRDY interrupt reads into, NULL if unused*/
+	int32_t MagX;
+	int32_t MagY;
+	int32_t MagZ;
+}IIS2MDC_Handle_t;
+
+
 /**************************************//**************************************//**************************************
  * Defines
  **************************************//**************************************//**************************************/
@@ -151,11 +218,28 @@ typedef struct{
  * Public Function Prototypes
  **************************************//**************************************//**************************************/
 void IIS2MDC_Init(IIS2MDC_InitStruct_t Settings, IIS2MDC_Handle_t *Dev, IIS2MDC_IO_Drv_t LowLevelDrivers);
+void IIS2MDC_InitStart(IIS2MDC_InitStruct_t Settings, IIS2MDC_Handle_t *Dev, IIS2MDC_IO_Drv_t LowLevelDrivers);
+void IIS2MDC_InitComplete(IIS2MDC_Handle_t *Dev);
+uint8_t IIS2MDC_BootPending(IIS2MDC_Handle_t *Dev);
 void IIS2MDC_DeInit(IIS2MDC_Handle_t *Dev);
 void IIS2MDC_Reset(IIS2MDC_Handle_t *Dev);
 void IIS2MDC_StartConversion(IIS2MDC_Handle_t *Dev);
 IIS2MDC_DataReadyStatus_t IIS2MDC_ReadMagnetic(IIS2MDC_Handle_t *Dev);
 void IIS2MDC_ReadReg(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length);
 void IIS2MDC_WriteReg(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length);
+void IIS2MDC_AttachFilter(IIS2MDC_Handle_t *Dev, IIS2MDC_FilterStage_t *Chain);
+void IIS2MDC_RegisterCallback(IIS2MDC_Handle_t *Dev, IIS2MDC_CallbackID_t ID, IIS2MDC_Callback_t Callback);
+IIS2MDC_DataReadyStatus_t IIS2MDC_ServiceIRQ(IIS2MDC_Handle_t *Dev);
+void IIS2MDC_PublishRaw(IIS2MDC_Handle_t *Dev, uint8_t *pdata);
+IIS2MDC_BusState_t IIS2MDC_RecoverBus(IIS2MDC_Handle_t *Dev);
+IIS2MDC_Status_t IIS2MDC_Reconfigure(IIS2MDC_Handle_t *Dev, const IIS2MDC_InitStruct_t *Settings);
+IIS2MDC_Status_t IIS2MDC_SetDataRate(IIS2MDC_Handle_t *Dev, IIS2MDC_OutputDataRate_t DataRate);
+IIS2MDC_Status_t IIS2MDC_SetPowerMode(IIS2MDC_Handle_t *Dev, IIS2MDC_ResolutionPowerMode_t PowerMode);
+IIS2MDC_Status_t IIS2MDC_SetLowPassFilter(IIS2MDC_Handle_t *Dev, IIS2MDC_LowPassFilterMode_t LPF);
+IIS2MDC_Status_t IIS2MDC_SetTemperatureComp(IIS2MDC_Handle_t *Dev, IIS2MDC_TemperatureComp_t TempComp);
+IIS2MDC_Status_t IIS2MDC_SetOffsetCancellation(IIS2MDC_Handle_t *Dev, IIS2MDC_OffsetCancelation_t Mode, IIS2MDC_OffsetCancelationPulseMode_t Pulse);
+IIS2MDC_Status_t IIS2MDC_SetIRQConfig(IIS2MDC_Handle_t *Dev, IIS2MDC_IRQConfig_t IRQConfig, int16_t Threshold);
+IIS2MDC_Status_t IIS2MDC_SetCalibration(IIS2MDC_Handle_t *Dev, const IIS2MDC_Calibration_t *Calibration);
+const IIS2MDC_Calibration_t* IIS2MDC_CalibrationForEpoch(const IIS2MDC_Handle_t *Dev, uint8_t Epoch);
 
 #endif /* INC_IIS2MDC_H_ */
@@ -0,0 +1,68 @@
+/*
+ * IIS2MDC_Adaptive.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_ADAPTIVE_H_
+#define INC_IIS2MDC_ADAPTIVE_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_ADAPTIVE_MAX_LEVELS (8U)
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+typedef struct{
+	IIS2MDC_OutputDataRate_t DataRate;
+	IIS2MDC_ResolutionPowerMode_t PowerMode;
+}IIS2MDC_AdaptiveLevel_t;
+
+/*Rates in milligauss per second, times in ms. Motion is measured over at least WindowMs so sensor noise does not
+ *read as motion at high ODRs.*/
+typedef struct{
+	const IIS2MDC_AdaptiveLevel_t *Levels; /*Slowest first. NULL selects 10 Hz low power up to 100 Hz high resolution.*/
+	uint8_t NumLevels;
+	uint32_t MotionRate;  /*Field change rate above this is motion*/
+	uint32_t StillRate;   /*Below this is still. Between the two the level holds (hysteresis).*/
+	uint32_t WindowMs;
+	uint32_t StepUpMs;    /*Motion lasting this long jumps to the fastest level, bounds the added latency*/
+	uint32_t StepDownMs;  /*Stillness lasting this long drops one level, the timer restarts after each step*/
+}IIS2MDC_AdaptiveConfig_t;
+
+typedef struct{
+	IIS2MDC_AdaptiveConfig_t Config;
+	IIS2MDC_Handle_t *Dev;
+	uint8_t Level;
+	uint8_t HasReference;
+	int32_t Reference[3];
+	uint32_t ReferenceTime;
+	uint32_t MotionSince;
+	uint32_t StillSince;
+	uint8_t Moving;
+	uint8_t Still;
+	uint32_t LastTime;
+	uint32_t Rate;            /*Last measured field change rate*/
+	struct{
+		uint32_t TimeInLevel[IIS2MDC_ADAPTIVE_MAX_LEVELS]; /*ms spent at each level*/
+		uint32_t StepsUp;
+		uint32_t StepsDown;
+		uint32_t Failed;      /*Level changes the bus rejected, retried on the next sample*/
+	}Stats;
+}IIS2MDC_Adaptive_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Adaptive_Init(IIS2MDC_Adaptive_t *Ctrl, IIS2MDC_Handle_t *Dev, IIS2MDC_AdaptiveConfig_t Config, uint32_t Timestamp);
+uint8_t IIS2MDC_Adaptive_Process(IIS2MDC_Adaptive_t *Ctrl, const int32_t Sample[3], uint32_t Timestamp);
+
+#endif /* INC_IIS2MDC_ADAPTIVE_H_ */
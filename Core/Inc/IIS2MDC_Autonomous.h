@@ -0,0 +1,50 @@
+/*
+ * IIS2MDC_Autonomous.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_AUTONOMOUS_H_
+#define INC_IIS2MDC_AUTONOMOUS_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+typedef struct{
+	uint32_t Samples;
+	uint32_t Stale;      /*Reads that found no new sample, the ODR is slower than the read period*/
+	uint32_t Overruns;   /*The sensor overwrote a sample before it was read*/
+	uint32_t Wakeups;    /*Blocks parsed, one core wake up each*/
+	uint32_t Errors;     /*NACK, bus or DMA errors. The reads restart from the first slot.*/
+	uint32_t Dropped;    /*Blocks the DMA overwrote before Process got to them*/
+}IIS2MDC_AutonomousStats_t;
+
+/*The ring holds two blocks of WakeEvery reads: the DMA fills one while the core parses the other*/
+typedef struct{
+	IIS2MDC_Handle_t *Dev;
+	IIS2MDC_Autonomous_Drv_t Autonomous_IO;
+	const volatile uint8_t *Ring;
+	uint8_t Slots;
+	uint8_t WakeEvery;
+	uint8_t ReadSlot;
+	volatile uint8_t BlocksPending;
+	volatile uint8_t Restarted;
+	IIS2MDC_AutonomousStats_t Stats;
+}IIS2MDC_Autonomous_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Autonomous_Init(IIS2MDC_Autonomous_t *A, IIS2MDC_Handle_t *Dev, IIS2MDC_Autonomous_Drv_t LowLevelDrivers, uint32_t PeriodMs, uint8_t WakeEvery);
+void IIS2MDC_Autonomous_DeInit(IIS2MDC_Autonomous_t *A);
+void IIS2MDC_Autonomous_BlockEvent(IIS2MDC_Autonomous_t *A, uint8_t Error);
+uint16_t IIS2MDC_Autonomous_Process(IIS2MDC_Autonomous_t *A);
+
+#endif /* INC_IIS2MDC_AUTONOMOUS_H_ */
@@ -0,0 +1,79 @@
+/*
+ * IIS2MDC_Compress.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_COMPRESS_H_
+#define INC_IIS2MDC_COMPRESS_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_COMPRESS_MAX_BYTES (18U)      /*Most bytes one call to IIS2MDC_Encoder_Encode or _Flush can write*/
+#define IIS2MDC_COMPRESS_CHANNELS (4U)        /*Timestamp, X, Y, Z*/
+#define IIS2MDC_COMPRESS_ESCAPE (16U)         /*Rice quotients this large are replaced by the raw value*/
+#define IIS2MDC_COMPRESS_RAW_BITS (17U)       /*Width of an escaped value, any int16 delta fits once zigzagged*/
+#define IIS2MDC_COMPRESS_KEY_BYTES (12U)      /*Keyframe payload: timestamp, last interval, X, Y, Z, little endian*/
+#define IIS2MDC_COMPRESS_MEAN_INIT (64U)      /*Model mean after a keyframe, a Rice parameter of 2*/
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*Both ends keep the same model and update it after every sample, nothing about it is transmitted*/
+typedef struct{
+	int16_t Last[3];
+	uint32_t LastTime;
+	int32_t LastInterval;
+	uint32_t Mean[IIS2MDC_COMPRESS_CHANNELS]; /*16 x running mean of each channel's coded value, sets its Rice parameter*/
+}IIS2MDC_CompressModel_t;
+
+/*Streaming encoder, one call per sample. Samples are coded as a bit stream:
+ * Keyframe: bit 1, zero padding to a byte boundary, then IIS2MDC_COMPRESS_KEY_BYTES raw bytes. Resets the model, so
+ *           decoding can start at any keyframe whose offset is known.
+ * Delta:    bit 0, then the change in sample interval and the X, Y, Z deltas, each zigzagged and Rice coded with a
+ *           parameter adapted from its running mean. Rice codes are q zeros, a one, then k bits.
+ *A block is what lies between Init or Flush and the next Flush. It always starts with a keyframe and has to be decoded
+ *from its first byte, so blocks are the unit to frame or store.*/
+typedef struct{
+	IIS2MDC_CompressModel_t Model;
+	uint32_t Bits;          /*Pending bits, MSB first*/
+	uint8_t BitCount;       /*Less than 8 between calls*/
+	uint16_t KeyInterval;   /*Samples between keyframes, 0 for one per block only*/
+	uint16_t SinceKey;
+	uint8_t KeyPending;
+	uint32_t Samples;
+	uint32_t Keyframes;
+	uint32_t Bytes;
+}IIS2MDC_Encoder_t;
+
+typedef struct{
+	IIS2MDC_CompressModel_t Model;
+	const uint8_t *Data;
+	uint32_t Length;        /*Bytes*/
+	uint32_t BitPosition;
+	uint8_t Started;        /*Cleared until the first keyframe, deltas before it can't be decoded*/
+}IIS2MDC_Decoder_t;
+
+typedef enum{
+	IIS2MDC_DecodeSample,
+	IIS2MDC_DecodeEnd,      /*Out of data, or only padding left*/
+	IIS2MDC_DecodeCorrupt   /*Delta before any keyframe*/
+}IIS2MDC_DecodeStatus_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_Encoder_Init(IIS2MDC_Encoder_t *E, uint16_t KeyInterval);
+uint8_t IIS2MDC_Encoder_Encode(IIS2MDC_Encoder_t *E, const int16_t Field[3], uint32_t Timestamp, uint8_t *Out);
+uint8_t IIS2MDC_Encoder_Flush(IIS2MDC_Encoder_t *E, uint8_t *Out);
+void IIS2MDC_Decoder_Init(IIS2MDC_Decoder_t *D, const uint8_t *Data, uint32_t Length);
+IIS2MDC_DecodeStatus_t IIS2MDC_Decoder_Decode(IIS2MDC_Decoder_t *D, int16_t Field[3], uint32_t *Timestamp);
+
+#endif /* INC_IIS2MDC_COMPRESS_H_ */
@@ -0,0 +1,47 @@
+/*
+ * IIS2MDC_Convert.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_CONVERT_H_
+#define INC_IIS2MDC_CONVERT_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_CAL_MATRIX_FRAC_BITS (14U) /*Calibration matrix coefficients are Q1.14*/
+#define IIS2MDC_CAL_Q14(x) ((int16_t)((x) * (1 << IIS2MDC_CAL_MATRIX_FRAC_BITS) + (((x) < 0) ? -0.5 : 0.5)))
+#define IIS2MDC_SENSITIVITY_FRAC_BITS (8U)
+#define IIS2MDC_SENSITIVITY_MG_PER_LSB_Q8 (384) /*1.5 mG/LSB*/
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*Hard iron bias (raw LSB) is subtracted first, then the soft iron matrix is applied.
+ *The sum of absolute coefficients in each matrix row must stay below 2.0 so the accumulator can not overflow.*/
+typedef struct{
+	int16_t Bias[3];
+	int16_t Matrix[3][3];
+}IIS2MDC_Calibration_t;
+
+/**************************************//**************************************//**************************************
+ * Public/Exported Variables
+ **************************************//**************************************//**************************************/
+extern const IIS2MDC_Calibration_t IIS2MDC_DefaultCalibration;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_ConvertBlock(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count);
+void IIS2MDC_ConvertBlockReference(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count);
+void IIS2MDC_UnpackBlock(const uint8_t *pdata, int16_t *raw, uint32_t count);
+void IIS2MDC_ScaleBlock(const int16_t *in, int32_t *milligauss, uint32_t count);
+
+#endif /* INC_IIS2MDC_CONVERT_H_ */
@@ -0,0 +1,54 @@
+/*
+ * IIS2MDC_Decimator.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_DECIMATOR_H_
+#define INC_IIS2MDC_DECIMATOR_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_CIC_MAX_ORDER (3U)
+#define IIS2MDC_CIC_INPUT_BITS (20U)  /*Signed input range, the calibrated mG of the 49 G sensor with headroom*/
+#define IIS2MDC_CIC_MAX_GAIN (1ULL << (63U - IIS2MDC_CIC_INPUT_BITS)) /*Ratio^Order, the output must fit the 64 bit state*/
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+typedef void (*IIS2MDC_DecimatorCallback_t)(const int32_t Sample[3], void *Context);
+
+/*CIC decimator: Order 1 is a boxcar average of Ratio samples, higher orders trade settling time for alias rejection.
+ *Each subscriber is statically allocated by the user and decimates the full rate stream independently.
+ *The integrators grow without bound and wrap, which is how a CIC works: state is unsigned so the wrap is defined, and
+ *the comb differences are exact as long as the output fits, which IIS2MDC_CIC_MAX_GAIN guarantees.*/
+typedef struct IIS2MDC_Decimator{
+	uint16_t Ratio;
+	uint8_t Order;
+	uint16_t Phase;
+	int64_t Gain;
+	uint64_t Integrator[3][IIS2MDC_CIC_MAX_ORDER];
+	uint64_t Comb[3][IIS2MDC_CIC_MAX_ORDER];
+	int32_t Output[3];
+	uint32_t OutputCount;
+	IIS2MDC_DecimatorCallback_t Callback;
+	void *Context;
+	struct IIS2MDC_Decimator *Next;
+}IIS2MDC_Decimator_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_Decimator_Init(IIS2MDC_Decimator_t *Decimator, uint16_t Ratio, uint8_t Order, IIS2MDC_DecimatorCallback_t Callback, void *Context);
+void IIS2MDC_Decimator_Subscribe(IIS2MDC_Handle_t *Dev, IIS2MDC_Decimator_t *Decimator);
+void IIS2MDC_Decimator_Unsubscribe(IIS2MDC_Handle_t *Dev, IIS2MDC_Decimator_t *Decimator);
+void IIS2MDC_Decimator_Push(IIS2MDC_Decimator_t *List, const int32_t Sample[3]);
+
+#endif /* INC_IIS2MDC_DECIMATOR_H_ */
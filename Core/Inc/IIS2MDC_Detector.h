@@ -0,0 +1,77 @@
+/*
+ * IIS2MDC_Detector.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_DETECTOR_H_
+#define INC_IIS2MDC_DETECTOR_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_DETECTOR_QUEUE_LENGTH (8U)
+
+/**************************************//**************************************//**************************************
+ * Typedefs / Enumerations
+ **************************************//**************************************//**************************************/
+typedef enum{
+	IIS2MDC_EventAboveHigh,
+	IIS2MDC_EventHighCleared,
+	IIS2MDC_EventBelowLow,
+	IIS2MDC_EventLowCleared,
+	IIS2MDC_EventRateOfChange
+}IIS2MDC_DetectorEventType_t;
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*Magnitudes in milligauss, rates in milligauss per second so they keep their meaning when the ODR changes.
+ *A threshold of 0 disables that detector.*/
+typedef struct{
+	uint32_t HighThreshold;   /*Field magnitude above this raises IIS2MDC_EventAboveHigh*/
+	uint32_t LowThreshold;    /*Field magnitude below this raises IIS2MDC_EventBelowLow*/
+	uint32_t RateThreshold;   /*Change of the field vector per second, measured between consecutive samples*/
+	uint32_t Hysteresis;      /*Distance back past a threshold before the condition clears and can trigger again*/
+	uint32_t RateHysteresis;  /*Same for the rate, in mG/s*/
+	void (*Notify)(void);     /*Run after events are queued, e.g. to post to the main loop. May be NULL.*/
+}IIS2MDC_DetectorConfig_t;
+
+typedef struct{
+	IIS2MDC_DetectorEventType_t Type;
+	uint32_t Timestamp;
+	uint32_t Value;           /*Field magnitude, or rate in mG/s for IIS2MDC_EventRateOfChange*/
+}IIS2MDC_DetectorEvent_t;
+
+typedef struct{
+	IIS2MDC_DetectorConfig_t Config;
+	uint8_t HighActive;
+	uint8_t LowActive;
+	uint8_t RateActive;
+	uint8_t HasPrevious;
+	int32_t Previous[3];
+	uint32_t PreviousTime;
+	uint32_t Magnitude;
+	uint32_t Rate;            /*Last measured rate of change in mG/s*/
+	IIS2MDC_DetectorEvent_t Queue[IIS2MDC_DETECTOR_QUEUE_LENGTH];
+	uint8_t Head;
+	uint8_t Tail;
+	uint32_t Dropped;
+}IIS2MDC_Detector_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_Detector_Init(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorConfig_t Config);
+void IIS2MDC_Detector_Process(IIS2MDC_Detector_t *Detector, const int32_t Sample[3], uint32_t Timestamp);
+uint8_t IIS2MDC_Detector_GetEvent(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorEvent_t *Event);
+uint32_t IIS2MDC_ISqrt(uint64_t value);
+uint32_t IIS2MDC_Magnitude(const int32_t Vector[3]);
+
+#endif /* INC_IIS2MDC_DETECTOR_H_ */
@@ -0,0 +1,93 @@
+/*
+ * IIS2MDC_Filter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_FILTER_H_
+#define INC_IIS2MDC_FILTER_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_FILTER_MAX_WINDOW (32U)
+#define IIS2MDC_BIQUAD_FRAC_BITS (28U)
+#define IIS2MDC_BIQUAD_Q28(x) ((int32_t)((x) * (1L << IIS2MDC_BIQUAD_FRAC_BITS) + (((x) < 0) ? -0.5 : 0.5)))
+
+/**************************************//**************************************//**************************************
+ * Typedefs / Enumerations
+ **************************************//**************************************//**************************************/
+typedef enum{
+	IIS2MDC_FilterMovingAverage,
+	IIS2MDC_FilterMedian,
+	IIS2MDC_FilterBiquad
+}IIS2MDC_FilterType_t;
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*y = B0*x + B1*x[-1] + B2*x[-2] - A1*y[-1] - A2*y[-2], coefficients in Q4.28 with a0 normalized to 1*/
+typedef struct{
+	int32_t B0;
+	int32_t B1;
+	int32_t B2;
+	int32_t A1;
+	int32_t A2;
+}IIS2MDC_BiquadCoeffs_t;
+
+typedef struct{
+	int32_t Sum[3];
+	int32_t History[3][IIS2MDC_FILTER_MAX_WINDOW];
+}IIS2MDC_MovingAverage_t;
+
+/*Sliding median as two heaps over the window: Low is a max-heap of the smaller half, High a min-heap of the larger half.
+ *Each sample's heap position is tracked so the expiring sample can be replaced in place in O(log n).*/
+typedef struct{
+	int32_t Value[IIS2MDC_FILTER_MAX_WINDOW];
+	uint8_t Position[IIS2MDC_FILTER_MAX_WINDOW];
+	uint8_t Low[IIS2MDC_FILTER_MAX_WINDOW / 2 + 1]; /*+1: a heap briefly holds one extra sample while rebalancing*/
+	uint8_t High[IIS2MDC_FILTER_MAX_WINDOW / 2 + 1];
+	uint8_t LowCount;
+	uint8_t HighCount;
+}IIS2MDC_Median_t;
+
+typedef struct{
+	IIS2MDC_BiquadCoeffs_t Coeffs;
+	int32_t X1[3];
+	int32_t X2[3];
+	int32_t Y1[3];
+	int32_t Y2[3];
+	int64_t Residual[3];
+}IIS2MDC_Biquad_t;
+
+/*One stage of a filter chain. Stages are statically allocated by the user and linked with IIS2MDC_Filter_Append.*/
+typedef struct IIS2MDC_FilterStage{
+	IIS2MDC_FilterType_t Type;
+	uint8_t Window;
+	uint8_t Count;
+	uint8_t Oldest;
+	union{
+		IIS2MDC_MovingAverage_t MovingAverage;
+		IIS2MDC_Median_t Median[3];
+		IIS2MDC_Biquad_t Biquad;
+	}State;
+	struct IIS2MDC_FilterStage *Next;
+}IIS2MDC_FilterStage_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_Filter_InitMovingAverage(IIS2MDC_FilterStage_t *Stage, uint8_t Window);
+void IIS2MDC_Filter_InitMedian(IIS2MDC_FilterStage_t *Stage, uint8_t Window);
+void IIS2MDC_Filter_InitBiquad(IIS2MDC_FilterStage_t *Stage, const IIS2MDC_BiquadCoeffs_t *Coeffs);
+IIS2MDC_FilterStage_t *IIS2MDC_Filter_Append(IIS2MDC_FilterStage_t *Chain, IIS2MDC_FilterStage_t *Stage);
+void IIS2MDC_Filter_Reset(IIS2MDC_FilterStage_t *Chain);
+void IIS2MDC_Filter_Apply(IIS2MDC_FilterStage_t *Chain, int32_t Sample[3]);
+
+#endif /* INC_IIS2MDC_FILTER_H_ */
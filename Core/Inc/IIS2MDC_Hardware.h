@@ -18,30 +18,85 @@
 typedef enum{
 	IIS2MDC_IRQEnable,
 	IIS2MDC_IRQDisable,
-	IIS2MDC_ReadIntPin
+	IIS2MDC_ReadIntPin,
+	IIS2MDC_BusClear,  /*Clock out a slave holding SDA low and send a STOP*/
+	IIS2MDC_BusReinit, /*Reset and re-initialize the bus peripheral*/
+	IIS2MDC_InterfaceBits, /*Returns the CFG_REG_C interface bits (I2C_DIS, 4WSPI) the transport needs kept set*/
+	IIS2MDC_BootRemaining, /*Returns the ms left until the sensor has booted, 0 once it can be accessed*/
+	IIS2MDC_BootWait       /*Blocks for whatever is left of the boot time and finishes transport setup that needs the sensor awake*/
 }IIS2MDC_Cmd_t;
 
 typedef enum{
 	IIS2MDC_Ok,
-	IIS2MDC_Error
+	IIS2MDC_Error,
+	IIS2MDC_ErrorNack,
+	IIS2MDC_ErrorArbitrationLost,
+	IIS2MDC_ErrorTimeout
 }IIS2MDC_Status_t;
 
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_BOOT_MS (20U) /*Power up / reboot time before the registers can be accessed*/
+#define IIS2MDC_AUTONOMOUS_SLOT_SIZE (8U) /*Ring stride for autonomous reads, a register block of up to 8 bytes*/
+#define IIS2MDC_AUTONOMOUS_MAX_SLOTS (16U)
+
 /**************************************//**************************************//**************************************
  * Driver Structs
  **************************************//**************************************//**************************************/
+/*Completion of a non blocking read, runs from the transport's interrupt*/
+typedef void (*IIS2MDC_ReadDone_t)(void *Context, IIS2MDC_Status_t Status);
+
 typedef struct{
 	void (*Init)(void);
 	void (*DeInit)(void);
 	IIS2MDC_Status_t (*ReadReg)(uint8_t, uint8_t*, uint8_t);
 	IIS2MDC_Status_t (*WriteReg)(uint8_t, uint8_t*, uint8_t);
 	uint8_t (*ioctl)(IIS2MDC_Cmd_t);
+	IIS2MDC_Status_t (*ReadRegAsync)(uint8_t, uint8_t*, uint8_t, IIS2MDC_ReadDone_t, void*); /*Optional, NULL if the transport can only block*/
 }IIS2MDC_IO_Drv_t;
 
+/*Low power timer and sleep hooks. The timer must keep running while asleep, ReadTimer returns its free running 16 bit count.
+ *Sleep is called between EnterCritical/ExitCritical and must return on any pending interrupt.*/
+typedef struct{
+	void (*Init)(void);
+	void (*StartTimer)(uint8_t, uint16_t);
+	void (*StopTimer)(void);
+	uint16_t (*ReadTimer)(void);
+	void (*Sleep)(void);
+	void (*EnterCritical)(void);
+	void (*ExitCritical)(void);
+	uint32_t TimerClockHz;
+}IIS2MDC_LowPower_Drv_t;
+
+/*Register block reads done by DMA on a timer while the core sleeps. Start returns the ring the slots land in, NULL if
+ *the bus is busy. The interrupt raised after every WakeEvery slots must reach IIS2MDC_Autonomous_BlockEvent.*/
+typedef struct{
+	void (*Init)(void);
+	const volatile uint8_t* (*Start)(uint8_t Reg, uint8_t Length, uint8_t Slots, uint8_t WakeEvery, uint8_t PrescalerLog2, uint16_t PeriodTicks);
+	void (*Stop)(void);
+	void (*Sleep)(void);
+	void (*EnterCritical)(void);
+	void (*ExitCritical)(void);
+	uint32_t TimerClockHz;
+}IIS2MDC_Autonomous_Drv_t;
+
+/*Byte stream off the board. Write queues the whole buffer or none of it and returns without waiting for the link.*/
+typedef struct{
+	uint8_t (*Write)(const uint8_t*, uint16_t); /*Non zero if queued*/
+}IIS2MDC_Telemetry_Drv_t;
+
 
 /**************************************//**************************************//**************************************
  * Public/Exported Variables
  **************************************//**************************************//**************************************/
 extern IIS2MDC_IO_Drv_t IIS2MDC_Hardware_Drv;
+#ifdef HAL_SPI_MODULE_ENABLED /*Visible once stm32u5xx_hal.h has been included*/
+extern IIS2MDC_IO_Drv_t IIS2MDC_Hardware_SPI_Drv;
+#endif
+extern IIS2MDC_LowPower_Drv_t IIS2MDC_LowPower_Hardware_Drv;
+extern IIS2MDC_Autonomous_Drv_t IIS2MDC_Autonomous_Hardware_Drv;
+extern IIS2MDC_Telemetry_Drv_t IIS2MDC_Telemetry_Hardware_Drv;
 
 
 #endif /* INC_IIS2MDC_HARDWARE_H_ */
@@ -0,0 +1,34 @@
+/*
+ * IIS2MDC_Heading.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_HEADING_H_
+#define INC_IIS2MDC_HEADING_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_CENTIDEG_90 (9000)
+#define IIS2MDC_CENTIDEG_180 (18000)
+#define IIS2MDC_CENTIDEG_360 (36000)
+#define IIS2MDC_TRIG_FRAC_BITS (15U) /*IIS2MDC_Sin/IIS2MDC_Cos results are Q15*/
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+int32_t IIS2MDC_Atan2(int32_t y, int32_t x);
+uint16_t IIS2MDC_WrapHeading(int32_t centidegrees);
+int16_t IIS2MDC_Sin(int32_t centidegrees);
+int16_t IIS2MDC_Cos(int32_t centidegrees);
+void IIS2MDC_SetDeclination(IIS2MDC_Handle_t *Dev, int16_t Declination);
+uint16_t IIS2MDC_GetHeading(IIS2MDC_Handle_t *Dev);
+
+#endif /* INC_IIS2MDC_HEADING_H_ */
@@ -0,0 +1,57 @@
+/*
+ * IIS2MDC_LowPower.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_LOWPOWER_H_
+#define INC_IIS2MDC_LOWPOWER_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Typedefs / Enumerations
+ **************************************//**************************************//**************************************/
+typedef enum{
+	IIS2MDC_LowPowerIdle,
+	IIS2MDC_LowPowerConverting
+}IIS2MDC_LowPowerState_t;
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+typedef struct{
+	uint32_t SleepTicks;
+	uint32_t AwakeTicks;
+	uint32_t Samples;
+	uint32_t MissedTriggers;
+}IIS2MDC_LowPowerStats_t;
+
+typedef struct{
+	IIS2MDC_Handle_t *Dev;
+	IIS2MDC_LowPower_Drv_t LowPower_IO;
+	IIS2MDC_LowPowerState_t State;
+	volatile uint8_t TriggerPending;
+	uint8_t PrescalerLog2;
+	uint16_t PeriodTicks;
+	uint16_t LastTimestamp;
+	uint64_t TotalTicks;      /*Timer ticks since Init, asleep or not*/
+	IIS2MDC_LowPowerStats_t Stats;
+}IIS2MDC_LowPower_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_LowPower_Init(IIS2MDC_LowPower_t *LP, IIS2MDC_Handle_t *Dev, IIS2MDC_LowPower_Drv_t LowLevelDrivers, uint32_t PeriodMs);
+void IIS2MDC_LowPower_DeInit(IIS2MDC_LowPower_t *LP);
+void IIS2MDC_LowPower_TimerEvent(IIS2MDC_LowPower_t *LP);
+IIS2MDC_DataReadyStatus_t IIS2MDC_LowPower_Process(IIS2MDC_LowPower_t *LP);
+uint16_t IIS2MDC_LowPower_SleepPermille(const IIS2MDC_LowPower_t *LP);
+uint32_t IIS2MDC_LowPower_ElapsedMs(const IIS2MDC_LowPower_t *LP);
+
+#endif /* INC_IIS2MDC_LOWPOWER_H_ */
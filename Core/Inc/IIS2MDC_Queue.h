@@ -0,0 +1,72 @@
+/*
+ * IIS2MDC_Queue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_QUEUE_H_
+#define INC_IIS2MDC_QUEUE_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_QUEUE_CONVERTED (0x80U) /*Set in a slot's epoch tag once its calibrated value is memoized*/
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+typedef void (*IIS2MDC_QueueNotify_t)(void);
+
+typedef struct{
+	uint32_t Samples;  /*Reads that landed in a slot*/
+	uint32_t Dropped;  /*Reads discarded because no slot was free*/
+	uint32_t Busy;     /*DRDY while the previous read was still in flight*/
+	uint32_t Errors;   /*Failed reads, retried by the next Acquire*/
+	uint32_t Conversions;   /*Slots calibrated, each at most once*/
+	uint32_t EpochExpired;  /*Slots whose calibration was replaced too many times since capture, converted with the current one*/
+}IIS2MDC_QueueStats_t;
+
+/*User storage, each array holds Length slots*/
+typedef struct{
+	int16_t *Raw;          /*3 * Length values, X,Y,Z interleaved. DMA target, never modified by the CPU.*/
+	int16_t *Calibrated;   /*3 * Length values, filled on first request*/
+	uint32_t *Timestamp;   /*Time of the DRDY edge*/
+	uint8_t *Epoch;        /*Dev->CalibrationEpoch at the DRDY edge, plus IIS2MDC_QUEUE_CONVERTED*/
+	uint16_t Length;       /*Power of 2*/
+}IIS2MDC_QueueStorage_t;
+
+/*Sample queue the DMA writes into directly. Each slot is one XYZ triplet: OUTX_L..OUTZ_H are little endian, so the
+ *register bytes already are the int16 samples. The next slot is the target of the read in flight while the consumer
+ *works on the ones before it. Nothing is converted in the interrupt: slots carry the calibration epoch they were
+ *captured in and are calibrated only when a consumer asks, once.*/
+typedef struct IIS2MDC_Queue{
+	IIS2MDC_Handle_t *Dev;
+	IIS2MDC_QueueStorage_t Storage;
+	volatile uint16_t Head;     /*Free running count of slots the DMA has filled*/
+	volatile uint16_t Tail;     /*Free running count of slots the consumer has released*/
+	volatile uint8_t InFlight;
+	volatile uint8_t RetryPending;
+	int16_t *Target;            /*Where the read in flight lands*/
+	uint32_t PendingTimestamp;
+	int16_t Discard[3];         /*Target when the queue is full, the read still has to happen to release DRDY*/
+	IIS2MDC_QueueNotify_t Notify;
+	IIS2MDC_QueueStats_t Stats;
+}IIS2MDC_Queue_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Queue_Init(IIS2MDC_Queue_t *Q, IIS2MDC_Handle_t *Dev, IIS2MDC_QueueStorage_t Storage, IIS2MDC_QueueNotify_t Notify);
+void IIS2MDC_Queue_DeInit(IIS2MDC_Queue_t *Q);
+IIS2MDC_Status_t IIS2MDC_Queue_Read(IIS2MDC_Queue_t *Q, uint32_t Timestamp);
+uint16_t IIS2MDC_Queue_Acquire(IIS2MDC_Queue_t *Q, const int16_t **Raw, const uint32_t **Timestamps);
+const int16_t* IIS2MDC_Queue_Calibrated(IIS2MDC_Queue_t *Q, uint16_t First, uint16_t Count);
+void IIS2MDC_Queue_Release(IIS2MDC_Queue_t *Q, uint16_t Count);
+
+#endif /* INC_IIS2MDC_QUEUE_H_ */
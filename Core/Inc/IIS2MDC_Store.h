@@ -0,0 +1,65 @@
+/*
+ * IIS2MDC_Store.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_STORE_H_
+#define INC_IIS2MDC_STORE_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_STORE_CAPACITY (1536U)       /*Records, 8 bytes each. 12 KB fits SRAM4 next to the autonomous DMA tables.*/
+#define IIS2MDC_STORE_MAGIC (0x53324D49U)    /*"IM2S"*/
+#define IIS2MDC_STORE_TIME_MARK (0xFFFFU)    /*Delta of a record that holds an absolute time instead of a sample*/
+#define IIS2MDC_STORE_NEED_MARK (0x0001U)    /*Header flag: the time base changed, the next append starts with a mark*/
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*A sample is the field in mG saturated to int16 (well past Earth's field) and the ms since the previous record.
+ *A time mark carries the absolute time split low/high over Field[0..1], the sample after it has a delta of 0.*/
+typedef struct{
+	int16_t Field[3];
+	uint16_t Delta;
+}IIS2MDC_StoreRecord_t;
+
+/*Kept with the records so the store survives a reset as well as Stop: Check tells a valid header from power up noise*/
+typedef struct{
+	uint32_t Magic;
+	uint16_t Capacity;
+	uint16_t Head;         /*Next record written*/
+	uint16_t Count;        /*Records not drained yet, time marks included*/
+	uint16_t Flags;
+	uint32_t LastTime;     /*Time of the newest record, deltas are taken from it*/
+	uint32_t TailTime;     /*Time of the oldest record*/
+	uint32_t Overwritten;  /*Samples lost to a full store, the oldest go first*/
+	uint32_t Check;
+}IIS2MDC_StoreHeader_t;
+
+typedef struct{
+	IIS2MDC_StoreHeader_t Header;
+	IIS2MDC_StoreRecord_t Records[IIS2MDC_STORE_CAPACITY];
+}IIS2MDC_Store_t;
+
+typedef struct{
+	int16_t Field[3];
+	uint32_t Timestamp;
+}IIS2MDC_StoreSample_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+uint16_t IIS2MDC_Store_Init(IIS2MDC_Store_t *Store);
+void IIS2MDC_Store_Clear(IIS2MDC_Store_t *Store);
+void IIS2MDC_Store_Append(IIS2MDC_Store_t *Store, const int32_t Field[3], uint32_t Timestamp);
+uint16_t IIS2MDC_Store_Drain(IIS2MDC_Store_t *Store, IIS2MDC_StoreSample_t *Out, uint16_t Max);
+
+#endif /* INC_IIS2MDC_STORE_H_ */
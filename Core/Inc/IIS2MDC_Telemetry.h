@@ -0,0 +1,68 @@
+/*
+ * IIS2MDC_Telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_TELEMETRY_H_
+#define INC_IIS2MDC_TELEMETRY_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include "IIS2MDC_Compress.h"
+#include "telemetry.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Defines
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_TELEMETRY_TYPE_SAMPLES (0x01U) /*Payload is one IIS2MDC_Compress block of XYZ in mG, timestamps in ms*/
+#define IIS2MDC_TELEMETRY_TYPE_CONFIG (0x02U)  /*Payload is the sensor configuration samples were taken with, see below*/
+#define IIS2MDC_TELEMETRY_MAX_SAMPLES (32U)
+#define IIS2MDC_TELEMETRY_CONFIG_BYTES (39U)
+#define IIS2MDC_TELEMETRY_CONFIG_PERIOD (64U)  /*Sample frames between repeats of an unchanged configuration*/
+#define IIS2MDC_TELEMETRY_PAYLOAD_BYTES (IIS2MDC_TELEMETRY_MAX_SAMPLES * IIS2MDC_COMPRESS_MAX_BYTES + 1U)
+#define IIS2MDC_TELEMETRY_FRAME_BYTES TELEMETRY_FRAME_MAX(IIS2MDC_TELEMETRY_PAYLOAD_BYTES)
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+typedef struct{
+	uint32_t Frames;    /*Queued on the link*/
+	uint32_t Samples;
+	uint32_t Dropped;   /*Frames the link had no room for. Their sequence numbers are skipped so the receiver sees the gap.*/
+	uint32_t Bytes;     /*On the wire, delimiters included*/
+}IIS2MDC_TelemetryStats_t;
+
+/*Collects samples into compressed blocks, one block per frame. Every frame starts with a keyframe, so a lost or
+ *corrupted frame costs only its own samples.
+ *With a sensor attached a configuration frame goes out ahead of the samples whenever the sensor's registers,
+ *calibration or declination change, and every IIS2MDC_TELEMETRY_CONFIG_PERIOD frames for receivers that start late.
+ *Its payload, little endian: register image (12 bytes, as IIS2MDC_RegisterImage_t), calibration bias (3 x int16 LSB),
+ *calibration matrix (9 x int16 Q1.14, row major), declination (int16 centidegrees), calibration epoch (uint8).*/
+typedef struct{
+	IIS2MDC_Telemetry_Drv_t Telemetry_IO;
+	IIS2MDC_Encoder_t Encoder;
+	uint8_t SamplesPerFrame;
+	uint8_t Count;
+	uint8_t Sequence;
+	uint16_t Length;
+	uint8_t Payload[IIS2MDC_TELEMETRY_PAYLOAD_BYTES];
+	uint8_t Frame[IIS2MDC_TELEMETRY_FRAME_BYTES];
+	const IIS2MDC_Handle_t *Sensor;  /*NULL sends samples only*/
+	uint8_t Config[IIS2MDC_TELEMETRY_CONFIG_BYTES]; /*Last configuration sent*/
+	uint8_t SinceConfig;
+	IIS2MDC_TelemetryStats_t Stats;
+}IIS2MDC_Telemetry_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Telemetry_Init(IIS2MDC_Telemetry_t *T, IIS2MDC_Telemetry_Drv_t LowLevelDrivers, uint8_t SamplesPerFrame);
+void IIS2MDC_Telemetry_AttachSensor(IIS2MDC_Telemetry_t *T, const IIS2MDC_Handle_t *Sensor);
+void IIS2MDC_Telemetry_Append(IIS2MDC_Telemetry_t *T, const int32_t Field[3], uint32_t Timestamp);
+void IIS2MDC_Telemetry_Flush(IIS2MDC_Telemetry_t *T);
+
+#endif /* INC_IIS2MDC_TELEMETRY_H_ */
@@ -0,0 +1,42 @@
+/*
+ * IIS2MDC_Tilt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_IIS2MDC_TILT_H_
+#define INC_IIS2MDC_TILT_H_
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+/**************************************//**************************************//**************************************
+ * Driver Structs
+ **************************************//**************************************//**************************************/
+
+/*Any accelerometer can be plugged in. ReadAccel returns the at-rest reading in any unit (mg, raw LSB...) with |value| < 65536,
+ *axes aligned with the magnetometer: X forward, Y left, Z up (reads +1 g when level).*/
+typedef struct{
+	void (*Init)(void);
+	IIS2MDC_Status_t (*ReadAccel)(int32_t*, int32_t*, int32_t*);
+}IIS2MDC_Accel_Drv_t;
+
+typedef struct{
+	IIS2MDC_Handle_t *Dev;
+	IIS2MDC_Accel_Drv_t Accel_IO;
+	int16_t Roll;      /*Centidegrees, positive with the left side up*/
+	int16_t Pitch;     /*Centidegrees, positive with the nose down*/
+	uint16_t Heading;  /*Centidegrees, 0 to 35999, declination applied*/
+}IIS2MDC_Tilt_t;
+
+/**************************************//**************************************//**************************************
+ * Public Function Prototypes
+ **************************************//**************************************//**************************************/
+void IIS2MDC_Tilt_Init(IIS2MDC_Tilt_t *Tilt, IIS2MDC_Handle_t *Dev, IIS2MDC_Accel_Drv_t LowLevelDrivers);
+IIS2MDC_DataReadyStatus_t IIS2MDC_Tilt_ReadMagnetic(IIS2MDC_Tilt_t *Tilt);
+uint16_t IIS2MDC_TiltCompensate(const int32_t Mag[3], const int32_t Accel[3], int16_t *Roll, int16_t *Pitch);
+
+#endif /* INC_IIS2MDC_TILT_H_ */
@@ -0,0 +1,36 @@
+/*
+ * event.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_EVENT_H_
+#define INC_EVENT_H_
+
+#include <stdint.h>
+
+#define EVENT_QUEUE_LENGTH 16 /*Must be a power of 2*/
+
+typedef enum{
+	event_none = 0,
+	event_iis2mdc_drdy = 1,
+	event_iis2mdc_anomaly = 2,
+	event_iis2mdc_samples = 3,
+}Event_Type_t;
+
+typedef struct{
+	uint64_t idle_cycles;
+	uint64_t total_cycles;
+	uint32_t dropped;
+	uint8_t high_water;
+}Event_Stats_t;
+
+void event_init(void);
+void event_post(Event_Type_t event);
+Event_Type_t event_wait(void);
+void event_get_stats(Event_Stats_t *stats);
+uint16_t event_idle_permille(void);
+void event_reset_stats(void);
+
+#endif /* INC_EVENT_H_ */
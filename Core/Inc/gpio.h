@@ -39,6 +39,8 @@ extern "C" {
 void MX_GPIO_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+void IIS2MDC_GPIO_Init(void);
+void IIS2MDC_SPI_GPIO_Init(void);
 
 /* USER CODE END Prototypes */
 
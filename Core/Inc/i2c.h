@@ -29,18 +29,41 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
+#include "i2c_arbiter.h"
+#include "i2c_timing.h"
+#include "lpbam.h"
 
 /* USER CODE END Includes */
 
 extern I2C_HandleTypeDef hi2c2;
 
 /* USER CODE BEGIN Private defines */
+#define I2C2_DEFAULT_SPEED i2c_speed_standard /*Profile applied by MX_I2C2_Init until i2c2_set_speed picks another*/
+#define I2C2_USE_DMA 1 /*0: the arbiter runs polled transfers instead of GPDMA1 channels 0 (RX) and 1 (TX)*/
+
+extern I2C_Arbiter_t i2c2_bus;
+#if I2C2_USE_DMA
+extern DMA_HandleTypeDef handle_GPDMA1_Channel0;
+extern DMA_HandleTypeDef handle_GPDMA1_Channel1;
+#endif
 
 /* USER CODE END Private defines */
 
 void MX_I2C2_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+uint32_t i2c2_timeout_us(uint16_t bytes);
+uint8_t i2c2_set_speed(I2C_Speed_t speed);
+I2C_Speed_t i2c2_get_speed(void);
+I2C_Result_t i2c2_mem_read(uint8_t address, uint8_t reg, uint8_t *pdata, uint8_t length, uint32_t timeout_us);
+I2C_Result_t i2c2_mem_write(uint8_t address, uint8_t reg, const uint8_t *pdata, uint8_t length, uint32_t timeout_us);
+uint8_t i2c2_bus_clear(void);
+void i2c2_reinit(void);
+uint8_t i2c2_autonomous_start(LPBAM_I2C_Read_t *cfg, LPBAM_Table_t *table);
+void i2c2_autonomous_stop(void);
+void i2c2_autonomous_dma_irq(void);
+uint8_t i2c2_autonomous_i2c_irq(void);
+void i2c2_autonomous_callback(uint8_t error);
 
 /* USER CODE END Prototypes */
 
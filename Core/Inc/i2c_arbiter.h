@@ -0,0 +1,91 @@
+/*
+ * i2c_arbiter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_I2C_ARBITER_H_
+#define INC_I2C_ARBITER_H_
+
+#include <stdint.h>
+
+#define I2C_ARBITER_PRIORITIES 3 /*0 is served first*/
+
+typedef enum{
+	i2c_ok = 0,
+	i2c_nack,               /*Address or data byte not acknowledged*/
+	i2c_arbitration_lost,   /*Another master won the bus*/
+	i2c_bus_error,          /*Misplaced START/STOP*/
+	i2c_timeout             /*Deadline passed, the bus is likely held by a slave*/
+}I2C_Result_t;
+
+typedef enum{
+	i2c_transaction_idle = 0,
+	i2c_transaction_queued,
+	i2c_transaction_active,
+	i2c_transaction_done
+}I2C_Transaction_State_t;
+
+/*Owned by the caller and must stay valid until state is i2c_transaction_done*/
+typedef struct I2C_Transaction{
+	uint8_t address;        /*8 bit (shifted) device address*/
+	uint8_t reg;
+	uint8_t *data;
+	uint8_t length;
+	uint8_t read;
+	uint8_t priority;
+	uint32_t timeout_ticks; /*Limit on the active transfer, 0 for none*/
+	void (*done)(struct I2C_Transaction *transaction); /*Runs from the completing context (usually the DMA ISR), may be NULL*/
+	void *context;
+	volatile I2C_Transaction_State_t state;
+	volatile I2C_Result_t result;
+	uint32_t queued_at;
+	uint32_t started_at;
+	struct I2C_Transaction *next;
+}I2C_Transaction_t;
+
+/*start begins a transfer and reports the end through i2c_arbiter_complete, from an ISR or before returning.
+ *abort stops the active transfer and leaves the bus usable, it is called with interrupts enabled and may wait.
+ *Timestamps are free running ticks of timestamp_hz.*/
+typedef struct{
+	void (*start)(I2C_Transaction_t *transaction);
+	void (*abort)(void);
+	uint32_t (*timestamp)(void);
+	uint32_t timestamp_hz;
+	uint32_t (*enter_critical)(void);
+	void (*exit_critical)(uint32_t state);
+}I2C_Arbiter_Drv_t;
+
+typedef struct{
+	uint32_t completed;
+	uint32_t failed;
+	uint32_t aborted;
+	uint64_t total_wait_ticks;  /*Queued to started, summed over completed transactions*/
+	uint32_t max_wait_ticks;
+	uint32_t max_active_ticks;  /*Started to completed*/
+	uint8_t high_water;
+}I2C_Arbiter_Stats_t;
+
+typedef struct{
+	I2C_Arbiter_Drv_t drv;
+	I2C_Transaction_t *head[I2C_ARBITER_PRIORITIES];
+	I2C_Transaction_t *tail[I2C_ARBITER_PRIORITIES];
+	I2C_Transaction_t *volatile active;
+	volatile uint8_t depth;
+	volatile uint8_t dispatching;
+	volatile uint8_t held;      /*Bus lent to hardware outside the queue, transactions wait until release*/
+	volatile uint8_t aborting;  /*A timed out transfer is being aborted, nothing starts until it is over*/
+	I2C_Arbiter_Stats_t stats;
+}I2C_Arbiter_t;
+
+void i2c_arbiter_init(I2C_Arbiter_t *bus, I2C_Arbiter_Drv_t drv);
+void i2c_arbiter_submit(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction);
+void i2c_arbiter_complete(I2C_Arbiter_t *bus, I2C_Result_t result);
+void i2c_arbiter_poll(I2C_Arbiter_t *bus);
+I2C_Result_t i2c_arbiter_transfer(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction, uint32_t timeout_us);
+uint8_t i2c_arbiter_hold(I2C_Arbiter_t *bus);
+void i2c_arbiter_release(I2C_Arbiter_t *bus);
+uint32_t i2c_arbiter_ticks_to_us(const I2C_Arbiter_t *bus, uint32_t ticks);
+
+#endif /* INC_I2C_ARBITER_H_ */
@@ -0,0 +1,31 @@
+/*
+ * i2c_timing.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_I2C_TIMING_H_
+#define INC_I2C_TIMING_H_
+
+#include <stdint.h>
+
+typedef enum{
+	i2c_speed_standard = 0,  /*100 kHz*/
+	i2c_speed_fast,          /*400 kHz*/
+	i2c_speed_fast_plus,     /*1 MHz, needs Fast-mode Plus drive on the pins*/
+	i2c_speed_count
+}I2C_Speed_t;
+
+/*Board dependent edge times, measured or estimated from pull-up and bus capacitance*/
+typedef struct{
+	uint16_t rise_ns;
+	uint16_t fall_ns;
+	uint8_t analog_filter;   /*1 if the analog noise filter is enabled*/
+	uint8_t digital_filter;  /*DNF, 0-15 kernel clocks*/
+}I2C_Bus_Edges_t;
+
+uint8_t i2c_timing_compute(uint32_t kernel_hz, I2C_Speed_t speed, const I2C_Bus_Edges_t *edges, uint32_t *timing);
+uint32_t i2c_timing_period_ns(uint32_t kernel_hz, uint32_t timing, const I2C_Bus_Edges_t *edges);
+
+#endif /* INC_I2C_TIMING_H_ */
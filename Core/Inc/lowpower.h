@@ -0,0 +1,26 @@
+/*
+ * lowpower.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_LOWPOWER_H_
+#define INC_LOWPOWER_H_
+
+#include <stdint.h>
+
+#define LOWPOWER_TIMER_CLOCK_HZ LSI_VALUE
+
+void lowpower_timer_init(void);
+void lowpower_timer_start(uint8_t prescaler_log2, uint16_t period_ticks);
+void lowpower_timer_start_periodic(uint8_t prescaler_log2, uint16_t period_ticks);
+void lowpower_timer_stop(void);
+uint16_t lowpower_timer_read(void);
+void lowpower_timer_irq(void);
+void lowpower_timer_callback(void);
+void lowpower_enter_stop1(void);
+void lowpower_enter_stop2(void);
+void lowpower_trim_sram_retention(void);
+
+#endif /* INC_LOWPOWER_H_ */
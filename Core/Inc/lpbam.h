@@ -0,0 +1,58 @@
+/*
+ * lpbam.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_LPBAM_H_
+#define INC_LPBAM_H_
+
+#include <stdint.h>
+
+#define LPBAM_NODES_PER_READ 4U
+#define LPBAM_MAX_SLOTS 16U
+
+/*GPDMA linear addressing linked-list item, in the order the channel loads it when all of its update bits are set*/
+typedef struct{
+	uint32_t ctr1;
+	uint32_t ctr2;
+	uint32_t cbr1;
+	uint32_t csar;
+	uint32_t cdar;
+	uint32_t cllr;
+}LPBAM_Node_t;
+
+/*Periodic register block read from an I2C v2 peripheral into a ring, with no CPU involvement between wake ups.
+ *Addresses are as seen by the DMA, so a table can be built and checked on a host.*/
+typedef struct{
+	uint32_t cr2_address;
+	uint32_t txdr_address;
+	uint32_t rxdr_address;
+	uint8_t request_tx;      /*GPDMA request lines*/
+	uint8_t request_rx;
+	uint8_t request_tc;      /*Line raised on transfer complete when AUTOCR.TCDMAEN is set*/
+	uint8_t trigger;         /*GPDMA trigger that starts each read*/
+	uint8_t device_address;  /*8 bit (shifted)*/
+	uint8_t reg;             /*First register, the device auto-increments*/
+	uint8_t length;
+	uint8_t slots;           /*One read per slot*/
+	uint8_t slot_size;       /*At least length*/
+	uint8_t wake_every;      /*Reads per transfer complete event, must divide slots*/
+	uint32_t ring_address;
+	uint32_t table_address;  /*All nodes must sit in the same 64 KB page, the channel only reloads the low half*/
+}LPBAM_I2C_Read_t;
+
+typedef struct{
+	uint32_t cr2_write;      /*Values the DMA copies into the peripheral*/
+	uint32_t cr2_read;
+	uint32_t reg;
+	uint32_t reserved;
+	LPBAM_Node_t nodes[LPBAM_MAX_SLOTS * LPBAM_NODES_PER_READ];
+}LPBAM_Table_t;
+
+uint16_t lpbam_i2c_read_build(const LPBAM_I2C_Read_t *cfg, LPBAM_Table_t *table);
+uint32_t lpbam_base(const LPBAM_I2C_Read_t *cfg);
+uint32_t lpbam_first_link(const LPBAM_I2C_Read_t *cfg);
+
+#endif /* INC_LPBAM_H_ */
@@ -53,6 +53,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void SystemClock_Config(void);
 
 /* USER CODE END EFP */
 
@@ -68,6 +69,12 @@ void Error_Handler(void);
 #define IIS2MDC_IRQ_Pin GPIO_PIN_10
 #define IIS2MDC_IRQ_GPIO_Port GPIOD
 #define IIS2MDC_IRQ_EXTI_IRQn EXTI10_IRQn
+#define IIS2MDC_SPI_CS_Pin GPIO_PIN_12
+#define IIS2MDC_SPI_CS_GPIO_Port GPIOB
+#define IIS2MDC_SPI_SCK_Pin GPIO_PIN_13
+#define IIS2MDC_SPI_SCK_GPIO_Port GPIOB
+#define IIS2MDC_SPI_SDI_Pin GPIO_PIN_15
+#define IIS2MDC_SPI_SDI_GPIO_Port GPIOB
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
@@ -57,6 +57,15 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void EXTI10_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void GPDMA1_Channel0_IRQHandler(void);
+void GPDMA1_Channel1_IRQHandler(void);
+void GPDMA1_Channel2_IRQHandler(void);
+void GPDMA1_Channel3_IRQHandler(void);
+void GPDMA1_Channel4_IRQHandler(void);
+void SPI2_IRQHandler(void);
+void USART1_IRQHandler(void);
+void I2C2_EV_IRQHandler(void);
+void I2C2_ER_IRQHandler(void);
 
 /* USER CODE END EFP */
 
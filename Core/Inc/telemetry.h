@@ -0,0 +1,37 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+
+/*Frame on the wire: 0x00, COBS(type, sequence, payload, CRC16 little endian), 0x00.
+ *COBS leaves no zero inside a frame, so a receiver resynchronizes on the next zero after any loss. Anything between
+ *delimiters that does not decode with a good CRC (log text shares the port) is not a frame.*/
+#define TELEMETRY_HEADER_BYTES 2U
+#define TELEMETRY_CRC_BYTES 2U
+#define TELEMETRY_DELIMITER 0x00U
+/*Worst case wire size for a payload: COBS adds a byte per 254 and one more, plus both delimiters*/
+#define TELEMETRY_FRAME_MAX(payload) ((payload) + TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES + \
+		((payload) + TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES) / 254U + 1U + 2U)
+
+typedef enum{
+	telemetry_ok,
+	telemetry_too_short,   /*Less than a header and CRC, e.g. two adjacent delimiters*/
+	telemetry_bad_cobs,
+	telemetry_bad_crc
+}Telemetry_Status_t;
+
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, uint32_t length);
+uint32_t telemetry_cobs_encode(const uint8_t *in, uint32_t length, uint8_t *out);
+uint32_t telemetry_cobs_decode(const uint8_t *in, uint32_t length, uint8_t *out);
+uint32_t telemetry_frame_encode(uint8_t type, uint8_t sequence, const uint8_t *payload, uint32_t length, uint8_t *out);
+Telemetry_Status_t telemetry_frame_decode(uint8_t *frame, uint32_t length, uint8_t *type, uint8_t *sequence,
+		const uint8_t **payload, uint32_t *payload_length);
+
+#endif /* INC_TELEMETRY_H_ */
@@ -35,12 +35,18 @@ extern "C" {
 extern UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN Private defines */
+#define USART1_TX_RING_SIZE 2048U /*Power of 2. Telemetry frames and log text wait here for the TX DMA.*/
+
+extern DMA_HandleTypeDef handle_GPDMA1_Channel3;
 
 /* USER CODE END Private defines */
 
 void MX_USART1_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+uint8_t usart1_write(const uint8_t *data, uint16_t length);
+uint16_t usart1_tx_pending(void);
+uint32_t usart1_tx_dropped(void);
 
 /* USER CODE END Prototypes */
 
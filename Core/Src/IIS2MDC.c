@@ -8,25 +8,36 @@
  * Includes
  **************************************//**************************************//**************************************/
 #include "IIS2MDC.h"
+#include "IIS2MDC_Decimator.h"
 #include "log.h"
 #include "stddef.h"
+#include <string.h>
 /**************************************//**************************************//**************************************
  * Private Function Prototypes
  **************************************//**************************************//**************************************/
 static void ConvertMagnetic(IIS2MDC_Handle_t *Dev,uint8_t *pdata);
+static void PublishSample(IIS2MDC_Handle_t *Dev, uint8_t *pdata);
+static void Dispatch(IIS2MDC_Handle_t *Dev, IIS2MDC_CallbackID_t ID, uint8_t IntSource);
+static void SelectCalibration(IIS2MDC_Handle_t *Dev, const IIS2MDC_Calibration_t *Calibration);
+static IIS2MDC_Status_t ApplySettings(IIS2MDC_Handle_t *Dev);
+static IIS2MDC_Status_t BusRead(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length);
+static IIS2MDC_Status_t BusWrite(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length);
+static void BusFault(IIS2MDC_Handle_t *Dev, IIS2MDC_Status_t Status);
+static void WrongDevice(IIS2MDC_Handle_t *Dev);
+static void BuildRegisters(IIS2MDC_Handle_t *Dev, const IIS2MDC_InitStruct_t *Settings, IIS2MDC_RegisterImage_t *Image);
+static IIS2MDC_Status_t WriteRegisters(IIS2MDC_Handle_t *Dev, const IIS2MDC_RegisterImage_t *Image, uint8_t Force);
+static IIS2MDC_Status_t WriteSpan(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *Shadow, const uint8_t *Image, uint8_t length, uint8_t Force);
 /**************************************//**************************************//**************************************
  * Defines / Constants
  **************************************//**************************************//**************************************/
 static const uint8_t IIS2MDC_DEVICE_ID = 0x40;
-static const float CALIBRATION_MATRIX_A11 = 1.206096;
-static const float CALIBRATION_MATRIX_A12 = 0.026751;
-static const float CALIBRATION_MATRIX_A13 = 0.001434;
-static const float CALIBRATION_MATRIX_A21 = 0.026751;
-static const float CALIBRATION_MATRIX_A22 = 1.269714;
-static const float CALIBRATION_MATRIX_A23 = 0.015582;
-static const float CALIBRATION_MATRIX_A31 = 0.001434;
-static const float CALIBRATION_MATRIX_A32 = 0.015582;
-static const float CALIBRATION_MATRIX_A33 = 1.478172;
+#define IIS2MDC_BUS_ATTEMPTS (3U) /*Tries per register access before starting bus recovery*/
+#define IIS2MDC_CFG_A_MODE_MASK (0x03U)
+static const IIS2MDC_RegisterImage_t IIS2MDC_ResetRegisters = { /*Chip contents after power up or a soft reset*/
+		.Offset = {0, 0, 0, 0, 0, 0},
+		.Cfg = {0x03, 0x00, 0x00, 0xE0},
+		.Threshold = {0, 0}
+};
 /**************************************//**************************************//**************************************
  * Public Function Definitions
  **************************************//**************************************//**************************************/
@@ -39,92 +50,105 @@ static const float CALIBRATION_MATRIX_A33 = 1.478172;
  *@Postcondition: Dev Handle members and IIS2MDC Hardware registers will be initialized.
  **************************************//**************************************/
 void IIS2MDC_Init(IIS2MDC_InitStruct_t Settings, IIS2MDC_Handle_t *Dev, IIS2MDC_IO_Drv_t LowLevelDrivers){
+	IIS2MDC_InitStart(Settings, Dev, LowLevelDrivers);
+	IIS2MDC_InitComplete(Dev);
+}
+
+/**************************************//**************************************
+ *@Brief: First half of IIS2MDC_Init. Fills in the Dev Handle and brings up the low level IO without waiting for the sensor to boot.
+ *@Params: IIS2MDC Init Settings, Dev Handle pointer, Low level driver structure
+ *@Return: None
+ *@Precondition: LowLevelDrivers and Settings params should already be initialized.
+ *@Postcondition: Dev Handle members are initialized, the sensor is not accessed until IIS2MDC_InitComplete is called.
+ **************************************//**************************************/
+void IIS2MDC_InitStart(IIS2MDC_InitStruct_t Settings, IIS2MDC_Handle_t *Dev, IIS2MDC_IO_Drv_t LowLevelDrivers){
 	Dev->IIS2MDC_IO.Init = LowLevelDrivers.Init;
 	Dev->IIS2MDC_IO.DeInit = LowLevelDrivers.DeInit;
 	Dev->IIS2MDC_IO.WriteReg = LowLevelDrivers.WriteReg;
 	Dev->IIS2MDC_IO.ReadReg = LowLevelDrivers.ReadReg;
 	Dev->IIS2MDC_IO.ioctl = LowLevelDrivers.ioctl;
-	Dev->IIS2MDC_IO.Init();
-
-	if(Settings.IntPinMode != IIS2MDC_IntSignalDisabled){
-		Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQDisable);
-	}
-
-	uint8_t buffer8;
-	uint16_t buffer16;
-
-	/*WHO AM I*/
-	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_WHO_AM_I, &buffer8,1) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Read Device ID Reg Failed.");
-	} else if(buffer8 != IIS2MDC_DEVICE_ID){
-		_log(log_iis2mdc, "Initialization: Device ID Mismatch");
+	Dev->IIS2MDC_IO.ReadRegAsync = LowLevelDrivers.ReadRegAsync;
+	Dev->Calibration = (Settings.Calibration != NULL) ? Settings.Calibration : &IIS2MDC_DefaultCalibration;
+	Dev->CalibrationEpoch = 0;
+	for(uint8_t i = 0; i < IIS2MDC_CALIBRATION_HISTORY; i++){
+		Dev->CalibrationHistory[i] = Dev->Calibration;
 	}
-
-	/*Offset X Regs*/
-	buffer16 = Settings.Offset_X;
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_OFFSET_X_REG_L, (uint8_t*)&buffer16,2) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Offset X Write Failed");
-	}
-
-	/*Offset Y Regs*/
-	buffer16 = Settings.Offset_Y;
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_OFFSET_Y_REG_L, (uint8_t*)&buffer16,2) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Offset Y Write Failed");
-	}
-
-	/*Offset Z Regs*/
-	buffer16 = Settings.Offset_Z;
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_OFFSET_Z_REG_L, (uint8_t*)&buffer16,2) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Offset Z Write Failed");
+	Dev->Declination = Settings.Declination;
+	Dev->Filter = NULL;
+	Dev->Decimators = NULL;
+	Dev->Queue = NULL;
+	Dev->DrdyPinMode = Settings.DrdyPinMode;
+	Dev->IntPinMode = Settings.IntPinMode;
+	Dev->IntSource = 0;
+	Dev->Settings = Settings;
+	Dev->BusStats.Retries = 0;
+	Dev->BusStats.Faults = 0;
+	Dev->BusStats.Recoveries = 0;
+	Dev->BusStats.LastError = IIS2MDC_Ok;
+	for(uint8_t i = 0; i < IIS2MDC_NumCallbacks; i++){
+		Dev->Callbacks[i] = NULL;
 	}
+	Dev->IIS2MDC_IO.Init();
 
-	/*IRQ Threshold*/
-	buffer16 = Settings.IntThreshold;
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_INT_THS_L_REG, (uint8_t*)&buffer16,2) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Int Threshold Write Failed");
+	if((Settings.IntPinMode != IIS2MDC_IntSignalDisabled) || (Settings.DrdyPinMode != IIS2MDC_DrdySignalDisabled)){
+		Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQDisable); //Re-enabled by InitComplete
 	}
+}
 
-	/*CFG A*/
-	buffer8 = (Settings.TempComp << 7) | (Settings.PowerMode << 4) | (Settings.DataRate << 2) | (Settings.OperatingMode << 0);
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_CFG_REG_A,&buffer8,1) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Write CFG Reg A Failed.");
-	}
+/**************************************//**************************************
+ *@Brief: Second half of IIS2MDC_Init. Waits only for whatever is left of the sensor boot time, then configures it.
+ *@Params: Dev Handle pointer
+ *@Return: None
+ *@Precondition: IIS2MDC_InitStart has been called on Dev.
+ *@Postcondition: IIS2MDC Hardware registers will be initialized and the bus is IIS2MDC_BusOk. If the sensor could not
+ *                be reached the bus is left in recovery, which re-applies the settings later on. A chip with another
+ *                device ID leaves it in IIS2MDC_BusWrongDevice and is never written.
+ **************************************//**************************************/
+void IIS2MDC_InitComplete(IIS2MDC_Handle_t *Dev){
+	uint8_t PinRouted = (Dev->IntPinMode != IIS2MDC_IntSignalDisabled) || (Dev->DrdyPinMode != IIS2MDC_DrdySignalDisabled);
+	uint8_t Identified = 1;
+	IIS2MDC_Status_t Status = (IIS2MDC_Status_t)Dev->IIS2MDC_IO.ioctl(IIS2MDC_BootWait);
 
-	/*CFG B*/
-	buffer8 = (Settings.IRQOffsetMode << 3) | (Settings.OffsetCancellationPulse << 2) | (Settings.LPF << 0);
-	if(Settings.OperatingMode == IIS2MDC_OneShotMode){
-		buffer8 |= Settings.OffsetCancellation << 4;
+	if(Status != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Initialization: Bus Setup Failed.");
 	} else {
-		buffer8 |= Settings.OffsetCancellation << 1;
-	}
-
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_CFG_REG_B,&buffer8,1) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Write CFG Reg B Failed.");
-	}
-
-	/*CFG C*/
-	buffer8 = (Settings.IntPinMode << 6) | (1 << 4) | (Settings.DrdyPinMode);
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_CFG_REG_C,&buffer8,1) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Write CFG Reg C Failed.");
+		/*WHO AM I*/
+		uint8_t buffer8;
+		Status = Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_WHO_AM_I, &buffer8,1);
+		if(Status != IIS2MDC_Ok){
+			_log(log_iis2mdc, "Initialization: Read Device ID Reg Failed.");
+		} else if(buffer8 != IIS2MDC_DEVICE_ID){
+			_log(log_iis2mdc, "Initialization: Device ID Mismatch");
+			Identified = 0;
+		} else if(ApplySettings(Dev) != IIS2MDC_Ok){
+			_log(log_iis2mdc, "Initialization: Configuration Failed.");
+			Status = IIS2MDC_Error;
+		}
 	}
 
-	/*Int Source Reg*/
-	buffer8 = Settings.IRQConfig;
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_INT_CTRL_REG,&buffer8,1) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Write Int Ctrl Reg Failed.");
-	}
-
-	/*Clear Data acquired while initializing*/
-	uint8_t buffer6bytes[6];
-	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_OUTX_L_REG,buffer6bytes,6) != IIS2MDC_Ok){
-		_log(log_iis2mdc, "Initialization: Reading Data Reg Failed.");
+	if(!Identified){
+		WrongDevice(Dev); //Not recoverable, the pins stay masked
+		return;
+	} else if(Status == IIS2MDC_Ok){
+		Dev->BusState = IIS2MDC_BusOk;
+	} else {
+		BusFault(Dev, Status);
 	}
 
-	if(Settings.IntPinMode != IIS2MDC_IntSignalDisabled){
+	if(PinRouted){
 		Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQEnable);
 	}
+}
 
-
+/**************************************//**************************************
+ *@Brief: Checks if the sensor is still booting after IIS2MDC_InitStart.
+ *@Params: Dev Handle pointer
+ *@Return: ms until IIS2MDC_InitComplete can run without waiting, 0 if it already can.
+ *@Precondition: IIS2MDC_InitStart has been called on Dev.
+ *@Postcondition: None
+ **************************************//**************************************/
+uint8_t IIS2MDC_BootPending(IIS2MDC_Handle_t *Dev){
+	return Dev->IIS2MDC_IO.ioctl(IIS2MDC_BootRemaining);
 }
 
 
@@ -143,6 +167,7 @@ void IIS2MDC_DeInit(IIS2MDC_Handle_t *Dev){
 	Dev->IIS2MDC_IO.WriteReg = NULL;
 	Dev->IIS2MDC_IO.ReadReg = NULL;
 	Dev->IIS2MDC_IO.ioctl = NULL;
+	Dev->IIS2MDC_IO.ReadRegAsync = NULL;
 }
 
 
@@ -157,7 +182,9 @@ void IIS2MDC_Reset(IIS2MDC_Handle_t *Dev){
 	uint8_t reset_signal = 1 << 5;
 	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_CFG_REG_A, &reset_signal,1) != IIS2MDC_Ok){
 		_log(log_iis2mdc, "Reset Failed.");
+		return;
 	}
+	Dev->Shadow = IIS2MDC_ResetRegisters;
 }
 
 
@@ -169,15 +196,13 @@ void IIS2MDC_Reset(IIS2MDC_Handle_t *Dev){
  *@Postcondition: Device will begin an A-to-D conversion
  **************************************//**************************************/
 void IIS2MDC_StartConversion(IIS2MDC_Handle_t *Dev){
-	uint8_t reg;
-	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_CFG_REG_A, &reg, 1) != IIS2MDC_Ok){ //read reg
-		_log(log_iis2mdc, "Read CFG A Reg Failed.");
+	if(Dev->BusState != IIS2MDC_BusOk){
+		IIS2MDC_RecoverBus(Dev);
+		return;
 	}
 
-	reg &= ~(1 << 1); //Modify reg
-	reg |=  (1 << 0);
-
-	if(Dev->IIS2MDC_IO.WriteReg(IIS2MDC_REG_CFG_REG_A, &reg, 1) != IIS2MDC_Ok){ //store reg
+	uint8_t reg = (Dev->Shadow.Cfg[0] & ~IIS2MDC_CFG_A_MODE_MASK) | IIS2MDC_OneShotMode; //Shadow holds CFG A, no read needed
+	if(BusWrite(Dev, IIS2MDC_REG_CFG_REG_A, &reg, 1) != IIS2MDC_Ok){
 		_log(log_iis2mdc, "Writing CFG A Reg Failed.");
 	}
 }
@@ -186,13 +211,18 @@ void IIS2MDC_StartConversion(IIS2MDC_Handle_t *Dev){
 /**************************************//**************************************
  *@Brief: Reads Data from given IIS2MDC Sensor and converts it to millgause
  *@Params: IIS2MDC Device Handle
- *@Return: Status of read attempt: IIS2MDC_DataNotReady if new data is not available, IIS2MDC_DataReady if data was read successfully
+ *@Return: Status of read attempt: IIS2MDC_DataNotReady if new data is not available or the bus failed, IIS2MDC_DataReady if data was read successfully
  *@Precondition: Device handle is initialized, StartConversion should be called prior to this in OneShot mode (otherwise the read wont be successful)
  *@Postcondition: Dev Handle will contain new data in Milligause. If data was read successfully, DataReadyFlag will be set to IIS2MDC_DataNotReady.
  **************************************//**************************************/
 IIS2MDC_DataReadyStatus_t IIS2MDC_ReadMagnetic(IIS2MDC_Handle_t *Dev){
 	uint8_t buffer[6];
-	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_STATUS_REG, buffer,1) != IIS2MDC_Ok){
+	if(Dev->BusState != IIS2MDC_BusOk){
+		IIS2MDC_RecoverBus(Dev);
+		return IIS2MDC_DataNotReady;
+	}
+
+	if(BusRead(Dev, IIS2MDC_REG_STATUS_REG, buffer,1) != IIS2MDC_Ok){
 		_log(log_iis2mdc, "Reading Status Reg Failed.");
 		return IIS2MDC_DataNotReady;
 	} else if ((buffer[0] & 0x07) != 0x07){
@@ -201,11 +231,12 @@ IIS2MDC_DataReadyStatus_t IIS2MDC_ReadMagnetic(IIS2MDC_Handle_t *Dev){
 	}
 
 	Dev->DataReadyFlag = IIS2MDC_DataReady;
-	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_OUTX_L_REG, buffer,6) != IIS2MDC_Ok){
+	if(BusRead(Dev, IIS2MDC_REG_OUTX_L_REG, buffer,6) != IIS2MDC_Ok){
 		_log(log_iis2mdc, "Reading Data Regs Failed.");
+		return IIS2MDC_DataNotReady; //Buffer holds nothing valid, keep the last sample
 	}
 	Dev->DataReadyFlag = IIS2MDC_DataNotReady; //Data has been read, so reset data ready flag
-	ConvertMagnetic(Dev, buffer);
+	PublishSample(Dev, buffer);
 
 	return IIS2MDC_DataReady;
 }
@@ -238,6 +269,268 @@ void IIS2MDC_WriteReg(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_
 	}
 }
 
+
+/**************************************//**************************************
+ *@Brief: Attaches a software filter chain to the samples produced by IIS2MDC_ReadMagnetic
+ *@Params: Device handle, chain built with IIS2MDC_Filter_Append (NULL detaches)
+ *@Return: None
+ *@Precondition: Device handle is initialized, chain stages are initialized
+ *@Postcondition: MagX/MagY/MagZ hold filtered milligauss after each successful read. Chain history is reset.
+ **************************************//**************************************/
+void IIS2MDC_AttachFilter(IIS2MDC_Handle_t *Dev, IIS2MDC_FilterStage_t *Chain){
+	IIS2MDC_Filter_Reset(Chain);
+	Dev->Filter = Chain;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Registers a callback run by IIS2MDC_ServiceIRQ
+ *@Params: Device handle, event to hook, callback (NULL removes it)
+ *@Return: None
+ *@Precondition: Device handle is initialized
+ *@Postcondition: Callback runs from IIS2MDC_ServiceIRQ's context whenever that event is decoded.
+ **************************************//**************************************/
+void IIS2MDC_RegisterCallback(IIS2MDC_Handle_t *Dev, IIS2MDC_CallbackID_t ID, IIS2MDC_Callback_t Callback){
+	if(ID < IIS2MDC_NumCallbacks){
+		Dev->Callbacks[ID] = Callback;
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Works out why the INT/DRDY pin fired and dispatches the registered callbacks
+ *@Params: Device handle
+ *@Return: IIS2MDC_DataReady if a new sample was read into the handle, IIS2MDC_DataNotReady otherwise
+ *@Precondition: Device handle is initialized with DRDY and/or INT routed to the pin. Call from thread context after the pin interrupt, not from the ISR.
+ *@Postcondition: Dev->IntSource holds the decoded INT_SOURCE_REG flags, a latched INT is released and callbacks have run.
+ **************************************//**************************************/
+IIS2MDC_DataReadyStatus_t IIS2MDC_ServiceIRQ(IIS2MDC_Handle_t *Dev){
+	uint8_t buffer[IIS2MDC_REG_OUTZ_H_REG - IIS2MDC_REG_INT_SOURCE_REG + 1];
+	IIS2MDC_DataReadyStatus_t Result = IIS2MDC_DataNotReady;
+
+	if(Dev->BusState != IIS2MDC_BusOk){
+		IIS2MDC_RecoverBus(Dev);
+		return IIS2MDC_DataNotReady;
+	}
+
+	if(Dev->IntPinMode == IIS2MDC_IntSignalDisabled){
+		/*Only DRDY drives the pin, so the edge already says the outputs are new. Skip the status read.*/
+		if(BusRead(Dev, IIS2MDC_REG_OUTX_L_REG, buffer, 6) != IIS2MDC_Ok){
+			_log(log_iis2mdc, "IRQ: Reading Data Regs Failed.");
+			return IIS2MDC_DataNotReady;
+		}
+		Dev->DataReadyFlag = IIS2MDC_DataNotReady;
+		Dev->IntSource = 0;
+		PublishSample(Dev, buffer);
+		Dispatch(Dev, IIS2MDC_DataReadyCallback, 0);
+		return IIS2MDC_DataReady;
+	}
+
+	/*INT_SOURCE, the threshold, STATUS and the outputs are contiguous. When both signals share the pin one burst
+	 *answers which fired and fetches the sample. Reading INT_SOURCE also releases a latched INT.*/
+	uint8_t length = (Dev->DrdyPinMode != IIS2MDC_DrdySignalDisabled) ? sizeof(buffer) : 1;
+	if(BusRead(Dev, IIS2MDC_REG_INT_SOURCE_REG, buffer, length) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "IRQ: Reading Int Source Reg Failed.");
+		return IIS2MDC_DataNotReady;
+	}
+	Dev->IntSource = buffer[0];
+	Dev->DataReadyFlag = IIS2MDC_DataNotReady;
+
+	if(length > 1){
+		uint8_t StatusReg = buffer[IIS2MDC_REG_STATUS_REG - IIS2MDC_REG_INT_SOURCE_REG];
+		if((StatusReg & 0x07) == 0x07){
+			PublishSample(Dev, &buffer[IIS2MDC_REG_OUTX_L_REG - IIS2MDC_REG_INT_SOURCE_REG]);
+			Dispatch(Dev, IIS2MDC_DataReadyCallback, 0);
+			Result = IIS2MDC_DataReady;
+		}
+	}
+
+	const uint8_t ThresholdFlags = IIS2MDC_XPositiveThreshold | IIS2MDC_YPositiveThreshold | IIS2MDC_ZPositiveThreshold |
+			IIS2MDC_XNegativeThreshold | IIS2MDC_YNegativeThreshold | IIS2MDC_ZNegativeThreshold;
+	if((Dev->IntSource & IIS2MDC_IntActive) && (Dev->IntSource & ThresholdFlags)){
+		Dispatch(Dev, IIS2MDC_ThresholdCallback, Dev->IntSource);
+	}
+	if(Dev->IntSource & IIS2MDC_RangeOverflow){
+		Dispatch(Dev, IIS2MDC_OverflowCallback, Dev->IntSource);
+	}
+
+	return Result;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Publishes an output register block that was read without the driver, e.g. by DMA while the core slept
+ *@Params: Device handle, OUTX_L..OUTZ_H (6 bytes)
+ *@Return: None
+ *@Precondition: Device handle is initialized. Call from thread context, the data ready callback runs from here.
+ *@Postcondition: Sample is converted into the handle, pushed to the decimators and the data ready callback has run.
+ **************************************//**************************************/
+void IIS2MDC_PublishRaw(IIS2MDC_Handle_t *Dev, uint8_t *pdata){
+	PublishSample(Dev, pdata);
+	Dispatch(Dev, IIS2MDC_DataReadyCallback, 0);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Advances bus fault recovery by one step: bus clear, peripheral re-init, then checking the device ID and
+ *        re-applying Dev->Settings
+ *@Params: Device handle
+ *@Return: Bus state after the step, IIS2MDC_BusOk once the device is configured again. IIS2MDC_BusWrongDevice if
+ *         another chip answered, recovery stops there.
+ *@Precondition: Device handle is initialized. ReadMagnetic/ServiceIRQ call this on their own, call it periodically
+ *               as well if the sensor pin may stay asserted while the bus is down (no new edges arrive then).
+ *@Postcondition: At most one recovery step has run, none of them wait on the bus timeout more than once.
+ **************************************//**************************************/
+IIS2MDC_BusState_t IIS2MDC_RecoverBus(IIS2MDC_Handle_t *Dev){
+	uint8_t DeviceID;
+	switch(Dev->BusState){
+	case IIS2MDC_BusClearPending:
+		if(Dev->IIS2MDC_IO.ioctl(IIS2MDC_BusClear) != IIS2MDC_Ok){
+			_log(log_iis2mdc, "Recovery: SDA still held low after bus clear.");
+			break; //Try again on the next call
+		}
+		Dev->BusState = IIS2MDC_BusReinitPending;
+		break;
+
+	case IIS2MDC_BusReinitPending:
+		Dev->IIS2MDC_IO.ioctl(IIS2MDC_BusReinit);
+		Dev->BusState = IIS2MDC_BusReconfigPending;
+		break;
+
+	case IIS2MDC_BusReconfigPending:
+		if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_WHO_AM_I, &DeviceID, 1) != IIS2MDC_Ok){
+			Dev->BusState = IIS2MDC_BusClearPending;
+			break;
+		}
+		if(DeviceID != IIS2MDC_DEVICE_ID){ //Whatever answers now is not the sensor, e.g. it never did
+			_log(log_iis2mdc, "Recovery: Device ID Mismatch");
+			WrongDevice(Dev);
+			break;
+		}
+		if(ApplySettings(Dev) != IIS2MDC_Ok){
+			Dev->BusState = IIS2MDC_BusClearPending;
+			break;
+		}
+		Dev->DataReadyFlag = IIS2MDC_DataNotReady;
+		Dev->BusState = IIS2MDC_BusOk;
+		Dev->BusStats.Recoveries++;
+		_log(log_iis2mdc, "Recovery: Bus restored, configuration re-applied.");
+		break;
+
+	case IIS2MDC_BusWrongDevice: //Terminal, nothing is written to a chip that isn't the sensor
+	case IIS2MDC_BusOk:
+	default:
+		break;
+	}
+	return Dev->BusState;
+}
+
+/**************************************//**************************************
+ *@Brief: Changes the configuration of a running device. Only register bytes that differ from Dev->Shadow are written,
+ *        each contiguous block in a single burst, so the chip never sees a half applied configuration.
+ *@Params: Device handle, new settings
+ *@Return: IIS2MDC_Ok if the device now runs with Settings, IIS2MDC_Error if the bus failed (Dev->Settings is kept and
+ *         recovery re-applies it).
+ *@Precondition: Device handle is initialized.
+ *@Postcondition: Output registers and the data ready state are left alone, a sample in flight is still delivered.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Reconfigure(IIS2MDC_Handle_t *Dev, const IIS2MDC_InitStruct_t *Settings){
+	IIS2MDC_RegisterImage_t Image;
+	if(Dev->BusState != IIS2MDC_BusOk){
+		IIS2MDC_RecoverBus(Dev);
+		return IIS2MDC_Error;
+	}
+
+	BuildRegisters(Dev, Settings, &Image);
+	if(WriteRegisters(Dev, &Image, 0) != IIS2MDC_Ok){
+		return IIS2MDC_Error;
+	}
+
+	uint8_t WasRouted = (Dev->IntPinMode != IIS2MDC_IntSignalDisabled) || (Dev->DrdyPinMode != IIS2MDC_DrdySignalDisabled);
+	uint8_t PinRouted = (Settings->IntPinMode != IIS2MDC_IntSignalDisabled) || (Settings->DrdyPinMode != IIS2MDC_DrdySignalDisabled);
+	if(PinRouted != WasRouted){
+		Dev->IIS2MDC_IO.ioctl(PinRouted ? IIS2MDC_IRQEnable : IIS2MDC_IRQDisable);
+	}
+
+	Dev->Settings = *Settings;
+	Dev->DrdyPinMode = Settings->DrdyPinMode;
+	Dev->IntPinMode = Settings->IntPinMode;
+	SelectCalibration(Dev, (Settings->Calibration != NULL) ? Settings->Calibration : &IIS2MDC_DefaultCalibration);
+	Dev->Declination = Settings->Declination;
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Single setting wrappers around IIS2MDC_Reconfigure
+ *@Params: Device handle, new value(s)
+ *@Return: See IIS2MDC_Reconfigure
+ *@Precondition: Device handle is initialized.
+ *@Postcondition: At most one register write reaches the bus, none if the value is already set.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_SetDataRate(IIS2MDC_Handle_t *Dev, IIS2MDC_OutputDataRate_t DataRate){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.DataRate = DataRate;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+IIS2MDC_Status_t IIS2MDC_SetPowerMode(IIS2MDC_Handle_t *Dev, IIS2MDC_ResolutionPowerMode_t PowerMode){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.PowerMode = PowerMode;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+IIS2MDC_Status_t IIS2MDC_SetLowPassFilter(IIS2MDC_Handle_t *Dev, IIS2MDC_LowPassFilterMode_t LPF){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.LPF = LPF;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+IIS2MDC_Status_t IIS2MDC_SetTemperatureComp(IIS2MDC_Handle_t *Dev, IIS2MDC_TemperatureComp_t TempComp){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.TempComp = TempComp;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+IIS2MDC_Status_t IIS2MDC_SetOffsetCancellation(IIS2MDC_Handle_t *Dev, IIS2MDC_OffsetCancelation_t Mode, IIS2MDC_OffsetCancelationPulseMode_t Pulse){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.OffsetCancellation = Mode;
+	Settings.OffsetCancellationPulse = Pulse;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+/*Calibration lives only in the handle, no register is written, so it also succeeds while the bus is being recovered.
+ *Samples already tagged keep their epoch's calibration.*/
+IIS2MDC_Status_t IIS2MDC_SetCalibration(IIS2MDC_Handle_t *Dev, const IIS2MDC_Calibration_t *Calibration){
+	Dev->Settings.Calibration = Calibration;
+	SelectCalibration(Dev, (Calibration != NULL) ? Calibration : &IIS2MDC_DefaultCalibration);
+	return IIS2MDC_Ok;
+}
+
+/*INT_CTRL_REG and the threshold are separate blocks, so changing both costs two writes*/
+IIS2MDC_Status_t IIS2MDC_SetIRQConfig(IIS2MDC_Handle_t *Dev, IIS2MDC_IRQConfig_t IRQConfig, int16_t Threshold){
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.IRQConfig = IRQConfig;
+	Settings.IntThreshold = Threshold;
+	return IIS2MDC_Reconfigure(Dev, &Settings);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Looks up the calibration that was current when a sample was tagged with Epoch
+ *@Params: Device handle, epoch tag (Dev->CalibrationEpoch at capture)
+ *@Return: The calibration, or NULL if more than IIS2MDC_CALIBRATION_HISTORY - 1 changes happened since
+ *@Precondition: Device handle is initialized.
+ *@Postcondition: None
+ **************************************//**************************************/
+const IIS2MDC_Calibration_t* IIS2MDC_CalibrationForEpoch(const IIS2MDC_Handle_t *Dev, uint8_t Epoch){
+	uint8_t Age = (Dev->CalibrationEpoch - Epoch) & IIS2MDC_CALIBRATION_EPOCH_MASK;
+	if(Age >= IIS2MDC_CALIBRATION_HISTORY){
+		return NULL;
+	}
+	return Dev->CalibrationHistory[Epoch & (IIS2MDC_CALIBRATION_HISTORY - 1)];
+}
+
 /**************************************//**************************************//**************************************
  * Private Function Definitions
  **************************************//**************************************//**************************************/
@@ -250,12 +543,200 @@ void IIS2MDC_WriteReg(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_
  *@Postcondition: Device Handle will contain new magnetism measurements in Milligause.
  **************************************//**************************************/
 static void ConvertMagnetic(IIS2MDC_Handle_t *Dev, uint8_t *pdata){
-	int16_t MagX = ((int8_t)pdata[1] << 8) |  ((int8_t)pdata[0] << 0);
-	int16_t MagY = ((int8_t)pdata[3] << 8) |  ((int8_t)pdata[2] << 0);
-	int16_t MagZ = ((int8_t)pdata[5] << 8) |  ((int8_t)pdata[4] << 0);
-	Dev->MagX = (MagX * CALIBRATION_MATRIX_A11 + MagY * CALIBRATION_MATRIX_A12 + MagZ * CALIBRATION_MATRIX_A13);
-	Dev->MagY = (MagX * CALIBRATION_MATRIX_A21 + MagY * CALIBRATION_MATRIX_A22 + MagZ * CALIBRATION_MATRIX_A23);
-	Dev->MagZ = (MagX * CALIBRATION_MATRIX_A31 + MagY * CALIBRATION_MATRIX_A32 + MagZ * CALIBRATION_MATRIX_A33);
+	int16_t raw[3];
+	int32_t milligauss[3];
+	IIS2MDC_UnpackBlock(pdata, raw, 1);
+	IIS2MDC_ConvertBlock(Dev->Calibration, raw, raw, 1);
+	IIS2MDC_ScaleBlock(raw, milligauss, 1);
+	IIS2MDC_Filter_Apply(Dev->Filter, milligauss);
+	Dev->MagX = milligauss[0];
+	Dev->MagY = milligauss[1];
+	Dev->MagZ = milligauss[2];
+}
+
+
+/*Converts a freshly read output register block and hands it to the decimators*/
+static void PublishSample(IIS2MDC_Handle_t *Dev, uint8_t *pdata){
+	ConvertMagnetic(Dev, pdata);
+
+	const int32_t sample[3] = {Dev->MagX, Dev->MagY, Dev->MagZ};
+	IIS2MDC_Decimator_Push(Dev->Decimators, sample);
+}
+
+
+static void Dispatch(IIS2MDC_Handle_t *Dev, IIS2MDC_CallbackID_t ID, uint8_t IntSource){
+	if(Dev->Callbacks[ID] != NULL){
+		Dev->Callbacks[ID](Dev, IntSource);
+	}
+}
+
+
+/*Starts a new calibration epoch when the calibration actually changes, so tagged raw samples can find theirs*/
+static void SelectCalibration(IIS2MDC_Handle_t *Dev, const IIS2MDC_Calibration_t *Calibration){
+	if(Calibration == Dev->Calibration){
+		return;
+	}
+	uint8_t Epoch = (Dev->CalibrationEpoch + 1) & IIS2MDC_CALIBRATION_EPOCH_MASK;
+	Dev->CalibrationHistory[Epoch & (IIS2MDC_CALIBRATION_HISTORY - 1)] = Calibration;
+	Dev->Calibration = Calibration;
+	Dev->CalibrationEpoch = Epoch;
+}
+
+/**************************************//**************************************
+ *@Brief: Writes the configuration held in Dev->Settings to the device registers
+ *@Params: Device handle
+ *@Return: IIS2MDC_Error at the first register access that failed
+ *@Precondition: Low level IO is initialized
+ *@Postcondition: Device registers and Dev->Shadow match Dev->Settings and the output registers have been read once.
+ **************************************//**************************************/
+static IIS2MDC_Status_t ApplySettings(IIS2MDC_Handle_t *Dev){
+	IIS2MDC_RegisterImage_t Image;
+	BuildRegisters(Dev, &Dev->Settings, &Image);
+	if(WriteRegisters(Dev, &Image, 1) != IIS2MDC_Ok){
+		return IIS2MDC_Error;
+	}
+
+	/*Clear Data acquired while configuring, this also releases DRDY*/
+	uint8_t buffer6bytes[6];
+	if(Dev->IIS2MDC_IO.ReadReg(IIS2MDC_REG_OUTX_L_REG,buffer6bytes,6) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Configuration: Reading Data Reg Failed.");
+		return IIS2MDC_Error;
+	}
+
+	return IIS2MDC_Ok;
+}
+
+
+/*Translates settings into register contents. Multi-byte values are little endian like the chip.*/
+static void BuildRegisters(IIS2MDC_Handle_t *Dev, const IIS2MDC_InitStruct_t *Settings, IIS2MDC_RegisterImage_t *Image){
+	const int16_t Offsets[3] = {Settings->Offset_X, Settings->Offset_Y, Settings->Offset_Z};
+	for(uint8_t i = 0; i < 3; i++){
+		Image->Offset[2 * i] = (uint8_t)((uint16_t)Offsets[i] & 0xFF);
+		Image->Offset[2 * i + 1] = (uint8_t)((uint16_t)Offsets[i] >> 8);
+	}
+	Image->Threshold[0] = (uint8_t)((uint16_t)Settings->IntThreshold & 0xFF);
+	Image->Threshold[1] = (uint8_t)((uint16_t)Settings->IntThreshold >> 8);
+
+	/*CFG A*/
+	Image->Cfg[0] = (Settings->TempComp << 7) | (Settings->PowerMode << 4) | (Settings->DataRate << 2) | (Settings->OperatingMode << 0);
+
+	/*CFG B*/
+	Image->Cfg[1] = (Settings->IRQOffsetMode << 3) | (Settings->OffsetCancellationPulse << 2) | (Settings->LPF << 0);
+	if(Settings->OperatingMode == IIS2MDC_OneShotMode){
+		Image->Cfg[1] |= Settings->OffsetCancellation << 4;
+	} else {
+		Image->Cfg[1] |= Settings->OffsetCancellation << 1;
+	}
+
+	/*CFG C*/
+	Image->Cfg[2] = (Settings->IntPinMode << 6) | (1 << 4) | (Settings->DrdyPinMode) | Dev->IIS2MDC_IO.ioctl(IIS2MDC_InterfaceBits);
+
+	/*Int Ctrl Reg*/
+	Image->Cfg[3] = Settings->IRQConfig;
 }
 
 
+/*Writes each register block that differs from the shadow. Force writes every block in full (init and recovery, where
+ *the chip contents are unknown) through the raw driver, otherwise writes go through BusWrite's retries.
+ *The threshold goes ahead of INT_CTRL_REG so an interrupt is never enabled against a stale threshold.*/
+static IIS2MDC_Status_t WriteRegisters(IIS2MDC_Handle_t *Dev, const IIS2MDC_RegisterImage_t *Image, uint8_t Force){
+	if(WriteSpan(Dev, IIS2MDC_REG_OFFSET_X_REG_L, Dev->Shadow.Offset, Image->Offset, sizeof(Image->Offset), Force) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Configuration: Offset Write Failed");
+		return IIS2MDC_Error;
+	}
+
+	if(WriteSpan(Dev, IIS2MDC_REG_INT_THS_L_REG, Dev->Shadow.Threshold, Image->Threshold, sizeof(Image->Threshold), Force) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Configuration: Int Threshold Write Failed");
+		return IIS2MDC_Error;
+	}
+
+	if(WriteSpan(Dev, IIS2MDC_REG_CFG_REG_A, Dev->Shadow.Cfg, Image->Cfg, sizeof(Image->Cfg), Force) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Configuration: Write CFG Regs Failed.");
+		return IIS2MDC_Error;
+	}
+	return IIS2MDC_Ok;
+}
+
+
+/*Writes the bytes from the first to the last one that differ as one burst, unchanged bytes in between ride along
+ *since a second transaction costs more than a byte. The shadow only takes the new values once the write succeeded.*/
+static IIS2MDC_Status_t WriteSpan(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *Shadow, const uint8_t *Image, uint8_t length, uint8_t Force){
+	uint8_t first = 0;
+	uint8_t last = length;
+	if(!Force){
+		while(first < length && Shadow[first] == Image[first]){
+			first++;
+		}
+		if(first == length){
+			return IIS2MDC_Ok; //Nothing changed
+		}
+		while(Shadow[last - 1] == Image[last - 1]){
+			last--;
+		}
+	}
+
+	uint8_t buffer[6];
+	memcpy(buffer, &Image[first], last - first);
+	IIS2MDC_Status_t Status;
+	if(Force){
+		Status = Dev->IIS2MDC_IO.WriteReg(reg + first, buffer, last - first);
+	} else {
+		Status = BusWrite(Dev, reg + first, buffer, last - first);
+	}
+	if(Status != IIS2MDC_Ok){
+		return Status;
+	}
+	memcpy(&Shadow[first], &Image[first], last - first);
+	return IIS2MDC_Ok;
+}
+
+
+/*Register access with bounded retries. NACKs and lost arbitration are retried, a timeout or a transfer that
+ *still fails starts bus recovery. Returns the classified error of the last attempt.*/
+static IIS2MDC_Status_t BusRead(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length){
+	IIS2MDC_Status_t Status = IIS2MDC_Error;
+	for(uint8_t attempt = 0; attempt < IIS2MDC_BUS_ATTEMPTS; attempt++){
+		Status = Dev->IIS2MDC_IO.ReadReg(reg, pdata, length);
+		if(Status == IIS2MDC_Ok){
+			Dev->BusStats.Retries += attempt;
+			return IIS2MDC_Ok;
+		} else if(Status == IIS2MDC_ErrorTimeout){
+			break; //Bus is held, retrying only repeats the wait
+		}
+	}
+	BusFault(Dev, Status);
+	return Status;
+}
+
+
+static IIS2MDC_Status_t BusWrite(IIS2MDC_Handle_t *Dev, uint8_t reg, uint8_t *pdata, uint8_t length){
+	IIS2MDC_Status_t Status = IIS2MDC_Error;
+	for(uint8_t attempt = 0; attempt < IIS2MDC_BUS_ATTEMPTS; attempt++){
+		Status = Dev->IIS2MDC_IO.WriteReg(reg, pdata, length);
+		if(Status == IIS2MDC_Ok){
+			Dev->BusStats.Retries += attempt;
+			return IIS2MDC_Ok;
+		} else if(Status == IIS2MDC_ErrorTimeout){
+			break; //Bus is held, retrying only repeats the wait
+		}
+	}
+	BusFault(Dev, Status);
+	return Status;
+}
+
+
+static void BusFault(IIS2MDC_Handle_t *Dev, IIS2MDC_Status_t Status){
+	Dev->BusStats.LastError = Status;
+	Dev->BusStats.Faults++;
+	Dev->BusState = IIS2MDC_BusClearPending;
+	_log(log_iis2mdc, "Bus fault, starting recovery.");
+}
+
+
+/*The bus works but the chip is not an IIS2MDC. Counted as a fault, recovery is not started.*/
+static void WrongDevice(IIS2MDC_Handle_t *Dev){
+	Dev->BusStats.LastError = IIS2MDC_Error;
+	Dev->BusStats.Faults++;
+	Dev->BusState = IIS2MDC_BusWrongDevice;
+	Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQDisable);
+}
@@ -0,0 +1,134 @@
+/*
+ * IIS2MDC_Adaptive.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Adaptive.h"
+#include "IIS2MDC_Detector.h"
+#include <stddef.h>
+#include <string.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static IIS2MDC_Status_t SetLevel(IIS2MDC_Adaptive_t *Ctrl, uint8_t Level);
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+static const IIS2MDC_AdaptiveLevel_t IIS2MDC_DefaultLevels[] = {
+		{IIS2MDC_10Hz, IIS2MDC_LowPowerMode},
+		{IIS2MDC_20Hz, IIS2MDC_LowPowerMode},
+		{IIS2MDC_50Hz, IIS2MDC_HighResolutionMode},
+		{IIS2MDC_100Hz, IIS2MDC_HighResolutionMode}
+};
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Initializes a motion adaptive ODR / power mode controller and switches the device to the slowest level
+ *@Params: Controller storage, initialized device handle in continuous mode, thresholds and timing, current time in ms
+ *@Return: Status of the initial register write
+ *@Precondition: Device handle is initialized in continuous mode. In one-shot mode the sample rate is set by whoever
+ *               calls StartConversion and this controller has nothing to adjust.
+ *@Postcondition: Controller starts at level 0 with cleared statistics.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Adaptive_Init(IIS2MDC_Adaptive_t *Ctrl, IIS2MDC_Handle_t *Dev, IIS2MDC_AdaptiveConfig_t Config, uint32_t Timestamp){
+	memset(Ctrl, 0, sizeof(*Ctrl));
+	if(Config.Levels == NULL || Config.NumLevels == 0){
+		Config.Levels = IIS2MDC_DefaultLevels;
+		Config.NumLevels = sizeof(IIS2MDC_DefaultLevels) / sizeof(IIS2MDC_DefaultLevels[0]);
+	}
+	if(Config.NumLevels > IIS2MDC_ADAPTIVE_MAX_LEVELS){
+		Config.NumLevels = IIS2MDC_ADAPTIVE_MAX_LEVELS;
+	}
+	Ctrl->Config = Config;
+	Ctrl->Dev = Dev;
+	Ctrl->LastTime = Timestamp;
+	return SetLevel(Ctrl, 0);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Updates the motion estimate with one sample and steps the device level if needed
+ *@Params: Controller, XYZ sample in milligauss, sample time in ms
+ *@Return: Level the device runs at after this sample
+ *@Precondition: Controller is initialized, called for every sample from the main loop (it may write to the sensor).
+ *@Postcondition: Time since the previous call is added to the time of the level that was active during it.
+ **************************************//**************************************/
+uint8_t IIS2MDC_Adaptive_Process(IIS2MDC_Adaptive_t *Ctrl, const int32_t Sample[3], uint32_t Timestamp){
+	const IIS2MDC_AdaptiveConfig_t *cfg = &Ctrl->Config;
+
+	Ctrl->Stats.TimeInLevel[Ctrl->Level] += Timestamp - Ctrl->LastTime;
+	Ctrl->LastTime = Timestamp;
+
+	if(!Ctrl->HasReference){
+		memcpy(Ctrl->Reference, Sample, sizeof(Ctrl->Reference));
+		Ctrl->ReferenceTime = Timestamp;
+		Ctrl->HasReference = 1;
+		return Ctrl->Level;
+	}
+
+	uint32_t elapsed = Timestamp - Ctrl->ReferenceTime;
+	if(elapsed == 0 || elapsed < cfg->WindowMs){
+		return Ctrl->Level;
+	}
+
+	const int32_t delta[3] = {Sample[0] - Ctrl->Reference[0], Sample[1] - Ctrl->Reference[1], Sample[2] - Ctrl->Reference[2]};
+	Ctrl->Rate = (uint32_t)(((uint64_t)IIS2MDC_Magnitude(delta) * 1000U) / elapsed);
+	memcpy(Ctrl->Reference, Sample, sizeof(Ctrl->Reference));
+	Ctrl->ReferenceTime = Timestamp;
+
+	if(Ctrl->Rate > cfg->MotionRate){
+		if(!Ctrl->Moving){
+			Ctrl->Moving = 1;
+			Ctrl->MotionSince = Timestamp;
+		}
+		Ctrl->Still = 0;
+	} else if(Ctrl->Rate < cfg->StillRate){
+		if(!Ctrl->Still){
+			Ctrl->Still = 1;
+			Ctrl->StillSince = Timestamp;
+		}
+		Ctrl->Moving = 0;
+	} else {
+		Ctrl->Moving = 0;
+		Ctrl->Still = 0;
+	}
+
+	uint8_t top = cfg->NumLevels - 1;
+	if(Ctrl->Moving && Ctrl->Level != top && Timestamp - Ctrl->MotionSince >= cfg->StepUpMs){
+		if(SetLevel(Ctrl, top) == IIS2MDC_Ok){
+			Ctrl->Stats.StepsUp++;
+		}
+	} else if(Ctrl->Still && Ctrl->Level != 0 && Timestamp - Ctrl->StillSince >= cfg->StepDownMs){
+		if(SetLevel(Ctrl, Ctrl->Level - 1) == IIS2MDC_Ok){
+			Ctrl->Stats.StepsDown++;
+			Ctrl->StillSince = Timestamp;
+		}
+	}
+	return Ctrl->Level;
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*ODR and power mode share CFG_REG_A, so a level change is a single register write*/
+static IIS2MDC_Status_t SetLevel(IIS2MDC_Adaptive_t *Ctrl, uint8_t Level){
+	IIS2MDC_InitStruct_t Settings = Ctrl->Dev->Settings;
+	Settings.DataRate = Ctrl->Config.Levels[Level].DataRate;
+	Settings.PowerMode = Ctrl->Config.Levels[Level].PowerMode;
+	if(IIS2MDC_Reconfigure(Ctrl->Dev, &Settings) != IIS2MDC_Ok){
+		Ctrl->Stats.Failed++;
+		return IIS2MDC_Error;
+	}
+	Ctrl->Level = Level;
+	return IIS2MDC_Ok;
+}
@@ -0,0 +1,187 @@
+/*
+ * IIS2MDC_Autonomous.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Autonomous.h"
+#include "log.h"
+#include <stddef.h>
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+static const uint8_t MAX_PRESCALER_LOG2 = 7; /*Timer prescaler is 1..128*/
+static const uint8_t READ_LENGTH = IIS2MDC_REG_OUTZ_H_REG - IIS2MDC_REG_STATUS_REG + 1; /*STATUS then the outputs*/
+static const uint8_t STATUS_ZYXDA = 0x08U;
+static const uint8_t STATUS_ZYXOR = 0x80U;
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static uint16_t ParseSlot(IIS2MDC_Autonomous_t *A);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Starts reading the sensor every PeriodMs by DMA with the core stopped, waking it once per WakeEvery samples.
+ *@Params: Autonomous context, initialized device handle, autonomous drivers, read period in ms, samples per wake up
+ *@Return: IIS2MDC_Error if the period or block size can not be represented or the bus is busy, otherwise IIS2MDC_Ok
+ *@Precondition: Dev is initialized in IIS2MDC_ContinuousMode at an ODR of at least 1000 / PeriodMs Hz. The driver's
+ *               block interrupt calls IIS2MDC_Autonomous_BlockEvent.
+ *@Postcondition: The pin interrupt is masked and the bus belongs to the DMA, do not access Dev until DeInit.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Autonomous_Init(IIS2MDC_Autonomous_t *A, IIS2MDC_Handle_t *Dev, IIS2MDC_Autonomous_Drv_t LowLevelDrivers, uint32_t PeriodMs, uint8_t WakeEvery){
+	A->Dev = Dev;
+	A->Autonomous_IO = LowLevelDrivers;
+	A->Ring = NULL;
+	A->ReadSlot = 0;
+	A->BlocksPending = 0;
+	A->Restarted = 0;
+	A->Stats = (IIS2MDC_AutonomousStats_t){0};
+
+	if(Dev->Settings.OperatingMode != IIS2MDC_ContinuousMode || WakeEvery == 0 || WakeEvery > IIS2MDC_AUTONOMOUS_MAX_SLOTS / 2){
+		_log(log_iis2mdc, "Autonomous: Needs continuous mode and 1..%u samples per wake up.", IIS2MDC_AUTONOMOUS_MAX_SLOTS / 2);
+		return IIS2MDC_Error;
+	}
+	A->WakeEvery = WakeEvery;
+	A->Slots = 2 * WakeEvery;
+
+	/*Smallest prescaler keeps the best period resolution*/
+	uint64_t ticks = 0;
+	uint8_t prescaler;
+	for(prescaler = 0; prescaler <= MAX_PRESCALER_LOG2; prescaler++){
+		ticks = ((uint64_t)PeriodMs * LowLevelDrivers.TimerClockHz + (500ULL << prescaler)) / (1000ULL << prescaler);
+		if(ticks <= UINT16_MAX){
+			break;
+		}
+	}
+
+	if(ticks < 2 || prescaler > MAX_PRESCALER_LOG2){ //The trigger pulses mid period, one tick has no middle
+		_log(log_iis2mdc, "Autonomous: Period %lu ms out of range.", PeriodMs);
+		return IIS2MDC_Error;
+	}
+
+	Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQDisable); //DRDY would wake the core on every sample
+	A->Autonomous_IO.Init();
+	A->Ring = A->Autonomous_IO.Start(IIS2MDC_REG_STATUS_REG, READ_LENGTH, A->Slots, A->WakeEvery, prescaler, (uint16_t)ticks);
+	if(A->Ring == NULL){
+		_log(log_iis2mdc, "Autonomous: Bus busy or read list rejected.");
+		IIS2MDC_Autonomous_DeInit(A);
+		return IIS2MDC_Error;
+	}
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Stops autonomous reads and returns the bus and pin interrupt to the driver
+ *@Params: Autonomous context
+ *@Return: None
+ *@Precondition: A is initialized
+ *@Postcondition: Samples still in the ring are discarded. The device keeps converting in continuous mode.
+ **************************************//**************************************/
+void IIS2MDC_Autonomous_DeInit(IIS2MDC_Autonomous_t *A){
+	if(A->Ring != NULL){
+		A->Autonomous_IO.Stop();
+		A->Ring = NULL;
+	}
+	A->BlocksPending = 0;
+	if(A->Dev->DrdyPinMode != IIS2MDC_DrdySignalDisabled || A->Dev->IntPinMode != IIS2MDC_IntSignalDisabled){
+		A->Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQEnable);
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Records that a block of reads completed. Call from the DMA / bus interrupt.
+ *@Params: Autonomous context, non zero if the reads stopped on an error and were restarted from the first slot
+ *@Return: None
+ *@Precondition: A is initialized
+ *@Postcondition: Next call to IIS2MDC_Autonomous_Process parses the block.
+ **************************************//**************************************/
+void IIS2MDC_Autonomous_BlockEvent(IIS2MDC_Autonomous_t *A, uint8_t Error){
+	if(Error){
+		A->Stats.Errors++;
+		A->Stats.Dropped += A->BlocksPending; //Counted from the old slot position, can't be located any more
+		A->BlocksPending = 0;
+		A->Restarted = 1;
+		return;
+	}
+	if(A->BlocksPending < UINT8_MAX){
+		A->BlocksPending++;
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Publishes the samples of a completed block through the device handle, sleeping if there is nothing to do.
+ *@Params: Autonomous context
+ *@Return: Number of samples published. The data ready callback ran for each of them.
+ *@Precondition: A is initialized. Call from the main loop.
+ *@Postcondition: If more than one block was pending only the newest is parsed, the DMA is already overwriting the rest.
+ **************************************//**************************************/
+uint16_t IIS2MDC_Autonomous_Process(IIS2MDC_Autonomous_t *A){
+	uint16_t published = 0;
+
+	A->Autonomous_IO.EnterCritical();
+	uint8_t blocks = A->BlocksPending;
+	uint8_t restarted = A->Restarted;
+	A->BlocksPending = 0;
+	A->Restarted = 0;
+	A->Autonomous_IO.ExitCritical();
+
+	if(restarted){
+		A->ReadSlot = 0;
+	}
+	if(blocks > 1){
+		A->Stats.Dropped += blocks - 1;
+		A->ReadSlot = (uint8_t)((A->ReadSlot + (uint32_t)(blocks - 1) * A->WakeEvery) % A->Slots);
+	}
+	if(blocks > 0){
+		A->Stats.Wakeups++;
+		for(uint8_t i = 0; i < A->WakeEvery; i++){
+			published += ParseSlot(A);
+		}
+	}
+
+	A->Autonomous_IO.EnterCritical();
+	if(A->Ring != NULL && A->BlocksPending == 0 && !A->Restarted){
+		A->Autonomous_IO.Sleep();
+	}
+	A->Autonomous_IO.ExitCritical();
+
+	return published;
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Each slot is STATUS_REG followed by OUTX_L..OUTZ_H, read in one burst so BDU keeps the status and outputs matched*/
+static uint16_t ParseSlot(IIS2MDC_Autonomous_t *A){
+	const volatile uint8_t *slot = &A->Ring[A->ReadSlot * IIS2MDC_AUTONOMOUS_SLOT_SIZE];
+	A->ReadSlot = (uint8_t)((A->ReadSlot + 1U) % A->Slots);
+
+	uint8_t status = slot[0];
+	if(status & STATUS_ZYXOR){
+		A->Stats.Overruns++;
+	}
+	if((status & STATUS_ZYXDA) == 0){
+		A->Stats.Stale++;
+		return 0;
+	}
+
+	uint8_t buffer[6];
+	for(uint8_t i = 0; i < sizeof(buffer); i++){
+		buffer[i] = slot[1 + i];
+	}
+	IIS2MDC_PublishRaw(A->Dev, buffer);
+	A->Stats.Samples++;
+	return 1;
+}
@@ -0,0 +1,313 @@
+/*
+ * IIS2MDC_Compress.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Compress.h"
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+static const uint8_t MAX_RICE_PARAMETER = 15;
+static const int32_t MIN_INTERVAL_CHANGE = -65536; /*Anything that zigzags into IIS2MDC_COMPRESS_RAW_BITS*/
+static const int32_t MAX_INTERVAL_CHANGE = 65535;
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void ResetModel(IIS2MDC_CompressModel_t *M, const int16_t Field[3], uint32_t Timestamp, int32_t Interval);
+static uint8_t RiceParameter(uint32_t Mean);
+static void UpdateMean(uint32_t *Mean, uint32_t Value);
+static uint32_t Zigzag(int32_t Value);
+static int32_t Unzigzag(uint32_t Value);
+static void PutBits(IIS2MDC_Encoder_t *E, uint8_t *Out, uint8_t *n, uint32_t Value, uint8_t Count);
+static void PutRice(IIS2MDC_Encoder_t *E, uint8_t *Out, uint8_t *n, uint32_t *Mean, uint32_t Value);
+static uint8_t GetBits(IIS2MDC_Decoder_t *D, uint8_t Count, uint32_t *Value);
+static uint8_t GetRice(IIS2MDC_Decoder_t *D, uint32_t *Mean, uint32_t *Value);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Starts a new encoded stream
+ *@Params: Encoder, samples between keyframes (0 for a keyframe at the start of each block only)
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: The next sample is a keyframe.
+ **************************************//**************************************/
+void IIS2MDC_Encoder_Init(IIS2MDC_Encoder_t *E, uint16_t KeyInterval){
+	const int16_t Zero[3] = {0};
+	ResetModel(&E->Model, Zero, 0, 0);
+	E->Bits = 0;
+	E->BitCount = 0;
+	E->KeyInterval = KeyInterval;
+	E->SinceKey = 0;
+	E->KeyPending = 1;
+	E->Samples = 0;
+	E->Keyframes = 0;
+	E->Bytes = 0;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Encodes one sample
+ *@Params: Encoder, XYZ sample (any int16 unit, raw LSB keeps it lossless), timestamp in any tick unit, output buffer of
+ *         at least IIS2MDC_COMPRESS_MAX_BYTES
+ *@Return: Number of bytes completed into Out. Up to 7 bits stay pending in the encoder until the next call or Flush.
+ *@Precondition: E is initialized
+ *@Postcondition: A sample whose interval changed by more than 16 bits can hold is sent as a keyframe.
+ **************************************//**************************************/
+uint8_t IIS2MDC_Encoder_Encode(IIS2MDC_Encoder_t *E, const int16_t Field[3], uint32_t Timestamp, uint8_t *Out){
+	IIS2MDC_CompressModel_t *M = &E->Model;
+	uint8_t n = 0;
+	int32_t Interval = (int32_t)(Timestamp - M->LastTime);
+	int64_t Change = (int64_t)Interval - M->LastInterval;
+
+	if(E->KeyPending || (E->KeyInterval != 0 && E->SinceKey >= E->KeyInterval) ||
+			Change < MIN_INTERVAL_CHANGE || Change > MAX_INTERVAL_CHANGE){
+		uint16_t KeyInterval16 = (Interval < 0 || Interval > UINT16_MAX || E->KeyPending) ? 0 : (uint16_t)Interval;
+		PutBits(E, Out, &n, 1, 1);
+		if(E->BitCount != 0){
+			PutBits(E, Out, &n, 0, 8 - E->BitCount);
+		}
+		const uint8_t Key[IIS2MDC_COMPRESS_KEY_BYTES] = {
+				(uint8_t)Timestamp, (uint8_t)(Timestamp >> 8), (uint8_t)(Timestamp >> 16), (uint8_t)(Timestamp >> 24),
+				(uint8_t)KeyInterval16, (uint8_t)(KeyInterval16 >> 8),
+				(uint8_t)Field[0], (uint8_t)((uint16_t)Field[0] >> 8),
+				(uint8_t)Field[1], (uint8_t)((uint16_t)Field[1] >> 8),
+				(uint8_t)Field[2], (uint8_t)((uint16_t)Field[2] >> 8)
+		};
+		for(uint8_t i = 0; i < IIS2MDC_COMPRESS_KEY_BYTES; i++){
+			Out[n++] = Key[i];
+		}
+		ResetModel(M, Field, Timestamp, KeyInterval16);
+		E->SinceKey = 0;
+		E->KeyPending = 0;
+		E->Keyframes++;
+	} else {
+		PutBits(E, Out, &n, 0, 1);
+		PutRice(E, Out, &n, &M->Mean[0], Zigzag((int32_t)Change));
+		for(uint8_t i = 0; i < 3; i++){
+			PutRice(E, Out, &n, &M->Mean[1 + i], Zigzag((int32_t)Field[i] - M->Last[i]));
+			M->Last[i] = Field[i];
+		}
+		M->LastTime = Timestamp;
+		M->LastInterval = Interval;
+	}
+
+	E->SinceKey++;
+	E->Samples++;
+	E->Bytes += n;
+	return n;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Ends the current block, padding its last byte with zeros
+ *@Params: Encoder, output buffer of at least 1 byte
+ *@Return: Number of bytes written, 0 or 1
+ *@Precondition: E is initialized
+ *@Postcondition: The next sample starts a new block with a keyframe.
+ **************************************//**************************************/
+uint8_t IIS2MDC_Encoder_Flush(IIS2MDC_Encoder_t *E, uint8_t *Out){
+	uint8_t n = 0;
+	if(E->BitCount != 0){
+		Out[n++] = (uint8_t)(E->Bits << (8 - E->BitCount));
+	}
+	E->Bits = 0;
+	E->BitCount = 0;
+	E->KeyPending = 1;
+	E->Bytes += n;
+	return n;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Starts decoding a block
+ *@Params: Decoder, block from its first byte, its length in bytes
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: Data must stay valid while decoding.
+ **************************************//**************************************/
+void IIS2MDC_Decoder_Init(IIS2MDC_Decoder_t *D, const uint8_t *Data, uint32_t Length){
+	const int16_t Zero[3] = {0};
+	ResetModel(&D->Model, Zero, 0, 0);
+	D->Data = Data;
+	D->Length = Length;
+	D->BitPosition = 0;
+	D->Started = 0;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Decodes the next sample
+ *@Params: Decoder, returns the XYZ sample, returns its timestamp
+ *@Return: IIS2MDC_DecodeSample if one was decoded, IIS2MDC_DecodeEnd when only padding or a partial sample is left,
+ *         IIS2MDC_DecodeCorrupt if the block does not start with a keyframe
+ *@Precondition: D is initialized
+ *@Postcondition: On anything but a sample the decoder is left where it was.
+ **************************************//**************************************/
+IIS2MDC_DecodeStatus_t IIS2MDC_Decoder_Decode(IIS2MDC_Decoder_t *D, int16_t Field[3], uint32_t *Timestamp){
+	uint32_t Start = D->BitPosition;
+	IIS2MDC_CompressModel_t Saved = D->Model;
+	IIS2MDC_CompressModel_t *M = &D->Model;
+	uint32_t Flag;
+
+	if(!GetBits(D, 1, &Flag)){
+		return IIS2MDC_DecodeEnd;
+	}
+
+	if(Flag){
+		uint32_t Byte = (D->BitPosition + 7U) / 8U;
+		if(Byte + IIS2MDC_COMPRESS_KEY_BYTES > D->Length){
+			D->BitPosition = Start;
+			return IIS2MDC_DecodeEnd;
+		}
+		const uint8_t *Key = &D->Data[Byte];
+		uint32_t Time = (uint32_t)Key[0] | ((uint32_t)Key[1] << 8) | ((uint32_t)Key[2] << 16) | ((uint32_t)Key[3] << 24);
+		int32_t Interval = (int32_t)((uint32_t)Key[4] | ((uint32_t)Key[5] << 8));
+		int16_t Value[3];
+		for(uint8_t i = 0; i < 3; i++){
+			Value[i] = (int16_t)((uint16_t)Key[6 + 2 * i] | ((uint16_t)Key[7 + 2 * i] << 8));
+		}
+		ResetModel(M, Value, Time, Interval);
+		D->BitPosition = (Byte + IIS2MDC_COMPRESS_KEY_BYTES) * 8U;
+		D->Started = 1;
+	} else {
+		uint32_t Code[IIS2MDC_COMPRESS_CHANNELS];
+		for(uint8_t i = 0; i < IIS2MDC_COMPRESS_CHANNELS; i++){
+			if(!GetRice(D, &M->Mean[i], &Code[i])){
+				D->BitPosition = Start;
+				D->Model = Saved;
+				return IIS2MDC_DecodeEnd; //Trailing zero padding never completes a Rice code
+			}
+		}
+		if(!D->Started){
+			D->BitPosition = Start;
+			D->Model = Saved;
+			return IIS2MDC_DecodeCorrupt;
+		}
+		M->LastInterval += Unzigzag(Code[0]);
+		M->LastTime += (uint32_t)M->LastInterval;
+		for(uint8_t i = 0; i < 3; i++){
+			M->Last[i] = (int16_t)(M->Last[i] + Unzigzag(Code[1 + i]));
+		}
+	}
+
+	Field[0] = M->Last[0];
+	Field[1] = M->Last[1];
+	Field[2] = M->Last[2];
+	*Timestamp = M->LastTime;
+	return IIS2MDC_DecodeSample;
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+static void ResetModel(IIS2MDC_CompressModel_t *M, const int16_t Field[3], uint32_t Timestamp, int32_t Interval){
+	M->Last[0] = Field[0];
+	M->Last[1] = Field[1];
+	M->Last[2] = Field[2];
+	M->LastTime = Timestamp;
+	M->LastInterval = Interval;
+	for(uint8_t i = 0; i < IIS2MDC_COMPRESS_CHANNELS; i++){
+		M->Mean[i] = IIS2MDC_COMPRESS_MEAN_INIT;
+	}
+}
+
+/*Smallest k with 2^k at or above the running mean. Close to the optimum for geometric residuals.*/
+static uint8_t RiceParameter(uint32_t Mean){
+	uint8_t k = 0;
+	while(k < MAX_RICE_PARAMETER && (16UL << k) < Mean){
+		k++;
+	}
+	return k;
+}
+
+/*Mean settles at 16 x the average of recent values, about 16 samples of memory*/
+static void UpdateMean(uint32_t *Mean, uint32_t Value){
+	*Mean = *Mean - (*Mean >> 4) + ((Value > UINT16_MAX) ? UINT16_MAX : Value);
+}
+
+static uint32_t Zigzag(int32_t Value){
+	return ((uint32_t)Value << 1) ^ (uint32_t)(Value >> 31);
+}
+
+static int32_t Unzigzag(uint32_t Value){
+	return (int32_t)(Value >> 1) ^ -(int32_t)(Value & 1U);
+}
+
+/*Appends Count (at most 24) bits MSB first, storing each byte as it completes*/
+static void PutBits(IIS2MDC_Encoder_t *E, uint8_t *Out, uint8_t *n, uint32_t Value, uint8_t Count){
+	E->Bits = (E->Bits << Count) | (Value & ((1UL << Count) - 1U));
+	E->BitCount += Count;
+	while(E->BitCount >= 8){
+		E->BitCount -= 8;
+		Out[(*n)++] = (uint8_t)(E->Bits >> E->BitCount);
+	}
+	E->Bits &= (1UL << E->BitCount) - 1U;
+}
+
+static void PutRice(IIS2MDC_Encoder_t *E, uint8_t *Out, uint8_t *n, uint32_t *Mean, uint32_t Value){
+	uint8_t k = RiceParameter(*Mean);
+	uint32_t q = Value >> k;
+	if(q < IIS2MDC_COMPRESS_ESCAPE){
+		PutBits(E, Out, n, 1, (uint8_t)(q + 1)); //q zeros then the terminating one
+		if(k != 0){
+			PutBits(E, Out, n, Value, k);
+		}
+	} else {
+		PutBits(E, Out, n, 0, IIS2MDC_COMPRESS_ESCAPE);
+		PutBits(E, Out, n, Value, IIS2MDC_COMPRESS_RAW_BITS);
+	}
+	UpdateMean(Mean, Value);
+}
+
+static uint8_t GetBits(IIS2MDC_Decoder_t *D, uint8_t Count, uint32_t *Value){
+	if(D->BitPosition + Count > D->Length * 8U){
+		return 0;
+	}
+	uint32_t v = 0;
+	for(uint8_t i = 0; i < Count; i++){
+		uint32_t p = D->BitPosition++;
+		v = (v << 1) | ((D->Data[p >> 3] >> (7U - (p & 7U))) & 1U);
+	}
+	*Value = v;
+	return 1;
+}
+
+static uint8_t GetRice(IIS2MDC_Decoder_t *D, uint32_t *Mean, uint32_t *Value){
+	uint8_t k = RiceParameter(*Mean);
+	uint32_t q;
+	uint32_t Bit = 0;
+	for(q = 0; q < IIS2MDC_COMPRESS_ESCAPE; q++){
+		if(!GetBits(D, 1, &Bit)){
+			return 0;
+		}
+		if(Bit){
+			break;
+		}
+	}
+
+	uint32_t v;
+	if(q == IIS2MDC_COMPRESS_ESCAPE){
+		if(!GetBits(D, IIS2MDC_COMPRESS_RAW_BITS, &v)){
+			return 0;
+		}
+	} else {
+		uint32_t r = 0;
+		if(k != 0 && !GetBits(D, k, &r)){
+			return 0;
+		}
+		v = (q << k) | r;
+	}
+	UpdateMean(Mean, v);
+	*Value = v;
+	return 1;
+}
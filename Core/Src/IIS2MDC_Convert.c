@@ -0,0 +1,239 @@
+/*
+ * IIS2MDC_Convert.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Convert.h"
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define IIS2MDC_CONVERT_DSP
+#include "cmsis_compiler.h"
+#elif defined(__AVX2__)
+#define IIS2MDC_CONVERT_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define IIS2MDC_CONVERT_SSE2
+#include <emmintrin.h>
+#endif
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+#define ROUNDING_OFFSET (1L << (IIS2MDC_CAL_MATRIX_FRAC_BITS - 1))
+
+/*Same matrix the driver has always shipped with, no hard iron bias.*/
+const IIS2MDC_Calibration_t IIS2MDC_DefaultCalibration = {
+		.Bias = {0, 0, 0},
+		.Matrix = {
+				{IIS2MDC_CAL_Q14(1.206096), IIS2MDC_CAL_Q14(0.026751), IIS2MDC_CAL_Q14(0.001434)},
+				{IIS2MDC_CAL_Q14(0.026751), IIS2MDC_CAL_Q14(1.269714), IIS2MDC_CAL_Q14(0.015582)},
+				{IIS2MDC_CAL_Q14(0.001434), IIS2MDC_CAL_Q14(0.015582), IIS2MDC_CAL_Q14(1.478172)}
+		}
+};
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static int16_t Saturate16(int32_t value);
+#if defined(IIS2MDC_CONVERT_DSP)
+static uint32_t ConvertBlockDSP(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count);
+#elif defined(IIS2MDC_CONVERT_SSE2) || defined(IIS2MDC_CONVERT_AVX2)
+static uint32_t ConvertBlockSIMD(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count);
+#endif
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Applies hard iron bias and soft iron matrix to a block of raw XYZ triplets
+ *@Params: Calibration to apply, raw triplets (X,Y,Z interleaved), output triplets, number of triplets
+ *@Return: None
+ *@Precondition: raw and out each hold 3 * count int16 values. raw and out may be the same buffer.
+ *@Postcondition: out holds calibrated triplets, bit exact with IIS2MDC_ConvertBlockReference.
+ **************************************//**************************************/
+void IIS2MDC_ConvertBlock(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count){
+	uint32_t done = 0;
+#if defined(IIS2MDC_CONVERT_DSP)
+	done = ConvertBlockDSP(Cal, raw, out, count);
+#elif defined(IIS2MDC_CONVERT_SSE2) || defined(IIS2MDC_CONVERT_AVX2)
+	done = ConvertBlockSIMD(Cal, raw, out, count);
+#endif
+	IIS2MDC_ConvertBlockReference(Cal, &raw[3 * done], &out[3 * done], count - done);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Portable scalar version of IIS2MDC_ConvertBlock. Used for the tail of a block and to validate the SIMD paths.
+ *@Params: Calibration to apply, raw triplets (X,Y,Z interleaved), output triplets, number of triplets
+ *@Return: None
+ *@Precondition: raw and out each hold 3 * count int16 values. raw and out may be the same buffer.
+ *@Postcondition: out holds calibrated triplets.
+ **************************************//**************************************/
+void IIS2MDC_ConvertBlockReference(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count){
+	for(uint32_t i = 0; i < count; i++){
+		int32_t d[3];
+		for(uint8_t axis = 0; axis < 3; axis++){
+			d[axis] = Saturate16((int32_t)raw[3 * i + axis] - Cal->Bias[axis]);
+		}
+
+		for(uint8_t row = 0; row < 3; row++){
+			int32_t acc = ROUNDING_OFFSET;
+			acc += Cal->Matrix[row][0] * d[0];
+			acc += Cal->Matrix[row][1] * d[1];
+			acc += Cal->Matrix[row][2] * d[2];
+			out[3 * i + row] = Saturate16(acc >> IIS2MDC_CAL_MATRIX_FRAC_BITS);
+		}
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Assembles little endian OUTX_L..OUTZ_H register bytes into signed raw samples
+ *@Params: Register bytes (6 per triplet), output triplets, number of triplets
+ *@Return: None
+ *@Precondition: pdata holds 6 * count bytes read starting at OUTX_L_REG
+ *@Postcondition: raw holds 3 * count signed samples in LSB
+ **************************************//**************************************/
+void IIS2MDC_UnpackBlock(const uint8_t *pdata, int16_t *raw, uint32_t count){
+	for(uint32_t i = 0; i < 3 * count; i++){
+		raw[i] = (int16_t)(((uint16_t)pdata[2 * i + 1] << 8) | pdata[2 * i]);
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Scales samples from LSB to milligauss, rounding half up
+ *@Params: Input samples in LSB, output samples in milligauss, number of triplets
+ *@Return: None
+ *@Precondition: in holds 3 * count samples
+ *@Postcondition: milligauss holds 3 * count scaled samples. Full scale (+-32768 LSB) is +-49152 mG, so the output is 32 bits.
+ **************************************//**************************************/
+void IIS2MDC_ScaleBlock(const int16_t *in, int32_t *milligauss, uint32_t count){
+	for(uint32_t i = 0; i < 3 * count; i++){
+		milligauss[i] = ((int32_t)in[i] * IIS2MDC_SENSITIVITY_MG_PER_LSB_Q8 + (1 << (IIS2MDC_SENSITIVITY_FRAC_BITS - 1))) >> IIS2MDC_SENSITIVITY_FRAC_BITS;
+	}
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Clamps a 32 bit value to the int16 range*/
+static int16_t Saturate16(int32_t value){
+	if(value > INT16_MAX){
+		return INT16_MAX;
+	} else if(value < INT16_MIN){
+		return INT16_MIN;
+	}
+	return (int16_t)value;
+}
+
+#if defined(IIS2MDC_CONVERT_DSP)
+/*Cortex-M33 DSP path: X/Y pair is handled by one SMLAD per row, Z by a second SMLAD against a zero upper half.*/
+static uint32_t ConvertBlockDSP(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count){
+	const uint32_t bias_xy = ((uint32_t)(uint16_t)Cal->Bias[1] << 16) | (uint16_t)Cal->Bias[0];
+	const uint32_t bias_z = (uint16_t)Cal->Bias[2];
+	uint32_t m01[3];
+	uint32_t m2[3];
+
+	for(uint8_t row = 0; row < 3; row++){
+		m01[row] = ((uint32_t)(uint16_t)Cal->Matrix[row][1] << 16) | (uint16_t)Cal->Matrix[row][0];
+		m2[row] = (uint16_t)Cal->Matrix[row][2];
+	}
+
+	for(uint32_t i = 0; i < count; i++){
+		uint32_t dxy = __QSUB16(__UNALIGNED_UINT32_READ(&raw[3 * i]), bias_xy);
+		uint32_t dz = __QSUB16((uint16_t)raw[3 * i + 2], bias_z) & 0xFFFFU;
+		int32_t x = (int32_t)__SMLAD(dxy, m01[0], __SMLAD(dz, m2[0], ROUNDING_OFFSET));
+		int32_t y = (int32_t)__SMLAD(dxy, m01[1], __SMLAD(dz, m2[1], ROUNDING_OFFSET));
+		int32_t z = (int32_t)__SMLAD(dxy, m01[2], __SMLAD(dz, m2[2], ROUNDING_OFFSET));
+		out[3 * i + 0] = (int16_t)__SSAT(x >> IIS2MDC_CAL_MATRIX_FRAC_BITS, 16);
+		out[3 * i + 1] = (int16_t)__SSAT(y >> IIS2MDC_CAL_MATRIX_FRAC_BITS, 16);
+		out[3 * i + 2] = (int16_t)__SSAT(z >> IIS2MDC_CAL_MATRIX_FRAC_BITS, 16);
+	}
+	return count;
+}
+
+#elif defined(IIS2MDC_CONVERT_SSE2) || defined(IIS2MDC_CONVERT_AVX2)
+/*Host path. Two triplets are spread to [x0 y0 z0 0 x1 y1 z1 0] so each matrix row is a single PMADDWD plus a pair add.
+ *Loads are 16 bytes wide, so a block is only taken while at least 8 int16 remain in the source.*/
+static inline __m128i SpreadPair(const int16_t *src){
+	const __m128i keep_lo = _mm_setr_epi16(-1, -1, -1, 0, 0, 0, 0, 0);
+	const __m128i keep_hi = _mm_setr_epi16(0, 0, 0, 0, -1, -1, -1, 0);
+	__m128i v = _mm_loadu_si128((const __m128i*)src);
+	return _mm_or_si128(_mm_and_si128(v, keep_lo), _mm_and_si128(_mm_slli_si128(v, 2), keep_hi));
+}
+
+static inline void StorePair(int16_t *dst, __m128i x, __m128i y, __m128i z){
+	int16_t packed[16];
+	_mm_storeu_si128((__m128i*)&packed[0], _mm_packs_epi32(x, y));
+	_mm_storeu_si128((__m128i*)&packed[8], _mm_packs_epi32(z, z));
+	dst[0] = packed[0];  /*x0*/
+	dst[1] = packed[4];  /*y0*/
+	dst[2] = packed[8];  /*z0*/
+	dst[3] = packed[2];  /*x1*/
+	dst[4] = packed[6];  /*y1*/
+	dst[5] = packed[10]; /*z1*/
+}
+
+#if defined(IIS2MDC_CONVERT_AVX2)
+static inline __m256i MatrixRow(__m256i d, __m256i row, __m256i round){
+	__m256i p = _mm256_madd_epi16(d, row);
+	p = _mm256_add_epi32(p, _mm256_shuffle_epi32(p, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm256_srai_epi32(_mm256_add_epi32(p, round), IIS2MDC_CAL_MATRIX_FRAC_BITS);
+}
+
+static uint32_t ConvertBlockSIMD(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count){
+	const int16_t (*m)[3] = Cal->Matrix;
+	const __m256i bias = _mm256_setr_epi16(Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0, Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0,
+			Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0, Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0);
+	const __m256i row0 = _mm256_setr_epi16(m[0][0], m[0][1], m[0][2], 0, m[0][0], m[0][1], m[0][2], 0,
+			m[0][0], m[0][1], m[0][2], 0, m[0][0], m[0][1], m[0][2], 0);
+	const __m256i row1 = _mm256_setr_epi16(m[1][0], m[1][1], m[1][2], 0, m[1][0], m[1][1], m[1][2], 0,
+			m[1][0], m[1][1], m[1][2], 0, m[1][0], m[1][1], m[1][2], 0);
+	const __m256i row2 = _mm256_setr_epi16(m[2][0], m[2][1], m[2][2], 0, m[2][0], m[2][1], m[2][2], 0,
+			m[2][0], m[2][1], m[2][2], 0, m[2][0], m[2][1], m[2][2], 0);
+	const __m256i round = _mm256_set1_epi32(ROUNDING_OFFSET);
+	uint32_t i = 0;
+
+	for(; count - i >= 5; i += 4){
+		__m256i d = _mm256_set_m128i(SpreadPair(&raw[3 * i + 6]), SpreadPair(&raw[3 * i]));
+		d = _mm256_subs_epi16(d, bias);
+		__m256i x = MatrixRow(d, row0, round);
+		__m256i y = MatrixRow(d, row1, round);
+		__m256i z = MatrixRow(d, row2, round);
+		StorePair(&out[3 * i], _mm256_castsi256_si128(x), _mm256_castsi256_si128(y), _mm256_castsi256_si128(z));
+		StorePair(&out[3 * i + 6], _mm256_extracti128_si256(x, 1), _mm256_extracti128_si256(y, 1), _mm256_extracti128_si256(z, 1));
+	}
+	return i;
+}
+
+#else
+static inline __m128i MatrixRow(__m128i d, __m128i row, __m128i round){
+	__m128i p = _mm_madd_epi16(d, row);
+	p = _mm_add_epi32(p, _mm_shuffle_epi32(p, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_srai_epi32(_mm_add_epi32(p, round), IIS2MDC_CAL_MATRIX_FRAC_BITS);
+}
+
+static uint32_t ConvertBlockSIMD(const IIS2MDC_Calibration_t *Cal, const int16_t *raw, int16_t *out, uint32_t count){
+	const int16_t (*m)[3] = Cal->Matrix;
+	const __m128i bias = _mm_setr_epi16(Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0, Cal->Bias[0], Cal->Bias[1], Cal->Bias[2], 0);
+	const __m128i row0 = _mm_setr_epi16(m[0][0], m[0][1], m[0][2], 0, m[0][0], m[0][1], m[0][2], 0);
+	const __m128i row1 = _mm_setr_epi16(m[1][0], m[1][1], m[1][2], 0, m[1][0], m[1][1], m[1][2], 0);
+	const __m128i row2 = _mm_setr_epi16(m[2][0], m[2][1], m[2][2], 0, m[2][0], m[2][1], m[2][2], 0);
+	const __m128i round = _mm_set1_epi32(ROUNDING_OFFSET);
+	uint32_t i = 0;
+
+	for(; count - i >= 3; i += 2){
+		__m128i d = _mm_subs_epi16(SpreadPair(&raw[3 * i]), bias);
+		StorePair(&out[3 * i], MatrixRow(d, row0, round), MatrixRow(d, row1, round), MatrixRow(d, row2, round));
+	}
+	return i;
+}
+#endif
+#endif
@@ -0,0 +1,152 @@
+/*
+ * IIS2MDC_Decimator.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Decimator.h"
+#include <stddef.h>
+#include <string.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void DecimatorStep(IIS2MDC_Decimator_t *Decimator, const int32_t Sample[3]);
+static uint64_t CICGain(uint16_t Ratio, uint8_t Order);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Initializes a decimating subscriber
+ *@Params: Decimator storage, decimation ratio (output rate = input rate / Ratio), CIC order (1 to IIS2MDC_CIC_MAX_ORDER),
+ *         callback run for every output sample (may be NULL), user context handed to the callback
+ *@Return: None
+ *@Precondition: Samples pushed stay within IIS2MDC_CIC_INPUT_BITS
+ *@Postcondition: Decimator is reset. The first Order - 1 outputs are still settling. Ratio is lowered if Ratio^Order
+ *                would exceed IIS2MDC_CIC_MAX_GAIN (only order 3 above a ratio of 20000 or so).
+ **************************************//**************************************/
+void IIS2MDC_Decimator_Init(IIS2MDC_Decimator_t *Decimator, uint16_t Ratio, uint8_t Order, IIS2MDC_DecimatorCallback_t Callback, void *Context){
+	memset(Decimator, 0, sizeof(*Decimator));
+	if(Ratio == 0){
+		Ratio = 1;
+	}
+	if(Order == 0){
+		Order = 1;
+	} else if(Order > IIS2MDC_CIC_MAX_ORDER){
+		Order = IIS2MDC_CIC_MAX_ORDER;
+	}
+
+	while(CICGain(Ratio, Order) > IIS2MDC_CIC_MAX_GAIN){
+		Ratio--;
+	}
+
+	Decimator->Ratio = Ratio;
+	Decimator->Order = Order;
+	Decimator->Gain = (int64_t)CICGain(Ratio, Order);
+	Decimator->Callback = Callback;
+	Decimator->Context = Context;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Subscribes a decimator to the samples read from a device
+ *@Params: Device handle, initialized decimator
+ *@Return: None
+ *@Precondition: Device handle is initialized, decimator is not subscribed elsewhere
+ *@Postcondition: Every sample returned by IIS2MDC_ReadMagnetic (after the filter chain) is pushed into the decimator.
+ **************************************//**************************************/
+void IIS2MDC_Decimator_Subscribe(IIS2MDC_Handle_t *Dev, IIS2MDC_Decimator_t *Decimator){
+	struct IIS2MDC_Decimator **link = &Dev->Decimators;
+	while(*link != NULL){
+		link = &(*link)->Next;
+	}
+	Decimator->Next = NULL;
+	*link = Decimator;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Removes a decimator from a device's subscriber list
+ *@Params: Device handle, subscribed decimator
+ *@Return: None
+ *@Precondition: Not called from the context that runs IIS2MDC_ReadMagnetic
+ *@Postcondition: Decimator receives no more samples.
+ **************************************//**************************************/
+void IIS2MDC_Decimator_Unsubscribe(IIS2MDC_Handle_t *Dev, IIS2MDC_Decimator_t *Decimator){
+	struct IIS2MDC_Decimator **link = &Dev->Decimators;
+	while(*link != NULL){
+		if(*link == Decimator){
+			*link = Decimator->Next;
+			Decimator->Next = NULL;
+			return;
+		}
+		link = &(*link)->Next;
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Feeds one full rate XYZ sample to every decimator in a list
+ *@Params: First decimator of the list (NULL does nothing), sample
+ *@Return: None
+ *@Precondition: Decimators are initialized
+ *@Postcondition: Decimators that completed a block hold it in Output and have run their callback.
+ **************************************//**************************************/
+void IIS2MDC_Decimator_Push(IIS2MDC_Decimator_t *List, const int32_t Sample[3]){
+	for(IIS2MDC_Decimator_t *decimator = List; decimator != NULL; decimator = decimator->Next){
+		DecimatorStep(decimator, Sample);
+	}
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Integrators run at the input rate, combs at the output rate, both modulo 2^64. Output is normalized by the DC gain
+ *Ratio^Order.*/
+static void DecimatorStep(IIS2MDC_Decimator_t *Decimator, const int32_t Sample[3]){
+	for(uint8_t axis = 0; axis < 3; axis++){
+		uint64_t value = (uint64_t)(int64_t)Sample[axis];
+		for(uint8_t stage = 0; stage < Decimator->Order; stage++){
+			Decimator->Integrator[axis][stage] += value;
+			value = Decimator->Integrator[axis][stage];
+		}
+	}
+
+	if(++Decimator->Phase < Decimator->Ratio){
+		return;
+	}
+	Decimator->Phase = 0;
+
+	for(uint8_t axis = 0; axis < 3; axis++){
+		uint64_t difference = Decimator->Integrator[axis][Decimator->Order - 1];
+		for(uint8_t stage = 0; stage < Decimator->Order; stage++){
+			uint64_t delayed = Decimator->Comb[axis][stage];
+			Decimator->Comb[axis][stage] = difference;
+			difference -= delayed;
+		}
+		/*Two's complement back to signed without relying on the implementation defined conversion*/
+		int64_t value = (difference > (uint64_t)INT64_MAX) ? -(int64_t)(~difference) - 1 : (int64_t)difference;
+		int64_t half = (value < 0) ? -(Decimator->Gain / 2) : (Decimator->Gain / 2);
+		Decimator->Output[axis] = (int32_t)((value + half) / Decimator->Gain);
+	}
+
+	Decimator->OutputCount++;
+	if(Decimator->Callback != NULL){
+		Decimator->Callback(Decimator->Output, Decimator->Context);
+	}
+}
+
+
+static uint64_t CICGain(uint16_t Ratio, uint8_t Order){
+	uint64_t Gain = 1;
+	for(uint8_t stage = 0; stage < Order; stage++){
+		Gain *= Ratio;
+	}
+	return Gain;
+}
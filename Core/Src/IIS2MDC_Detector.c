@@ -0,0 +1,175 @@
+/*
+ * IIS2MDC_Detector.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Detector.h"
+#include <stddef.h>
+#include <string.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static uint8_t QueueEvent(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorEventType_t Type, uint32_t Timestamp, uint32_t Value);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Initializes a software field event detector
+ *@Params: Detector storage, thresholds and notification hook
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: Detector is armed with an empty event queue.
+ **************************************//**************************************/
+void IIS2MDC_Detector_Init(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorConfig_t Config){
+	memset(Detector, 0, sizeof(*Detector));
+	Detector->Config = Config;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Runs one sample through the magnitude and rate of change detectors
+ *@Params: Detector, XYZ sample in milligauss, sample time in ms (the rate is measured against it and it is stored
+ *         with any event raised)
+ *@Return: None
+ *@Precondition: Detector is initialized
+ *@Postcondition: Events raised by this sample are queued and Config.Notify has run if there were any.
+ **************************************//**************************************/
+void IIS2MDC_Detector_Process(IIS2MDC_Detector_t *Detector, const int32_t Sample[3], uint32_t Timestamp){
+	const IIS2MDC_DetectorConfig_t *cfg = &Detector->Config;
+	uint32_t magnitude = IIS2MDC_Magnitude(Sample);
+	uint8_t raised = 0;
+
+	Detector->Magnitude = magnitude;
+
+	if(cfg->HighThreshold != 0){
+		if(!Detector->HighActive && magnitude > cfg->HighThreshold){
+			Detector->HighActive = 1;
+			raised |= QueueEvent(Detector, IIS2MDC_EventAboveHigh, Timestamp, magnitude);
+		} else if(Detector->HighActive && magnitude + cfg->Hysteresis < cfg->HighThreshold){
+			Detector->HighActive = 0;
+			raised |= QueueEvent(Detector, IIS2MDC_EventHighCleared, Timestamp, magnitude);
+		}
+	}
+
+	if(cfg->LowThreshold != 0){
+		if(!Detector->LowActive && magnitude < cfg->LowThreshold){
+			Detector->LowActive = 1;
+			raised |= QueueEvent(Detector, IIS2MDC_EventBelowLow, Timestamp, magnitude);
+		} else if(Detector->LowActive && magnitude > cfg->LowThreshold + cfg->Hysteresis){
+			Detector->LowActive = 0;
+			raised |= QueueEvent(Detector, IIS2MDC_EventLowCleared, Timestamp, magnitude);
+		}
+	}
+
+	/*Two samples in the same ms carry no rate, the next one is measured against the older sample instead*/
+	uint32_t elapsed = Timestamp - Detector->PreviousTime;
+	if(!Detector->HasPrevious || elapsed != 0){
+		if(cfg->RateThreshold != 0 && Detector->HasPrevious){
+			const int32_t delta[3] = {Sample[0] - Detector->Previous[0], Sample[1] - Detector->Previous[1], Sample[2] - Detector->Previous[2]};
+			uint32_t rate = (uint32_t)(((uint64_t)IIS2MDC_Magnitude(delta) * 1000U) / elapsed);
+			Detector->Rate = rate;
+			if(!Detector->RateActive && rate > cfg->RateThreshold){
+				Detector->RateActive = 1;
+				raised |= QueueEvent(Detector, IIS2MDC_EventRateOfChange, Timestamp, rate);
+			} else if(Detector->RateActive && rate + cfg->RateHysteresis < cfg->RateThreshold){
+				Detector->RateActive = 0;
+			}
+		}
+
+		Detector->Previous[0] = Sample[0];
+		Detector->Previous[1] = Sample[1];
+		Detector->Previous[2] = Sample[2];
+		Detector->PreviousTime = Timestamp;
+		Detector->HasPrevious = 1;
+	}
+
+	if(raised && cfg->Notify != NULL){
+		cfg->Notify();
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Takes the oldest event from a detector's queue
+ *@Params: Detector, event output
+ *@Return: 1 if an event was returned, 0 if the queue is empty
+ *@Precondition: Called from the same context as IIS2MDC_Detector_Process
+ *@Postcondition: Event is removed from the queue.
+ **************************************//**************************************/
+uint8_t IIS2MDC_Detector_GetEvent(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorEvent_t *Event){
+	if(Detector->Head == Detector->Tail){
+		return 0;
+	}
+	*Event = Detector->Queue[Detector->Tail % IIS2MDC_DETECTOR_QUEUE_LENGTH];
+	Detector->Tail++;
+	return 1;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Integer square root
+ *@Params: Value
+ *@Return: floor(sqrt(value))
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+uint32_t IIS2MDC_ISqrt(uint64_t value){
+	uint64_t result = 0;
+	uint64_t bit = 1ULL << 62;
+
+	/*Start at the highest power of 4 not above value, then settle one result bit per step*/
+	while(bit > value){
+		bit >>= 2;
+	}
+	while(bit != 0){
+		if(value >= result + bit){
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)result;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Length of a 3 axis vector
+ *@Params: XYZ vector
+ *@Return: floor(|Vector|)
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+uint32_t IIS2MDC_Magnitude(const int32_t Vector[3]){
+	uint64_t sum = 0;
+	for(uint8_t axis = 0; axis < 3; axis++){
+		sum += (uint64_t)((int64_t)Vector[axis] * Vector[axis]);
+	}
+	return IIS2MDC_ISqrt(sum);
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Returns 1 if the event was queued, 0 if the queue was full*/
+static uint8_t QueueEvent(IIS2MDC_Detector_t *Detector, IIS2MDC_DetectorEventType_t Type, uint32_t Timestamp, uint32_t Value){
+	if((uint8_t)(Detector->Head - Detector->Tail) >= IIS2MDC_DETECTOR_QUEUE_LENGTH){
+		Detector->Dropped++;
+		return 0;
+	}
+	IIS2MDC_DetectorEvent_t *event = &Detector->Queue[Detector->Head % IIS2MDC_DETECTOR_QUEUE_LENGTH];
+	event->Type = Type;
+	event->Timestamp = Timestamp;
+	event->Value = Value;
+	Detector->Head++;
+	return 1;
+}
@@ -0,0 +1,319 @@
+/*
+ * IIS2MDC_Filter.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Filter.h"
+#include <stddef.h>
+#include <string.h>
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+#define HIGH_HEAP (0x80U) /*Flag in Median.Position: slot lives in the High heap*/
+#define LOW_HEAP (0x00U)
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void InitWindowed(IIS2MDC_FilterStage_t *Stage, IIS2MDC_FilterType_t Type, uint8_t Window);
+static void ApplyMovingAverage(IIS2MDC_FilterStage_t *Stage, uint8_t slot, int32_t Sample[3]);
+static void ApplyMedian(IIS2MDC_FilterStage_t *Stage, uint8_t slot, int32_t Sample[3]);
+static void ApplyBiquad(IIS2MDC_Biquad_t *Biquad, int32_t Sample[3]);
+static int32_t MedianUpdate(IIS2MDC_Median_t *Median, uint8_t slot, int32_t value, uint8_t replace);
+static void HeapSift(IIS2MDC_Median_t *Median, uint8_t side, uint8_t index);
+static void HeapPush(IIS2MDC_Median_t *Median, uint8_t side, uint8_t slot);
+static uint8_t HeapPop(IIS2MDC_Median_t *Median, uint8_t side);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Initializes a running sum moving average stage. O(1) per sample.
+ *@Params: Stage storage, window length (1 to IIS2MDC_FILTER_MAX_WINDOW)
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: Stage is reset and may be appended to a chain. Output averages the samples seen so far until the window fills.
+ **************************************//**************************************/
+void IIS2MDC_Filter_InitMovingAverage(IIS2MDC_FilterStage_t *Stage, uint8_t Window){
+	InitWindowed(Stage, IIS2MDC_FilterMovingAverage, Window);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Initializes a sliding median stage. O(log n) per sample.
+ *@Params: Stage storage, window length (1 to IIS2MDC_FILTER_MAX_WINDOW)
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: Stage is reset and may be appended to a chain. Even counts output the mean of the two middle samples.
+ **************************************//**************************************/
+void IIS2MDC_Filter_InitMedian(IIS2MDC_FilterStage_t *Stage, uint8_t Window){
+	InitWindowed(Stage, IIS2MDC_FilterMedian, Window);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Initializes a fixed point biquad IIR stage. O(1) per sample.
+ *@Params: Stage storage, coefficients (copied)
+ *@Return: None
+ *@Precondition: Coefficients describe a stable filter
+ *@Postcondition: Stage is reset and may be appended to a chain.
+ **************************************//**************************************/
+void IIS2MDC_Filter_InitBiquad(IIS2MDC_FilterStage_t *Stage, const IIS2MDC_BiquadCoeffs_t *Coeffs){
+	Stage->Type = IIS2MDC_FilterBiquad;
+	Stage->Window = 1;
+	Stage->Next = NULL;
+	Stage->State.Biquad.Coeffs = *Coeffs;
+	IIS2MDC_Filter_Reset(Stage);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Appends a stage to the end of a chain
+ *@Params: Existing chain (may be NULL), initialized stage
+ *@Return: Head of the chain
+ *@Precondition: Stage is not already part of a chain
+ *@Postcondition: Stage runs after every stage already in Chain.
+ **************************************//**************************************/
+IIS2MDC_FilterStage_t *IIS2MDC_Filter_Append(IIS2MDC_FilterStage_t *Chain, IIS2MDC_FilterStage_t *Stage){
+	Stage->Next = NULL;
+	if(Chain == NULL){
+		return Stage;
+	}
+
+	IIS2MDC_FilterStage_t *last = Chain;
+	while(last->Next != NULL){
+		last = last->Next;
+	}
+	last->Next = Stage;
+	return Chain;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Clears the history of every stage in a chain, keeping their configuration
+ *@Params: Chain
+ *@Return: None
+ *@Precondition: Stages are initialized
+ *@Postcondition: Next sample starts every stage from scratch.
+ **************************************//**************************************/
+void IIS2MDC_Filter_Reset(IIS2MDC_FilterStage_t *Chain){
+	for(IIS2MDC_FilterStage_t *stage = Chain; stage != NULL; stage = stage->Next){
+		stage->Count = 0;
+		stage->Oldest = 0;
+		if(stage->Type == IIS2MDC_FilterBiquad){
+			IIS2MDC_BiquadCoeffs_t coeffs = stage->State.Biquad.Coeffs;
+			memset(&stage->State.Biquad, 0, sizeof(stage->State.Biquad));
+			stage->State.Biquad.Coeffs = coeffs;
+		} else if(stage->Type == IIS2MDC_FilterMedian){
+			for(uint8_t axis = 0; axis < 3; axis++){
+				stage->State.Median[axis].LowCount = 0;
+				stage->State.Median[axis].HighCount = 0;
+			}
+		} else {
+			memset(stage->State.MovingAverage.Sum, 0, sizeof(stage->State.MovingAverage.Sum));
+		}
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Runs one XYZ sample through every stage of a chain
+ *@Params: Chain (NULL passes the sample through), sample to filter in place
+ *@Return: None
+ *@Precondition: Stages are initialized
+ *@Postcondition: Sample holds the chain output.
+ **************************************//**************************************/
+void IIS2MDC_Filter_Apply(IIS2MDC_FilterStage_t *Chain, int32_t Sample[3]){
+	for(IIS2MDC_FilterStage_t *stage = Chain; stage != NULL; stage = stage->Next){
+		uint8_t slot = (stage->Count < stage->Window) ? stage->Count : stage->Oldest;
+
+		switch(stage->Type){
+		case IIS2MDC_FilterMovingAverage:
+			ApplyMovingAverage(stage, slot, Sample);
+			break;
+		case IIS2MDC_FilterMedian:
+			ApplyMedian(stage, slot, Sample);
+			break;
+		case IIS2MDC_FilterBiquad:
+			ApplyBiquad(&stage->State.Biquad, Sample);
+			break;
+		default:
+			break;
+		}
+
+		if(stage->Count < stage->Window){
+			stage->Count++;
+		} else {
+			stage->Oldest = (stage->Oldest + 1 == stage->Window) ? 0 : stage->Oldest + 1;
+		}
+	}
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Common setup for stages with a sample window*/
+static void InitWindowed(IIS2MDC_FilterStage_t *Stage, IIS2MDC_FilterType_t Type, uint8_t Window){
+	if(Window == 0){
+		Window = 1;
+	} else if(Window > IIS2MDC_FILTER_MAX_WINDOW){
+		Window = IIS2MDC_FILTER_MAX_WINDOW;
+	}
+	Stage->Type = Type;
+	Stage->Window = Window;
+	Stage->Next = NULL;
+	IIS2MDC_Filter_Reset(Stage);
+}
+
+/*Running sum: add the new sample, drop the one leaving the window*/
+static void ApplyMovingAverage(IIS2MDC_FilterStage_t *Stage, uint8_t slot, int32_t Sample[3]){
+	IIS2MDC_MovingAverage_t *avg = &Stage->State.MovingAverage;
+	int32_t count = (Stage->Count < Stage->Window) ? Stage->Count + 1 : Stage->Window;
+
+	for(uint8_t axis = 0; axis < 3; axis++){
+		if(Stage->Count == Stage->Window){
+			avg->Sum[axis] -= avg->History[axis][slot];
+		}
+		avg->History[axis][slot] = Sample[axis];
+		avg->Sum[axis] += Sample[axis];
+
+		int32_t half = (avg->Sum[axis] < 0) ? -(count / 2) : (count / 2);
+		Sample[axis] = (avg->Sum[axis] + half) / count;
+	}
+}
+
+static void ApplyMedian(IIS2MDC_FilterStage_t *Stage, uint8_t slot, int32_t Sample[3]){
+	for(uint8_t axis = 0; axis < 3; axis++){
+		Sample[axis] = MedianUpdate(&Stage->State.Median[axis], slot, Sample[axis], Stage->Count == Stage->Window);
+	}
+}
+
+/*Direct form I. The bits shifted out of each output are fed back into the next one (error feedback), which removes the
+ *dead band a truncating fixed point IIR shows at low cutoff frequencies.*/
+static void ApplyBiquad(IIS2MDC_Biquad_t *Biquad, int32_t Sample[3]){
+	const IIS2MDC_BiquadCoeffs_t *c = &Biquad->Coeffs;
+
+	for(uint8_t axis = 0; axis < 3; axis++){
+		int32_t x = Sample[axis];
+		int64_t acc = Biquad->Residual[axis];
+		acc += (int64_t)c->B0 * x;
+		acc += (int64_t)c->B1 * Biquad->X1[axis];
+		acc += (int64_t)c->B2 * Biquad->X2[axis];
+		acc -= (int64_t)c->A1 * Biquad->Y1[axis];
+		acc -= (int64_t)c->A2 * Biquad->Y2[axis];
+
+		int32_t y = (int32_t)(acc >> IIS2MDC_BIQUAD_FRAC_BITS);
+		Biquad->Residual[axis] = acc - ((int64_t)y << IIS2MDC_BIQUAD_FRAC_BITS);
+		Biquad->X2[axis] = Biquad->X1[axis];
+		Biquad->X1[axis] = x;
+		Biquad->Y2[axis] = Biquad->Y1[axis];
+		Biquad->Y1[axis] = y;
+		Sample[axis] = y;
+	}
+}
+
+/*Inserts (window filling) or replaces (window full) the sample in slot and returns the median of the window*/
+static int32_t MedianUpdate(IIS2MDC_Median_t *Median, uint8_t slot, int32_t value, uint8_t replace){
+	Median->Value[slot] = value;
+
+	if(replace){
+		uint8_t position = Median->Position[slot];
+		HeapSift(Median, position & HIGH_HEAP, position & ~HIGH_HEAP);
+
+		/*Only the replaced sample can be out of place, one exchange of the tops restores Low <= High*/
+		if(Median->HighCount > 0 && Median->Value[Median->Low[0]] > Median->Value[Median->High[0]]){
+			uint8_t low_top = Median->Low[0];
+			Median->Low[0] = Median->High[0];
+			Median->High[0] = low_top;
+			HeapSift(Median, LOW_HEAP, 0);
+			HeapSift(Median, HIGH_HEAP, 0);
+		}
+	} else {
+		if(Median->LowCount == 0 || value <= Median->Value[Median->Low[0]]){
+			HeapPush(Median, LOW_HEAP, slot);
+		} else {
+			HeapPush(Median, HIGH_HEAP, slot);
+		}
+
+		if(Median->LowCount > Median->HighCount + 1){
+			HeapPush(Median, HIGH_HEAP, HeapPop(Median, LOW_HEAP));
+		} else if(Median->HighCount > Median->LowCount){
+			HeapPush(Median, LOW_HEAP, HeapPop(Median, HIGH_HEAP));
+		}
+	}
+
+	if(Median->LowCount > Median->HighCount){
+		return Median->Value[Median->Low[0]];
+	}
+	return (Median->Value[Median->Low[0]] + Median->Value[Median->High[0]]) / 2;
+}
+
+/*Moves the element at index up or down until its heap is ordered again. Low is a max-heap, High a min-heap.*/
+static void HeapSift(IIS2MDC_Median_t *Median, uint8_t side, uint8_t index){
+	uint8_t *heap = (side == HIGH_HEAP) ? Median->High : Median->Low;
+	uint8_t count = (side == HIGH_HEAP) ? Median->HighCount : Median->LowCount;
+	int32_t sign = (side == HIGH_HEAP) ? -1 : 1;
+	uint8_t slot = heap[index];
+	int32_t key = sign * Median->Value[slot];
+
+	while(index > 0){
+		uint8_t parent = (index - 1) / 2;
+		if(key <= sign * Median->Value[heap[parent]]){
+			break;
+		}
+		heap[index] = heap[parent];
+		Median->Position[heap[index]] = index | side;
+		index = parent;
+	}
+
+	for(;;){
+		uint8_t child = 2 * index + 1;
+		if(child >= count){
+			break;
+		}
+		if(child + 1 < count && sign * Median->Value[heap[child + 1]] > sign * Median->Value[heap[child]]){
+			child++;
+		}
+		if(sign * Median->Value[heap[child]] <= key){
+			break;
+		}
+		heap[index] = heap[child];
+		Median->Position[heap[index]] = index | side;
+		index = child;
+	}
+
+	heap[index] = slot;
+	Median->Position[slot] = index | side;
+}
+
+static void HeapPush(IIS2MDC_Median_t *Median, uint8_t side, uint8_t slot){
+	uint8_t index;
+	if(side == HIGH_HEAP){
+		index = Median->HighCount++;
+		Median->High[index] = slot;
+	} else {
+		index = Median->LowCount++;
+		Median->Low[index] = slot;
+	}
+	HeapSift(Median, side, index);
+}
+
+static uint8_t HeapPop(IIS2MDC_Median_t *Median, uint8_t side){
+	uint8_t *heap = (side == HIGH_HEAP) ? Median->High : Median->Low;
+	uint8_t *count = (side == HIGH_HEAP) ? &Median->HighCount : &Median->LowCount;
+	uint8_t top = heap[0];
+
+	(*count)--;
+	if(*count > 0){
+		heap[0] = heap[*count];
+		HeapSift(Median, side, 0);
+	}
+	return top;
+}
@@ -12,13 +12,15 @@
 #include "stm32u5xx_hal.h"
 #include "gpio.h"
 #include "i2c.h"
+#include "lowpower.h"
+#include "usart.h"
 #include "log.h"
 
 /**************************************//**************************************//**************************************
  * Defines / Constants
  **************************************//**************************************//**************************************/
 static const uint8_t IIS2MDC_DEVICE_ADDRESS = 0x3CU;
-static const uint16_t IIS2MDC_TIMEOUT_MS = 500;
+static const uint8_t IIS2MDC_BUS_PRIORITY = 1; //Sampling path, ahead of background traffic
 
 /**************************************//**************************************//**************************************
  * Private Function Prototypes
@@ -27,17 +29,38 @@ static void IIS2MDC_Init();
 static void IIS2MDC_DeInit();
 static IIS2MDC_Status_t IIS2MDC_WriteReg(uint8_t reg, uint8_t *pdata, uint8_t length);
 static IIS2MDC_Status_t IIS2MDC_ReadReg(uint8_t reg, uint8_t *pdata, uint8_t length);
+static IIS2MDC_Status_t IIS2MDC_ReadRegAsync(uint8_t reg, uint8_t *pdata, uint8_t length, IIS2MDC_ReadDone_t Done, void *Context);
+static void IIS2MDC_ReadAsyncComplete(I2C_Transaction_t *transaction);
 static uint8_t IIS2MDC_ioctl(IIS2MDC_Cmd_t command);
+static void IIS2MDC_EnterCritical(void);
+static void IIS2MDC_ExitCritical(void);
+static IIS2MDC_Status_t IIS2MDC_I2CStatus(I2C_Result_t result);
+static uint8_t IIS2MDC_BootTimeLeft(void);
+static const volatile uint8_t* IIS2MDC_AutonomousStart(uint8_t Reg, uint8_t Length, uint8_t Slots, uint8_t WakeEvery, uint8_t PrescalerLog2, uint16_t PeriodTicks);
+static void IIS2MDC_AutonomousStop(void);
+
+/**************************************//**************************************//**************************************
+ * Private Variables
+ **************************************//**************************************//**************************************/
+static uint32_t BootStart; //HAL tick when the IO was brought up
+static I2C_Transaction_t AsyncRead; //One non blocking read in flight at a time
+static IIS2MDC_ReadDone_t AsyncDone;
+
+/*Read by GPDMA1 while the core is in Stop 1. SRAM4 keeps the list out of the main RAM the CPU is using.*/
+static LPBAM_Table_t AutonomousTable __attribute__((section(".sram4"), aligned(4)));
+static volatile uint8_t AutonomousRing[IIS2MDC_AUTONOMOUS_MAX_SLOTS * IIS2MDC_AUTONOMOUS_SLOT_SIZE] __attribute__((section(".sram4"), aligned(4)));
 
 /**************************************//**************************************//**************************************
  * Private Function Definitions
  **************************************//**************************************//**************************************/
 
-/*Initializes low level IO*/
+/*Initializes low level IO. Only records when the sensor's boot started, the wait is left to the IIS2MDC_BootWait ioctl.*/
 static void IIS2MDC_Init(){
-	HAL_Delay(20); //Device takes 20 ms to boot.
+	BootStart = HAL_GetTick();
 	IIS2MDC_GPIO_Init();
-	MX_I2C2_Init();
+	if(hi2c2.State == HAL_I2C_STATE_RESET){ //Shared bus: another driver may already have it running at its chosen speed
+		MX_I2C2_Init();
+	}
 }
 
 /*DeInitializes low level IO.*/
@@ -46,24 +69,68 @@ static void IIS2MDC_DeInit(){
 	HAL_GPIO_DeInit(IIS2MDC_IRQ_GPIO_Port, IIS2MDC_IRQ_Pin);
 }
 
-/*Sends data to register over I2C2 Bus*/
+/*Sends data to register over I2C2 Bus. The deadline scales with the transfer: address, register and data bytes.*/
 static IIS2MDC_Status_t IIS2MDC_WriteReg(uint8_t reg, uint8_t *pdata, uint8_t length){
-	if(HAL_I2C_Mem_Write(&hi2c2, IIS2MDC_DEVICE_ADDRESS, reg, I2C_MEMADD_SIZE_8BIT, pdata , length, IIS2MDC_TIMEOUT_MS) != HAL_OK){
-		_log(log_i2c,"Write to IIS2MDC Reg address %x failed.",reg);
-		return IIS2MDC_Error;
+	I2C_Transaction_t transaction = {
+			.address = IIS2MDC_DEVICE_ADDRESS,
+			.reg = reg,
+			.data = pdata,
+			.length = length,
+			.read = 0,
+			.priority = IIS2MDC_BUS_PRIORITY
+	};
+	I2C_Result_t result = i2c_arbiter_transfer(&i2c2_bus, &transaction, i2c2_timeout_us(length + 2));
+	if(result != i2c_ok){
+		_log(log_i2c,"Write to IIS2MDC Reg address %x failed (%d).",reg, result);
+		return IIS2MDC_I2CStatus(result);
 	}
 	return IIS2MDC_Ok;
 }
 
-/*Reads data from register over I2C2 Bus*/
+/*Reads data from register over I2C2 Bus. Two address bytes, the register and the data are on the wire.*/
 static IIS2MDC_Status_t IIS2MDC_ReadReg(uint8_t reg, uint8_t *pdata, uint8_t length){
-	if(HAL_I2C_Mem_Read(&hi2c2, IIS2MDC_DEVICE_ADDRESS | 0x01, reg, I2C_MEMADD_SIZE_8BIT, pdata , length, IIS2MDC_TIMEOUT_MS) != HAL_OK){
-		_log(log_i2c,"Read from IIS2MDC Reg address %x failed.",reg);
+	I2C_Transaction_t transaction = {
+			.address = IIS2MDC_DEVICE_ADDRESS,
+			.reg = reg,
+			.data = pdata,
+			.length = length,
+			.read = 1,
+			.priority = IIS2MDC_BUS_PRIORITY
+	};
+	I2C_Result_t result = i2c_arbiter_transfer(&i2c2_bus, &transaction, i2c2_timeout_us(length + 3));
+	if(result != i2c_ok){
+		_log(log_i2c,"Read from IIS2MDC Reg address %x failed (%d).",reg, result);
+		return IIS2MDC_I2CStatus(result);
+	}
+	return IIS2MDC_Ok;
+}
+
+/*Queues a read on the arbiter and returns at once. The data lands in pdata by DMA, Done runs from the completing ISR.*/
+static IIS2MDC_Status_t IIS2MDC_ReadRegAsync(uint8_t reg, uint8_t *pdata, uint8_t length, IIS2MDC_ReadDone_t Done, void *Context){
+	if(AsyncRead.state == i2c_transaction_queued || AsyncRead.state == i2c_transaction_active){
 		return IIS2MDC_Error;
 	}
+	AsyncRead = (I2C_Transaction_t){
+			.address = IIS2MDC_DEVICE_ADDRESS,
+			.reg = reg,
+			.data = pdata,
+			.length = length,
+			.read = 1,
+			.priority = IIS2MDC_BUS_PRIORITY,
+			.timeout_ticks = (uint32_t)(((uint64_t)i2c2_timeout_us(length + 3) * i2c2_bus.drv.timestamp_hz) / 1000000U) + 1U,
+			.done = IIS2MDC_ReadAsyncComplete,
+			.context = Context
+	};
+	AsyncDone = Done;
+	i2c_arbiter_submit(&i2c2_bus, &AsyncRead);
 	return IIS2MDC_Ok;
 }
 
+/*Runs in interrupt context, so failures are left to the caller to count rather than logged here*/
+static void IIS2MDC_ReadAsyncComplete(I2C_Transaction_t *transaction){
+	AsyncDone(transaction->context, IIS2MDC_I2CStatus(transaction->result));
+}
+
 /*Performs any other needed functions for the driver.*/
 static uint8_t IIS2MDC_ioctl(IIS2MDC_Cmd_t command){
 	uint8_t PinStatus;
@@ -86,6 +153,25 @@ static uint8_t IIS2MDC_ioctl(IIS2MDC_Cmd_t command){
 		} else {
 			return 0;
 		}
+
+	case IIS2MDC_BusClear:
+		return (i2c2_bus_clear() == 0) ? IIS2MDC_Ok : IIS2MDC_Error;
+
+	case IIS2MDC_BusReinit:
+		i2c2_reinit();
+		return IIS2MDC_Ok;
+
+	case IIS2MDC_InterfaceBits:
+		return 0; //I2C stays enabled
+
+	case IIS2MDC_BootRemaining:
+		return IIS2MDC_BootTimeLeft();
+
+	case IIS2MDC_BootWait:
+		while(IIS2MDC_BootTimeLeft() != 0){
+		}
+		return IIS2MDC_Ok;
+
 	default:
 		break;
 
@@ -93,6 +179,60 @@ static uint8_t IIS2MDC_ioctl(IIS2MDC_Cmd_t command){
 	return 0;
 }
 
+/*Masks interrupts around the sleep decision, a pending IRQ still wakes the core from WFI*/
+static void IIS2MDC_EnterCritical(void){
+	__disable_irq();
+}
+
+static void IIS2MDC_ExitCritical(void){
+	__enable_irq();
+}
+
+/*A tick can be nearly over when BootStart is sampled, so one extra tick guarantees the full boot time has passed.*/
+static uint8_t IIS2MDC_BootTimeLeft(void){
+	uint32_t elapsed = HAL_GetTick() - BootStart;
+	return (elapsed > IIS2MDC_BOOT_MS) ? 0 : (uint8_t)(IIS2MDC_BOOT_MS + 1 - elapsed);
+}
+
+/*Reads are triggered by LPTIM1 channel 1, which the periodic timer mode pulses once per period*/
+static const volatile uint8_t* IIS2MDC_AutonomousStart(uint8_t Reg, uint8_t Length, uint8_t Slots, uint8_t WakeEvery, uint8_t PrescalerLog2, uint16_t PeriodTicks){
+	LPBAM_I2C_Read_t cfg = {
+			.trigger = GPDMA1_TRIGGER_LPTIM1_CH1,
+			.device_address = IIS2MDC_DEVICE_ADDRESS,
+			.reg = Reg,
+			.length = Length,
+			.slots = Slots,
+			.slot_size = IIS2MDC_AUTONOMOUS_SLOT_SIZE,
+			.wake_every = WakeEvery,
+			.ring_address = (uint32_t)AutonomousRing
+	};
+	if(Slots > IIS2MDC_AUTONOMOUS_MAX_SLOTS || i2c2_autonomous_start(&cfg, &AutonomousTable) != 0){
+		return NULL;
+	}
+	lowpower_timer_start_periodic(PrescalerLog2, PeriodTicks);
+	return AutonomousRing;
+}
+
+static void IIS2MDC_AutonomousStop(void){
+	lowpower_timer_stop();
+	i2c2_autonomous_stop();
+}
+
+static IIS2MDC_Status_t IIS2MDC_I2CStatus(I2C_Result_t result){
+	switch(result){
+	case i2c_ok:
+		return IIS2MDC_Ok;
+	case i2c_nack:
+		return IIS2MDC_ErrorNack;
+	case i2c_arbitration_lost:
+		return IIS2MDC_ErrorArbitrationLost;
+	case i2c_timeout:
+		return IIS2MDC_ErrorTimeout;
+	default:
+		return IIS2MDC_Error;
+	}
+}
+
 
 /**************************************//**************************************//**************************************
  * Public Variable Defitinion
@@ -102,7 +242,31 @@ IIS2MDC_IO_Drv_t IIS2MDC_Hardware_Drv = {
 		.DeInit = IIS2MDC_DeInit,
 		.WriteReg = IIS2MDC_WriteReg,
 		.ReadReg = IIS2MDC_ReadReg,
-		.ioctl = IIS2MDC_ioctl
+		.ioctl = IIS2MDC_ioctl,
+		.ReadRegAsync = IIS2MDC_ReadRegAsync
 };
 
+IIS2MDC_LowPower_Drv_t IIS2MDC_LowPower_Hardware_Drv = {
+		.Init = lowpower_timer_init,
+		.StartTimer = lowpower_timer_start,
+		.StopTimer = lowpower_timer_stop,
+		.ReadTimer = lowpower_timer_read,
+		.Sleep = lowpower_enter_stop2,
+		.EnterCritical = IIS2MDC_EnterCritical,
+		.ExitCritical = IIS2MDC_ExitCritical,
+		.TimerClockHz = LOWPOWER_TIMER_CLOCK_HZ
+};
 
+IIS2MDC_Autonomous_Drv_t IIS2MDC_Autonomous_Hardware_Drv = {
+		.Init = lowpower_timer_init,
+		.Start = IIS2MDC_AutonomousStart,
+		.Stop = IIS2MDC_AutonomousStop,
+		.Sleep = lowpower_enter_stop1,
+		.EnterCritical = IIS2MDC_EnterCritical,
+		.ExitCritical = IIS2MDC_ExitCritical,
+		.TimerClockHz = LOWPOWER_TIMER_CLOCK_HZ
+};
+
+IIS2MDC_Telemetry_Drv_t IIS2MDC_Telemetry_Hardware_Drv = {
+		.Write = usart1_write
+};
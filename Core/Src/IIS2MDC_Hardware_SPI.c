@@ -0,0 +1,280 @@
+/*
+ * IIS2MDC_Hardware_SPI.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Hardware.h"
+#include "stm32u5xx_hal.h"
+
+/*Built when HAL SPI is enabled (spi.c provides hspi2 and MX_SPI2_Init, USE_HAL_SPI_REGISTER_CALLBACKS must be 1).
+ *Pass IIS2MDC_Hardware_SPI_Drv to IIS2MDC_Init in place of IIS2MDC_Hardware_Drv for a sensor wired to SPI.*/
+#ifdef HAL_SPI_MODULE_ENABLED
+#include "IIS2MDC.h"
+#include "spi.h"
+#include "gpio.h"
+#include "log.h"
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+#define IIS2MDC_SPI_HANDLE hspi2
+#define IIS2MDC_SPI_INIT MX_SPI2_Init
+#define IIS2MDC_SPI_3WIRE 1          /*1: SDI/SDO shared (SPI Direction 1 line), 0: 4-wire with separate SDO*/
+
+#if !defined(IIS2MDC_SPI_CS_Pin) || !defined(IIS2MDC_SPI_CS_GPIO_Port)
+#error "Label the sensor chip select pin IIS2MDC_SPI_CS in CubeMX"
+#endif
+#if !USE_HAL_SPI_REGISTER_CALLBACKS
+#error "Enable register callbacks for SPI in CubeMX (Project Manager > Advanced Settings)"
+#endif
+
+#define IIS2MDC_CFG_C_BDU (1U << 4)
+#define IIS2MDC_CFG_C_I2C_DIS (1U << 5)
+#define IIS2MDC_CFG_C_4WSPI (1U << 2)
+#define IIS2MDC_SPI_READ (0x80U) /*First byte is R/W then the 7 bit address. The device auto-increments on longer frames.*/
+
+#if IIS2MDC_SPI_3WIRE
+static const uint8_t IIS2MDC_SPI_CFG_C_BITS = IIS2MDC_CFG_C_I2C_DIS;
+#else
+static const uint8_t IIS2MDC_SPI_CFG_C_BITS = IIS2MDC_CFG_C_I2C_DIS | IIS2MDC_CFG_C_4WSPI;
+#endif
+static const uint32_t IIS2MDC_SPI_TIMEOUT_MS = 2;
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void IIS2MDC_SPI_Init();
+static void IIS2MDC_SPI_DeInit();
+static IIS2MDC_Status_t IIS2MDC_SPI_WriteReg(uint8_t reg, uint8_t *pdata, uint8_t length);
+static IIS2MDC_Status_t IIS2MDC_SPI_ReadReg(uint8_t reg, uint8_t *pdata, uint8_t length);
+static IIS2MDC_Status_t IIS2MDC_SPI_ReadRegAsync(uint8_t reg, uint8_t *pdata, uint8_t length, IIS2MDC_ReadDone_t Done, void *Context);
+static uint8_t IIS2MDC_SPI_ioctl(IIS2MDC_Cmd_t command);
+static void IIS2MDC_SPI_Start(void);
+static uint8_t IIS2MDC_SPI_Claim(void);
+static IIS2MDC_Status_t IIS2MDC_SPI_Acquire(void);
+static void IIS2MDC_SPI_Release(void);
+static void IIS2MDC_SPI_RxDone(SPI_HandleTypeDef *hspi);
+static void IIS2MDC_SPI_RxError(SPI_HandleTypeDef *hspi);
+static IIS2MDC_Status_t IIS2MDC_SPI_SelectInterface(void);
+static uint8_t IIS2MDC_SPI_BootTimeLeft(void);
+
+/**************************************//**************************************//**************************************
+ * Private Variables
+ **************************************//**************************************//**************************************/
+static volatile uint8_t BusBusy; //A frame is in progress, CS is low
+static IIS2MDC_ReadDone_t AsyncDone; //One non blocking read in flight at a time
+static void *AsyncContext;
+static uint32_t BootStart; //HAL tick when the IO was brought up
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Initializes low level IO. The sensor's I2C block is turned off by the IIS2MDC_BootWait ioctl once it has booted.*/
+static void IIS2MDC_SPI_Init(){
+	BootStart = HAL_GetTick();
+	IIS2MDC_SPI_GPIO_Init();
+	IIS2MDC_GPIO_Init();
+	IIS2MDC_SPI_Start();
+}
+
+/*DeInitializes low level IO.*/
+static void IIS2MDC_SPI_DeInit(){
+	//Do Not De-Init SPI Peripheral as other devices may be using it.
+	HAL_GPIO_DeInit(IIS2MDC_IRQ_GPIO_Port, IIS2MDC_IRQ_Pin);
+}
+
+/*Write frame: address byte with R/W clear, then the data. Writes work the same in 3 and 4 wire mode.*/
+static IIS2MDC_Status_t IIS2MDC_SPI_WriteReg(uint8_t reg, uint8_t *pdata, uint8_t length){
+	uint8_t header = reg & ~IIS2MDC_SPI_READ;
+	IIS2MDC_Status_t status = IIS2MDC_SPI_Acquire();
+	if(status != IIS2MDC_Ok){
+		_log(log_iis2mdc,"SPI: Write to Reg address %x found the bus busy.",reg);
+		return status;
+	}
+
+	HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_RESET);
+	if(HAL_SPI_Transmit(&IIS2MDC_SPI_HANDLE, &header, 1, IIS2MDC_SPI_TIMEOUT_MS) != HAL_OK ||
+			HAL_SPI_Transmit(&IIS2MDC_SPI_HANDLE, pdata, length, IIS2MDC_SPI_TIMEOUT_MS) != HAL_OK){
+		status = IIS2MDC_ErrorTimeout;
+	}
+	IIS2MDC_SPI_Release();
+
+	if(status != IIS2MDC_Ok){
+		_log(log_iis2mdc,"SPI: Write to Reg address %x failed.",reg);
+	}
+	return status;
+}
+
+/*Read frame: address byte with R/W set, then length bytes from consecutive registers. In 3-wire mode the HAL turns the
+ *data line around between the two phases. Blocking reads are at most a few bytes, polling them beats setting up DMA.*/
+static IIS2MDC_Status_t IIS2MDC_SPI_ReadReg(uint8_t reg, uint8_t *pdata, uint8_t length){
+	uint8_t header = reg | IIS2MDC_SPI_READ;
+	IIS2MDC_Status_t status = IIS2MDC_SPI_Acquire();
+	if(status != IIS2MDC_Ok){
+		_log(log_iis2mdc,"SPI: Read from Reg address %x found the bus busy.",reg);
+		return status;
+	}
+
+	HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_RESET);
+	if(HAL_SPI_Transmit(&IIS2MDC_SPI_HANDLE, &header, 1, IIS2MDC_SPI_TIMEOUT_MS) != HAL_OK ||
+			HAL_SPI_Receive(&IIS2MDC_SPI_HANDLE, pdata, length, IIS2MDC_SPI_TIMEOUT_MS) != HAL_OK){
+		status = IIS2MDC_ErrorTimeout;
+	}
+	IIS2MDC_SPI_Release();
+
+	if(status != IIS2MDC_Ok){
+		_log(log_iis2mdc,"SPI: Read from Reg address %x failed.",reg);
+	}
+	return status;
+}
+
+/*Sends the address byte and leaves the data phase to DMA, then returns. CS stays low until the SPI callbacks end the
+ *frame and run Done from the interrupt. Returns an error without starting if another frame holds the bus.*/
+static IIS2MDC_Status_t IIS2MDC_SPI_ReadRegAsync(uint8_t reg, uint8_t *pdata, uint8_t length, IIS2MDC_ReadDone_t Done, void *Context){
+	uint8_t header = reg | IIS2MDC_SPI_READ;
+	if(!IIS2MDC_SPI_Claim()){
+		return IIS2MDC_Error;
+	}
+	AsyncDone = Done;
+	AsyncContext = Context;
+
+	HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_RESET);
+	if(HAL_SPI_Transmit(&IIS2MDC_SPI_HANDLE, &header, 1, IIS2MDC_SPI_TIMEOUT_MS) != HAL_OK ||
+			HAL_SPI_Receive_DMA(&IIS2MDC_SPI_HANDLE, pdata, length) != HAL_OK){
+		IIS2MDC_SPI_Release();
+		return IIS2MDC_ErrorTimeout;
+	}
+	return IIS2MDC_Ok;
+}
+
+/*Performs any other needed functions for the driver.*/
+static uint8_t IIS2MDC_SPI_ioctl(IIS2MDC_Cmd_t command){
+	switch(command){
+
+	case IIS2MDC_IRQEnable:
+		NVIC_EnableIRQ(IIS2MDC_IRQ_EXTI_IRQn);
+		return IIS2MDC_Ok;
+
+	case IIS2MDC_IRQDisable:
+		NVIC_DisableIRQ(IIS2MDC_IRQ_EXTI_IRQn);
+		return IIS2MDC_Ok;
+
+	case IIS2MDC_ReadIntPin:
+		return (HAL_GPIO_ReadPin(IIS2MDC_IRQ_GPIO_Port, IIS2MDC_IRQ_Pin) == GPIO_PIN_SET) ? 1 : 0;
+
+	case IIS2MDC_BusClear:
+		//SPI can't hang a slave mid frame: raising CS resets its frame decoder
+		HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_SET);
+		return IIS2MDC_Ok;
+
+	case IIS2MDC_BusReinit:
+		HAL_SPI_Abort(&IIS2MDC_SPI_HANDLE);
+		HAL_SPI_DeInit(&IIS2MDC_SPI_HANDLE);
+		HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_SET);
+		BusBusy = 0; //An aborted DMA read never completes
+		IIS2MDC_SPI_Start();
+		return IIS2MDC_SPI_SelectInterface();
+
+	case IIS2MDC_InterfaceBits:
+		return IIS2MDC_SPI_CFG_C_BITS;
+
+	case IIS2MDC_BootRemaining:
+		return IIS2MDC_SPI_BootTimeLeft();
+
+	case IIS2MDC_BootWait:
+		while(IIS2MDC_SPI_BootTimeLeft() != 0){
+		}
+		//SPI traffic must not be mistaken for an I2C start before the first register access
+		if(IIS2MDC_SPI_SelectInterface() != IIS2MDC_Ok){
+			_log(log_iis2mdc, "SPI: Selecting interface failed.");
+			return IIS2MDC_Error;
+		}
+		return IIS2MDC_Ok;
+
+	default:
+		break;
+	}
+	return 0;
+}
+
+/*Initializes the peripheral unless another driver already has it running, then hooks this driver's completion callbacks
+ *to the handle. HAL_SPI_Init resets registered callbacks to the weak defaults, so they are registered after every init.*/
+static void IIS2MDC_SPI_Start(void){
+	if(IIS2MDC_SPI_HANDLE.State == HAL_SPI_STATE_RESET){
+		IIS2MDC_SPI_INIT();
+	}
+	HAL_SPI_RegisterCallback(&IIS2MDC_SPI_HANDLE, HAL_SPI_RX_COMPLETE_CB_ID, IIS2MDC_SPI_RxDone);
+	HAL_SPI_RegisterCallback(&IIS2MDC_SPI_HANDLE, HAL_SPI_ERROR_CB_ID, IIS2MDC_SPI_RxError);
+}
+
+/*Takes the bus if it is free. Thread and interrupt callers race for it, so the check and the claim are one critical section.*/
+static uint8_t IIS2MDC_SPI_Claim(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t claimed = !BusBusy;
+	if(claimed){
+		BusBusy = 1;
+	}
+	__set_PRIMASK(primask);
+	return claimed;
+}
+
+/*Blocking callers wait out a DMA read in flight, which takes microseconds.*/
+static IIS2MDC_Status_t IIS2MDC_SPI_Acquire(void){
+	uint32_t start = HAL_GetTick();
+	while(!IIS2MDC_SPI_Claim()){
+		if((HAL_GetTick() - start) > IIS2MDC_SPI_TIMEOUT_MS){
+			return IIS2MDC_ErrorTimeout;
+		}
+	}
+	return IIS2MDC_Ok;
+}
+
+static void IIS2MDC_SPI_Release(void){
+	HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_SET);
+	BusBusy = 0;
+}
+
+/*End of a DMA read, from the SPI interrupt. The bus is released before Done so Done may start the next read.*/
+static void IIS2MDC_SPI_RxDone(SPI_HandleTypeDef *hspi){
+	(void)hspi;
+	IIS2MDC_SPI_Release();
+	AsyncDone(AsyncContext, IIS2MDC_Ok);
+}
+
+static void IIS2MDC_SPI_RxError(SPI_HandleTypeDef *hspi){
+	(void)hspi;
+	IIS2MDC_SPI_Release();
+	AsyncDone(AsyncContext, IIS2MDC_Error);
+}
+
+/*Disables I2C (and selects 4-wire SDO if configured). A write frame is understood in either SPI mode.*/
+static IIS2MDC_Status_t IIS2MDC_SPI_SelectInterface(void){
+	uint8_t cfg_c = IIS2MDC_SPI_CFG_C_BITS | IIS2MDC_CFG_C_BDU;
+	return IIS2MDC_SPI_WriteReg(IIS2MDC_REG_CFG_REG_C, &cfg_c, 1);
+}
+
+/*Whole ms until the boot time has surely passed since BootStart, rounded up by one tick.*/
+static uint8_t IIS2MDC_SPI_BootTimeLeft(void){
+	uint32_t elapsed = HAL_GetTick() - BootStart;
+	return (elapsed > IIS2MDC_BOOT_MS) ? 0 : (uint8_t)(IIS2MDC_BOOT_MS + 1 - elapsed);
+}
+
+/**************************************//**************************************//**************************************
+ * Public Variable Defitinion
+ **************************************//**************************************//**************************************/
+IIS2MDC_IO_Drv_t IIS2MDC_Hardware_SPI_Drv = {
+		.Init = IIS2MDC_SPI_Init,
+		.DeInit = IIS2MDC_SPI_DeInit,
+		.WriteReg = IIS2MDC_SPI_WriteReg,
+		.ReadReg = IIS2MDC_SPI_ReadReg,
+		.ioctl = IIS2MDC_SPI_ioctl,
+		.ReadRegAsync = IIS2MDC_SPI_ReadRegAsync
+};
+
+#endif /* HAL_SPI_MODULE_ENABLED */
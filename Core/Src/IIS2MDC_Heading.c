@@ -0,0 +1,169 @@
+/*
+ * IIS2MDC_Heading.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Heading.h"
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+/*atan(r) ~= r * (C1 + C3 * r^2 + C5 * r^4) on [0, 1], minimax fit, 0.035 deg max error.
+ *Coefficients are in centidegrees with 3 extra fraction bits, r is Q15.*/
+static const int32_t ATAN_C1 = 45624;
+static const int32_t ATAN_C3 = -13232;
+static const int32_t ATAN_C5 = 3636;
+#define ATAN_COEFF_FRAC_BITS (3U)
+#define RATIO_FRAC_BITS (15U)
+
+/*sin(0..90 deg) in 1 deg steps, Q15. Linear interpolation between entries is good to 4e-5.*/
+static const int16_t SIN_TABLE[91] = {
+		0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126,
+		5690, 6252, 6813, 7371, 7927, 8481, 9032, 9580, 10126, 10668,
+		11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886,
+		16384, 16877, 17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622,
+		21063, 21498, 21926, 22348, 22763, 23170, 23571, 23965, 24351, 24730,
+		25102, 25466, 25822, 26170, 26510, 26842, 27166, 27482, 27789, 28088,
+		28378, 28660, 28932, 29197, 29452, 29698, 29935, 30163, 30382, 30592,
+		30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166,
+		32270, 32365, 32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763,
+		32767
+};
+#define SIN_TABLE_STEP (100) /*centidegrees*/
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static int32_t AtanUnit(uint32_t ratio);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Integer four quadrant arctangent
+ *@Params: y and x components, any scale, |y| and |x| up to 65535
+ *@Return: Angle of (x, y) in centidegrees, -18000 to 18000. 0 if both are 0.
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+int32_t IIS2MDC_Atan2(int32_t y, int32_t x){
+	uint32_t ax = (x < 0) ? -x : x;
+	uint32_t ay = (y < 0) ? -y : y;
+	int32_t angle;
+
+	if(ax == 0 && ay == 0){
+		return 0;
+	}
+
+	/*Fold into the first octant so the ratio stays in [0, 1]*/
+	if(ay <= ax){
+		angle = AtanUnit((ay << RATIO_FRAC_BITS) / ax);
+	} else {
+		angle = IIS2MDC_CENTIDEG_90 - AtanUnit((ax << RATIO_FRAC_BITS) / ay);
+	}
+
+	if(x < 0){
+		angle = IIS2MDC_CENTIDEG_180 - angle;
+	}
+	return (y < 0) ? -angle : angle;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Wraps an angle into a compass heading
+ *@Params: Angle in centidegrees
+ *@Return: Equivalent angle in the range 0 to 35999 centidegrees
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+uint16_t IIS2MDC_WrapHeading(int32_t centidegrees){
+	centidegrees %= IIS2MDC_CENTIDEG_360;
+	if(centidegrees < 0){
+		centidegrees += IIS2MDC_CENTIDEG_360;
+	}
+	return (uint16_t)centidegrees;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Table based sine
+ *@Params: Angle in centidegrees
+ *@Return: sin(angle) in Q15
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+int16_t IIS2MDC_Sin(int32_t centidegrees){
+	int32_t angle = IIS2MDC_WrapHeading(centidegrees);
+	int32_t sign = 1;
+
+	if(angle >= IIS2MDC_CENTIDEG_180){
+		angle -= IIS2MDC_CENTIDEG_180;
+		sign = -1;
+	}
+	if(angle > IIS2MDC_CENTIDEG_90){
+		angle = IIS2MDC_CENTIDEG_180 - angle;
+	}
+
+	int32_t index = angle / SIN_TABLE_STEP;
+	int32_t frac = angle % SIN_TABLE_STEP;
+	int32_t value = SIN_TABLE[index];
+	if(frac != 0){
+		value += ((SIN_TABLE[index + 1] - value) * frac + SIN_TABLE_STEP / 2) / SIN_TABLE_STEP;
+	}
+	return (int16_t)(sign * value);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Table based cosine
+ *@Params: Angle in centidegrees
+ *@Return: cos(angle) in Q15
+ *@Precondition: None
+ *@Postcondition: None
+ **************************************//**************************************/
+int16_t IIS2MDC_Cos(int32_t centidegrees){
+	return IIS2MDC_Sin(centidegrees + IIS2MDC_CENTIDEG_90);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Sets the magnetic declination added to headings returned by IIS2MDC_GetHeading
+ *@Params: Device handle, declination in centidegrees, east positive
+ *@Return: None
+ *@Precondition: Device handle is initialized
+ *@Postcondition: Subsequent headings are relative to true north
+ **************************************//**************************************/
+void IIS2MDC_SetDeclination(IIS2MDC_Handle_t *Dev, int16_t Declination){
+	Dev->Declination = Declination;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Computes the compass heading of the last sample read, assuming the device is level (Z up)
+ *@Params: Device handle
+ *@Return: Heading in centidegrees (0 to 35999), clockwise from north with the X axis as the forward direction
+ *@Precondition: IIS2MDC_ReadMagnetic has returned IIS2MDC_DataReady at least once
+ *@Postcondition: None
+ **************************************//**************************************/
+uint16_t IIS2MDC_GetHeading(IIS2MDC_Handle_t *Dev){
+	return IIS2MDC_WrapHeading(IIS2MDC_Atan2(Dev->MagY, Dev->MagX) + Dev->Declination);
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*atan of a Q15 ratio in [0, 1], in centidegrees*/
+static int32_t AtanUnit(uint32_t ratio){
+	int32_t r = (int32_t)ratio;
+	int32_t r2 = (r * r) >> RATIO_FRAC_BITS;
+	int32_t p = ATAN_C5;
+	p = ATAN_C3 + ((p * r2) >> RATIO_FRAC_BITS);
+	p = ATAN_C1 + ((p * r2) >> RATIO_FRAC_BITS);
+	return (p * r + (1 << (RATIO_FRAC_BITS + ATAN_COEFF_FRAC_BITS - 1))) >> (RATIO_FRAC_BITS + ATAN_COEFF_FRAC_BITS);
+}
@@ -0,0 +1,173 @@
+/*
+ * IIS2MDC_LowPower.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_LowPower.h"
+#include "log.h"
+#include <stddef.h>
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+static const uint8_t MAX_PRESCALER_LOG2 = 7; /*Timer prescaler is 1..128*/
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static uint16_t ElapsedTicks(IIS2MDC_LowPower_t *LP);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Starts duty cycled acquisition: a one-shot conversion every PeriodMs, sleeping in between.
+ *@Params: Low power context, initialized device handle, low power timer/sleep drivers, sample period in ms
+ *@Return: IIS2MDC_Error if the period can not be represented by the timer, otherwise IIS2MDC_Ok
+ *@Precondition: Dev is initialized in IIS2MDC_OneShotMode with IIS2MDC_DrdyOnPin, and its DRDY interrupt sets Dev->DataReadyFlag.
+ *@Postcondition: Timer is running. IIS2MDC_LowPower_TimerEvent must be called from the timer interrupt.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_LowPower_Init(IIS2MDC_LowPower_t *LP, IIS2MDC_Handle_t *Dev, IIS2MDC_LowPower_Drv_t LowLevelDrivers, uint32_t PeriodMs){
+	LP->Dev = Dev;
+	LP->LowPower_IO = LowLevelDrivers;
+	LP->State = IIS2MDC_LowPowerIdle;
+	LP->TriggerPending = 0;
+	LP->TotalTicks = 0;
+	LP->Stats = (IIS2MDC_LowPowerStats_t){0};
+
+	/*Smallest prescaler keeps the best period resolution*/
+	uint64_t ticks = 0;
+	uint8_t prescaler;
+	for(prescaler = 0; prescaler <= MAX_PRESCALER_LOG2; prescaler++){
+		ticks = ((uint64_t)PeriodMs * LowLevelDrivers.TimerClockHz + (500ULL << prescaler)) / (1000ULL << prescaler);
+		if(ticks <= UINT16_MAX){
+			break;
+		}
+	}
+
+	if(ticks == 0 || prescaler > MAX_PRESCALER_LOG2){
+		_log(log_iis2mdc, "Low Power: Period %lu ms out of range.", PeriodMs);
+		return IIS2MDC_Error;
+	}
+
+	LP->PrescalerLog2 = prescaler;
+	LP->PeriodTicks = (uint16_t)ticks;
+	LP->LowPower_IO.Init();
+	LP->LowPower_IO.StartTimer(LP->PrescalerLog2, LP->PeriodTicks);
+	LP->LastTimestamp = LP->LowPower_IO.ReadTimer();
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Stops duty cycled acquisition
+ *@Params: Low power context
+ *@Return: None
+ *@Precondition: LP is initialized
+ *@Postcondition: Timer is stopped, device handle is left in one-shot mode.
+ **************************************//**************************************/
+void IIS2MDC_LowPower_DeInit(IIS2MDC_LowPower_t *LP){
+	LP->LowPower_IO.StopTimer();
+	LP->State = IIS2MDC_LowPowerIdle;
+	LP->TriggerPending = 0;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Requests a new conversion. Call from the low power timer interrupt.
+ *@Params: Low power context
+ *@Return: None
+ *@Precondition: LP is initialized
+ *@Postcondition: Next call to IIS2MDC_LowPower_Process starts a conversion.
+ **************************************//**************************************/
+void IIS2MDC_LowPower_TimerEvent(IIS2MDC_LowPower_t *LP){
+	LP->TriggerPending = 1;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Runs the acquisition state machine once, sleeping if there is nothing to do.
+ *@Params: Low power context
+ *@Return: IIS2MDC_DataReady if a new sample was read into the device handle, otherwise IIS2MDC_DataNotReady
+ *@Precondition: LP is initialized
+ *@Postcondition: Sleep and awake time are accumulated in LP->Stats in timer ticks.
+ **************************************//**************************************/
+IIS2MDC_DataReadyStatus_t IIS2MDC_LowPower_Process(IIS2MDC_LowPower_t *LP){
+	if(LP->TriggerPending){
+		LP->TriggerPending = 0;
+		if(LP->State == IIS2MDC_LowPowerConverting){
+			LP->Stats.MissedTriggers++; //Previous conversion never completed, start over
+		}
+		LP->Dev->DataReadyFlag = IIS2MDC_DataNotReady;
+		IIS2MDC_StartConversion(LP->Dev);
+		LP->State = IIS2MDC_LowPowerConverting;
+	}
+
+	if(LP->Dev->DataReadyFlag == IIS2MDC_DataReady){
+		if(LP->State == IIS2MDC_LowPowerIdle){
+			IIS2MDC_ReadMagnetic(LP->Dev); //Unrequested conversion (e.g. from Init). Drain it or DRDY never sees another edge.
+			LP->Dev->DataReadyFlag = IIS2MDC_DataNotReady;
+		} else if(IIS2MDC_ReadMagnetic(LP->Dev) == IIS2MDC_DataReady){
+			LP->State = IIS2MDC_LowPowerIdle;
+			LP->Stats.Samples++;
+			LP->Stats.AwakeTicks += ElapsedTicks(LP);
+			return IIS2MDC_DataReady;
+		}
+	}
+
+	LP->LowPower_IO.EnterCritical();
+	if(!LP->TriggerPending && LP->Dev->DataReadyFlag != IIS2MDC_DataReady){
+		LP->Stats.AwakeTicks += ElapsedTicks(LP);
+		LP->LowPower_IO.Sleep();
+		LP->Stats.SleepTicks += ElapsedTicks(LP);
+	}
+	LP->LowPower_IO.ExitCritical();
+
+	return IIS2MDC_DataNotReady;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Fraction of time spent asleep since Init. Average current is roughly I_run * (1 - x) + I_stop * x.
+ *@Params: Low power context
+ *@Return: Time asleep in parts per thousand
+ *@Precondition: LP is initialized
+ *@Postcondition: None
+ **************************************//**************************************/
+uint16_t IIS2MDC_LowPower_SleepPermille(const IIS2MDC_LowPower_t *LP){
+	uint64_t total = (uint64_t)LP->Stats.SleepTicks + LP->Stats.AwakeTicks;
+	if(total == 0){
+		return 0;
+	}
+	return (uint16_t)(((uint64_t)LP->Stats.SleepTicks * 1000U) / total);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Time since Init as counted by the low power timer. SysTick stops in Stop 2, this does not.
+ *@Params: Low power context
+ *@Return: Time in ms, as of the last sample or wake up
+ *@Precondition: LP is initialized
+ *@Postcondition: None
+ **************************************//**************************************/
+uint32_t IIS2MDC_LowPower_ElapsedMs(const IIS2MDC_LowPower_t *LP){
+	return (uint32_t)(((LP->TotalTicks << LP->PrescalerLog2) * 1000U) / LP->LowPower_IO.TimerClockHz);
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Ticks since the last call. The timer is read at least once per period so a 16 bit difference never wraps twice.*/
+static uint16_t ElapsedTicks(IIS2MDC_LowPower_t *LP){
+	uint16_t now = LP->LowPower_IO.ReadTimer();
+	uint16_t elapsed = (uint16_t)(now - LP->LastTimestamp);
+	LP->LastTimestamp = now;
+	LP->TotalTicks += elapsed;
+	return elapsed;
+}
@@ -0,0 +1,207 @@
+/*
+ * IIS2MDC_Queue.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Queue.h"
+#include "log.h"
+#include <stddef.h>
+
+/**************************************//**************************************//**************************************
+ * Defines / Constants
+ **************************************//**************************************//**************************************/
+static const uint8_t SAMPLE_BYTES = IIS2MDC_REG_OUTZ_H_REG - IIS2MDC_REG_OUTX_L_REG + 1;
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void ReadDone(void *Context, IIS2MDC_Status_t Status);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Sets up a zero copy sample queue on user storage and attaches it to a device
+ *@Params: Queue, initialized device handle, slot storage, function called from the completing interrupt after each
+ *         read (may be NULL)
+ *@Return: IIS2MDC_Error if Length is not a power of 2, otherwise IIS2MDC_Ok
+ *@Precondition: Dev is initialized in continuous mode with IIS2MDC_DrdyOnPin. The pin interrupt calls IIS2MDC_Queue_Read
+ *               when Dev->Queue is set, instead of flagging the sample for ReadMagnetic/ServiceIRQ.
+ *@Postcondition: Samples bypass the handle's filter chain and decimators, consumers take them from the queue.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Queue_Init(IIS2MDC_Queue_t *Q, IIS2MDC_Handle_t *Dev, IIS2MDC_QueueStorage_t Storage, IIS2MDC_QueueNotify_t Notify){
+	if(Storage.Length == 0 || (Storage.Length & (Storage.Length - 1)) != 0){
+		_log(log_iis2mdc, "Queue: Length %u is not a power of 2.", Storage.Length);
+		return IIS2MDC_Error;
+	}
+	Q->Dev = Dev;
+	Q->Storage = Storage;
+	Q->Head = 0;
+	Q->Tail = 0;
+	Q->InFlight = 0;
+	Q->RetryPending = 0;
+	Q->Target = NULL;
+	Q->Notify = Notify;
+	Q->Stats = (IIS2MDC_QueueStats_t){0};
+	Dev->Queue = Q;
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Detaches the queue, the pin interrupt goes back to flagging samples for ReadMagnetic/ServiceIRQ
+ *@Params: Queue
+ *@Return: None
+ *@Precondition: Q is initialized
+ *@Postcondition: A read still in flight completes into its slot, the slots stay readable.
+ **************************************//**************************************/
+void IIS2MDC_Queue_DeInit(IIS2MDC_Queue_t *Q){
+	Q->Dev->Queue = NULL;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Starts reading the outputs into the next free slot. Call from the DRDY interrupt.
+ *@Params: Queue, time of the DRDY edge
+ *@Return: IIS2MDC_Error if a read is already in flight or the transport refused it, otherwise IIS2MDC_Ok
+ *@Precondition: Q is initialized
+ *@Postcondition: The slot is committed by the completion interrupt. With a blocking transport it is committed here.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Queue_Read(IIS2MDC_Queue_t *Q, uint32_t Timestamp){
+	if(Q->InFlight){
+		Q->Stats.Busy++;
+		return IIS2MDC_Error;
+	}
+
+	IIS2MDC_QueueStorage_t *S = &Q->Storage;
+	if((uint16_t)(Q->Head - Q->Tail) >= S->Length){
+		Q->Target = Q->Discard;
+		Q->Stats.Dropped++;
+	} else {
+		uint16_t slot = Q->Head & (S->Length - 1);
+		Q->Target = &S->Raw[3 * slot];
+		S->Timestamp[slot] = Timestamp;
+		S->Epoch[slot] = Q->Dev->CalibrationEpoch; //A tag, not a conversion: keeps the interrupt short
+	}
+	Q->PendingTimestamp = Timestamp;
+	Q->InFlight = 1;
+
+	IIS2MDC_IO_Drv_t *IO = &Q->Dev->IIS2MDC_IO;
+	if(IO->ReadRegAsync == NULL){
+		IIS2MDC_Status_t Status = IO->ReadReg(IIS2MDC_REG_OUTX_L_REG, (uint8_t*)Q->Target, SAMPLE_BYTES);
+		ReadDone(Q, Status);
+		return Status;
+	}
+	if(IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, (uint8_t*)Q->Target, SAMPLE_BYTES, ReadDone, Q) != IIS2MDC_Ok){
+		Q->InFlight = 0;
+		Q->Stats.Busy++;
+		return IIS2MDC_Error;
+	}
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Gives the consumer the oldest run of filled slots, as captured
+ *@Params: Queue, returns the raw XYZ triplets (LSB, interleaved), returns their timestamps
+ *@Return: Number of triplets in the run, 0 if the queue is empty. The run stops at the end of the storage, acquire
+ *         again after releasing it to get the slots that wrapped.
+ *@Precondition: Q is initialized. Call from thread context.
+ *@Postcondition: The run stays valid and untouched by the DMA until IIS2MDC_Queue_Release. A read that failed is retried.
+ **************************************//**************************************/
+uint16_t IIS2MDC_Queue_Acquire(IIS2MDC_Queue_t *Q, const int16_t **Raw, const uint32_t **Timestamps){
+	if(Q->RetryPending && !Q->InFlight){
+		/*DRDY stays high after a failed read, no new edge will come to start the next one*/
+		Q->RetryPending = 0;
+		Q->Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQDisable);
+		IIS2MDC_Queue_Read(Q, Q->PendingTimestamp);
+		Q->Dev->IIS2MDC_IO.ioctl(IIS2MDC_IRQEnable);
+	}
+
+	uint16_t available = (uint16_t)(Q->Head - Q->Tail);
+	uint16_t start = Q->Tail & (Q->Storage.Length - 1);
+	uint16_t count = (available < Q->Storage.Length - start) ? available : (uint16_t)(Q->Storage.Length - start);
+
+	*Raw = &Q->Storage.Raw[3 * start];
+	*Timestamps = &Q->Storage.Timestamp[start];
+	return count;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Calibrated values for part of the acquired run, converting only the slots never asked for before
+ *@Params: Queue, index of the first triplet within the run, number of triplets
+ *@Return: Calibrated XYZ triplets (LSB, interleaved) for the requested slots
+ *@Precondition: First + Count is no more than the last IIS2MDC_Queue_Acquire returned
+ *@Postcondition: Each slot is converted with the calibration of the epoch it was captured in. Consecutive slots of
+ *                one epoch go through IIS2MDC_ConvertBlock together.
+ **************************************//**************************************/
+const int16_t* IIS2MDC_Queue_Calibrated(IIS2MDC_Queue_t *Q, uint16_t First, uint16_t Count){
+	IIS2MDC_QueueStorage_t *S = &Q->Storage;
+	uint16_t start = (Q->Tail + First) & (S->Length - 1);
+
+	for(uint16_t i = 0; i < Count;){
+		uint16_t slot = start + i;
+		uint8_t epoch = S->Epoch[slot];
+		if(epoch & IIS2MDC_QUEUE_CONVERTED){
+			i++;
+			continue;
+		}
+
+		uint16_t run = 1;
+		while(i + run < Count && S->Epoch[slot + run] == epoch){
+			run++;
+		}
+
+		const IIS2MDC_Calibration_t *Cal = IIS2MDC_CalibrationForEpoch(Q->Dev, epoch);
+		if(Cal == NULL){
+			Cal = Q->Dev->Calibration;
+			Q->Stats.EpochExpired += run;
+		}
+		IIS2MDC_ConvertBlock(Cal, &S->Raw[3 * slot], &S->Calibrated[3 * slot], run);
+		for(uint16_t k = 0; k < run; k++){
+			S->Epoch[slot + k] = epoch | IIS2MDC_QUEUE_CONVERTED;
+		}
+		Q->Stats.Conversions += run;
+		i += run;
+	}
+	return &S->Calibrated[3 * start];
+}
+
+
+/**************************************//**************************************
+ *@Brief: Returns consumed slots to the DMA
+ *@Params: Queue, number of triplets consumed from the last acquired run
+ *@Return: None
+ *@Precondition: Count is no more than the last IIS2MDC_Queue_Acquire returned
+ *@Postcondition: The released slots may be overwritten by the next read.
+ **************************************//**************************************/
+void IIS2MDC_Queue_Release(IIS2MDC_Queue_t *Q, uint16_t Count){
+	Q->Tail = (uint16_t)(Q->Tail + Count);
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Completion of the read in flight, runs in interrupt context. The slot is committed before InFlight drops so a DRDY
+ *edge arriving in between always sees the next free slot.*/
+static void ReadDone(void *Context, IIS2MDC_Status_t Status){
+	IIS2MDC_Queue_t *Q = Context;
+	if(Status != IIS2MDC_Ok){
+		Q->Stats.Errors++;
+		Q->RetryPending = 1;
+	} else if(Q->Target != Q->Discard){
+		Q->Head++;
+		Q->Stats.Samples++;
+	}
+	Q->InFlight = 0;
+	if(Q->Notify != NULL){
+		Q->Notify();
+	}
+}
@@ -0,0 +1,186 @@
+/*
+ * IIS2MDC_Store.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Store.h"
+#include <stddef.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void Push(IIS2MDC_Store_t *Store, IIS2MDC_StoreRecord_t Record);
+static void DropOldest(IIS2MDC_Store_t *Store);
+static uint16_t TailIndex(const IIS2MDC_StoreHeader_t *Header);
+static uint32_t MarkTime(const IIS2MDC_StoreRecord_t *Record);
+static uint32_t HeaderCheck(const IIS2MDC_StoreHeader_t *Header);
+static int16_t Saturate16(int32_t Value);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Opens a store placed in retained memory, keeping whatever a previous run left in it
+ *@Params: Store, normally in a NOLOAD section so startup code leaves it alone
+ *@Return: Number of records recovered, 0 if the store had to be formatted
+ *@Precondition: None
+ *@Postcondition: Store is valid. Recovered records are followed by a time mark, the new run has its own time base.
+ **************************************//**************************************/
+uint16_t IIS2MDC_Store_Init(IIS2MDC_Store_t *Store){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	if(H->Magic == IIS2MDC_STORE_MAGIC && H->Capacity == IIS2MDC_STORE_CAPACITY && H->Head < H->Capacity &&
+			H->Count <= H->Capacity && H->Check == HeaderCheck(H)){
+		H->Flags |= IIS2MDC_STORE_NEED_MARK;
+		H->Check = HeaderCheck(H);
+		return H->Count;
+	}
+	IIS2MDC_Store_Clear(Store);
+	return 0;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Discards every record and the overwrite count
+ *@Params: Store
+ *@Return: None
+ *@Precondition: None
+ *@Postcondition: Store is empty and valid.
+ **************************************//**************************************/
+void IIS2MDC_Store_Clear(IIS2MDC_Store_t *Store){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	H->Magic = IIS2MDC_STORE_MAGIC;
+	H->Capacity = IIS2MDC_STORE_CAPACITY;
+	H->Head = 0;
+	H->Count = 0;
+	H->Flags = 0;
+	H->LastTime = 0;
+	H->TailTime = 0;
+	H->Overwritten = 0;
+	H->Check = HeaderCheck(H);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Appends one sample, overwriting the oldest when full
+ *@Params: Store, field in mG, sample time in ms
+ *@Return: None
+ *@Precondition: Store is initialized. Timestamps do not go backwards within a run.
+ *@Postcondition: 8 bytes are used per sample, plus a time mark after gaps of a minute or more.
+ **************************************//**************************************/
+void IIS2MDC_Store_Append(IIS2MDC_Store_t *Store, const int32_t Field[3], uint32_t Timestamp){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	uint32_t delta = 0;
+
+	if(H->Count == 0){
+		H->TailTime = Timestamp;
+		H->Flags &= ~IIS2MDC_STORE_NEED_MARK;
+	} else {
+		delta = Timestamp - H->LastTime;
+		if((H->Flags & IIS2MDC_STORE_NEED_MARK) || delta >= IIS2MDC_STORE_TIME_MARK){
+			IIS2MDC_StoreRecord_t Mark = {
+					.Field = {(int16_t)(Timestamp & 0xFFFFU), (int16_t)(Timestamp >> 16), 0},
+					.Delta = IIS2MDC_STORE_TIME_MARK
+			};
+			Push(Store, Mark);
+			H->Flags &= ~IIS2MDC_STORE_NEED_MARK;
+			delta = 0;
+		}
+	}
+
+	IIS2MDC_StoreRecord_t Record = {
+			.Field = {Saturate16(Field[0]), Saturate16(Field[1]), Saturate16(Field[2])},
+			.Delta = (uint16_t)delta
+	};
+	Push(Store, Record);
+	H->LastTime = Timestamp;
+	H->Check = HeaderCheck(H);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Removes up to Max of the oldest samples, restoring their absolute times
+ *@Params: Store, output samples, capacity of Out
+ *@Return: Number of samples written to Out
+ *@Precondition: Store is initialized
+ *@Postcondition: Drained records are free for new samples.
+ **************************************//**************************************/
+uint16_t IIS2MDC_Store_Drain(IIS2MDC_Store_t *Store, IIS2MDC_StoreSample_t *Out, uint16_t Max){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	uint16_t n = 0;
+
+	while(n < Max && H->Count > 0){
+		const IIS2MDC_StoreRecord_t Record = Store->Records[TailIndex(H)];
+		uint32_t Time = H->TailTime;
+		DropOldest(Store);
+		if(Record.Delta == IIS2MDC_STORE_TIME_MARK){
+			continue;
+		}
+		Out[n].Field[0] = Record.Field[0];
+		Out[n].Field[1] = Record.Field[1];
+		Out[n].Field[2] = Record.Field[2];
+		Out[n].Timestamp = Time;
+		n++;
+	}
+	H->Check = HeaderCheck(H);
+	return n;
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+static void Push(IIS2MDC_Store_t *Store, IIS2MDC_StoreRecord_t Record){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	if(H->Count == H->Capacity){
+		if(Store->Records[TailIndex(H)].Delta != IIS2MDC_STORE_TIME_MARK){
+			H->Overwritten++;
+		}
+		DropOldest(Store);
+	}
+	Store->Records[H->Head] = Record;
+	H->Head = (H->Head + 1 == H->Capacity) ? 0 : H->Head + 1;
+	H->Count++;
+}
+
+/*Removes the tail record and works out the time of the one behind it*/
+static void DropOldest(IIS2MDC_Store_t *Store){
+	IIS2MDC_StoreHeader_t *H = &Store->Header;
+	H->Count--;
+	if(H->Count == 0){
+		return;
+	}
+	const IIS2MDC_StoreRecord_t *Next = &Store->Records[TailIndex(H)];
+	H->TailTime = (Next->Delta == IIS2MDC_STORE_TIME_MARK) ? MarkTime(Next) : H->TailTime + Next->Delta;
+}
+
+static uint16_t TailIndex(const IIS2MDC_StoreHeader_t *Header){
+	return (uint16_t)((Header->Head + Header->Capacity - Header->Count) % Header->Capacity);
+}
+
+static uint32_t MarkTime(const IIS2MDC_StoreRecord_t *Record){
+	return (uint32_t)(uint16_t)Record->Field[0] | ((uint32_t)(uint16_t)Record->Field[1] << 16);
+}
+
+/*Rotating XOR over the header words before Check. Cheap enough to refresh on every append.*/
+static uint32_t HeaderCheck(const IIS2MDC_StoreHeader_t *Header){
+	const uint32_t *Words = (const uint32_t*)Header;
+	uint32_t Check = 0xA5A5A5A5U;
+	for(size_t i = 0; i < offsetof(IIS2MDC_StoreHeader_t, Check) / sizeof(uint32_t); i++){
+		Check = ((Check << 5) | (Check >> 27)) ^ Words[i];
+	}
+	return Check;
+}
+
+static int16_t Saturate16(int32_t Value){
+	if(Value > INT16_MAX){
+		return INT16_MAX;
+	} else if(Value < INT16_MIN){
+		return INT16_MIN;
+	}
+	return (int16_t)Value;
+}
@@ -0,0 +1,162 @@
+/*
+ * IIS2MDC_Telemetry.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Telemetry.h"
+#include "log.h"
+#include <string.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static void SendConfig(IIS2MDC_Telemetry_t *T);
+static uint8_t Send(IIS2MDC_Telemetry_t *T, uint8_t Type, const uint8_t *Payload, uint32_t Length);
+static uint8_t *Put16(uint8_t *Out, int16_t Value);
+static int16_t Saturate16(int32_t Value);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Sets up a sample telemetry stream
+ *@Params: Telemetry context, link driver, samples per frame (1..IIS2MDC_TELEMETRY_MAX_SAMPLES)
+ *@Return: IIS2MDC_Error if SamplesPerFrame is out of range, otherwise IIS2MDC_Ok
+ *@Precondition: None
+ *@Postcondition: Nothing is sent until SamplesPerFrame samples are appended or the stream is flushed.
+ **************************************//**************************************/
+IIS2MDC_Status_t IIS2MDC_Telemetry_Init(IIS2MDC_Telemetry_t *T, IIS2MDC_Telemetry_Drv_t LowLevelDrivers, uint8_t SamplesPerFrame){
+	if(SamplesPerFrame == 0 || SamplesPerFrame > IIS2MDC_TELEMETRY_MAX_SAMPLES){
+		_log(log_iis2mdc, "Telemetry: 1..%u samples per frame.", IIS2MDC_TELEMETRY_MAX_SAMPLES);
+		return IIS2MDC_Error;
+	}
+	T->Telemetry_IO = LowLevelDrivers;
+	IIS2MDC_Encoder_Init(&T->Encoder, 0);
+	T->SamplesPerFrame = SamplesPerFrame;
+	T->Count = 0;
+	T->Sequence = 0;
+	T->Length = 0;
+	T->Sensor = NULL;
+	T->SinceConfig = 0;
+	T->Stats = (IIS2MDC_TelemetryStats_t){0};
+	return IIS2MDC_Ok;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Describes the samples on the stream with the sensor's configuration and calibration
+ *@Params: Telemetry context, sensor the samples come from
+ *@Return: None
+ *@Precondition: T and Sensor are initialized. Call from thread context.
+ *@Postcondition: A configuration frame is sent now and again as described in IIS2MDC_Telemetry.h.
+ **************************************//**************************************/
+void IIS2MDC_Telemetry_AttachSensor(IIS2MDC_Telemetry_t *T, const IIS2MDC_Handle_t *Sensor){
+	T->Sensor = Sensor;
+	T->SinceConfig = IIS2MDC_TELEMETRY_CONFIG_PERIOD;
+	SendConfig(T);
+}
+
+
+/**************************************//**************************************
+ *@Brief: Adds a sample to the frame being built, sending it once full
+ *@Params: Telemetry context, field in mG (saturated to int16 on the wire), sample time in ms
+ *@Return: None
+ *@Precondition: T is initialized. Call from thread context.
+ *@Postcondition: Never waits for the link, a frame it can't take is counted in Stats.Dropped.
+ **************************************//**************************************/
+void IIS2MDC_Telemetry_Append(IIS2MDC_Telemetry_t *T, const int32_t Field[3], uint32_t Timestamp){
+	const int16_t Sample[3] = {Saturate16(Field[0]), Saturate16(Field[1]), Saturate16(Field[2])};
+	T->Length += IIS2MDC_Encoder_Encode(&T->Encoder, Sample, Timestamp, &T->Payload[T->Length]);
+	T->Count++;
+	T->Stats.Samples++;
+	if(T->Count >= T->SamplesPerFrame){
+		IIS2MDC_Telemetry_Flush(T);
+	}
+}
+
+
+/**************************************//**************************************
+ *@Brief: Sends the samples collected so far as a frame
+ *@Params: Telemetry context
+ *@Return: None
+ *@Precondition: T is initialized. Call from thread context.
+ *@Postcondition: The next sample starts a new frame. Nothing is sent if no samples are pending.
+ **************************************//**************************************/
+void IIS2MDC_Telemetry_Flush(IIS2MDC_Telemetry_t *T){
+	if(T->Count == 0){
+		return;
+	}
+	SendConfig(T);
+	T->Length += IIS2MDC_Encoder_Flush(&T->Encoder, &T->Payload[T->Length]);
+	Send(T, IIS2MDC_TELEMETRY_TYPE_SAMPLES, T->Payload, T->Length);
+	T->Count = 0;
+	T->Length = 0;
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*Sends the configuration if it changed or is due for a repeat. One that can't be sent is retried on the next flush.*/
+static void SendConfig(IIS2MDC_Telemetry_t *T){
+	if(T->Sensor == NULL){
+		return;
+	}
+	const IIS2MDC_Handle_t *Dev = T->Sensor;
+	uint8_t Config[IIS2MDC_TELEMETRY_CONFIG_BYTES];
+	uint8_t *p = Config;
+	memcpy(p, Dev->Shadow.Offset, sizeof(Dev->Shadow.Offset));
+	p += sizeof(Dev->Shadow.Offset);
+	memcpy(p, Dev->Shadow.Cfg, sizeof(Dev->Shadow.Cfg));
+	p += sizeof(Dev->Shadow.Cfg);
+	memcpy(p, Dev->Shadow.Threshold, sizeof(Dev->Shadow.Threshold));
+	p += sizeof(Dev->Shadow.Threshold);
+	for(uint8_t i = 0; i < 3; i++){
+		p = Put16(p, Dev->Calibration->Bias[i]);
+	}
+	for(uint8_t i = 0; i < 9; i++){
+		p = Put16(p, Dev->Calibration->Matrix[i / 3][i % 3]);
+	}
+	p = Put16(p, Dev->Declination);
+	*p = Dev->CalibrationEpoch;
+
+	if(T->SinceConfig < IIS2MDC_TELEMETRY_CONFIG_PERIOD && memcmp(Config, T->Config, sizeof(Config)) == 0){
+		T->SinceConfig++;
+		return;
+	}
+	if(Send(T, IIS2MDC_TELEMETRY_TYPE_CONFIG, Config, sizeof(Config))){
+		memcpy(T->Config, Config, sizeof(Config));
+		T->SinceConfig = 0;
+	}
+}
+
+static uint8_t Send(IIS2MDC_Telemetry_t *T, uint8_t Type, const uint8_t *Payload, uint32_t Length){
+	uint32_t n = telemetry_frame_encode(Type, T->Sequence++, Payload, Length, T->Frame);
+	if(T->Telemetry_IO.Write(T->Frame, (uint16_t)n)){
+		T->Stats.Frames++;
+		T->Stats.Bytes += n;
+		return 1;
+	}
+	T->Stats.Dropped++;
+	return 0;
+}
+
+static uint8_t *Put16(uint8_t *Out, int16_t Value){
+	Out[0] = (uint8_t)((uint16_t)Value & 0xFFU);
+	Out[1] = (uint8_t)((uint16_t)Value >> 8);
+	return Out + 2;
+}
+
+static int16_t Saturate16(int32_t Value){
+	if(Value > INT16_MAX){
+		return INT16_MAX;
+	} else if(Value < INT16_MIN){
+		return INT16_MIN;
+	}
+	return (int16_t)Value;
+}
@@ -0,0 +1,107 @@
+/*
+ * IIS2MDC_Tilt.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+/**************************************//**************************************//**************************************
+ * Includes
+ **************************************//**************************************//**************************************/
+#include "IIS2MDC_Tilt.h"
+#include "IIS2MDC_Heading.h"
+#include "log.h"
+#include <stddef.h>
+
+/**************************************//**************************************//**************************************
+ * Private Function Prototypes
+ **************************************//**************************************//**************************************/
+static int32_t Atan2Q15(int64_t y, int64_t x);
+
+/**************************************//**************************************//**************************************
+ * Public Function Definitions
+ **************************************//**************************************//**************************************/
+
+/**************************************//**************************************
+ *@Brief: Attaches an accelerometer to a magnetometer handle for tilt compensated heading
+ *@Params: Tilt context, initialized magnetometer handle, accelerometer driver
+ *@Return: None
+ *@Precondition: Dev is initialized
+ *@Postcondition: Accelerometer driver Init has been called.
+ **************************************//**************************************/
+void IIS2MDC_Tilt_Init(IIS2MDC_Tilt_t *Tilt, IIS2MDC_Handle_t *Dev, IIS2MDC_Accel_Drv_t LowLevelDrivers){
+	Tilt->Dev = Dev;
+	Tilt->Accel_IO = LowLevelDrivers;
+	Tilt->Roll = 0;
+	Tilt->Pitch = 0;
+	Tilt->Heading = 0;
+	Tilt->Accel_IO.Init();
+}
+
+
+/**************************************//**************************************
+ *@Brief: Reads the magnetometer and, when a sample is ready, the accelerometer, then updates the tilt compensated heading.
+ *@Params: Tilt context
+ *@Return: Status of the magnetometer read, see IIS2MDC_ReadMagnetic
+ *@Precondition: Tilt is initialized
+ *@Postcondition: On IIS2MDC_DataReady, Roll, Pitch and Heading describe the new sample. Heading includes Dev->Declination.
+ **************************************//**************************************/
+IIS2MDC_DataReadyStatus_t IIS2MDC_Tilt_ReadMagnetic(IIS2MDC_Tilt_t *Tilt){
+	int32_t accel[3];
+	if(IIS2MDC_ReadMagnetic(Tilt->Dev) != IIS2MDC_DataReady){
+		return IIS2MDC_DataNotReady;
+	}
+
+	if(Tilt->Accel_IO.ReadAccel(&accel[0], &accel[1], &accel[2]) != IIS2MDC_Ok){
+		_log(log_iis2mdc, "Tilt: Reading Accelerometer Failed.");
+		return IIS2MDC_DataReady; //Magnetometer sample is still valid, keep the previous heading
+	}
+
+	const int32_t mag[3] = {Tilt->Dev->MagX, Tilt->Dev->MagY, Tilt->Dev->MagZ};
+	Tilt->Heading = IIS2MDC_WrapHeading(IIS2MDC_TiltCompensate(mag, accel, &Tilt->Roll, &Tilt->Pitch) + Tilt->Dev->Declination);
+	return IIS2MDC_DataReady;
+}
+
+
+/**************************************//**************************************
+ *@Brief: Rotates a field vector into the horizontal plane and computes its heading
+ *@Params: Field vector (X forward, Y left, Z up), accelerometer reading in the same frame, roll and pitch outputs (may be NULL)
+ *@Return: Magnetic heading in centidegrees, 0 to 35999
+ *@Precondition: |Mag| components < 65536, |Accel| components < 65536
+ *@Postcondition: Roll and pitch are written in centidegrees if not NULL
+ **************************************//**************************************/
+uint16_t IIS2MDC_TiltCompensate(const int32_t Mag[3], const int32_t Accel[3], int16_t *Roll, int16_t *Pitch){
+	/*a = g * (-sin(p), sin(r)cos(p), cos(r)cos(p)), so roll comes from Y/Z and pitch from X against the rolled Y/Z*/
+	int32_t roll = IIS2MDC_Atan2(Accel[1], Accel[2]);
+	int64_t sin_r = IIS2MDC_Sin(roll);
+	int64_t cos_r = IIS2MDC_Cos(roll);
+	int32_t pitch = Atan2Q15(-(int64_t)Accel[0] << IIS2MDC_TRIG_FRAC_BITS, Accel[1] * sin_r + Accel[2] * cos_r);
+	int64_t sin_p = IIS2MDC_Sin(pitch);
+	int64_t cos_p = IIS2MDC_Cos(pitch);
+
+	/*Field after undoing roll (about X) and then pitch (about Y), all Q15*/
+	int64_t rolled_z = Mag[1] * sin_r + Mag[2] * cos_r;
+	int64_t level_y = Mag[1] * cos_r - Mag[2] * sin_r;
+	int64_t level_x = Mag[0] * cos_p + ((rolled_z * sin_p) >> IIS2MDC_TRIG_FRAC_BITS);
+
+	if(Roll != NULL){
+		*Roll = (int16_t)roll;
+	}
+	if(Pitch != NULL){
+		*Pitch = (int16_t)pitch;
+	}
+	return IIS2MDC_WrapHeading(Atan2Q15(level_y, level_x));
+}
+
+/**************************************//**************************************//**************************************
+ * Private Function Definitions
+ **************************************//**************************************//**************************************/
+
+/*IIS2MDC_Atan2 of wide fixed point components. Both are shifted down together until they fit its 16 bit input range,
+ *keeping as many fraction bits as possible.*/
+static int32_t Atan2Q15(int64_t y, int64_t x){
+	while(y >= 65536 || y <= -65536 || x >= 65536 || x <= -65536){
+		y /= 2;
+		x /= 2;
+	}
+	return IIS2MDC_Atan2((int32_t)y, (int32_t)x);
+}
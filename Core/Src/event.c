@@ -0,0 +1,100 @@
+/*
+ * event.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "event.h"
+#include "stm32u5xx_hal.h"
+
+/*Single consumer queue: interrupts post, the main loop waits. Posting is done with interrupts masked so ISRs of any
+ *priority may post. Idle time is measured with the DWT cycle counter around WFI.*/
+static volatile uint8_t queue[EVENT_QUEUE_LENGTH];
+static volatile uint8_t head;
+static volatile uint8_t tail;
+static Event_Stats_t stats;
+static uint32_t last_cycle;
+
+static void event_account(uint8_t idle){
+	uint32_t now = DWT->CYCCNT;
+	uint32_t elapsed = now - last_cycle;
+	last_cycle = now;
+	stats.total_cycles += elapsed;
+	if(idle){
+		stats.idle_cycles += elapsed;
+	}
+}
+
+void event_init(void){
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	head = 0;
+	tail = 0;
+	event_reset_stats();
+}
+
+void event_post(Event_Type_t event){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	uint8_t used = (uint8_t)(head - tail);
+	if(used >= EVENT_QUEUE_LENGTH){
+		stats.dropped++;
+	} else {
+		queue[head & (EVENT_QUEUE_LENGTH - 1)] = event;
+		head++;
+		if(used + 1 > stats.high_water){
+			stats.high_water = used + 1;
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+/*Returns the oldest event, or sleeps until the next interrupt and returns event_none if that interrupt posted nothing*/
+Event_Type_t event_wait(void){
+	Event_Type_t event = event_none;
+
+	__disable_irq();
+	if(head == tail){
+		event_account(0);
+		__DSB();
+		__WFI(); //Wakes on a pending IRQ even though PRIMASK is set
+		event_account(1);
+		__enable_irq(); //Let the waking ISR post before the queue is checked
+		__ISB();
+		__disable_irq();
+	}
+	if(head != tail){
+		event = (Event_Type_t)queue[tail & (EVENT_QUEUE_LENGTH - 1)];
+		tail++;
+	}
+	__enable_irq();
+
+	return event;
+}
+
+void event_get_stats(Event_Stats_t *out){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	event_account(0);
+	*out = stats;
+	__set_PRIMASK(primask);
+}
+
+/*Share of cycles spent in WFI since the last reset, in parts per thousand*/
+uint16_t event_idle_permille(void){
+	Event_Stats_t snapshot;
+	event_get_stats(&snapshot);
+	if(snapshot.total_cycles == 0){
+		return 0;
+	}
+	return (uint16_t)((snapshot.idle_cycles * 1000U) / snapshot.total_cycles);
+}
+
+void event_reset_stats(void){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	stats = (Event_Stats_t){0};
+	last_cycle = DWT->CYCCNT;
+	__set_PRIMASK(primask);
+}
@@ -48,6 +48,16 @@ void MX_GPIO_Init(void)
   __HAL_RCC_GPIOH_CLK_ENABLE();
   __HAL_RCC_GPIOD_CLK_ENABLE();
 
+  /*Configure GPIO pin Output Level */
+  HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_SET);
+
+  /*Configure GPIO pin : PtPin */
+  GPIO_InitStruct.Pin = IIS2MDC_SPI_CS_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(IIS2MDC_SPI_CS_GPIO_Port, &GPIO_InitStruct);
+
   /*Configure GPIO pin : PtPin */
   GPIO_InitStruct.Pin = IIS2MDC_IRQ_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
@@ -77,4 +87,18 @@ void IIS2MDC_GPIO_Init(void){
 	  HAL_NVIC_SetPriority(EXTI10_IRQn, 0, 0);
 	  HAL_NVIC_EnableIRQ(EXTI10_IRQn);
 }
+
+/*Chip select for a sensor on SPI2, driven high before it becomes an output so the sensor never sees a stray frame*/
+void IIS2MDC_SPI_GPIO_Init(void){
+		GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	  __HAL_RCC_GPIOB_CLK_ENABLE();
+
+	  HAL_GPIO_WritePin(IIS2MDC_SPI_CS_GPIO_Port, IIS2MDC_SPI_CS_Pin, GPIO_PIN_SET);
+	  GPIO_InitStruct.Pin = IIS2MDC_SPI_CS_Pin;
+	  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	  GPIO_InitStruct.Pull = GPIO_NOPULL;
+	  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	  HAL_GPIO_Init(IIS2MDC_SPI_CS_GPIO_Port, &GPIO_InitStruct);
+}
 /* USER CODE END 2 */
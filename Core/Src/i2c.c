@@ -21,7 +21,45 @@
 #include "i2c.h"
 
 /* USER CODE BEGIN 0 */
+#define I2C_BUS_CLEAR_CLOCKS 9 /*A slave stuck mid byte releases SDA within 9 clocks*/
+#define I2C_BITS_PER_BYTE 9 /*8 data bits and the ACK*/
+#define I2C_TIMEOUT_MARGIN 2 /*Nominal transfer time is multiplied by this...*/
+#define I2C_TIMEOUT_SLACK_US 50 /*...and this is added to cover START/STOP setup and the software loop*/
+#define I2C_PE_LOW_READS 3 /*PE must stay low for 3 APB cycles after a software reset*/
 
+static void i2c_bus_delay(void);
+static uint32_t i2c_deadline(uint32_t timeout_us);
+static I2C_Result_t i2c2_wait(uint32_t flag, uint32_t deadline);
+static I2C_Result_t i2c2_abort(I2C_Result_t result);
+static void i2c2_disable(void);
+static void i2c2_bus_start(I2C_Transaction_t *transaction);
+static void i2c2_bus_abort(void);
+static uint32_t i2c2_bus_timestamp(void);
+static uint32_t i2c2_bus_enter_critical(void);
+static void i2c2_bus_exit_critical(uint32_t state);
+static void i2c2_write_timing(uint32_t timing, I2C_Speed_t speed);
+static void i2c2_autonomous_restart(void);
+
+/*PH4/PH5 with the discovery board's pull-ups. The analog filter is enabled below and the digital filter is off.*/
+static const I2C_Bus_Edges_t i2c2_edges = {
+    .rise_ns = 100,
+    .fall_ns = 10,
+    .analog_filter = 1,
+    .digital_filter = 0
+};
+static I2C_Speed_t i2c2_speed = I2C2_DEFAULT_SPEED;
+static uint32_t i2c2_timing;
+
+/*Autonomous reads run on their own channel, the arbiter's channels keep their HAL configuration*/
+#define I2C2_AUTONOMOUS_CHANNEL GPDMA1_Channel2
+#define I2C2_AUTONOMOUS_IRQn GPDMA1_Channel2_IRQn
+static uint32_t i2c2_autonomous_link; //First node, 0 when not running
+
+I2C_Arbiter_t i2c2_bus;
+#if I2C2_USE_DMA
+DMA_HandleTypeDef handle_GPDMA1_Channel0;
+DMA_HandleTypeDef handle_GPDMA1_Channel1;
+#endif
 /* USER CODE END 0 */
 
 I2C_HandleTypeDef hi2c2;
@@ -65,7 +103,33 @@ void MX_I2C2_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN I2C2_Init 2 */
+  /*Transfer deadlines are measured in core cycles*/
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  /*The generated Timing constant stays: it is CubeMX's 100 kHz value for a 160 MHz kernel clock with 0 ns edges (the
+   *calculator reproduces it, see Tools/i2c_timing_test.c) and lets HAL_I2C_Init enable the peripheral. It is replaced
+   *here with the selected profile, computed for the actual kernel clock and this board's edges. Re-initializing after
+   *a bus fault keeps whatever speed was in use.*/
+  if(i2c2_timing == 0 && i2c_timing_compute(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C2), i2c2_speed, &i2c2_edges, &i2c2_timing) != 0)
+  {
+    Error_Handler();
+  }
+  i2c2_write_timing(i2c2_timing, i2c2_speed);
 
+  /*Every driver on I2C2 queues through the arbiter. Re-initializing the peripheral after a fault keeps the queue.*/
+  if(i2c2_bus.drv.start == NULL)
+  {
+    I2C_Arbiter_Drv_t drv = {
+        .start = i2c2_bus_start,
+        .abort = i2c2_bus_abort,
+        .timestamp = i2c2_bus_timestamp,
+        .timestamp_hz = SystemCoreClock,
+        .enter_critical = i2c2_bus_enter_critical,
+        .exit_critical = i2c2_bus_exit_critical
+    };
+    i2c_arbiter_init(&i2c2_bus, drv);
+  }
   /* USER CODE END I2C2_Init 2 */
 
 }
@@ -105,7 +169,66 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle)
     /* I2C2 clock enable */
     __HAL_RCC_I2C2_CLK_ENABLE();
   /* USER CODE BEGIN I2C2_MspInit 1 */
+#if I2C2_USE_DMA
+    __HAL_RCC_GPDMA1_CLK_ENABLE();
+
+    handle_GPDMA1_Channel0.Instance = GPDMA1_Channel0;
+    handle_GPDMA1_Channel0.Init.Request = GPDMA1_REQUEST_I2C2_RX;
+    handle_GPDMA1_Channel0.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+    handle_GPDMA1_Channel0.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    handle_GPDMA1_Channel0.Init.SrcInc = DMA_SINC_FIXED;
+    handle_GPDMA1_Channel0.Init.DestInc = DMA_DINC_INCREMENTED;
+    handle_GPDMA1_Channel0.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel0.Init.DestDataWidth = DMA_DEST_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel0.Init.Priority = DMA_LOW_PRIORITY_HIGH_WEIGHT;
+    handle_GPDMA1_Channel0.Init.SrcBurstLength = 1;
+    handle_GPDMA1_Channel0.Init.DestBurstLength = 1;
+    handle_GPDMA1_Channel0.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0|DMA_DEST_ALLOCATED_PORT0;
+    handle_GPDMA1_Channel0.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    handle_GPDMA1_Channel0.Init.Mode = DMA_NORMAL;
+    if (HAL_DMA_Init(&handle_GPDMA1_Channel0) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(i2cHandle, hdmarx, handle_GPDMA1_Channel0);
+    if (HAL_DMA_ConfigChannelAttributes(&handle_GPDMA1_Channel0, DMA_CHANNEL_NPRIV) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    handle_GPDMA1_Channel1.Instance = GPDMA1_Channel1;
+    handle_GPDMA1_Channel1.Init.Request = GPDMA1_REQUEST_I2C2_TX;
+    handle_GPDMA1_Channel1.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+    handle_GPDMA1_Channel1.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    handle_GPDMA1_Channel1.Init.SrcInc = DMA_SINC_INCREMENTED;
+    handle_GPDMA1_Channel1.Init.DestInc = DMA_DINC_FIXED;
+    handle_GPDMA1_Channel1.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel1.Init.DestDataWidth = DMA_DEST_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel1.Init.Priority = DMA_LOW_PRIORITY_HIGH_WEIGHT;
+    handle_GPDMA1_Channel1.Init.SrcBurstLength = 1;
+    handle_GPDMA1_Channel1.Init.DestBurstLength = 1;
+    handle_GPDMA1_Channel1.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0|DMA_DEST_ALLOCATED_PORT0;
+    handle_GPDMA1_Channel1.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    handle_GPDMA1_Channel1.Init.Mode = DMA_NORMAL;
+    if (HAL_DMA_Init(&handle_GPDMA1_Channel1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(i2cHandle, hdmatx, handle_GPDMA1_Channel1);
+    if (HAL_DMA_ConfigChannelAttributes(&handle_GPDMA1_Channel1, DMA_CHANNEL_NPRIV) != HAL_OK)
+    {
+      Error_Handler();
+    }
 
+    HAL_NVIC_SetPriority(GPDMA1_Channel0_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel0_IRQn);
+    HAL_NVIC_SetPriority(GPDMA1_Channel1_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(I2C2_EV_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C2_ER_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(I2C2_ER_IRQn);
+#endif
   /* USER CODE END I2C2_MspInit 1 */
   }
 }
@@ -130,11 +253,499 @@ void HAL_I2C_MspDeInit(I2C_HandleTypeDef* i2cHandle)
     HAL_GPIO_DeInit(MEMS_I2C_SDA_GPIO_Port, MEMS_I2C_SDA_Pin);
 
   /* USER CODE BEGIN I2C2_MspDeInit 1 */
-
+#if I2C2_USE_DMA
+    HAL_DMA_DeInit(i2cHandle->hdmarx);
+    HAL_DMA_DeInit(i2cHandle->hdmatx);
+    HAL_NVIC_DisableIRQ(I2C2_EV_IRQn);
+    HAL_NVIC_DisableIRQ(I2C2_ER_IRQn);
+#endif
   /* USER CODE END I2C2_MspDeInit 1 */
   }
 }
 
 /* USER CODE BEGIN 1 */
 
+/*Frees a slave holding SDA low after an interrupted transfer: clocks SCL by hand until SDA is released, then sends a STOP.
+ *I2C2 is left de-initialized, call i2c2_reinit to hand the pins back. Returns 0 if SDA was released.*/
+uint8_t i2c2_bus_clear(void)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  HAL_I2C_DeInit(&hi2c2);
+
+  __HAL_RCC_GPIOH_CLK_ENABLE();
+  HAL_GPIO_WritePin(GPIOH, MEMS_I2C_SCL_Pin|MEMS_I2C_SDA_Pin, GPIO_PIN_SET);
+  GPIO_InitStruct.Pin = MEMS_I2C_SCL_Pin|MEMS_I2C_SDA_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOH, &GPIO_InitStruct);
+  i2c_bus_delay();
+
+  for(uint8_t clock = 0; clock < I2C_BUS_CLEAR_CLOCKS; clock++)
+  {
+    if(HAL_GPIO_ReadPin(MEMS_I2C_SDA_GPIO_Port, MEMS_I2C_SDA_Pin) == GPIO_PIN_SET)
+    {
+      break;
+    }
+    HAL_GPIO_WritePin(MEMS_I2C_SCL_GPIO_Port, MEMS_I2C_SCL_Pin, GPIO_PIN_RESET);
+    i2c_bus_delay();
+    HAL_GPIO_WritePin(MEMS_I2C_SCL_GPIO_Port, MEMS_I2C_SCL_Pin, GPIO_PIN_SET);
+    i2c_bus_delay();
+  }
+
+  /*STOP: SDA rises while SCL is high*/
+  HAL_GPIO_WritePin(MEMS_I2C_SCL_GPIO_Port, MEMS_I2C_SCL_Pin, GPIO_PIN_RESET);
+  i2c_bus_delay();
+  HAL_GPIO_WritePin(MEMS_I2C_SDA_GPIO_Port, MEMS_I2C_SDA_Pin, GPIO_PIN_RESET);
+  i2c_bus_delay();
+  HAL_GPIO_WritePin(MEMS_I2C_SCL_GPIO_Port, MEMS_I2C_SCL_Pin, GPIO_PIN_SET);
+  i2c_bus_delay();
+  HAL_GPIO_WritePin(MEMS_I2C_SDA_GPIO_Port, MEMS_I2C_SDA_Pin, GPIO_PIN_SET);
+  i2c_bus_delay();
+
+  uint8_t stuck = (HAL_GPIO_ReadPin(MEMS_I2C_SDA_GPIO_Port, MEMS_I2C_SDA_Pin) != GPIO_PIN_SET);
+  HAL_GPIO_DeInit(GPIOH, MEMS_I2C_SCL_Pin|MEMS_I2C_SDA_Pin);
+  return stuck;
+}
+
+/*Resets I2C2 and re-runs its CubeMX init, which also restores the pin alternate functions*/
+void i2c2_reinit(void)
+{
+  HAL_I2C_DeInit(&hi2c2);
+  MX_I2C2_Init();
+}
+
+/*Deadline for a transfer of the given number of bytes on the wire (address and register bytes included)
+ *at the clock currently programmed into I2C2*/
+uint32_t i2c2_timeout_us(uint16_t bytes)
+{
+  uint32_t period_ns = i2c_timing_period_ns(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C2), hi2c2.Init.Timing, &i2c2_edges);
+  uint32_t bits = (uint32_t)bytes * I2C_BITS_PER_BYTE + 3U; //START, repeated START, STOP
+  return (uint32_t)(((uint64_t)bits * period_ns * I2C_TIMEOUT_MARGIN) / 1000U) + I2C_TIMEOUT_SLACK_US;
+}
+
+/*Switches I2C2 to another timing profile. Only done between transfers: returns 1 without changing anything if a
+ *transfer is active or queued, or if the kernel clock can't reach that speed.*/
+uint8_t i2c2_set_speed(I2C_Speed_t speed)
+{
+  uint32_t timing;
+  if(i2c_timing_compute(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C2), speed, &i2c2_edges, &timing) != 0)
+  {
+    return 1;
+  }
+
+  uint32_t critical = i2c2_bus_enter_critical();
+  if(i2c2_bus.active != NULL || i2c2_bus.depth != 0 || (I2C2->ISR & I2C_ISR_BUSY))
+  {
+    i2c2_bus_exit_critical(critical);
+    return 1;
+  }
+  i2c2_write_timing(timing, speed);
+  i2c2_timing = timing;
+  i2c2_speed = speed;
+  i2c2_bus_exit_critical(critical);
+  return 0;
+}
+
+I2C_Speed_t i2c2_get_speed(void)
+{
+  return i2c2_speed;
+}
+
+/*Register read: write the register address, then a repeated START and read length bytes. Polled, ends by timeout_us at the latest.*/
+I2C_Result_t i2c2_mem_read(uint8_t address, uint8_t reg, uint8_t *pdata, uint8_t length, uint32_t timeout_us)
+{
+  uint32_t deadline = i2c_deadline(timeout_us);
+  I2C_Result_t result;
+
+  if(length == 0)
+  {
+    return i2c_ok;
+  }
+  while(I2C2->ISR & I2C_ISR_BUSY)
+  {
+    if((int32_t)(DWT->CYCCNT - deadline) >= 0)
+    {
+      return i2c2_abort(i2c_timeout);
+    }
+  }
+
+  I2C2->CR2 = (address & I2C_CR2_SADD) | (1U << I2C_CR2_NBYTES_Pos) | I2C_CR2_START;
+  if((result = i2c2_wait(I2C_ISR_TXIS, deadline)) != i2c_ok)
+  {
+    return result;
+  }
+  I2C2->TXDR = reg;
+  if((result = i2c2_wait(I2C_ISR_TC, deadline)) != i2c_ok)
+  {
+    return result;
+  }
+
+  I2C2->CR2 = (address & I2C_CR2_SADD) | I2C_CR2_RD_WRN | ((uint32_t)length << I2C_CR2_NBYTES_Pos) | I2C_CR2_AUTOEND | I2C_CR2_START;
+  for(uint8_t i = 0; i < length; i++)
+  {
+    if((result = i2c2_wait(I2C_ISR_RXNE, deadline)) != i2c_ok)
+    {
+      return result;
+    }
+    pdata[i] = (uint8_t)I2C2->RXDR;
+  }
+
+  if((result = i2c2_wait(I2C_ISR_STOPF, deadline)) != i2c_ok)
+  {
+    return result;
+  }
+  I2C2->ICR = I2C_ICR_STOPCF;
+  I2C2->CR2 = 0;
+  return i2c_ok;
+}
+
+/*Register write: register address followed by length bytes in one transfer. Polled, ends by timeout_us at the latest.*/
+I2C_Result_t i2c2_mem_write(uint8_t address, uint8_t reg, const uint8_t *pdata, uint8_t length, uint32_t timeout_us)
+{
+  uint32_t deadline = i2c_deadline(timeout_us);
+  I2C_Result_t result;
+
+  while(I2C2->ISR & I2C_ISR_BUSY)
+  {
+    if((int32_t)(DWT->CYCCNT - deadline) >= 0)
+    {
+      return i2c2_abort(i2c_timeout);
+    }
+  }
+
+  I2C2->CR2 = (address & I2C_CR2_SADD) | ((uint32_t)(length + 1U) << I2C_CR2_NBYTES_Pos) | I2C_CR2_AUTOEND | I2C_CR2_START;
+  if((result = i2c2_wait(I2C_ISR_TXIS, deadline)) != i2c_ok)
+  {
+    return result;
+  }
+  I2C2->TXDR = reg;
+  for(uint8_t i = 0; i < length; i++)
+  {
+    if((result = i2c2_wait(I2C_ISR_TXIS, deadline)) != i2c_ok)
+    {
+      return result;
+    }
+    I2C2->TXDR = pdata[i];
+  }
+
+  if((result = i2c2_wait(I2C_ISR_STOPF, deadline)) != i2c_ok)
+  {
+    return result;
+  }
+  I2C2->ICR = I2C_ICR_STOPCF;
+  I2C2->CR2 = 0;
+  return i2c_ok;
+}
+
+static uint32_t i2c_deadline(uint32_t timeout_us)
+{
+  return DWT->CYCCNT + timeout_us * (SystemCoreClock / 1000000U);
+}
+
+/*Waits for an ISR flag, classifying whatever ends the transfer first*/
+static I2C_Result_t i2c2_wait(uint32_t flag, uint32_t deadline)
+{
+  for(;;)
+  {
+    uint32_t isr = I2C2->ISR;
+    if(isr & I2C_ISR_NACKF)
+    {
+      return i2c2_abort(i2c_nack);
+    }
+    if(isr & I2C_ISR_ARLO)
+    {
+      return i2c2_abort(i2c_arbitration_lost);
+    }
+    if(isr & I2C_ISR_BERR)
+    {
+      return i2c2_abort(i2c_bus_error);
+    }
+    if(isr & flag)
+    {
+      return i2c_ok;
+    }
+    if((int32_t)(DWT->CYCCNT - deadline) >= 0)
+    {
+      return i2c2_abort(i2c_timeout);
+    }
+  }
+}
+
+/*Leaves the peripheral idle after a failed transfer. Clearing PE resets the transfer state machine and flags.*/
+static I2C_Result_t i2c2_abort(I2C_Result_t result)
+{
+  I2C2->ICR = I2C_ICR_NACKCF | I2C_ICR_ARLOCF | I2C_ICR_BERRCF | I2C_ICR_STOPCF;
+  I2C2->CR2 = 0;
+  i2c2_disable();
+  I2C2->CR1 |= I2C_CR1_PE;
+  return result;
+}
+
+/*Clears PE and returns once the software reset has taken: PE reads back 0 and has stayed low for the 3 APB cycles
+ *RM0456 requires before it is set again. Every APB read takes at least one APB clock, so the read back loop plus
+ *I2C_PE_LOW_READS more reads cover it at any AHB/APB ratio.*/
+static void i2c2_disable(void)
+{
+  I2C2->CR1 &= ~I2C_CR1_PE;
+  while(I2C2->CR1 & I2C_CR1_PE)
+  {
+  }
+  for(uint32_t i = 0; i < I2C_PE_LOW_READS; i++)
+  {
+    (void)I2C2->CR1;
+  }
+}
+
+#if I2C2_USE_DMA
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if(hi2c->Instance == I2C2)
+  {
+    i2c_arbiter_complete(&i2c2_bus, i2c_ok);
+  }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if(hi2c->Instance == I2C2)
+  {
+    i2c_arbiter_complete(&i2c2_bus, i2c_ok);
+  }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+  if(hi2c->Instance != I2C2)
+  {
+    return;
+  }
+  uint32_t error = HAL_I2C_GetError(hi2c);
+  I2C_Result_t result = i2c_bus_error;
+  if(error & HAL_I2C_ERROR_AF)
+  {
+    result = i2c_nack;
+  }
+  else if(error & HAL_I2C_ERROR_ARLO)
+  {
+    result = i2c_arbitration_lost;
+  }
+  else if(error & HAL_I2C_ERROR_TIMEOUT)
+  {
+    result = i2c_timeout;
+  }
+  i2c_arbiter_complete(&i2c2_bus, result);
+}
+#endif
+
+/*Arbiter backend: starts the next queued transfer. With DMA it completes from the callbacks above, the next transfer is
+ *started from the same ISR so queued transfers run back to back.*/
+static void i2c2_bus_start(I2C_Transaction_t *transaction)
+{
+#if I2C2_USE_DMA
+  HAL_StatusTypeDef status;
+  if(transaction->read)
+  {
+    status = HAL_I2C_Mem_Read_DMA(&hi2c2, transaction->address, transaction->reg, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length);
+  }
+  else
+  {
+    status = HAL_I2C_Mem_Write_DMA(&hi2c2, transaction->address, transaction->reg, I2C_MEMADD_SIZE_8BIT, transaction->data, transaction->length);
+  }
+  if(status != HAL_OK)
+  {
+    i2c_arbiter_complete(&i2c2_bus, i2c_bus_error);
+  }
+#else
+  I2C_Result_t result;
+  if(transaction->read)
+  {
+    result = i2c2_mem_read(transaction->address, transaction->reg, transaction->data, transaction->length, i2c2_timeout_us(transaction->length + 3));
+  }
+  else
+  {
+    result = i2c2_mem_write(transaction->address, transaction->reg, transaction->data, transaction->length, i2c2_timeout_us(transaction->length + 2));
+  }
+  i2c_arbiter_complete(&i2c2_bus, result);
+#endif
+}
+
+/*Stops a transfer that ran past its deadline. Re-initializing also clears any half finished HAL state. The arbiter calls
+ *it with interrupts enabled, HAL_DMA_Abort bounds its wait with HAL_GetTick.*/
+static void i2c2_bus_abort(void)
+{
+#if I2C2_USE_DMA
+  HAL_DMA_Abort(&handle_GPDMA1_Channel0);
+  HAL_DMA_Abort(&handle_GPDMA1_Channel1);
+#endif
+  i2c2_reinit();
+}
+
+static uint32_t i2c2_bus_timestamp(void)
+{
+  return DWT->CYCCNT;
+}
+
+static uint32_t i2c2_bus_enter_critical(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+}
+
+static void i2c2_bus_exit_critical(uint32_t state)
+{
+  __set_PRIMASK(state);
+}
+
+/*TIMINGR and the Fast-mode Plus drive can only change with the peripheral disabled. hi2c2.Init.Timing is kept in step
+ *because transfer timeouts are derived from it.*/
+static void i2c2_write_timing(uint32_t timing, I2C_Speed_t speed)
+{
+  i2c2_disable();
+  hi2c2.Init.Timing = timing;
+  I2C2->TIMINGR = timing;
+  if(speed == i2c_speed_fast_plus)
+  {
+    I2C2->CR1 |= I2C_CR1_FMP;
+  }
+  else
+  {
+    I2C2->CR1 &= ~I2C_CR1_FMP;
+  }
+  __HAL_I2C_ENABLE(&hi2c2);
+}
+
+/*Hands I2C2 to a GPDMA linked list that reads on every trigger without the CPU (see lpbam.c). The kernel clock moves to
+ *HSI16, which the I2C and GPDMA1 can request on their own in Stop 0/1. Returns 1 if the bus is in use or the table can't
+ *be built. cfg's peripheral fields are filled in here, table must stay valid until i2c2_autonomous_stop.*/
+uint8_t i2c2_autonomous_start(LPBAM_I2C_Read_t *cfg, LPBAM_Table_t *table)
+{
+  uint32_t timing;
+  if(i2c_timing_compute(HSI_VALUE, i2c2_speed, &i2c2_edges, &timing) != 0)
+  {
+    return 1;
+  }
+
+  cfg->cr2_address = (uint32_t)&I2C2->CR2;
+  cfg->txdr_address = (uint32_t)&I2C2->TXDR;
+  cfg->rxdr_address = (uint32_t)&I2C2->RXDR;
+  cfg->request_tx = GPDMA1_REQUEST_I2C2_TX;
+  cfg->request_rx = GPDMA1_REQUEST_I2C2_RX;
+  cfg->request_tc = GPDMA1_REQUEST_I2C2_TX; //TCDMAEN raises the TX request on TC
+  cfg->table_address = (uint32_t)table;
+  if(lpbam_i2c_read_build(cfg, table) == 0)
+  {
+    return 1;
+  }
+
+  if(i2c_arbiter_hold(&i2c2_bus) != 0)
+  {
+    return 1;
+  }
+
+  RCC_PeriphCLKInitTypeDef PeriphClkInit = {0};
+  PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_I2C2;
+  PeriphClkInit.I2c2ClockSelection = RCC_I2C2CLKSOURCE_HSI;
+  if(HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+  {
+    i2c_arbiter_release(&i2c2_bus);
+    return 1;
+  }
+  i2c2_write_timing(timing, i2c2_speed);
+  __HAL_RCC_I2C2_CLK_SLEEP_ENABLE();
+  __HAL_RCC_GPDMA1_CLK_SLEEP_ENABLE();
+
+  I2C2->ICR = I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+  I2C2->AUTOCR = I2C_AUTOCR_TCDMAEN;
+  I2C2->CR1 |= I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN | I2C_CR1_NACKIE | I2C_CR1_ERRIE; //Errors stall the list, the IRQ restarts it
+
+  i2c2_autonomous_link = lpbam_first_link(cfg);
+  I2C2_AUTONOMOUS_CHANNEL->CLBAR = lpbam_base(cfg);
+  HAL_NVIC_SetPriority(I2C2_AUTONOMOUS_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(I2C2_AUTONOMOUS_IRQn);
+  i2c2_autonomous_restart();
+  return 0;
+}
+
+/*Stops the list and gives the bus back to the arbiter. Re-initializing restores the PCLK1 kernel clock and timing.*/
+void i2c2_autonomous_stop(void)
+{
+  if(i2c2_autonomous_link == 0)
+  {
+    return;
+  }
+  HAL_NVIC_DisableIRQ(I2C2_AUTONOMOUS_IRQn);
+  I2C2_AUTONOMOUS_CHANNEL->CCR |= DMA_CCR_SUSP;
+  while((I2C2_AUTONOMOUS_CHANNEL->CSR & (DMA_CSR_SUSPF | DMA_CSR_IDLEF)) == 0)
+  {
+  }
+  I2C2_AUTONOMOUS_CHANNEL->CCR = DMA_CCR_RESET;
+  i2c2_autonomous_link = 0;
+
+  I2C2->AUTOCR = 0;
+  I2C2->CR1 &= ~(I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN | I2C_CR1_NACKIE | I2C_CR1_ERRIE);
+  i2c2_reinit();
+  i2c_arbiter_release(&i2c2_bus);
+}
+
+/*GPDMA1 channel 2 interrupt: one call per wake_every reads, or a DMA error*/
+void i2c2_autonomous_dma_irq(void)
+{
+  uint32_t flags = I2C2_AUTONOMOUS_CHANNEL->CSR;
+  if(flags & (DMA_CSR_DTEF | DMA_CSR_ULEF | DMA_CSR_USEF))
+  {
+    I2C2_AUTONOMOUS_CHANNEL->CFCR = DMA_CFCR_DTEF | DMA_CFCR_ULEF | DMA_CFCR_USEF | DMA_CFCR_TCF;
+    i2c2_autonomous_restart();
+    i2c2_autonomous_callback(1);
+    return;
+  }
+  if(flags & DMA_CSR_TCF)
+  {
+    I2C2_AUTONOMOUS_CHANNEL->CFCR = DMA_CFCR_TCF;
+    i2c2_autonomous_callback(0);
+  }
+}
+
+/*Call first from the I2C2 event and error handlers. A NACK or bus error leaves the list waiting for a request that
+ *never comes, so the list is restarted from the first read and the slot in progress is reported lost.
+ *Returns 1 if the interrupt belonged to the autonomous reads.*/
+uint8_t i2c2_autonomous_i2c_irq(void)
+{
+  if(i2c2_autonomous_link == 0)
+  {
+    return 0;
+  }
+  I2C2->ICR = I2C_ICR_NACKCF | I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF | I2C_ICR_STOPCF;
+  i2c2_autonomous_restart();
+  i2c2_autonomous_callback(1);
+  return 1;
+}
+
+__weak void i2c2_autonomous_callback(uint8_t error)
+{
+  (void)error;
+}
+
+/*Resets the channel and points it at the first node, it loads the node on enable and waits for the trigger*/
+static void i2c2_autonomous_restart(void)
+{
+  I2C2_AUTONOMOUS_CHANNEL->CCR = DMA_CCR_RESET;
+  I2C2_AUTONOMOUS_CHANNEL->CFCR = DMA_CFCR_TCF | DMA_CFCR_HTF | DMA_CFCR_DTEF | DMA_CFCR_ULEF | DMA_CFCR_USEF | DMA_CFCR_SUSPF | DMA_CFCR_TOF;
+  I2C2_AUTONOMOUS_CHANNEL->CTR1 = 0;
+  I2C2_AUTONOMOUS_CHANNEL->CTR2 = 0;
+  I2C2_AUTONOMOUS_CHANNEL->CBR1 = 0;
+  I2C2_AUTONOMOUS_CHANNEL->CLLR = i2c2_autonomous_link;
+  I2C2_AUTONOMOUS_CHANNEL->CCR = DMA_CCR_TCIE | DMA_CCR_DTEIE | DMA_CCR_ULEIE | DMA_CCR_USEIE;
+  I2C2_AUTONOMOUS_CHANNEL->CCR |= DMA_CCR_EN;
+}
+
+/*Roughly 5-10 us, half an SCL period at 50-100 kHz whatever the core clock*/
+static void i2c_bus_delay(void)
+{
+  for(volatile uint32_t i = SystemCoreClock / 400000U; i > 0; i--)
+  {
+  }
+}
 /* USER CODE END 1 */
@@ -0,0 +1,204 @@
+/*
+ * i2c_arbiter.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "i2c_arbiter.h"
+#include <stddef.h>
+#include <string.h>
+
+/*One queue per priority level, FIFO within a level. Submitting and completing may happen from any context: the queue is
+ *only touched inside the driver's critical section, and whichever context finds the bus idle starts the next transfer.
+ *Completion starts the next queued transfer straight from the completing ISR, so back to back transfers do not wait
+ *on the main loop. A backend that completes inside start() is handled by the dispatch loop instead of by recursion.*/
+
+static void i2c_arbiter_finish(I2C_Arbiter_t *bus, I2C_Transaction_t *expected, I2C_Result_t result);
+static void i2c_arbiter_retire(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction, I2C_Result_t result, uint32_t now);
+static void i2c_arbiter_dispatch(I2C_Arbiter_t *bus);
+static I2C_Transaction_t* i2c_arbiter_pop(I2C_Arbiter_t *bus);
+
+void i2c_arbiter_init(I2C_Arbiter_t *bus, I2C_Arbiter_Drv_t drv){
+	memset(bus, 0, sizeof(*bus));
+	bus->drv = drv;
+}
+
+void i2c_arbiter_submit(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction){
+	uint8_t level = (transaction->priority < I2C_ARBITER_PRIORITIES) ? transaction->priority : (I2C_ARBITER_PRIORITIES - 1);
+
+	transaction->next = NULL;
+	transaction->result = i2c_ok;
+	transaction->queued_at = bus->drv.timestamp();
+
+	uint32_t critical = bus->drv.enter_critical();
+	transaction->state = i2c_transaction_queued;
+	if(bus->tail[level] == NULL){
+		bus->head[level] = transaction;
+	} else {
+		bus->tail[level]->next = transaction;
+	}
+	bus->tail[level] = transaction;
+	bus->depth++;
+	if(bus->depth > bus->stats.high_water){
+		bus->stats.high_water = bus->depth;
+	}
+	bus->drv.exit_critical(critical);
+
+	i2c_arbiter_dispatch(bus);
+}
+
+/*Called by the backend when the active transfer ends*/
+void i2c_arbiter_complete(I2C_Arbiter_t *bus, I2C_Result_t result){
+	i2c_arbiter_finish(bus, NULL, result);
+}
+
+/*Aborts the active transfer once it is past its timeout. Call periodically when only asynchronous transactions are used.
+ *The backend's abort waits on the peripheral with a tick based timeout of its own, so it runs with interrupts enabled:
+ *the transaction is detached first, which turns a completion racing the abort into a no-op, and nothing is started
+ *on the bus until the abort is over.*/
+void i2c_arbiter_poll(I2C_Arbiter_t *bus){
+	uint32_t critical = bus->drv.enter_critical();
+	I2C_Transaction_t *transaction = bus->active;
+	if(transaction == NULL || bus->aborting || transaction->timeout_ticks == 0 ||
+			(bus->drv.timestamp() - transaction->started_at) <= transaction->timeout_ticks){
+		bus->drv.exit_critical(critical);
+		return;
+	}
+	bus->active = NULL;
+	bus->aborting = 1;
+	bus->stats.aborted++;
+	bus->drv.exit_critical(critical);
+
+	bus->drv.abort();
+
+	uint32_t now = bus->drv.timestamp();
+	critical = bus->drv.enter_critical();
+	bus->aborting = 0;
+	i2c_arbiter_retire(bus, transaction, i2c_timeout, now);
+	bus->drv.exit_critical(critical);
+
+	if(transaction->done != NULL){
+		transaction->done(transaction);
+	}
+	i2c_arbiter_dispatch(bus);
+}
+
+/*Blocking transfer for thread context. timeout_us bounds the transfer itself, not the time spent queued behind others.*/
+I2C_Result_t i2c_arbiter_transfer(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction, uint32_t timeout_us){
+	transaction->timeout_ticks = (uint32_t)(((uint64_t)timeout_us * bus->drv.timestamp_hz) / 1000000U);
+	if(transaction->timeout_ticks == 0 && timeout_us != 0){
+		transaction->timeout_ticks = 1;
+	}
+	transaction->done = NULL;
+	i2c_arbiter_submit(bus, transaction);
+	while(transaction->state != i2c_transaction_done){
+		i2c_arbiter_poll(bus);
+	}
+	return transaction->result;
+}
+
+/*Takes the bus away from the queue, e.g. for an autonomous DMA sequence. Returns 1 without holding it if a transaction
+ *is active or queued. Blocking transfers must not be made while held, they would wait until release.*/
+uint8_t i2c_arbiter_hold(I2C_Arbiter_t *bus){
+	uint32_t critical = bus->drv.enter_critical();
+	if(bus->active != NULL || bus->depth != 0 || bus->dispatching || bus->held || bus->aborting){
+		bus->drv.exit_critical(critical);
+		return 1;
+	}
+	bus->held = 1;
+	bus->drv.exit_critical(critical);
+	return 0;
+}
+
+void i2c_arbiter_release(I2C_Arbiter_t *bus){
+	uint32_t critical = bus->drv.enter_critical();
+	bus->held = 0;
+	bus->drv.exit_critical(critical);
+	i2c_arbiter_dispatch(bus);
+}
+
+uint32_t i2c_arbiter_ticks_to_us(const I2C_Arbiter_t *bus, uint32_t ticks){
+	return (uint32_t)(((uint64_t)ticks * 1000000U) / bus->drv.timestamp_hz);
+}
+
+/*Retires the active transaction, if it is still the expected one (NULL accepts any)*/
+static void i2c_arbiter_finish(I2C_Arbiter_t *bus, I2C_Transaction_t *expected, I2C_Result_t result){
+	uint32_t now = bus->drv.timestamp();
+
+	uint32_t critical = bus->drv.enter_critical();
+	I2C_Transaction_t *transaction = bus->active;
+	if(transaction == NULL || (expected != NULL && transaction != expected)){
+		bus->drv.exit_critical(critical); //Late completion of an aborted transfer
+		return;
+	}
+	bus->active = NULL;
+	i2c_arbiter_retire(bus, transaction, result, now);
+	bus->drv.exit_critical(critical);
+
+	if(transaction->done != NULL){
+		transaction->done(transaction);
+	}
+	i2c_arbiter_dispatch(bus);
+}
+
+/*Statistics and the result of a transaction taken off the bus. Called inside the critical section.*/
+static void i2c_arbiter_retire(I2C_Arbiter_t *bus, I2C_Transaction_t *transaction, I2C_Result_t result, uint32_t now){
+	uint32_t active_ticks = now - transaction->started_at;
+	if(active_ticks > bus->stats.max_active_ticks){
+		bus->stats.max_active_ticks = active_ticks;
+	}
+	if(result == i2c_ok){
+		bus->stats.completed++;
+	} else {
+		bus->stats.failed++;
+	}
+	transaction->result = result;
+	transaction->state = i2c_transaction_done;
+}
+
+static void i2c_arbiter_dispatch(I2C_Arbiter_t *bus){
+	for(;;){
+		uint32_t critical = bus->drv.enter_critical();
+		if(bus->active != NULL || bus->dispatching || bus->held || bus->aborting){
+			bus->drv.exit_critical(critical);
+			return;
+		}
+		I2C_Transaction_t *transaction = i2c_arbiter_pop(bus);
+		if(transaction == NULL){
+			bus->drv.exit_critical(critical);
+			return;
+		}
+		uint32_t now = bus->drv.timestamp();
+		uint32_t wait = now - transaction->queued_at;
+		bus->stats.total_wait_ticks += wait;
+		if(wait > bus->stats.max_wait_ticks){
+			bus->stats.max_wait_ticks = wait;
+		}
+		transaction->started_at = now;
+		transaction->state = i2c_transaction_active;
+		bus->active = transaction;
+		bus->dispatching = 1;
+		bus->drv.exit_critical(critical);
+
+		bus->drv.start(transaction);
+
+		critical = bus->drv.enter_critical();
+		bus->dispatching = 0;
+		bus->drv.exit_critical(critical);
+	}
+}
+
+static I2C_Transaction_t* i2c_arbiter_pop(I2C_Arbiter_t *bus){
+	for(uint8_t level = 0; level < I2C_ARBITER_PRIORITIES; level++){
+		I2C_Transaction_t *transaction = bus->head[level];
+		if(transaction != NULL){
+			bus->head[level] = transaction->next;
+			if(bus->head[level] == NULL){
+				bus->tail[level] = NULL;
+			}
+			bus->depth--;
+			return transaction;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,134 @@
+/*
+ * i2c_timing.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "i2c_timing.h"
+#include <stddef.h>
+
+/*Computes TIMINGR (PRESC, SCLDEL, SDADEL, SCLH, SCLL) for the STM32 I2C v2 peripheral from the I2C-bus specification
+ *limits, the kernel clock and the board's edge times, the same way CubeMX's timing tool does: prescalers in increasing
+ *order with the shortest SCLDEL/SDADEL that fit, the shortest high phase first, and the first setting with the lowest
+ *period error wins. All times are in ps so a 160 MHz kernel period (6250 ps) stays exact.*/
+
+#define PS_PER_NS 1000U
+#define PS_PER_S 1000000000000ULL
+#define AF_DELAY_MIN_PS 50000U   /*Analog filter delay range*/
+#define AF_DELAY_MAX_PS 260000U
+#define RATE_TOLERANCE_PERCENT 20U /*Accept a bus clock within this share of the nominal rate*/
+
+typedef struct{
+	uint32_t rate_hz;
+	uint32_t hddat_min;  /*ns*/
+	uint32_t vddat_max;
+	uint32_t sudat_min;
+	uint32_t low_min;
+	uint32_t high_min;
+}I2C_Spec_t;
+
+/*Fast-mode Plus tHIGH is 260 ns in the specification, CubeMX keeps a margin over it and 270 ns reproduces its values*/
+static const I2C_Spec_t i2c_specs[i2c_speed_count] = {
+	[i2c_speed_standard]  = {100000U,  0, 3450, 250, 4700, 4000},
+	[i2c_speed_fast]      = {400000U,  0,  900, 100, 1300,  600},
+	[i2c_speed_fast_plus] = {1000000U, 0,  450,  50,  500,  270},
+};
+
+/*Input synchronizer delay added to each SCL phase: analog filter, digital filter and two kernel clocks*/
+static int64_t i2c_timing_sync(int64_t clk, const I2C_Bus_Edges_t *edges){
+	return (edges->analog_filter ? AF_DELAY_MIN_PS : 0) + ((int64_t)edges->digital_filter + 2) * clk;
+}
+
+/*Returns 0 and the register value in *timing, or 1 if the kernel clock can't meet the speed*/
+uint8_t i2c_timing_compute(uint32_t kernel_hz, I2C_Speed_t speed, const I2C_Bus_Edges_t *edges, uint32_t *timing){
+	if(speed >= i2c_speed_count || kernel_hz == 0 || edges == NULL){
+		return 1;
+	}
+	const I2C_Spec_t *spec = &i2c_specs[speed];
+	const int64_t clk = (int64_t)(PS_PER_S / kernel_hz);
+	const int64_t rise = (int64_t)edges->rise_ns * PS_PER_NS;
+	const int64_t fall = (int64_t)edges->fall_ns * PS_PER_NS;
+	const int64_t af_min = edges->analog_filter ? AF_DELAY_MIN_PS : 0;
+	const int64_t af_max = edges->analog_filter ? AF_DELAY_MAX_PS : 0;
+	const int64_t dnf = (int64_t)edges->digital_filter * clk;
+	const int64_t tsync = i2c_timing_sync(clk, edges);
+	const int64_t bus_period = (int64_t)(PS_PER_S / spec->rate_hz);
+	const int64_t period_min = (int64_t)(PS_PER_S * 100U / ((uint64_t)spec->rate_hz * (100U + RATE_TOLERANCE_PERCENT)));
+	const int64_t period_max = (int64_t)(PS_PER_S * 100U / ((uint64_t)spec->rate_hz * (100U - RATE_TOLERANCE_PERCENT)));
+
+	/*Data hold/setup windows around the SCL edges*/
+	int64_t sdadel_min = fall + (int64_t)spec->hddat_min * PS_PER_NS - af_min - ((int64_t)edges->digital_filter + 3) * clk;
+	int64_t sdadel_max = (int64_t)spec->vddat_max * PS_PER_NS - rise - af_max - ((int64_t)edges->digital_filter + 4) * clk;
+	int64_t scldel_min = rise + (int64_t)spec->sudat_min * PS_PER_NS;
+	if(sdadel_min < 0){
+		sdadel_min = 0;
+	}
+	if(sdadel_max < 0){
+		return 1;
+	}
+
+	int64_t best_error = bus_period;
+	uint32_t best = 0;
+	uint8_t found = 0;
+
+	for(uint32_t presc = 0; presc < 16; presc++){
+		const int64_t tpresc = (int64_t)(presc + 1) * clk;
+
+		uint32_t scldel = 0;
+		while(scldel < 16 && (int64_t)(scldel + 1) * tpresc < scldel_min){
+			scldel++;
+		}
+		uint32_t sdadel = 0;
+		while(sdadel < 16 && (int64_t)sdadel * tpresc < sdadel_min){
+			sdadel++;
+		}
+		if(scldel >= 16 || sdadel >= 16 || (int64_t)sdadel * tpresc > sdadel_max){
+			continue;
+		}
+
+		/*SCL high/low phases, each stretched by the input synchronizer*/
+		for(uint32_t sclh = 0; sclh < 256; sclh++){
+			const int64_t thigh = (int64_t)(sclh + 1) * tpresc + tsync;
+			if(thigh + rise + fall > period_max){
+				break; //Every longer high phase is over the period too
+			}
+			if(thigh < (int64_t)spec->high_min * PS_PER_NS || clk >= thigh){
+				continue;
+			}
+			for(uint32_t scll = 0; scll < 256; scll++){
+				const int64_t tlow = (int64_t)(scll + 1) * tpresc + tsync;
+				const int64_t tscl = tlow + thigh + rise + fall;
+				if(tlow <= (int64_t)spec->low_min * PS_PER_NS || clk >= (tlow - af_min - dnf) / 4 || tscl < period_min){
+					continue;
+				}
+				if(tscl > period_max){
+					break;
+				}
+				int64_t error = tscl > bus_period ? tscl - bus_period : bus_period - tscl;
+				if(error < best_error){
+					best_error = error;
+					best = (presc << 28) | (scldel << 20) | (sdadel << 16) | (sclh << 8) | scll;
+					found = 1;
+				}
+			}
+		}
+	}
+
+	if(!found){
+		return 1;
+	}
+	*timing = best;
+	return 0;
+}
+
+/*SCL period in ns a TIMINGR value produces on a bus with the given edges, synchronizer delays included*/
+uint32_t i2c_timing_period_ns(uint32_t kernel_hz, uint32_t timing, const I2C_Bus_Edges_t *edges){
+	if(kernel_hz == 0 || edges == NULL){
+		return 0;
+	}
+	const int64_t clk = (int64_t)(PS_PER_S / kernel_hz);
+	const int64_t tpresc = (int64_t)((timing >> 28) + 1U) * clk;
+	const int64_t tscl = (int64_t)(((timing >> 8) & 0xFFU) + 1U) * tpresc + (int64_t)((timing & 0xFFU) + 1U) * tpresc +
+			2 * i2c_timing_sync(clk, edges) + (int64_t)edges->rise_ns * PS_PER_NS + (int64_t)edges->fall_ns * PS_PER_NS;
+	return (uint32_t)((tscl + PS_PER_NS / 2) / PS_PER_NS);
+}
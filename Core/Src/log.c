@@ -10,9 +10,13 @@
 #include <stdio.h>
 #include <stdarg.h>
 
+/*Log text shares the USART1 TX ring with telemetry frames. A full ring is waited out like the old blocking transmit,
+ *unless interrupts are masked or the UART is not up yet, in which case the character is dropped.*/
 int __io_putchar(int ch){
 	uint8_t pchar = ch;
-	HAL_UART_Transmit(&huart1, &pchar, 1, HAL_MAX_DELAY);
+	while(usart1_tx_pending() >= USART1_TX_RING_SIZE && huart1.gState != HAL_UART_STATE_RESET &&
+			__get_PRIMASK() == 0 && __get_IPSR() == 0);
+	usart1_write(&pchar, 1);
 	return ch;
 }
 
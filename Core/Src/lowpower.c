@@ -0,0 +1,163 @@
+/*
+ * lowpower.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "lowpower.h"
+#include "main.h"
+#include <stddef.h>
+
+extern void *_sbrk(ptrdiff_t incr);
+extern uint8_t _estack;
+
+/*LPTIM1 runs free from LSI with ARR = 0xFFFF so CNT doubles as a timestamp that keeps counting in Stop 2.
+ *Compare channel 1 is advanced by one period on every match to generate the sample trigger.*/
+static uint16_t period;
+
+/*Main SRAM pages that can lose their content in Stop. SRAM4 is not listed, it is always retained and holds what must
+ *survive: DMA tables and the sample store.*/
+static const struct{
+	uint32_t base;
+	uint32_t size;
+	uint32_t retention;
+}lowpower_sram_pages[] = {
+	{SRAM1_BASE + 0x00000U, 0x10000U, PWR_SRAM1_PAGE1_STOP},
+	{SRAM1_BASE + 0x10000U, 0x10000U, PWR_SRAM1_PAGE2_STOP},
+	{SRAM1_BASE + 0x20000U, 0x10000U, PWR_SRAM1_PAGE3_STOP},
+	{SRAM2_BASE + 0x00000U, 0x02000U, PWR_SRAM2_PAGE1_STOP},
+	{SRAM2_BASE + 0x02000U, 0x0E000U, PWR_SRAM2_PAGE2_STOP},
+	{SRAM3_BASE + 0x00000U, 0x10000U, PWR_SRAM3_PAGE1_STOP},
+	{SRAM3_BASE + 0x10000U, 0x10000U, PWR_SRAM3_PAGE2_STOP},
+	{SRAM3_BASE + 0x20000U, 0x10000U, PWR_SRAM3_PAGE3_STOP},
+	{SRAM3_BASE + 0x30000U, 0x10000U, PWR_SRAM3_PAGE4_STOP},
+	{SRAM3_BASE + 0x40000U, 0x10000U, PWR_SRAM3_PAGE5_STOP},
+	{SRAM3_BASE + 0x50000U, 0x10000U, PWR_SRAM3_PAGE6_STOP},
+	{SRAM3_BASE + 0x60000U, 0x10000U, PWR_SRAM3_PAGE7_STOP},
+	{SRAM3_BASE + 0x70000U, 0x10000U, PWR_SRAM3_PAGE8_STOP},
+};
+
+/*Room below the current stack pointer for the frames pushed between here and WFI*/
+#define LOWPOWER_STACK_GUARD 0x400U
+
+/*Writes a LPTIM register that is synchronized to the kernel clock and waits for the update to complete*/
+static void lowpower_timer_write(__IO uint32_t *reg, uint32_t value, uint32_t ok_flag){
+	*reg = value;
+	while((LPTIM1->ISR & ok_flag) == 0);
+	LPTIM1->ICR = ok_flag;
+}
+
+void lowpower_timer_init(void){
+	RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+	RCC_OscInitStruct.LSIState = RCC_LSI_ON;
+	RCC_OscInitStruct.LSIDiv = RCC_LSI_DIV1;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+	if(HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK){
+		Error_Handler();
+	}
+
+	__HAL_RCC_LPTIM1_CONFIG(RCC_LPTIM1CLKSOURCE_LSI);
+	__HAL_RCC_LPTIM1_CLK_ENABLE();
+	__HAL_RCC_LPTIM1_CLKAM_ENABLE(); //Keep LPTIM1 clocked in Stop 0/1/2
+
+	HAL_NVIC_SetPriority(LPTIM1_IRQn, 0, 0);
+}
+
+void lowpower_timer_start(uint8_t prescaler_log2, uint16_t period_ticks){
+	lowpower_timer_stop();
+	period = period_ticks;
+
+	LPTIM1->CFGR = (prescaler_log2 << LPTIM_CFGR_PRESC_Pos) & LPTIM_CFGR_PRESC; //Prescaler can only change while disabled
+	LPTIM1->CCMR1 = 0;
+	LPTIM1->CR = LPTIM_CR_ENABLE;
+	lowpower_timer_write(&LPTIM1->DIER, LPTIM_DIER_CC1IE, LPTIM_ISR_DIEROK);
+	lowpower_timer_write(&LPTIM1->ARR, 0xFFFFU, LPTIM_ISR_ARROK);
+	lowpower_timer_write(&LPTIM1->CCR1, period_ticks, LPTIM_ISR_CMP1OK);
+	LPTIM1->CR |= LPTIM_CR_CNTSTRT;
+
+	HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+}
+
+/*Hardware trigger for DMA: the counter wraps every period and channel 1 pulses mid period with no interrupt.
+ *lowpower_timer_read is not a free running timestamp in this mode.*/
+void lowpower_timer_start_periodic(uint8_t prescaler_log2, uint16_t period_ticks){
+	lowpower_timer_stop();
+	period = period_ticks;
+
+	LPTIM1->CFGR = (prescaler_log2 << LPTIM_CFGR_PRESC_Pos) & LPTIM_CFGR_PRESC;
+	LPTIM1->CCMR1 = LPTIM_CCMR1_CC1E;
+	LPTIM1->CR = LPTIM_CR_ENABLE;
+	lowpower_timer_write(&LPTIM1->ARR, period_ticks - 1U, LPTIM_ISR_ARROK);
+	lowpower_timer_write(&LPTIM1->CCR1, period_ticks / 2U, LPTIM_ISR_CMP1OK);
+	LPTIM1->CR |= LPTIM_CR_CNTSTRT;
+}
+
+void lowpower_timer_stop(void){
+	HAL_NVIC_DisableIRQ(LPTIM1_IRQn);
+	LPTIM1->CR = 0;
+	HAL_NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+}
+
+/*CNT is clocked asynchronously, two consecutive equal reads are required for a reliable value*/
+uint16_t lowpower_timer_read(void){
+	uint32_t first;
+	uint32_t second = LPTIM1->CNT;
+	do{
+		first = second;
+		second = LPTIM1->CNT;
+	}while(first != second);
+	return (uint16_t)second;
+}
+
+void lowpower_timer_irq(void){
+	if((LPTIM1->ISR & LPTIM_ISR_CC1IF) != 0){
+		LPTIM1->ICR = LPTIM_ICR_CC1CF;
+		LPTIM1->CCR1 = (uint16_t)(LPTIM1->CCR1 + period); //CMP1OK is cleared lazily, next write is a full period away
+		lowpower_timer_callback();
+	}
+}
+
+__weak void lowpower_timer_callback(void){
+
+}
+
+/*Stop 1 keeps GPDMA1 and I2C1/2/4 able to run autonomously on a kernel clock request, Stop 2 does not*/
+void lowpower_enter_stop1(void){
+	HAL_SuspendTick();
+	HAL_PWREx_EnterSTOP1Mode(PWR_STOPENTRY_WFI);
+	SystemClock_Config();
+	HAL_ResumeTick();
+}
+
+/*Powers down every main SRAM page in Stop that holds neither .data/.bss/heap (from the bottom of RAM up to the heap
+ *break) nor the live stack (at the top of RAM). Those pages come back with undefined content, which is fine since nothing
+ *is there. Runs on every entry as the heap and stack move.*/
+void lowpower_trim_sram_retention(void){
+	uint32_t heap_end = (uint32_t)_sbrk(0);
+	uint32_t stack_low = __get_MSP() - LOWPOWER_STACK_GUARD;
+	uint32_t stack_high = (uint32_t)&_estack;
+
+	for(uint32_t i = 0; i < sizeof(lowpower_sram_pages) / sizeof(lowpower_sram_pages[0]); i++){
+		uint32_t start = lowpower_sram_pages[i].base;
+		uint32_t end = start + lowpower_sram_pages[i].size;
+		if(start < heap_end || (end > stack_low && start < stack_high)){
+			HAL_PWREx_EnableRAMsContentStopRetention(lowpower_sram_pages[i].retention);
+		} else {
+			HAL_PWREx_DisableRAMsContentStopRetention(lowpower_sram_pages[i].retention);
+		}
+	}
+	HAL_PWREx_EnableRAMsContentStopRetention(PWR_SRAM4_FULL_STOP);
+}
+
+/*Enters Stop 2 and restores the system clock on wake up. Call with interrupts masked, any pending IRQ still wakes the core.*/
+void lowpower_enter_stop2(void){
+	lowpower_trim_sram_retention();
+	HAL_SuspendTick();
+	HAL_PWREx_EnterSTOP2Mode(PWR_STOPENTRY_WFI);
+	SystemClock_Config(); //Wake up runs from MSI, bring the PLL back
+	HAL_ResumeTick();
+}
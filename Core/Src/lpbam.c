@@ -0,0 +1,107 @@
+/*
+ * lpbam.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "lpbam.h"
+#include <stddef.h>
+#include <string.h>
+
+/*Builds the linked list for a triggered I2C register read. Each read is four nodes:
+ *  1. trigger -> CR2: write 1 byte with START (software request, held until the trigger edge)
+ *  2. TXIS    -> TXDR: the register address
+ *  3. TC      -> CR2: read length bytes with repeated START and AUTOEND
+ *  4. RXNE    -> ring slot: the data, raising the transfer complete event on every wake_every'th read
+ *The last node links back to the first so the ring fills forever. Field positions are from RM0456 (GPDMA and I2C),
+ *kept local so this file builds without the device headers.*/
+
+#define CTR1_SDW_BYTE (0U << 0)
+#define CTR1_SDW_WORD (2U << 0)
+#define CTR1_SINC (1U << 3)
+#define CTR1_DDW_BYTE (0U << 16)
+#define CTR1_DDW_WORD (2U << 16)
+#define CTR1_DINC (1U << 19)
+
+#define CTR2_REQSEL_Pos 0U
+#define CTR2_SWREQ (1U << 9)
+#define CTR2_DREQ (1U << 10)        /*Request comes from the destination peripheral*/
+#define CTR2_TRIGM_BLOCK (0U << 14)
+#define CTR2_TRIGSEL_Pos 16U
+#define CTR2_TRIGPOL_RISING (1U << 24)
+#define CTR2_TCEM_BLOCK (0U << 30)  /*Event at the end of this node's block*/
+#define CTR2_TCEM_LAST (3U << 30)   /*Event at the end of the last node, never reached by a circular list*/
+
+#define CLLR_LA_Msk 0xFFFCU
+#define CLLR_LINEAR_UPDATE ((1U << 31) | (1U << 30) | (1U << 29) | (1U << 28) | (1U << 27) | (1U << 16)) /*UT1 UT2 UB1 USA UDA ULL*/
+
+#define CR2_RD_WRN (1U << 10)
+#define CR2_START (1U << 13)
+#define CR2_NBYTES_Pos 16U
+#define CR2_AUTOEND (1U << 25)
+
+static uint32_t lpbam_node_address(const LPBAM_I2C_Read_t *cfg, uint16_t index){
+	return cfg->table_address + offsetof(LPBAM_Table_t, nodes) + (uint32_t)index * sizeof(LPBAM_Node_t);
+}
+
+static uint32_t lpbam_link(const LPBAM_I2C_Read_t *cfg, uint16_t index){
+	return (lpbam_node_address(cfg, index) & CLLR_LA_Msk) | CLLR_LINEAR_UPDATE;
+}
+
+static void lpbam_node(LPBAM_Node_t *node, uint32_t ctr1, uint32_t ctr2, uint32_t bytes, uint32_t src, uint32_t dst){
+	node->ctr1 = ctr1;
+	node->ctr2 = ctr2;
+	node->cbr1 = bytes;
+	node->csar = src;
+	node->cdar = dst;
+}
+
+/*Returns the number of nodes written, 0 if the configuration can't be expressed*/
+uint16_t lpbam_i2c_read_build(const LPBAM_I2C_Read_t *cfg, LPBAM_Table_t *table){
+	if(cfg->slots == 0 || cfg->slots > LPBAM_MAX_SLOTS || cfg->length == 0 || cfg->slot_size < cfg->length ||
+			cfg->wake_every == 0 || (cfg->slots % cfg->wake_every) != 0 || (cfg->table_address & 3U) != 0){
+		return 0;
+	}
+	uint16_t count = (uint16_t)(cfg->slots * LPBAM_NODES_PER_READ);
+	if((cfg->table_address >> 16) != ((lpbam_node_address(cfg, count) - 1U) >> 16)){
+		return 0;
+	}
+
+	memset(table, 0, sizeof(*table));
+	table->cr2_write = cfg->device_address | (1U << CR2_NBYTES_Pos) | CR2_START;
+	table->cr2_read = cfg->device_address | CR2_RD_WRN | ((uint32_t)cfg->length << CR2_NBYTES_Pos) | CR2_AUTOEND | CR2_START;
+	table->reg = cfg->reg;
+
+	const uint32_t cr2_write = cfg->table_address + offsetof(LPBAM_Table_t, cr2_write);
+	const uint32_t cr2_read = cfg->table_address + offsetof(LPBAM_Table_t, cr2_read);
+	const uint32_t reg = cfg->table_address + offsetof(LPBAM_Table_t, reg);
+	const uint32_t triggered = CTR2_SWREQ | ((uint32_t)cfg->trigger << CTR2_TRIGSEL_Pos) | CTR2_TRIGPOL_RISING | CTR2_TRIGM_BLOCK;
+
+	for(uint16_t slot = 0; slot < cfg->slots; slot++){
+		LPBAM_Node_t *node = &table->nodes[slot * LPBAM_NODES_PER_READ];
+		uint32_t wake = (((slot + 1U) % cfg->wake_every) == 0) ? CTR2_TCEM_BLOCK : CTR2_TCEM_LAST;
+
+		lpbam_node(&node[0], CTR1_SDW_WORD | CTR1_DDW_WORD, triggered | CTR2_TCEM_LAST, 4, cr2_write, cfg->cr2_address);
+		lpbam_node(&node[1], CTR1_SDW_BYTE | CTR1_DDW_BYTE, ((uint32_t)cfg->request_tx << CTR2_REQSEL_Pos) | CTR2_DREQ | CTR2_TCEM_LAST,
+				1, reg, cfg->txdr_address);
+		lpbam_node(&node[2], CTR1_SDW_WORD | CTR1_DDW_WORD, ((uint32_t)cfg->request_tc << CTR2_REQSEL_Pos) | CTR2_DREQ | CTR2_TCEM_LAST,
+				4, cr2_read, cfg->cr2_address);
+		lpbam_node(&node[3], CTR1_SDW_BYTE | CTR1_DDW_BYTE | CTR1_DINC, ((uint32_t)cfg->request_rx << CTR2_REQSEL_Pos) | wake,
+				cfg->length, cfg->rxdr_address, cfg->ring_address + (uint32_t)slot * cfg->slot_size);
+	}
+
+	for(uint16_t i = 0; i < count; i++){
+		table->nodes[i].cllr = lpbam_link(cfg, (uint16_t)((i + 1U) % count));
+	}
+	return count;
+}
+
+/*Value for the channel's CLBAR*/
+uint32_t lpbam_base(const LPBAM_I2C_Read_t *cfg){
+	return cfg->table_address & 0xFFFF0000U;
+}
+
+/*Value for the channel's CLLR before enabling it: with BNDT at 0 the channel starts by loading the first node*/
+uint32_t lpbam_first_link(const LPBAM_I2C_Read_t *cfg){
+	return lpbam_link(cfg, 0);
+}
@@ -25,6 +25,17 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "IIS2MDC_LowPower.h"
+#include "event.h"
+#include "IIS2MDC_Detector.h"
+#include "IIS2MDC_Adaptive.h"
+#include "IIS2MDC_Autonomous.h"
+#include "IIS2MDC_Queue.h"
+#include "IIS2MDC_Store.h"
+#include "IIS2MDC_Compress.h"
+#include "IIS2MDC_Telemetry.h"
+#include "i2c.h"
+#include "log.h"
 
 /* USER CODE END Includes */
 
@@ -35,6 +46,22 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define SENSOR_DUTY_CYCLED 0 /*1: one-shot conversions paced by LPTIM1 with Stop 2 in between samples*/
+#define SENSOR_PERIOD_MS 1000
+#define SENSOR_STORE_BURST 64 /*Duty cycled samples wait in the SRAM4 store and are drained into the log in bursts of this size*/
+#define SENSOR_AUTONOMOUS 0 /*1: DMA reads the sensor every SENSOR_AUTONOMOUS_PERIOD_MS in Stop 1, one wake up per block*/
+#define SENSOR_AUTONOMOUS_PERIOD_MS 100
+#define SENSOR_AUTONOMOUS_ODR IIS2MDC_10Hz /*One conversion per read, a faster ODR overwrites unread samples*/
+#define SENSOR_AUTONOMOUS_BLOCK 8
+#define SENSOR_ZERO_COPY 0 /*1: DRDY reads by DMA straight into SensorQueue slots, consumed in place by the main loop*/
+#define SENSOR_QUEUE_LENGTH 512 /*Power of 2, holds the whole log so it can be inspected in place*/
+#define SENSOR_COMPRESS 0 /*1 with SENSOR_ZERO_COPY: calibrated samples are also delta/Rice encoded into SensorStream*/
+#define SENSOR_STREAM_BYTES 2048
+#define SENSOR_KEY_INTERVAL 100
+#define SENSOR_TELEMETRY 0 /*1: samples are also streamed as COBS/CRC16 frames over USART1 by DMA, see Tools/telemetry_ingest.c*/
+#define SENSOR_TELEMETRY_FRAME 16 /*Samples per frame*/
+#define SENSOR_ADAPTIVE_ODR 1 /*Continuous mode only: ODR and power mode follow motion, 10 Hz low power while still*/
+#define SENSOR_LOG_LENGTH 500
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -46,20 +73,47 @@
 
 /* USER CODE BEGIN PV */
 IIS2MDC_Handle_t Sensor;
+IIS2MDC_LowPower_t SensorLowPower;
+IIS2MDC_Detector_t SensorDetector;
+IIS2MDC_Adaptive_t SensorAdaptive;
+IIS2MDC_Autonomous_t SensorAutonomous;
+#if SENSOR_TELEMETRY
+IIS2MDC_Telemetry_t SensorTelemetry;
+#endif
+#if SENSOR_DUTY_CYCLED
+IIS2MDC_Store_t SensorStore __attribute__((section(".sram4"))); //Retained in Stop and across resets, main SRAM need not be
+#endif
+#if SENSOR_ZERO_COPY
+IIS2MDC_Queue_t SensorQueue;
+int16_t SensorQueueRaw[3 * SENSOR_QUEUE_LENGTH];
+int16_t SensorQueueCalibrated[3 * SENSOR_QUEUE_LENGTH];
+uint32_t SensorQueueTimestamps[SENSOR_QUEUE_LENGTH];
+uint8_t SensorQueueEpochs[SENSOR_QUEUE_LENGTH];
+#if SENSOR_COMPRESS
+IIS2MDC_Encoder_t SensorEncoder;
+uint8_t SensorStream[SENSOR_STREAM_BYTES]; //One block, decode with IIS2MDC_Decoder_Decode on a PC
+uint16_t SensorStreamLength;
+#endif
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void SystemPower_Config(void);
 /* USER CODE BEGIN PFP */
+void SensorInitStart();
 void SensorInit();
+void SensorAnomalyNotify(void);
+void SensorQueueNotify(void);
+void SensorLogSample(IIS2MDC_Handle_t *Dev, uint8_t IntSource);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
-float MagXLog[500];
-float MagYLog[500];
-float MagZLog[500];
+float MagXLog[SENSOR_LOG_LENGTH];
+float MagYLog[SENSOR_LOG_LENGTH];
+float MagZLog[SENSOR_LOG_LENGTH];
+uint16_t SensorLogCount;
 /* USER CODE END 0 */
 
 /**
@@ -88,6 +142,7 @@ int main(void)
   SystemPower_Config();
 
   /* USER CODE BEGIN SysInit */
+  SensorInitStart(); //Sensor boots while the rest of the peripherals are brought up
 
   /* USER CODE END SysInit */
 
@@ -95,8 +150,12 @@ int main(void)
   MX_ICACHE_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
+  event_init();
   SensorInit();
+#if !SENSOR_DUTY_CYCLED && !SENSOR_AUTONOMOUS
   uint32_t stop_time = HAL_GetTick() + 5000;
+  uint16_t anomalies = 0;
+#endif
   uint16_t samples = 0;
   uint32_t profiler = 0;
   /* USER CODE END 2 */
@@ -105,15 +164,106 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  while(HAL_GetTick() < stop_time){
-		  if(Sensor.DataReadyFlag == IIS2MDC_DataReady){
-			  IIS2MDC_ReadMagnetic(&Sensor);
-			  MagXLog[samples] = Sensor.MagX;
-			  MagYLog[samples] = Sensor.MagY;
-			  MagZLog[samples] = Sensor.MagZ;
-			  samples++;
+#if SENSOR_DUTY_CYCLED
+	  if(samples < SENSOR_LOG_LENGTH){ //Runs once, then reports
+		  while(samples < SENSOR_LOG_LENGTH){ //SysTick is suspended in Stop 2, so run by sample count
+			  if(IIS2MDC_LowPower_Process(&SensorLowPower) == IIS2MDC_DataReady){
+				  const int32_t field[3] = {Sensor.MagX, Sensor.MagY, Sensor.MagZ};
+				  IIS2MDC_Store_Append(&SensorStore, field, IIS2MDC_LowPower_ElapsedMs(&SensorLowPower));
+			  }
+			  uint16_t burst_size = (SENSOR_LOG_LENGTH - samples < SENSOR_STORE_BURST) ? SENSOR_LOG_LENGTH - samples : SENSOR_STORE_BURST; //Whatever the log can't take stays in the store
+			  if(SensorStore.Header.Count >= burst_size){
+				  IIS2MDC_StoreSample_t burst[SENSOR_STORE_BURST];
+				  uint16_t count = IIS2MDC_Store_Drain(&SensorStore, burst, burst_size);
+				  for(uint16_t i = 0; i < count; i++){
+					  MagXLog[samples] = burst[i].Field[0];
+					  MagYLog[samples] = burst[i].Field[1];
+					  MagZLog[samples] = burst[i].Field[2];
+					  samples++;
+				  }
+			  }
 		  }
+		  uint16_t sleep_permille = IIS2MDC_LowPower_SleepPermille(&SensorLowPower);
+		  _log(log_iis2mdc, "Low Power: %u samples, asleep %u permille.", samples, sleep_permille);
 	  }
+#elif SENSOR_AUTONOMOUS
+	  if(samples < SENSOR_LOG_LENGTH){ //Runs once, then reports
+		  while(samples < SENSOR_LOG_LENGTH){ //SysTick is suspended in Stop 1, so run by sample count
+			  IIS2MDC_Autonomous_Process(&SensorAutonomous); //Samples are logged by the data ready callback
+			  samples = SensorLogCount;
+		  }
+		  _log(log_iis2mdc, "Autonomous: %u samples, %lu wake ups, %lu blocks dropped, %lu errors.", samples,
+				  (unsigned long)SensorAutonomous.Stats.Wakeups, (unsigned long)SensorAutonomous.Stats.Dropped,
+				  (unsigned long)SensorAutonomous.Stats.Errors);
+	  }
+	  event_wait(); //Nothing left to log, sleep instead of spinning on profiler
+#else
+	  if(HAL_GetTick() < stop_time && samples < SENSOR_LOG_LENGTH){ //Runs once, then reports
+		  while(HAL_GetTick() < stop_time && samples < SENSOR_LOG_LENGTH){
+			  switch(event_wait()){ //Sleeps in WFI until an interrupt, SysTick wakes it at least every 1 ms
+			  case event_iis2mdc_drdy:
+				  if(IIS2MDC_ServiceIRQ(&Sensor) == IIS2MDC_DataReady){ //Decodes DRDY vs threshold IRQs without a status poll
+					  MagXLog[samples] = Sensor.MagX;
+					  MagYLog[samples] = Sensor.MagY;
+					  MagZLog[samples] = Sensor.MagZ;
+					  samples++;
+					  const int32_t field[3] = {Sensor.MagX, Sensor.MagY, Sensor.MagZ};
+					  IIS2MDC_Detector_Process(&SensorDetector, field, HAL_GetTick());
+#if SENSOR_TELEMETRY
+					  IIS2MDC_Telemetry_Append(&SensorTelemetry, field, HAL_GetTick());
+#endif
+#if SENSOR_ADAPTIVE_ODR
+					  IIS2MDC_Adaptive_Process(&SensorAdaptive, field, HAL_GetTick());
+#endif
+				  }
+				  break;
+#if SENSOR_ZERO_COPY
+			  case event_iis2mdc_samples: {
+				  const int16_t *raw;
+				  const uint32_t *timestamps;
+				  uint16_t count;
+				  while((count = IIS2MDC_Queue_Acquire(&SensorQueue, &raw, &timestamps)) != 0){
+					  const int16_t *calibrated = IIS2MDC_Queue_Calibrated(&SensorQueue, 0, count); //The detector looks at every sample
+					  for(uint16_t i = 0; i < count; i++){
+						  int32_t field[3];
+						  IIS2MDC_ScaleBlock(&calibrated[3 * i], field, 1);
+						  IIS2MDC_Detector_Process(&SensorDetector, field, timestamps[i]);
+#if SENSOR_COMPRESS
+						  if(SensorStreamLength + 2 * IIS2MDC_COMPRESS_MAX_BYTES <= SENSOR_STREAM_BYTES){ //Room left to flush
+							  SensorStreamLength += IIS2MDC_Encoder_Encode(&SensorEncoder, &calibrated[3 * i], timestamps[i], &SensorStream[SensorStreamLength]);
+						  }
+#endif
+					  }
+					  samples += count;
+					  IIS2MDC_Queue_Release(&SensorQueue, count);
+				  }
+				  break;
+			  }
+#endif
+			  case event_iis2mdc_anomaly: {
+				  IIS2MDC_DetectorEvent_t anomaly;
+				  while(IIS2MDC_Detector_GetEvent(&SensorDetector, &anomaly)){
+					  anomalies++;
+				  }
+				  break;
+			  }
+			  default:
+				  if(Sensor.BusState != IIS2MDC_BusOk){
+					  IIS2MDC_RecoverBus(&Sensor); //DRDY stays high while the bus is down, so no edge will arrive to drive recovery
+				  }
+				  break;
+			  }
+		  }
+#if SENSOR_ZERO_COPY && SENSOR_COMPRESS
+		  SensorStreamLength += IIS2MDC_Encoder_Flush(&SensorEncoder, &SensorStream[SensorStreamLength]); //The window can end before the log fills, the last bits are still pending
+#endif
+#if SENSOR_TELEMETRY
+		  IIS2MDC_Telemetry_Flush(&SensorTelemetry); //The log length is not a multiple of the frame, send the rest
+#endif
+		  _log(log_iis2mdc, "Event loop: %u samples, %u anomalies, idle %u permille.", samples, anomalies, event_idle_permille()); //Headroom left at the configured ODR
+	  }
+	  event_wait();
+#endif
 	  profiler++;
     /* USER CODE END WHILE */
 
@@ -189,7 +339,7 @@ static void SystemPower_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-void SensorInit(){
+void SensorInitStart(){
 	IIS2MDC_InitStruct_t InitSettings = {
 			.DataRate= IIS2MDC_20Hz,
 			.DrdyPinMode = IIS2MDC_DrdyOnPin,
@@ -206,7 +356,100 @@ void SensorInit(){
 			.Offset_Z = 0
 	};
 
-	IIS2MDC_Init(InitSettings, &Sensor, IIS2MDC_Hardware_Drv);
+#if SENSOR_DUTY_CYCLED
+	InitSettings.OperatingMode = IIS2MDC_OneShotMode;
+#elif SENSOR_AUTONOMOUS
+	InitSettings.DataRate = SENSOR_AUTONOMOUS_ODR;
+	InitSettings.DrdyPinMode = IIS2MDC_DrdySignalDisabled; //Reads are timed by LPTIM1, whose clock drifts against the sensor's, so the odd slot reads stale or overran
+#endif
+	IIS2MDC_InitStart(InitSettings, &Sensor, IIS2MDC_Hardware_Drv);
+}
+
+void SensorInit(){
+	IIS2MDC_InitComplete(&Sensor);
+#if SENSOR_TELEMETRY
+	if(IIS2MDC_Telemetry_Init(&SensorTelemetry, IIS2MDC_Telemetry_Hardware_Drv, SENSOR_TELEMETRY_FRAME) != IIS2MDC_Ok){
+		Error_Handler();
+	}
+	IIS2MDC_Telemetry_AttachSensor(&SensorTelemetry, &Sensor);
+#endif
+#if SENSOR_DUTY_CYCLED
+	uint16_t recovered = IIS2MDC_Store_Init(&SensorStore);
+	if(recovered){
+		_log(log_iis2mdc, "Store: %u records kept from before reset.", recovered);
+	}
+	if(IIS2MDC_LowPower_Init(&SensorLowPower, &Sensor, IIS2MDC_LowPower_Hardware_Drv, SENSOR_PERIOD_MS) != IIS2MDC_Ok){
+		Error_Handler();
+	}
+#elif SENSOR_AUTONOMOUS
+	IIS2MDC_RegisterCallback(&Sensor, IIS2MDC_DataReadyCallback, SensorLogSample);
+	if(IIS2MDC_Autonomous_Init(&SensorAutonomous, &Sensor, IIS2MDC_Autonomous_Hardware_Drv, SENSOR_AUTONOMOUS_PERIOD_MS,
+			SENSOR_AUTONOMOUS_BLOCK) != IIS2MDC_Ok){
+		Error_Handler();
+	}
+#elif SENSOR_ZERO_COPY
+	IIS2MDC_QueueStorage_t QueueStorage = {
+			.Raw = SensorQueueRaw,
+			.Calibrated = SensorQueueCalibrated,
+			.Timestamp = SensorQueueTimestamps,
+			.Epoch = SensorQueueEpochs,
+			.Length = SENSOR_QUEUE_LENGTH
+	};
+	if(IIS2MDC_Queue_Init(&SensorQueue, &Sensor, QueueStorage, SensorQueueNotify) != IIS2MDC_Ok){
+		Error_Handler();
+	}
+#if SENSOR_COMPRESS
+	IIS2MDC_Encoder_Init(&SensorEncoder, SENSOR_KEY_INTERVAL);
+#endif
+#elif SENSOR_ADAPTIVE_ODR
+	IIS2MDC_AdaptiveConfig_t AdaptiveSettings = {
+			.Levels = NULL,
+			.MotionRate = 200,  //A slow turn sweeps Earth's field at several hundred mG/s
+			.StillRate = 80,
+			.WindowMs = 250,
+			.StepUpMs = 0,
+			.StepDownMs = 2000
+	};
+	if(IIS2MDC_Adaptive_Init(&SensorAdaptive, &Sensor, AdaptiveSettings, HAL_GetTick()) != IIS2MDC_Ok){
+		Error_Handler();
+	}
+#endif
+
+	IIS2MDC_DetectorConfig_t DetectorSettings = {
+			.HighThreshold = 1000, //Earth's field is 250-650 mG, so these flag nearby magnets and ferrous objects
+			.LowThreshold = 150,
+			.RateThreshold = 4000, //mG/s, a magnet moving past. Turning the board sweeps Earth's field at under 1000 mG/s.
+			.Hysteresis = 50,
+			.RateHysteresis = 1000,
+			.Notify = SensorAnomalyNotify
+	};
+	IIS2MDC_Detector_Init(&SensorDetector, DetectorSettings);
+}
+
+void SensorAnomalyNotify(void){
+	event_post(event_iis2mdc_anomaly);
+}
+
+void SensorQueueNotify(void){
+	event_post(event_iis2mdc_samples);
+}
+
+void SensorLogSample(IIS2MDC_Handle_t *Dev, uint8_t IntSource){
+	(void)IntSource;
+	if(SensorLogCount < SENSOR_LOG_LENGTH){
+		MagXLog[SensorLogCount] = Dev->MagX;
+		MagYLog[SensorLogCount] = Dev->MagY;
+		MagZLog[SensorLogCount] = Dev->MagZ;
+		SensorLogCount++;
+	}
+}
+
+void lowpower_timer_callback(void){
+	IIS2MDC_LowPower_TimerEvent(&SensorLowPower);
+}
+
+void i2c2_autonomous_callback(uint8_t error){
+	IIS2MDC_Autonomous_BlockEvent(&SensorAutonomous, error);
 }
 /* USER CODE END 4 */
 
@@ -21,6 +21,12 @@
 #include "main.h"
 #include "stm32u5xx_it.h"
 #include "IIS2MDC.h"
+#include "IIS2MDC_Queue.h"
+#include "lowpower.h"
+#include "event.h"
+#include "i2c.h"
+#include "usart.h"
+#include "spi.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
@@ -214,8 +220,70 @@ void EXTI10_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+void LPTIM1_IRQHandler(void)
+{
+	lowpower_timer_irq();
+}
+
+void GPDMA1_Channel0_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&handle_GPDMA1_Channel0);
+}
+
+void GPDMA1_Channel1_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&handle_GPDMA1_Channel1);
+}
+
+void GPDMA1_Channel2_IRQHandler(void)
+{
+	i2c2_autonomous_dma_irq();
+}
+
+void GPDMA1_Channel3_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&handle_GPDMA1_Channel3);
+}
+
+void GPDMA1_Channel4_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&handle_GPDMA1_Channel4);
+}
+
+void SPI2_IRQHandler(void)
+{
+	HAL_SPI_IRQHandler(&hspi2);
+}
+
+void USART1_IRQHandler(void)
+{
+	HAL_UART_IRQHandler(&huart1);
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+	if(i2c2_autonomous_i2c_irq() == 0)
+	{
+		HAL_I2C_EV_IRQHandler(&hi2c2);
+	}
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+	if(i2c2_autonomous_i2c_irq() == 0)
+	{
+		HAL_I2C_ER_IRQHandler(&hi2c2);
+	}
+}
+
 void HAL_GPIO_EXTI_Rising_Callback(uint16_t GPIO_Pin)
 {
+	if(Sensor.Queue != NULL)
+	{
+		IIS2MDC_Queue_Read(Sensor.Queue, HAL_GetTick()); //DMA lands the sample straight in its queue slot
+		return;
+	}
 	Sensor.DataReadyFlag = IIS2MDC_DataReady;
+	event_post(event_iis2mdc_drdy);
 }
 /* USER CODE END 1 */
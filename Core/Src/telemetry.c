@@ -0,0 +1,111 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "telemetry.h"
+
+#define TELEMETRY_CRC_INIT 0xFFFFU
+#define TELEMETRY_CRC_POLY 0x1021U /*CRC-16/CCITT-FALSE*/
+
+uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, uint32_t length){
+	for(uint32_t i = 0; i < length; i++){
+		crc ^= (uint16_t)data[i] << 8;
+		for(uint8_t bit = 0; bit < 8; bit++){
+			crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ TELEMETRY_CRC_POLY) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/*Returns the encoded length, at most length + length / 254 + 1. No delimiter is added.*/
+uint32_t telemetry_cobs_encode(const uint8_t *in, uint32_t length, uint8_t *out){
+	uint32_t code_index = 0;
+	uint32_t n = 1;
+	uint8_t code = 1;
+	for(uint32_t i = 0; i < length; i++){
+		if(in[i] == 0){
+			out[code_index] = code;
+			code_index = n++;
+			code = 1;
+		} else {
+			out[n++] = in[i];
+			if(++code == 0xFFU){
+				out[code_index] = code;
+				code_index = n++;
+				code = 1;
+			}
+		}
+	}
+	out[code_index] = code;
+	return n;
+}
+
+/*Returns the decoded length, 0 if the input holds a zero or a code runs past its end. out may alias in.*/
+uint32_t telemetry_cobs_decode(const uint8_t *in, uint32_t length, uint8_t *out){
+	uint32_t i = 0;
+	uint32_t n = 0;
+	while(i < length){
+		uint8_t code = in[i++];
+		if(code == 0 || i + code - 1U > length){
+			return 0;
+		}
+		for(uint8_t k = 1; k < code; k++){
+			if(in[i] == 0){
+				return 0;
+			}
+			out[n++] = in[i++];
+		}
+		if(code != 0xFFU && i < length){
+			out[n++] = 0;
+		}
+	}
+	return n;
+}
+
+/*Writes a complete frame with both delimiters into out, sized with TELEMETRY_FRAME_MAX. Returns its length.
+ *Header, payload and CRC are staged at the end of out and COBS encoded forwards over themselves: the encoder's write
+ *position never catches up with its read position, so no second buffer is needed.*/
+uint32_t telemetry_frame_encode(uint8_t type, uint8_t sequence, const uint8_t *payload, uint32_t length, uint8_t *out){
+	uint32_t raw_length = length + TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES;
+	uint8_t *raw = &out[3U + raw_length / 254U];
+	raw[0] = type;
+	raw[1] = sequence;
+	for(uint32_t i = 0; i < length; i++){
+		raw[TELEMETRY_HEADER_BYTES + i] = payload[i];
+	}
+	uint16_t crc = telemetry_crc16(TELEMETRY_CRC_INIT, raw, TELEMETRY_HEADER_BYTES + length);
+	raw[TELEMETRY_HEADER_BYTES + length] = (uint8_t)crc;
+	raw[TELEMETRY_HEADER_BYTES + length + 1U] = (uint8_t)(crc >> 8);
+
+	out[0] = TELEMETRY_DELIMITER;
+	uint32_t n = 1 + telemetry_cobs_encode(raw, raw_length, &out[1]);
+	out[n++] = TELEMETRY_DELIMITER;
+	return n;
+}
+
+/*Decodes the bytes between two delimiters in place. payload points into frame on success.*/
+Telemetry_Status_t telemetry_frame_decode(uint8_t *frame, uint32_t length, uint8_t *type, uint8_t *sequence,
+		const uint8_t **payload, uint32_t *payload_length){
+	if(length < 1U + TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES){
+		return telemetry_too_short;
+	}
+	uint32_t n = telemetry_cobs_decode(frame, length, frame);
+	if(n == 0){
+		return telemetry_bad_cobs;
+	}
+	if(n < TELEMETRY_HEADER_BYTES + TELEMETRY_CRC_BYTES){
+		return telemetry_too_short;
+	}
+	uint32_t body = n - TELEMETRY_CRC_BYTES;
+	uint16_t crc = (uint16_t)frame[body] | ((uint16_t)frame[body + 1U] << 8);
+	if(telemetry_crc16(TELEMETRY_CRC_INIT, frame, body) != crc){
+		return telemetry_bad_crc;
+	}
+	*type = frame[0];
+	*sequence = frame[1];
+	*payload = &frame[TELEMETRY_HEADER_BYTES];
+	*payload_length = body - TELEMETRY_HEADER_BYTES;
+	return telemetry_ok;
+}
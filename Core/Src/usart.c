@@ -21,7 +21,18 @@
 #include "usart.h"
 
 /* USER CODE BEGIN 0 */
-
+/*TX goes through a ring drained by GPDMA1 channel 3, so nothing that writes to USART1 waits for the line.
+ *Writers run in thread context only, the DMA completion interrupt only consumes.*/
+#define USART1_TX_RING_MASK (USART1_TX_RING_SIZE - 1U)
+
+DMA_HandleTypeDef handle_GPDMA1_Channel3;
+static uint8_t usart1_tx_ring[USART1_TX_RING_SIZE];
+static volatile uint16_t usart1_tx_head;   //Free running count of bytes queued
+static volatile uint16_t usart1_tx_tail;   //Free running count of bytes sent
+static volatile uint16_t usart1_tx_active; //Length of the DMA transfer in flight, 0 when idle
+static uint32_t usart1_tx_drops;
+
+static void usart1_tx_kick(void);
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart1;
@@ -39,7 +50,7 @@ void MX_USART1_UART_Init(void)
 
   /* USER CODE END USART1_Init 1 */
   huart1.Instance = USART1;
-  huart1.Init.BaudRate = 115200;
+  huart1.Init.BaudRate = 921600;
   huart1.Init.WordLength = UART_WORDLENGTH_8B;
   huart1.Init.StopBits = UART_STOPBITS_1;
   huart1.Init.Parity = UART_PARITY_NONE;
@@ -107,7 +118,37 @@ void HAL_UART_MspInit(UART_HandleTypeDef* uartHandle)
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
   /* USER CODE BEGIN USART1_MspInit 1 */
+    __HAL_RCC_GPDMA1_CLK_ENABLE();
+
+    handle_GPDMA1_Channel3.Instance = GPDMA1_Channel3;
+    handle_GPDMA1_Channel3.Init.Request = GPDMA1_REQUEST_USART1_TX;
+    handle_GPDMA1_Channel3.Init.BlkHWRequest = DMA_BREQ_SINGLE_BURST;
+    handle_GPDMA1_Channel3.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    handle_GPDMA1_Channel3.Init.SrcInc = DMA_SINC_INCREMENTED;
+    handle_GPDMA1_Channel3.Init.DestInc = DMA_DINC_FIXED;
+    handle_GPDMA1_Channel3.Init.SrcDataWidth = DMA_SRC_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel3.Init.DestDataWidth = DMA_DEST_DATAWIDTH_BYTE;
+    handle_GPDMA1_Channel3.Init.Priority = DMA_LOW_PRIORITY_LOW_WEIGHT;
+    handle_GPDMA1_Channel3.Init.SrcBurstLength = 1;
+    handle_GPDMA1_Channel3.Init.DestBurstLength = 1;
+    handle_GPDMA1_Channel3.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0|DMA_DEST_ALLOCATED_PORT0;
+    handle_GPDMA1_Channel3.Init.TransferEventMode = DMA_TCEM_BLOCK_TRANSFER;
+    handle_GPDMA1_Channel3.Init.Mode = DMA_NORMAL;
+    if (HAL_DMA_Init(&handle_GPDMA1_Channel3) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(uartHandle, hdmatx, handle_GPDMA1_Channel3);
+    if (HAL_DMA_ConfigChannelAttributes(&handle_GPDMA1_Channel3, DMA_CHANNEL_NPRIV) != HAL_OK)
+    {
+      Error_Handler();
+    }
 
+    /*Below the sensor and bus interrupts, a late TX completion only delays the next chunk*/
+    HAL_NVIC_SetPriority(GPDMA1_Channel3_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(GPDMA1_Channel3_IRQn);
+    HAL_NVIC_SetPriority(USART1_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
   /* USER CODE END USART1_MspInit 1 */
   }
 }
@@ -130,11 +171,82 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef* uartHandle)
     HAL_GPIO_DeInit(GPIOA, DEBUG_USART_RX_Pin|DEBUG_USART_TX_Pin);
 
   /* USER CODE BEGIN USART1_MspDeInit 1 */
-
+    HAL_DMA_DeInit(uartHandle->hdmatx);
+    HAL_NVIC_DisableIRQ(GPDMA1_Channel3_IRQn);
+    HAL_NVIC_DisableIRQ(USART1_IRQn);
   /* USER CODE END USART1_MspDeInit 1 */
   }
 }
 
 /* USER CODE BEGIN 1 */
+/*Queues all of data or none of it and starts the DMA if it is idle. Returns 1 if queued. Thread context only.*/
+uint8_t usart1_write(const uint8_t *data, uint16_t length)
+{
+  uint16_t head = usart1_tx_head;
+  if (length > USART1_TX_RING_SIZE - (uint16_t)(head - usart1_tx_tail))
+  {
+    usart1_tx_drops++;
+    return 0;
+  }
+  for (uint16_t i = 0; i < length; i++)
+  {
+    usart1_tx_ring[(uint16_t)(head + i) & USART1_TX_RING_MASK] = data[i];
+  }
+  usart1_tx_head = (uint16_t)(head + length);
+  usart1_tx_kick();
+  return 1;
+}
+
+/*Bytes queued or in flight*/
+uint16_t usart1_tx_pending(void)
+{
+  return (uint16_t)(usart1_tx_head - usart1_tx_tail);
+}
+
+/*Writes refused because the ring was full*/
+uint32_t usart1_tx_dropped(void)
+{
+  return usart1_tx_drops;
+}
+
+/*Sends the oldest contiguous run of the ring. Called by writers and by the completion interrupt. A start refused
+ *because the UART is not initialized yet leaves the bytes queued for the next write.*/
+static void usart1_tx_kick(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint16_t queued = (uint16_t)(usart1_tx_head - usart1_tx_tail);
+  if (usart1_tx_active == 0 && queued != 0)
+  {
+    uint16_t start = usart1_tx_tail & USART1_TX_RING_MASK;
+    uint16_t length = (queued < USART1_TX_RING_SIZE - start) ? queued : (uint16_t)(USART1_TX_RING_SIZE - start);
+    if (HAL_UART_Transmit_DMA(&huart1, &usart1_tx_ring[start], length) == HAL_OK)
+    {
+      usart1_tx_active = length;
+    }
+  }
+  __set_PRIMASK(primask);
+}
 
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART1)
+  {
+    usart1_tx_tail = (uint16_t)(usart1_tx_tail + usart1_tx_active);
+    usart1_tx_active = 0;
+    usart1_tx_kick();
+  }
+}
+
+/*A failed chunk is dropped rather than resent, the receiver resynchronizes on the next frame delimiter*/
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART1 && usart1_tx_active != 0)
+  {
+    usart1_tx_tail = (uint16_t)(usart1_tx_tail + usart1_tx_active);
+    usart1_tx_active = 0;
+    usart1_tx_drops++;
+    usart1_tx_kick();
+  }
+}
 /* USER CODE END 1 */
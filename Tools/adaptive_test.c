@@ -0,0 +1,146 @@
+/*
+ * adaptive_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Trace replay for IIS2MDC_Adaptive with the detector running beside it, on the simulated sensor: 60 s still, 5 s
+ * rotating at 90 deg/s, then still again. Checks when the controller steps up and back down, that the level changes
+ * reach the sensor, and that the detector's rate of change reads the same at every ODR the controller picks so the
+ * rotation doesn't raise events. Uses the settings from main.c.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/adaptive_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC_Adaptive.c Core/Src/IIS2MDC_Detector.c \
+ *       Core/Src/IIS2MDC.c Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o adaptive_test -lm
+ * Run:
+ *   ./adaptive_test, exits non-zero on failure. SIM_VERBOSE=1 prints the driver log.
+ */
+#include "iis2mdc_sim.h"
+#include "IIS2MDC_Adaptive.h"
+#include "IIS2MDC_Detector.h"
+#include "test_util.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define STILL_S 60.0
+#define ROTATE_S 5.0
+#define TRACE_S 75.0
+#define HORIZONTAL_MG 400.0
+#define VERTICAL_MG (-300.0)
+#define NOISE_LSB 2
+
+static IIS2MDC_Handle_t Dev;
+static IIS2MDC_Adaptive_t Adaptive;
+static IIS2MDC_Detector_t Detector;
+
+/*Board flat, turning about the vertical at 90 deg/s during the rotation*/
+static void field(uint64_t now_us, int16_t out[3]){
+	double t = now_us / 1e6;
+	double angle = t < STILL_S ? 0 : t < STILL_S + ROTATE_S ? (t - STILL_S) * M_PI / 2 : ROTATE_S * M_PI / 2;
+	double mg[3] = {HORIZONTAL_MG * cos(angle), HORIZONTAL_MG * sin(angle), VERTICAL_MG};
+	for(int i = 0; i < 3; i++){
+		out[i] = (int16_t)(lround(mg[i] / 1.5) + rand() % (2 * NOISE_LSB + 1) - NOISE_LSB); //1.5 mG per LSB
+	}
+}
+
+int main(void){
+	static const IIS2MDC_Calibration_t identity = { //The default calibration is a particular board's soft iron
+		.Bias = {0, 0, 0},
+		.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_20Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.Calibration = &identity;
+	srand(1);
+	sim_power_on();
+	sim.field = field;
+	sim.now_us += IIS2MDC_BOOT_MS * 1000U;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+
+	/*main.c's settings*/
+	IIS2MDC_AdaptiveConfig_t AdaptiveSettings = {NULL, 0, 200, 80, 250, 0, 2000};
+	check(IIS2MDC_Adaptive_Init(&Adaptive, &Dev, AdaptiveSettings, (uint32_t)(sim.now_us / 1000U)) == IIS2MDC_Ok, "init", 0);
+	IIS2MDC_Detector_Init(&Detector, (IIS2MDC_DetectorConfig_t){1000, 150, 4000, 50, 1000, NULL});
+	uint8_t top = 3;
+
+	uint32_t samples = 0, rate_events = 0;
+	uint32_t top_at_ms = 0, left_top_at_ms = 0, level_zero_at_ms = 0;
+	uint8_t previous = Adaptive.Level, held = 1;
+	uint64_t rate_sum[4] = {0};
+	uint32_t rate_count[4] = {0};
+	while(sim.now_us < (uint64_t)(TRACE_S * 1e6)){
+		uint32_t odr = sim_odr_hz();
+		sim_advance(sim.now_us + 1000000U / odr);
+		if(IIS2MDC_ReadMagnetic(&Dev) != IIS2MDC_DataReady){
+			continue;
+		}
+		samples++;
+		uint32_t now_ms = (uint32_t)(sim.now_us / 1000U);
+		const int32_t mag[3] = {Dev.MagX, Dev.MagY, Dev.MagZ};
+		IIS2MDC_Detector_Process(&Detector, mag, now_ms);
+		uint8_t level = IIS2MDC_Adaptive_Process(&Adaptive, mag, now_ms);
+		check(sim_odr_hz() == 10U * (level == 0) + 20U * (level == 1) + 50U * (level == 2) + 100U * (level == 3),
+				"level applied to the sensor", level);
+
+		IIS2MDC_DetectorEvent_t e;
+		while(IIS2MDC_Detector_GetEvent(&Detector, &e)){
+			rate_events += e.Type == IIS2MDC_EventRateOfChange;
+		}
+		/*Skip the samples straddling the start and end of the rotation*/
+		if(now_ms > STILL_S * 1000 + 100 && now_ms < (STILL_S + ROTATE_S) * 1000){
+			uint8_t rate_level = (odr == 10) ? 0 : (odr == 20) ? 1 : (odr == 50) ? 2 : 3;
+			rate_sum[rate_level] += Detector.Rate;
+			rate_count[rate_level]++;
+		}
+
+		if(now_ms < STILL_S * 1000){
+			check(level == 0, "stays at the slowest level while still", now_ms);
+		}
+		if(level == top && previous != top && top_at_ms == 0){
+			top_at_ms = now_ms;
+		}
+		if(top_at_ms != 0 && now_ms < (STILL_S + ROTATE_S) * 1000 && level != top){
+			held = 0;
+		}
+		if(level != top && previous == top){
+			left_top_at_ms = now_ms;
+		}
+		if(level == 0 && previous != 0 && now_ms > STILL_S * 1000){
+			level_zero_at_ms = now_ms;
+		}
+		previous = level;
+	}
+
+	uint32_t latency = top_at_ms - (uint32_t)(STILL_S * 1000);
+	check(top_at_ms > STILL_S * 1000 && latency <= 250 + 1000 / 20 + 50, "top level soon after motion starts", latency);
+	check(held, "top level held through the rotation", 0);
+	uint32_t after = left_top_at_ms - (uint32_t)((STILL_S + ROTATE_S) * 1000);
+	/*Stillness is seen once the window no longer reaches back into the rotation, then each level lasts StepDownMs
+	 *plus a window*/
+	check(after >= 2000 && after <= 2000 + 2 * 250 + 10, "first step down after StepDownMs", after);
+	uint32_t back = level_zero_at_ms - (uint32_t)((STILL_S + ROTATE_S) * 1000);
+	check(back >= after + 2 * 2000 && back <= after + 2 * (2000 + 250), "back to the slowest level in three steps", back);
+	check(Adaptive.Stats.StepsUp == 1 && Adaptive.Stats.StepsDown == 3, "steps", Adaptive.Stats.StepsDown);
+	check(Adaptive.Stats.Failed == 0, "no failed level changes", Adaptive.Stats.Failed);
+	check(rate_events == 0, "rotation raises no rate events", rate_events);
+
+	/*90 deg/s sweeps the horizontal component at 400 mG * pi / 2. Sensor noise adds more per sample at 100 Hz.*/
+	const double expected = HORIZONTAL_MG * M_PI / 2;
+	printf("detector rate while rotating, expected %.0f mG/s:\n", expected);
+	for(int i = 0; i < 4; i++){
+		if(rate_count[i] == 0){
+			continue;
+		}
+		double mean = (double)rate_sum[i] / rate_count[i];
+		check(mean > expected * 0.85 && mean < expected * 1.25, "rate independent of the ODR", (long)mean);
+		printf("  level %d: %4.0f mG/s over %u samples\n", i, mean, rate_count[i]);
+	}
+	printf("motion to top level %u ms, top to first step down %u ms, back to level 0 after %u ms\n", latency, after, back);
+	for(int i = 0; i < 4; i++){
+		printf("level %d: %6.1f s\n", i, Adaptive.Stats.TimeInLevel[i] / 1000.0);
+	}
+	printf("%u samples, %u at a fixed 20 Hz, steps up %u down %u\n", samples, (uint32_t)(TRACE_S * 20), Adaptive.Stats.StepsUp,
+			Adaptive.Stats.StepsDown);
+	return test_result();
+}
@@ -0,0 +1,281 @@
+/*
+ * arbiter_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Multi-device simulation for i2c_arbiter. Three simulated devices share one bus that completes transfers from a
+ * virtual 1 MHz clock, like the DMA ISR would. Checks priority order, data integrity, wait statistics, a device that
+ * holds the bus until the timeout, a completion that races the abort, holding the bus for autonomous mode, and a
+ * backend that completes inside start().
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/arbiter_test.c Core/Src/i2c_arbiter.c -o arbiter_test
+ * Run:
+ *   ./arbiter_test, exits non-zero on failure
+ */
+#include "i2c_arbiter.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DEVICES 3
+#define FIRST_ADDRESS 0x10         /*7 bit addresses 0x10, 0x11, 0x12*/
+#define BYTE_US 90                 /*About 100 kHz*/
+
+static I2C_Arbiter_t bus;
+
+static uint32_t now_us;
+static I2C_Transaction_t *inflight;
+static uint32_t finish_at;
+static int hung_device = -1;
+static uint8_t regs[DEVICES][256];
+static int starts[32];
+static int started;
+static int depth, max_depth;
+static int masked;                 /*Critical section nesting*/
+static int abort_masked = -1;      /*Nesting seen by the last abort*/
+static uint8_t complete_in_abort;  /*The transfer's own completion fires while it is being aborted*/
+
+static int device(const I2C_Transaction_t *t){
+	return t->address / 2 - FIRST_ADDRESS;
+}
+
+static uint32_t timestamp(void){
+	return now_us;
+}
+
+static uint32_t enter_critical(void){
+	masked++;
+	return 0;
+}
+
+static void exit_critical(uint32_t state){
+	(void)state;
+	masked--;
+}
+
+static void transfer_data(I2C_Transaction_t *t){
+	if(t->read){
+		memcpy(t->data, &regs[device(t)][t->reg], t->length);
+	} else {
+		memcpy(&regs[device(t)][t->reg], t->data, t->length);
+	}
+}
+
+/*Asynchronous backend: address, register and data bytes on the wire, completed later by tick()*/
+static void start_async(I2C_Transaction_t *t){
+	inflight = t;
+	finish_at = now_us + (t->length + 3) * BYTE_US;
+	if(started < 32){
+		starts[started++] = (int)(intptr_t)t->context;
+	}
+}
+
+static void abort_transfer(void){
+	abort_masked = masked;
+	if(complete_in_abort && inflight != NULL){
+		inflight = NULL;
+		i2c_arbiter_complete(&bus, i2c_ok);
+	}
+	inflight = NULL;
+}
+
+/*One microsecond of bus time, completes the transfer in flight like the ISR would*/
+static void tick(void){
+	now_us++;
+	if(inflight != NULL && device(inflight) != hung_device && now_us >= finish_at){
+		I2C_Transaction_t *t = inflight;
+		inflight = NULL;
+		transfer_data(t);
+		i2c_arbiter_complete(&bus, i2c_ok);
+	}
+}
+
+/*Synchronous backend, the transfer is over before start() returns*/
+static void start_sync(I2C_Transaction_t *t){
+	depth++;
+	if(depth > max_depth){
+		max_depth = depth;
+	}
+	if(started < 32){
+		starts[started++] = (int)(intptr_t)t->context;
+	}
+	transfer_data(t);
+	i2c_arbiter_complete(&bus, i2c_ok);
+	depth--;
+}
+
+static void init(void (*start)(I2C_Transaction_t *transaction)){
+	i2c_arbiter_init(&bus, (I2C_Arbiter_Drv_t){start, abort_transfer, timestamp, 1000000, enter_critical, exit_critical});
+	started = 0;
+	inflight = NULL;
+}
+
+static void transaction(I2C_Transaction_t *t, int dev, uint8_t reg, uint8_t *data, uint8_t length, uint8_t priority, int id){
+	memset(t, 0, sizeof(*t));
+	t->address = (uint8_t)((FIRST_ADDRESS + dev) * 2);
+	t->reg = reg;
+	t->data = data;
+	t->length = length;
+	t->read = 1;
+	t->priority = priority;
+	t->context = (void*)(intptr_t)id;
+}
+
+static void run_until_done(I2C_Transaction_t *t){
+	for(uint32_t limit = 0; t->state != i2c_transaction_done && limit < 1000000; limit++){
+		tick();
+		i2c_arbiter_poll(&bus);
+	}
+}
+
+static void priorities(void){
+	I2C_Transaction_t t[9];
+	uint8_t data[9][6];
+	init(start_async);
+	for(int i = 0; i < 9; i++){
+		transaction(&t[i], i % DEVICES, 0x68, data[i], 6, (uint8_t)(i % DEVICES), i);
+	}
+	for(int i = 0; i < 9; i++){
+		i2c_arbiter_submit(&bus, &t[i]);
+	}
+	run_until_done(&t[8]);
+
+	/*The first starts on an idle bus, then priority 0 first and FIFO within a level*/
+	static const int expected[9] = {0, 3, 6, 1, 4, 7, 2, 5, 8};
+	for(int i = 0; i < 9; i++){
+		check(starts[i] == expected[i], "start order", starts[i]);
+		check(t[i].state == i2c_transaction_done && t[i].result == i2c_ok, "completed", i);
+		check(memcmp(data[i], &regs[i % DEVICES][0x68], 6) == 0, "data from the right device", i);
+	}
+	check(bus.stats.completed == 9 && bus.stats.failed == 0, "completed count", bus.stats.completed);
+	check(bus.stats.high_water == 8, "high water", bus.stats.high_water);
+	check(bus.stats.max_wait_ticks == 8 * 9 * BYTE_US, "longest wait is eight transfers", bus.stats.max_wait_ticks);
+	check(bus.stats.max_active_ticks == 9 * BYTE_US, "active time of one transfer", bus.stats.max_active_ticks);
+	printf("9 transactions, 3 devices: %u completed, waited %lu us on average, %u us at most\n", bus.stats.completed,
+			(unsigned long)(bus.stats.total_wait_ticks / bus.stats.completed), bus.stats.max_wait_ticks);
+}
+
+/*A transaction submitted from a completion callback jumps the queued lower priority ones*/
+static I2C_Transaction_t urgent;
+static uint8_t urgent_data[2];
+
+static void submit_urgent(I2C_Transaction_t *t){
+	(void)t;
+	transaction(&urgent, 0, 0x4F, urgent_data, 1, 0, 99);
+	i2c_arbiter_submit(&bus, &urgent);
+}
+
+static void from_callback(void){
+	I2C_Transaction_t t[3];
+	uint8_t data[3][6];
+	init(start_async);
+	for(int i = 0; i < 3; i++){
+		transaction(&t[i], 1, 0x68, data[i], 6, 2, i);
+		i2c_arbiter_submit(&bus, &t[i]);
+	}
+	t[0].done = submit_urgent;
+	run_until_done(&t[2]);
+	check(starts[1] == 99, "urgent transaction next", starts[1]);
+	check(urgent.state == i2c_transaction_done && urgent.result == i2c_ok, "urgent completed", urgent.result);
+}
+
+static void hung_bus(void){
+	uint8_t data[6], other_data[6];
+	I2C_Transaction_t hang, other;
+	init(start_async);
+	hung_device = 2;
+	transaction(&hang, 2, 0x68, data, 6, 0, 0);
+	hang.timeout_ticks = 2000;
+	transaction(&other, 0, 0x68, other_data, 6, 1, 1);
+	uint32_t start = now_us;
+	i2c_arbiter_submit(&bus, &hang);
+	i2c_arbiter_submit(&bus, &other);
+	run_until_done(&hang);
+	uint32_t elapsed = now_us - start;
+	check(hang.result == i2c_timeout, "hung device times out", hang.result);
+	check(elapsed == 2001, "aborted on the first poll past the timeout", elapsed);
+	check(bus.stats.aborted == 1 && bus.stats.failed == 1, "aborted", bus.stats.aborted);
+	check(abort_masked == 0, "abort runs with interrupts enabled", abort_masked);
+
+	/*The other device is served as soon as the bus is back, and a late completion of the aborted one is ignored*/
+	check(other.state == i2c_transaction_active, "next device started", other.state);
+	i2c_arbiter_complete(&bus, i2c_ok);
+	check(other.state == i2c_transaction_done, "late completion retires the active one", other.state);
+	hung_device = -1;
+	i2c_arbiter_poll(&bus);
+	check(bus.stats.aborted == 1, "no abort without an active transfer", bus.stats.aborted);
+	printf("hung device: timed out after %u us, the bus moved on\n", elapsed);
+
+	/*A completion that races the abort neither retires the aborted transaction nor starts the next one mid abort*/
+	init(start_async);
+	hung_device = 2;
+	transaction(&hang, 2, 0x68, data, 6, 0, 0);
+	hang.timeout_ticks = 2000;
+	transaction(&other, 0, 0x68, other_data, 6, 1, 1);
+	i2c_arbiter_submit(&bus, &hang);
+	i2c_arbiter_submit(&bus, &other);
+	complete_in_abort = 1;
+	run_until_done(&hang);
+	complete_in_abort = 0;
+	check(hang.result == i2c_timeout, "racing completion ignored", hang.result);
+	check(bus.stats.completed == 0 && bus.stats.failed == 1, "retired once", bus.stats.completed);
+	check(other.state == i2c_transaction_active && inflight == &other, "next device started after the abort", other.state);
+	run_until_done(&other);
+	check(other.result == i2c_ok && regs[0][0x68] == other_data[0], "next device served", other.result);
+	hung_device = -1;
+}
+
+static void hold(void){
+	uint8_t data[6];
+	I2C_Transaction_t t;
+	init(start_async);
+	check(i2c_arbiter_hold(&bus) == 0, "hold an idle bus", 0);
+	check(i2c_arbiter_hold(&bus) == 1, "hold twice", 0);
+	transaction(&t, 1, 0x68, data, 6, 0, 0);
+	i2c_arbiter_submit(&bus, &t);
+	check(t.state == i2c_transaction_queued && started == 0, "queued while held", t.state);
+	i2c_arbiter_release(&bus);
+	check(t.state == i2c_transaction_active, "started on release", t.state);
+	check(i2c_arbiter_hold(&bus) == 1, "hold a busy bus", 0);
+	run_until_done(&t);
+	check(i2c_arbiter_hold(&bus) == 0, "hold once idle again", 0);
+	i2c_arbiter_release(&bus);
+}
+
+static void synchronous(void){
+	I2C_Transaction_t t[9], last;
+	uint8_t data[9][6], last_data[1];
+	init(start_sync);
+	/*Queue everything first so a single dispatch runs them all*/
+	bus.dispatching = 1;
+	for(int i = 0; i < 9; i++){
+		transaction(&t[i], i % DEVICES, 0x68, data[i], 6, (uint8_t)(i % DEVICES), i);
+		i2c_arbiter_submit(&bus, &t[i]);
+	}
+	bus.dispatching = 0;
+	transaction(&last, 0, 0x40, last_data, 1, 2, 9);
+	I2C_Result_t result = i2c_arbiter_transfer(&bus, &last, 100);
+
+	static const int expected[10] = {0, 3, 6, 1, 4, 7, 2, 5, 8, 9};
+	for(int i = 0; i < 10; i++){
+		check(starts[i] == expected[i], "synchronous start order", starts[i]);
+	}
+	check(result == i2c_ok && bus.stats.completed == 10, "synchronous completed", bus.stats.completed);
+	check(max_depth == 1, "no recursion through completion", max_depth);
+	printf("synchronous backend: %u completed, start() nesting %d\n", bus.stats.completed, max_depth);
+}
+
+int main(void){
+	for(int d = 0; d < DEVICES; d++){
+		for(int r = 0; r < 256; r++){
+			regs[d][r] = (uint8_t)(d * 64 + r);
+		}
+	}
+	priorities();
+	from_callback();
+	hung_bus();
+	hold();
+	synchronous();
+	return test_result();
+}
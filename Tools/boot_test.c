@@ -0,0 +1,172 @@
+/*
+ * boot_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Boot time simulation for IIS2MDC_InitStart/IIS2MDC_InitComplete on the simulated sensor. Two sensors power up
+ * together while other peripherals are brought up, every register access made before a sensor finished booting is
+ * counted. Also covers the failure paths of InitComplete: a sensor that does not answer, a wrong device ID and a
+ * transport that can't be set up all leave the bus in recovery instead of IIS2MDC_BusOk.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/boot_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC.c Core/Src/IIS2MDC_Convert.c \
+ *       Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o boot_test -lm
+ * Run:
+ *   ./boot_test, exits non-zero on failure
+ */
+#include "iis2mdc_sim.h"
+#include "test_util.h"
+#include <stdio.h>
+
+#define OTHER_PERIPHERALS_MS 15U /*What main() initializes between InitStart and InitComplete*/
+
+static sim_t *const sensors[SIM_SENSORS] = {&sim, &sim_second};
+
+static IIS2MDC_InitStruct_t settings(void){
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.DrdyPinMode = IIS2MDC_DrdyOnPin;
+	return Settings;
+}
+
+static uint8_t configured(const sim_t *s){
+	return s->regs[IIS2MDC_REG_CFG_REG_A] == ((IIS2MDC_100Hz << 2) | IIS2MDC_ContinuousMode);
+}
+
+/*Both sensors boot while the rest of the board comes up, InitComplete only waits for what is left*/
+static void overlapped(void){
+	IIS2MDC_Handle_t Dev[SIM_SENSORS];
+	sim.now_us = 0;
+	for(uint32_t i = 0; i < SIM_SENSORS; i++){
+		sim_power_on_sensor(sensors[i]);
+	}
+	for(uint32_t i = 0; i < SIM_SENSORS; i++){
+		IIS2MDC_InitStart(settings(), &Dev[i], sim_driver_of(sensors[i]));
+		check(sensors[i]->log_count == 0 && !sensors[i]->irq_enabled, "InitStart leaves the sensor alone", i);
+	}
+	sim_advance(sim.now_us + OTHER_PERIPHERALS_MS * 1000U);
+	uint8_t pending = IIS2MDC_BootPending(&Dev[0]);
+	check(pending == IIS2MDC_BOOT_MS - OTHER_PERIPHERALS_MS, "boot pending", pending);
+	for(uint32_t i = 0; i < SIM_SENSORS; i++){
+		IIS2MDC_InitComplete(&Dev[i]);
+		check(Dev[i].BusState == IIS2MDC_BusOk && configured(sensors[i]), "sensor configured", i);
+		check(sensors[i]->irq_enabled, "pin interrupt enabled", i);
+		check(sensors[i]->early_accesses == 0, "no access before boot", sensors[i]->early_accesses);
+	}
+
+	/*After the boot only the configuration traffic is left, about a millisecond for both at 400 kHz*/
+	uint32_t ready_ms = (uint32_t)(sim.now_us / 1000U);
+	uint32_t blocking = SIM_SENSORS * IIS2MDC_BOOT_MS + OTHER_PERIPHERALS_MS;
+	check(sim.now_us - sim.boot_done_us < 2000U, "ready when the sensors booted", (double)(sim.now_us - sim.boot_done_us));
+	printf("%u sensors and %u ms of other peripherals: ready after %u ms, %u ms with blocking init\n", SIM_SENSORS,
+			OTHER_PERIPHERALS_MS, ready_ms, blocking);
+	sim_second.powered = 0; //One sensor from here on
+}
+
+/*Everything else took longer than the boot, InitComplete doesn't wait at all*/
+static void slow_peripherals(void){
+	IIS2MDC_Handle_t Dev;
+	sim.now_us = 100000;
+	sim_power_on();
+	IIS2MDC_InitStart(settings(), &Dev, sim_driver());
+	sim_advance(sim.now_us + 40000U);
+	uint64_t start = sim.now_us;
+	check(IIS2MDC_BootPending(&Dev) == 0, "nothing pending", IIS2MDC_BootPending(&Dev));
+	IIS2MDC_InitComplete(&Dev);
+	check(sim.now_us - start < 1000U && sim.early_accesses == 0, "no wait", (double)(sim.now_us - start));
+	check(Dev.BusState == IIS2MDC_BusOk, "configured", Dev.BusState);
+}
+
+/*A sensor that doesn't answer is left to bus recovery, which configures it once it does*/
+static void absent(void){
+	IIS2MDC_Handle_t Dev;
+	sim.now_us = 0;
+	sim_power_on();
+	sim.fail_next = UINT32_MAX;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	IIS2MDC_InitStart(settings(), &Dev, sim_driver());
+	IIS2MDC_InitComplete(&Dev);
+	check(Dev.BusState == IIS2MDC_BusClearPending, "absent sensor starts recovery", Dev.BusState);
+	check(Dev.BusStats.Faults == 1 && Dev.BusStats.LastError == IIS2MDC_ErrorNack, "fault classified", Dev.BusStats.LastError);
+	check(sim.writes == 0, "nothing configured", sim.writes);
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_50Hz) != IIS2MDC_Ok, "no configuration change while faulted", 0);
+
+	sim.fail_next = 0;
+	int calls = 0;
+	while(Dev.BusState != IIS2MDC_BusOk && calls < 10){
+		IIS2MDC_RecoverBus(&Dev);
+		calls++;
+	}
+	check(calls == 2 && Dev.BusStats.Recoveries == 1, "recovered once the sensor answers", calls); //SetDataRate ran the bus clear
+	check(configured(&sim), "configured by recovery", sim.regs[IIS2MDC_REG_CFG_REG_A]);
+}
+
+static void wrong_id(void){
+	IIS2MDC_Handle_t Dev;
+	sim.now_us = 0;
+	sim_power_on();
+	sim.regs[IIS2MDC_REG_WHO_AM_I] = 0x33;
+	IIS2MDC_InitStart(settings(), &Dev, sim_driver());
+	IIS2MDC_InitComplete(&Dev);
+	check(Dev.BusState == IIS2MDC_BusWrongDevice && Dev.BusStats.LastError == IIS2MDC_Error, "wrong device ID", Dev.BusState);
+	check(!sim.irq_enabled, "pin interrupt left masked", 0);
+
+	/*The main loop keeps calling recovery, and a setter tries its luck, the chip is still never written*/
+	for(int i = 0; i < 10; i++){
+		IIS2MDC_RecoverBus(&Dev);
+	}
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_50Hz) != IIS2MDC_Ok, "no configuration change", 0);
+	check(IIS2MDC_ServiceIRQ(&Dev) == IIS2MDC_DataNotReady, "no sample", 0);
+	check(sim.writes == 0, "wrong device not configured", sim.writes);
+	check(Dev.BusState != IIS2MDC_BusOk && sim.bus_clears == 0, "recovery not attempted", Dev.BusState);
+
+	/*Nothing answered at init, what answers once the bus is back is another chip*/
+	sim.now_us = 0;
+	sim_power_on();
+	sim.fail_next = UINT32_MAX;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	IIS2MDC_InitStart(settings(), &Dev, sim_driver());
+	IIS2MDC_InitComplete(&Dev);
+	check(Dev.BusState == IIS2MDC_BusClearPending, "absent chip starts recovery", Dev.BusState);
+	sim.fail_next = 0;
+	sim.regs[IIS2MDC_REG_WHO_AM_I] = 0x33;
+	for(int i = 0; i < 10; i++){
+		IIS2MDC_RecoverBus(&Dev);
+	}
+	check(sim.writes == 0, "wrong device found by recovery not configured", sim.writes);
+	check(Dev.BusState == IIS2MDC_BusWrongDevice && Dev.BusStats.Recoveries == 0, "recovery stops at the device ID",
+			Dev.BusState);
+}
+
+static void boot_wait_fails(void){
+	IIS2MDC_Handle_t Dev;
+	sim.now_us = 0;
+	sim_power_on();
+	sim.boot_wait_fails = 1;
+	IIS2MDC_InitStart(settings(), &Dev, sim_driver());
+	IIS2MDC_InitComplete(&Dev);
+	check(Dev.BusState != IIS2MDC_BusOk, "transport setup failed", Dev.BusState);
+	check(sim.log_count == 0, "no register access without a transport", sim.log_count);
+}
+
+static void deinit_clears_driver(void){
+	IIS2MDC_Handle_t Dev;
+	sim.now_us = 0;
+	sim_power_on();
+	IIS2MDC_Init(settings(), &Dev, sim_driver());
+	IIS2MDC_DeInit(&Dev);
+	check(Dev.IIS2MDC_IO.Init == NULL && Dev.IIS2MDC_IO.DeInit == NULL && Dev.IIS2MDC_IO.ReadReg == NULL &&
+			Dev.IIS2MDC_IO.WriteReg == NULL && Dev.IIS2MDC_IO.ioctl == NULL, "driver cleared", 0);
+	check(Dev.IIS2MDC_IO.ReadRegAsync == NULL, "asynchronous read cleared", 0);
+}
+
+int main(void){
+	overlapped();
+	slow_peripherals();
+	absent();
+	wrong_id();
+	boot_wait_fails();
+	deinit_clears_driver();
+	return test_result();
+}
@@ -0,0 +1,157 @@
+/*
+ * busfault_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Fault injection test for the driver's bus retries and recovery, on the simulated sensor. Covers a NACK absorbed by a
+ * retry, retries running out, a stuck SDA that must not be retried, recovery of a sensor that lost its configuration,
+ * a bus clear that needs several attempts, and a failure while the configuration is re-applied.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/busfault_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC.c Core/Src/IIS2MDC_Convert.c \
+ *       Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o busfault_test -lm
+ * Run:
+ *   ./busfault_test, exits non-zero on failure. SIM_VERBOSE=1 prints the driver log.
+ */
+#include "iis2mdc_sim.h"
+#include "test_util.h"
+#include <stdio.h>
+
+static IIS2MDC_Handle_t Dev;
+static uint8_t configured_cfg_a;
+
+static void field(uint64_t now_us, int16_t out[3]){
+	out[0] = (int16_t)(now_us / 10000U); //Sample number at 100 Hz, so a stale sample is obvious
+	out[1] = 200;
+	out[2] = -300;
+}
+
+/*Waits for the next sample and reads it*/
+static IIS2MDC_DataReadyStatus_t next_sample(void){
+	sim_advance(sim.now_us + 10000);
+	return IIS2MDC_ReadMagnetic(&Dev);
+}
+
+/*Steps recovery until the bus is back, returns the calls it took and the longest a single call blocked*/
+static int recover(uint64_t *worst_us){
+	int calls = 0;
+	*worst_us = 0;
+	while(Dev.BusState != IIS2MDC_BusOk && calls < 20){
+		uint64_t start = sim.now_us;
+		IIS2MDC_RecoverBus(&Dev);
+		calls++;
+		if(sim.now_us - start > *worst_us){
+			*worst_us = sim.now_us - start;
+		}
+	}
+	return calls;
+}
+
+static void clean(void){
+	int good = 0;
+	for(int i = 0; i < 50; i++){
+		good += next_sample() == IIS2MDC_DataReady;
+	}
+	check(good == 50, "clean samples", good);
+	check(Dev.BusStats.Retries == 0 && Dev.BusStats.Faults == 0, "clean bus stats", Dev.BusStats.Faults);
+}
+
+static void glitch(void){
+	sim.fail_next = 1;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	check(next_sample() == IIS2MDC_DataReady, "sample through a NACK", 0);
+	check(Dev.BusStats.Retries == 1 && Dev.BusStats.Faults == 0, "NACK absorbed by one retry", Dev.BusStats.Retries);
+
+	sim.fail_next = 1;
+	sim.fail_status = IIS2MDC_ErrorArbitrationLost;
+	check(next_sample() == IIS2MDC_DataReady, "sample through lost arbitration", 0);
+	check(Dev.BusStats.Retries == 2 && Dev.BusStats.Faults == 0, "arbitration loss absorbed", Dev.BusStats.Retries);
+
+	/*Three NACKs in a row use up the attempts*/
+	sim.fail_next = 3;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	check(next_sample() == IIS2MDC_DataNotReady, "sample after retries ran out", 0);
+	check(Dev.BusState == IIS2MDC_BusClearPending && Dev.BusStats.LastError == IIS2MDC_ErrorNack, "fault classified", Dev.BusStats.LastError);
+	uint64_t worst;
+	int calls = recover(&worst);
+	check(calls == 3, "recovery calls", calls);
+	check(Dev.BusStats.Recoveries == 1, "recoveries", Dev.BusStats.Recoveries);
+}
+
+static void stuck(void){
+	int32_t before = Dev.MagX;
+	sim.stuck = 1;
+	sim_advance(sim.now_us + 10000);
+	sim_clear_log();
+	uint64_t start = sim.now_us;
+	check(IIS2MDC_ReadMagnetic(&Dev) == IIS2MDC_DataNotReady, "sample with SDA stuck", 0);
+	check(sim.log_count == 1, "a timeout is not retried", sim.log_count);
+	uint64_t blocked = sim.now_us - start;
+	check(blocked <= SIM_TIMEOUT_US, "blocked for one timeout at most", (long)blocked);
+	check(Dev.MagX == before, "last good sample kept", Dev.MagX);
+	check(Dev.BusStats.LastError == IIS2MDC_ErrorTimeout, "timeout classified", Dev.BusStats.LastError);
+
+	/*The sensor browned out while the bus was down and lost its configuration*/
+	sim.regs[IIS2MDC_REG_CFG_REG_A] = 0x03;
+	sim.regs[IIS2MDC_REG_CFG_REG_C] = 0x00;
+	uint32_t clears = sim.bus_clears;
+	uint64_t worst;
+	int calls = recover(&worst);
+	check(calls == 3, "recovery calls", calls);
+	check(worst < SIM_TIMEOUT_US, "no recovery step waits out a timeout", (long)worst);
+	check(sim.bus_clears == clears + 1 && sim.reinits >= 1, "bus cleared and re-initialized", sim.bus_clears);
+	check(sim.regs[IIS2MDC_REG_CFG_REG_A] == configured_cfg_a, "configuration re-applied", sim.regs[IIS2MDC_REG_CFG_REG_A]);
+	check(next_sample() == IIS2MDC_DataReady && Dev.MagX != before, "samples flow again", Dev.MagX);
+	printf("stuck SDA: blocked %lu us, recovered in %d calls, worst step %lu us\n", (unsigned long)blocked, calls, (unsigned long)worst);
+}
+
+static void clear_retries(void){
+	sim.stuck = 1;
+	sim.clear_fails = 2;
+	next_sample();
+	for(int i = 0; i < 2; i++){
+		check(IIS2MDC_RecoverBus(&Dev) == IIS2MDC_BusClearPending, "still clearing", i);
+	}
+	uint64_t worst;
+	int calls = recover(&worst);
+	check(calls == 3, "recovery calls once the clear works", calls);
+	check(next_sample() == IIS2MDC_DataReady, "sample after a slow clear", 0);
+}
+
+static void reconfig_failure(void){
+	sim.fail_next = 3;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	next_sample();
+	IIS2MDC_RecoverBus(&Dev);
+	IIS2MDC_RecoverBus(&Dev);
+	check(Dev.BusState == IIS2MDC_BusReconfigPending, "reconfigure next", Dev.BusState);
+
+	/*Configuration writes use the raw driver, one failure starts over from the bus clear*/
+	sim.fail_next = 1;
+	check(IIS2MDC_RecoverBus(&Dev) == IIS2MDC_BusClearPending, "failed reconfigure starts over", Dev.BusState);
+	uint64_t worst;
+	int calls = recover(&worst);
+	check(calls == 3, "recovery calls after a failed reconfigure", calls);
+	check(next_sample() == IIS2MDC_DataReady, "sample after a failed reconfigure", 0);
+}
+
+int main(void){
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.LPF = IIS2MDC_LowPassFilterEnabled;
+	sim_power_on();
+	sim.field = field;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+	configured_cfg_a = sim.regs[IIS2MDC_REG_CFG_REG_A];
+
+	clean();
+	glitch();
+	stuck();
+	clear_retries();
+	reconfig_failure();
+	printf("bus stats: %u retries, %u faults, %u recoveries\n", Dev.BusStats.Retries, Dev.BusStats.Faults,
+			Dev.BusStats.Recoveries);
+
+	return test_result();
+}
@@ -0,0 +1,155 @@
+/*
+ * compress_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host benchmark for IIS2MDC_Compress: compression ratio and encode cost per sample on a recorded trace.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc Tools/compress_bench.c Core/Src/IIS2MDC_Compress.c -o compress_bench
+ * Run:
+ *   ./compress_bench [trace.txt] [samples per block]
+ * A trace has one sample per line, "timestamp x y z" separated by spaces or commas (raw LSB, ms). Without one, a
+ * 100 Hz trace of a slowly turning sensor with 2 LSB of noise is generated.
+ */
+#include "IIS2MDC_Compress.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#endif
+
+#define RAW_BYTES_PER_SAMPLE 10U /*int16 XYZ plus a uint32 timestamp*/
+#define BENCH_REPEATS 20
+
+typedef struct{
+	uint32_t timestamp;
+	int16_t field[3];
+}sample_t;
+
+static sample_t *load(const char *path, size_t *count){
+	FILE *f = fopen(path, "r");
+	if(f == NULL){
+		perror(path);
+		exit(1);
+	}
+	size_t capacity = 1024;
+	sample_t *samples = malloc(capacity * sizeof(sample_t));
+	char line[256];
+	*count = 0;
+	while(fgets(line, sizeof(line), f) != NULL){
+		for(char *c = line; *c; c++){
+			if(*c == ',') *c = ' ';
+		}
+		long t, x, y, z;
+		if(sscanf(line, "%ld %ld %ld %ld", &t, &x, &y, &z) != 4){
+			continue;
+		}
+		if(*count == capacity){
+			capacity *= 2;
+			samples = realloc(samples, capacity * sizeof(sample_t));
+		}
+		samples[*count] = (sample_t){(uint32_t)t, {(int16_t)x, (int16_t)y, (int16_t)z}};
+		(*count)++;
+	}
+	fclose(f);
+	return samples;
+}
+
+static sample_t *synthesize(size_t count){
+	sample_t *samples = malloc(count * sizeof(sample_t));
+	srand(1);
+	for(size_t i = 0; i < count; i++){
+		double angle = i * 0.002;
+		samples[i].timestamp = (uint32_t)(i * 10 + (rand() % 3 == 0)); //DRDY against a 1 ms tick jitters by one
+		samples[i].field[0] = (int16_t)(200 * cos(angle) + rand() % 5 - 2);
+		samples[i].field[1] = (int16_t)(200 * sin(angle) + rand() % 5 - 2);
+		samples[i].field[2] = (int16_t)(-300 + rand() % 5 - 2);
+	}
+	return samples;
+}
+
+static size_t encode(const sample_t *samples, size_t count, uint16_t block, uint8_t *out, size_t *keyframes){
+	IIS2MDC_Encoder_t encoder;
+	IIS2MDC_Encoder_Init(&encoder, 0);
+	size_t length = 0;
+	for(size_t i = 0; i < count; i++){
+		length += IIS2MDC_Encoder_Encode(&encoder, samples[i].field, samples[i].timestamp, &out[length]);
+		if(block != 0 && (i + 1) % block == 0){
+			length += IIS2MDC_Encoder_Flush(&encoder, &out[length]);
+		}
+	}
+	length += IIS2MDC_Encoder_Flush(&encoder, &out[length]);
+	*keyframes = encoder.Keyframes;
+	return length;
+}
+
+/*Blocks are not delimited in the benchmark buffer, so decode with the same block size and re-align after each one*/
+static int verify(const sample_t *samples, size_t count, uint16_t block, const uint8_t *data, size_t length){
+	IIS2MDC_Decoder_t decoder;
+	IIS2MDC_Decoder_Init(&decoder, data, length);
+	for(size_t i = 0; i < count; i++){
+		int16_t field[3];
+		uint32_t timestamp;
+		if(IIS2MDC_Decoder_Decode(&decoder, field, &timestamp) != IIS2MDC_DecodeSample ||
+				timestamp != samples[i].timestamp || memcmp(field, samples[i].field, sizeof(field)) != 0){
+			fprintf(stderr, "mismatch at sample %zu\n", i);
+			return 0;
+		}
+		if(block != 0 && (i + 1) % block == 0){
+			uint32_t next = (decoder.BitPosition + 7U) / 8U;
+			IIS2MDC_Decoder_Init(&decoder, data + next, (uint32_t)(length - next));
+			data += next;
+			length -= next;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv){
+	size_t count = 100000;
+	sample_t *samples = (argc > 1) ? load(argv[1], &count) : synthesize(count);
+	uint16_t block = (argc > 2) ? (uint16_t)atoi(argv[2]) : 0;
+	if(count == 0){
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+	uint8_t *out = malloc(count * IIS2MDC_COMPRESS_MAX_BYTES + 1);
+	size_t keyframes = 0;
+	size_t length = 0;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+#ifdef BENCH_CYCLES
+	uint64_t cycles = BENCH_CYCLES();
+#endif
+	for(int r = 0; r < BENCH_REPEATS; r++){
+		length = encode(samples, count, block, out, &keyframes);
+	}
+#ifdef BENCH_CYCLES
+	cycles = BENCH_CYCLES() - cycles;
+#endif
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / ((double)count * BENCH_REPEATS);
+
+	if(!verify(samples, count, block, out, length)){
+		return 1;
+	}
+
+	printf("samples          %zu (block %u, %zu keyframes)\n", count, block, keyframes);
+	printf("raw bytes        %zu (%u per sample)\n", count * RAW_BYTES_PER_SAMPLE, RAW_BYTES_PER_SAMPLE);
+	printf("encoded bytes    %zu (%.2f bits per sample)\n", length, length * 8.0 / count);
+	printf("ratio            %.2f\n", (double)(count * RAW_BYTES_PER_SAMPLE) / length);
+	printf("encode           %.1f ns per sample\n", ns);
+#ifdef BENCH_CYCLES
+	printf("encode           %.1f TSC cycles per sample\n", (double)cycles / ((double)count * BENCH_REPEATS));
+#endif
+	printf("round trip       ok\n");
+	free(out);
+	free(samples);
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * decimator_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Decimator. For every order and a range of ratios: unity DC gain for positive and negative
+ * fields, one output per Ratio inputs, and every output against the CIC's impulse response applied directly. A run of
+ * more than 10^6 samples takes the order 3 integrators through their wrap, build it with -fsanitize=undefined so any
+ * signed overflow stops the test. Also covers the ratio limit and several subscribers on one list.
+ * Build from the repository root:
+ *   gcc -O2 -fsanitize=undefined -fno-sanitize-recover=undefined -ICore/Inc -ITools Tools/decimator_test.c \
+ *       Core/Src/IIS2MDC_Decimator.c -o decimator_test
+ * Run:
+ *   ./decimator_test, exits non-zero on failure
+ */
+#include "IIS2MDC_Decimator.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LONG_RUN 2000000U           /*Order 3 integrators wrap after about 5 * 10^5 samples of 500 mG*/
+#define FIELD_MG 500
+#define RESPONSE_MAX (IIS2MDC_CIC_MAX_ORDER * 1000U)
+
+static const uint16_t ratios[] = {1, 2, 3, 5, 10, 64, 1000};
+
+/*What a decimator's callback saw*/
+typedef struct{
+	uint32_t count;
+	int32_t last[3];
+}Seen_t;
+
+static void seen(const int32_t Sample[3], void *Context){
+	Seen_t *s = Context;
+	s->count++;
+	memcpy(s->last, Sample, sizeof(s->last));
+}
+
+/*Impulse response of Order boxcars of length Ratio, in place of the integrators and combs*/
+static uint32_t response(uint16_t ratio, uint8_t order, int64_t *h){
+	uint32_t length = 1;
+	h[0] = 1;
+	for(uint8_t stage = 0; stage < order; stage++){
+		int64_t next[RESPONSE_MAX] = {0};
+		for(uint32_t i = 0; i < length; i++){
+			for(uint16_t k = 0; k < ratio; k++){
+				next[i + k] += h[i];
+			}
+		}
+		length += ratio - 1U;
+		memcpy(h, next, length * sizeof(h[0]));
+	}
+	return length;
+}
+
+/*The output due after input n, rounded half away from zero like the decimator*/
+static int32_t direct(const int32_t *x, uint32_t n, const int64_t *h, uint32_t length, int64_t gain){
+	int64_t sum = 0;
+	for(uint32_t k = 0; k < length && k <= n; k++){
+		sum += h[k] * x[n - k];
+	}
+	int64_t half = (sum < 0) ? -(gain / 2) : (gain / 2);
+	return (int32_t)((sum + half) / gain);
+}
+
+static void dc_gain(void){
+	for(uint8_t order = 1; order <= IIS2MDC_CIC_MAX_ORDER; order++){
+		for(unsigned r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++){
+			IIS2MDC_Decimator_t D;
+			Seen_t s = {0};
+			IIS2MDC_Decimator_Init(&D, ratios[r], order, seen, &s);
+			const int32_t field[3] = {FIELD_MG, -FIELD_MG, 1};
+			uint32_t inputs = (uint32_t)ratios[r] * (order + 20U);
+			uint32_t wrong = 0;
+			for(uint32_t i = 0; i < inputs; i++){
+				IIS2MDC_Decimator_Push(&D, field);
+				if(D.Phase == 0 && s.count >= order){ //Settled
+					wrong += memcmp(s.last, field, sizeof(field)) != 0;
+				}
+			}
+			check(wrong == 0, "unity DC gain", ratios[r] * 10 + order);
+			check(s.count == inputs / ratios[r] && D.OutputCount == s.count, "one output per Ratio inputs", ratios[r] * 10 + order);
+		}
+	}
+}
+
+/*Random input, every output against the impulse response, including the settling ones*/
+static void impulse_response(void){
+	static int32_t x[20000];
+	static int64_t h[RESPONSE_MAX];
+	srand(3);
+	for(uint32_t i = 0; i < sizeof(x) / sizeof(x[0]); i++){
+		x[i] = rand() % 2001 - 1000;
+	}
+	for(uint8_t order = 1; order <= IIS2MDC_CIC_MAX_ORDER; order++){
+		for(unsigned r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++){
+			IIS2MDC_Decimator_t D;
+			IIS2MDC_Decimator_Init(&D, ratios[r], order, NULL, NULL);
+			uint32_t length = response(ratios[r], order, h);
+			uint32_t wrong = 0;
+			for(uint32_t i = 0; i < sizeof(x) / sizeof(x[0]); i++){
+				const int32_t sample[3] = {x[i], -x[i], x[i] / 2};
+				IIS2MDC_Decimator_Push(&D, sample);
+				if(D.Phase == 0){
+					wrong += D.Output[0] != direct(x, i, h, length, D.Gain);
+					wrong += D.Output[1] != -direct(x, i, h, length, D.Gain);
+				}
+			}
+			check(wrong == 0, "matches the impulse response", ratios[r] * 10 + order);
+		}
+	}
+}
+
+/*Past the wrap of every integrator stage, the outputs are still exact*/
+static void long_run(void){
+	static int64_t h[RESPONSE_MAX];
+	static int32_t x[LONG_RUN];
+	const uint16_t ratio = 10;
+	IIS2MDC_Decimator_t D;
+	IIS2MDC_Decimator_Init(&D, ratio, IIS2MDC_CIC_MAX_ORDER, NULL, NULL);
+	uint32_t length = response(ratio, IIS2MDC_CIC_MAX_ORDER, h);
+	srand(4);
+	uint32_t wrong = 0;
+	for(uint32_t i = 0; i < LONG_RUN; i++){
+		x[i] = FIELD_MG + rand() % 21 - 10;
+		const int32_t sample[3] = {x[i], -x[i], (1 << (IIS2MDC_CIC_INPUT_BITS - 1)) - 1}; //And the largest input
+		IIS2MDC_Decimator_Push(&D, sample);
+		if(D.Phase == 0 && D.OutputCount > IIS2MDC_CIC_MAX_ORDER){
+			int32_t expected = direct(x, i, h, length, D.Gain);
+			wrong += D.Output[0] != expected || D.Output[1] != -expected || D.Output[2] != sample[2];
+		}
+	}
+	check(wrong == 0, "exact after the integrators wrapped", wrong);
+	check(D.OutputCount == LONG_RUN / ratio, "outputs over the long run", D.OutputCount);
+	printf("%u samples at order %u, ratio %u: %u outputs, last %d mG\n", LONG_RUN, IIS2MDC_CIC_MAX_ORDER, ratio,
+			D.OutputCount, D.Output[0]);
+}
+
+static void limits(void){
+	IIS2MDC_Decimator_t D;
+	IIS2MDC_Decimator_Init(&D, 0, 0, NULL, NULL);
+	check(D.Ratio == 1 && D.Order == 1, "zero ratio and order", D.Ratio);
+	IIS2MDC_Decimator_Init(&D, 10, IIS2MDC_CIC_MAX_ORDER + 1, NULL, NULL);
+	check(D.Order == IIS2MDC_CIC_MAX_ORDER, "order clamped", D.Order);
+	IIS2MDC_Decimator_Init(&D, UINT16_MAX, IIS2MDC_CIC_MAX_ORDER, NULL, NULL);
+	uint64_t next = (uint64_t)(D.Ratio + 1U) * (D.Ratio + 1U) * (D.Ratio + 1U);
+	check((uint64_t)D.Gain <= IIS2MDC_CIC_MAX_GAIN && next > IIS2MDC_CIC_MAX_GAIN, "ratio limited to the state width", D.Ratio);
+	IIS2MDC_Decimator_Init(&D, UINT16_MAX, 2, NULL, NULL);
+	check(D.Ratio == UINT16_MAX, "order 2 takes any ratio", D.Ratio);
+}
+
+/*Subscribers on one list each decimate the full rate stream*/
+static void subscribers(void){
+	IIS2MDC_Decimator_t A, B;
+	Seen_t a = {0}, b = {0};
+	IIS2MDC_Decimator_Init(&A, 5, 1, seen, &a);
+	IIS2MDC_Decimator_Init(&B, 20, 2, seen, &b);
+	A.Next = &B;
+	for(int32_t i = 0; i < 100; i++){
+		const int32_t sample[3] = {i, 0, 0};
+		IIS2MDC_Decimator_Push(&A, sample);
+	}
+	check(a.count == 20 && b.count == 5, "rates per subscriber", a.count);
+	check(a.last[0] == 97, "boxcar of the last block", a.last[0]); //95..99
+}
+
+int main(void){
+	dc_gain();
+	impulse_response();
+	long_run();
+	limits();
+	subscribers();
+	return test_result();
+}
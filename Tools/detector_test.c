@@ -0,0 +1,202 @@
+/*
+ * detector_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Detector: integer square root, the exact event sequence for a scripted disturbance, a rate
+ * threshold that means the same at every ODR, a noise sweep showing where hysteresis stops chatter, and queue overflow.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/detector_test.c Core/Src/IIS2MDC_Detector.c -o detector_test -lm
+ * Run:
+ *   ./detector_test, exits non-zero on failure
+ */
+#include "IIS2MDC_Detector.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static int notified;
+
+static void notify(void){
+	notified++;
+}
+
+static int isqrt_ok(uint64_t v){
+	uint64_t r = IIS2MDC_ISqrt(v);
+	return r * r <= v && (r + 1) * (r + 1) > v;
+}
+
+static void isqrt(void){
+	for(uint64_t v = 0; v < 2000000; v++){
+		check(isqrt_ok(v), "isqrt", (long)v);
+	}
+	for(int i = 0; i < 1000000; i++){
+		uint64_t v = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 2) ^ (uint64_t)rand();
+		check(isqrt_ok(v), "isqrt random", (long)v);
+	}
+	for(uint32_t r = 65535; r < 4000000000U; r += 99991){
+		uint64_t square = (uint64_t)r * r;
+		check(IIS2MDC_ISqrt(square) == r && IIS2MDC_ISqrt(square - 1) == r - 1, "isqrt square edge", r);
+	}
+	check(IIS2MDC_ISqrt(UINT64_MAX) == UINT32_MAX, "isqrt max", 0);
+	/*Full scale on all three axes*/
+	const int32_t full[3] = {-49152, -49152, -49152};
+	check(IIS2MDC_Magnitude(full) == 85133, "magnitude full scale", IIS2MDC_Magnitude(full));
+	printf("isqrt: 0..2e6, 1e6 random, perfect square edges\n");
+}
+
+/*Field of magnitude m along a fixed direction*/
+static void along(double m, int32_t s[3]){
+	s[0] = lround(m * 0.6);
+	s[1] = lround(m * 0.8);
+	s[2] = 0;
+}
+
+static void scripted(void){
+	static const struct{
+		IIS2MDC_DetectorEventType_t type;
+		uint32_t timestamp;
+	}expected[] = {
+			{IIS2MDC_EventAboveHigh, 1010}, {IIS2MDC_EventRateOfChange, 1010},
+			{IIS2MDC_EventHighCleared, 2000}, {IIS2MDC_EventRateOfChange, 2000},
+			{IIS2MDC_EventBelowLow, 2500}, {IIS2MDC_EventRateOfChange, 2500},
+			{IIS2MDC_EventLowCleared, 3000}, {IIS2MDC_EventRateOfChange, 3000}
+	};
+	IIS2MDC_Detector_t d;
+	IIS2MDC_Detector_Init(&d, (IIS2MDC_DetectorConfig_t){800, 200, 15000, 20, 2000, notify});
+	notified = 0;
+	unsigned n = 0;
+	for(uint32_t i = 0; i < 400; i++){
+		/*100 Hz. 500 mG with +-3 mG of noise, a 900 mG disturbance, then a 150 mG dropout.*/
+		double m = 500 + (i > 100 && i < 200 ? 400 : 0) + (i >= 250 && i < 300 ? -350 : 0) + (int)(i % 7) - 3;
+		int32_t s[3];
+		along(m, s);
+		IIS2MDC_Detector_Process(&d, s, i * 10);
+		IIS2MDC_DetectorEvent_t e;
+		while(IIS2MDC_Detector_GetEvent(&d, &e)){
+			if(n < sizeof(expected) / sizeof(expected[0])){
+				check(e.Type == expected[n].type && e.Timestamp == expected[n].timestamp, "event", n);
+			}
+			n++;
+		}
+	}
+	check(n == sizeof(expected) / sizeof(expected[0]), "event count", n);
+	check(notified == 4, "notifications, one per sample that raised events", notified);
+	check(d.Dropped == 0, "dropped", d.Dropped);
+	printf("scripted disturbance: %u events as expected\n", n);
+}
+
+/*Field ramp at rate_mgs sampled at odr_hz with +-1 ms of timestamp jitter, returns rate events and the highest rate seen*/
+static unsigned ramp_rate(uint32_t rate_mgs, uint32_t odr_hz, uint32_t *peak){
+	IIS2MDC_Detector_t d;
+	IIS2MDC_Detector_Init(&d, (IIS2MDC_DetectorConfig_t){0, 0, 800, 0, 200, NULL});
+	unsigned events = 0;
+	*peak = 0;
+	for(uint32_t i = 0; i < 2 * odr_hz; i++){
+		uint32_t t_ms = i * 1000U / odr_hz;
+		int32_t s[3];
+		along(100 + (double)rate_mgs * t_ms / 1000.0, s);
+		IIS2MDC_Detector_Process(&d, s, t_ms + 10 + (i % 3) - 1);
+		if(d.Rate > *peak){
+			*peak = d.Rate;
+		}
+		IIS2MDC_DetectorEvent_t e;
+		while(IIS2MDC_Detector_GetEvent(&d, &e)){
+			events += e.Type == IIS2MDC_EventRateOfChange;
+		}
+	}
+	return events;
+}
+
+static void rate_units(void){
+	static const uint32_t odrs[] = {10, 20, 50, 100};
+	printf("rate threshold 800 mG/s: events for a 1000 / 500 mG/s ramp, highest measured rate\n");
+	for(unsigned i = 0; i < sizeof(odrs) / sizeof(odrs[0]); i++){
+		uint32_t fast_peak, slow_peak;
+		unsigned fast = ramp_rate(1000, odrs[i], &fast_peak);
+		unsigned slow = ramp_rate(500, odrs[i], &slow_peak);
+		check(fast == 1, "1000 mG/s ramp raises one event at every ODR", (long)odrs[i]);
+		check(slow == 0, "500 mG/s ramp raises none at any ODR", (long)odrs[i]);
+		/*Two ms of jitter over one period is the worst case, 8 ms measured for 10 ms of change at 100 Hz*/
+		check(fast_peak <= 1000U * 1000U / (1000U / odrs[i] - 2U), "measured rate tracks the ramp", (long)fast_peak);
+		printf("  %3u Hz: %u / %u, %u / %u mG/s\n", odrs[i], fast, slow, fast_peak, slow_peak);
+	}
+
+	/*A second sample in the same ms is not a rate, the next one is measured over the whole interval*/
+	IIS2MDC_Detector_t d;
+	IIS2MDC_Detector_Init(&d, (IIS2MDC_DetectorConfig_t){0, 0, 800, 0, 200, NULL});
+	int32_t s[3];
+	along(500, s);
+	IIS2MDC_Detector_Process(&d, s, 100);
+	along(510, s);
+	IIS2MDC_Detector_Process(&d, s, 100);
+	check(d.Rate == 0 && d.Head == 0, "same ms sample ignored for the rate", d.Rate);
+	along(520, s);
+	IIS2MDC_Detector_Process(&d, s, 120);
+	check(d.Rate == 1000, "rate over the whole interval", d.Rate);
+}
+
+/*Slow ramp through the high threshold and back with uniform noise. Noise within the hysteresis gives one event each way.*/
+static unsigned ramp_events(int noise){
+	IIS2MDC_Detector_t d;
+	IIS2MDC_Detector_Init(&d, (IIS2MDC_DetectorConfig_t){800, 0, 0, 20, 0, NULL});
+	unsigned events = 0;
+	for(int t = 0; t < 4000; t++){
+		double m = (t < 2000) ? 700 + t * 0.1 : 900 - (t - 2000) * 0.1;
+		if(noise){
+			m += rand() % (2 * noise + 1) - noise;
+		}
+		int32_t s[3];
+		along(m, s);
+		IIS2MDC_Detector_Process(&d, s, t);
+		IIS2MDC_DetectorEvent_t e;
+		while(IIS2MDC_Detector_GetEvent(&d, &e)){
+			events++;
+		}
+	}
+	return events;
+}
+
+static void hysteresis_sweep(void){
+	printf("noise sweep, 20 mG hysteresis: peak noise / events for one crossing each way\n");
+	for(int noise = 0; noise <= 30; noise += 3){
+		unsigned events = ramp_events(noise);
+		if(2 * noise < 20){
+			check(events == 2, "events with noise inside the hysteresis", noise);
+		}
+		printf("  %2d mG: %u\n", noise, events);
+	}
+}
+
+static void overflow(void){
+	IIS2MDC_Detector_t d;
+	IIS2MDC_Detector_Init(&d, (IIS2MDC_DetectorConfig_t){800, 0, 0, 20, 0, notify});
+	notified = 0;
+	for(int i = 0; i < 40; i++){
+		int32_t s[3];
+		along((i & 1) ? 500 : 900, s);
+		IIS2MDC_Detector_Process(&d, s, i);
+	}
+	check(d.Dropped == 40 - IIS2MDC_DETECTOR_QUEUE_LENGTH, "dropped", d.Dropped);
+	check(notified == IIS2MDC_DETECTOR_QUEUE_LENGTH, "notifications only for queued events", notified);
+	IIS2MDC_DetectorEvent_t e;
+	unsigned n = 0;
+	while(IIS2MDC_Detector_GetEvent(&d, &e)){
+		check(e.Timestamp == n, "oldest events kept", n); //Newer events are the ones dropped
+		n++;
+	}
+	check(n == IIS2MDC_DETECTOR_QUEUE_LENGTH, "queued", n);
+	printf("overflow: %u queued, %u dropped\n", n, d.Dropped);
+}
+
+int main(void){
+	srand(34);
+	isqrt();
+	scripted();
+	rate_units();
+	hysteresis_sweep();
+	overflow();
+	return test_result();
+}
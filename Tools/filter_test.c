@@ -0,0 +1,172 @@
+/*
+ * filter_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test and benchmark for IIS2MDC_Filter. Median and moving average are checked against brute force over every
+ * window length, the biquad against a double precision reference with the same Q4.28 coefficients, then chaining and
+ * reset. Ends with the cost per sample of a median -> average -> biquad chain.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/filter_test.c Core/Src/IIS2MDC_Filter.c -o filter_test -lm
+ * Run:
+ *   ./filter_test, exits non-zero on failure
+ */
+#include "IIS2MDC_Filter.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define SAMPLES 3000
+
+
+static int compare(const void *a, const void *b){
+	int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+	return (x > y) - (x < y);
+}
+
+/*Axes with a wide range, many duplicates, and only negative values*/
+static void random_sample(int32_t s[3]){
+	s[0] = rand() % 2001 - 1000;
+	s[1] = rand() % 7;
+	s[2] = -(rand() % 100000);
+}
+
+static void windows(void){
+	static IIS2MDC_FilterStage_t median, average;
+	static int32_t history[SAMPLES][3];
+	for(uint8_t w = 1; w <= IIS2MDC_FILTER_MAX_WINDOW; w++){
+		IIS2MDC_Filter_InitMedian(&median, w);
+		IIS2MDC_Filter_InitMovingAverage(&average, w);
+		for(int i = 0; i < SAMPLES; i++){
+			int32_t m[3], a[3];
+			random_sample(history[i]);
+			for(int k = 0; k < 3; k++){
+				m[k] = a[k] = history[i][k];
+			}
+			IIS2MDC_Filter_Apply(&median, m);
+			IIS2MDC_Filter_Apply(&average, a);
+
+			/*Until the window fills both work on the samples seen so far*/
+			int n = (i + 1 < w) ? i + 1 : w;
+			for(int k = 0; k < 3; k++){
+				int32_t window[IIS2MDC_FILTER_MAX_WINDOW];
+				int64_t sum = 0;
+				for(int j = 0; j < n; j++){
+					window[j] = history[i - j][k];
+					sum += window[j];
+				}
+				qsort(window, n, sizeof(window[0]), compare);
+				int32_t expected = (n & 1) ? window[n / 2] : (window[n / 2 - 1] + window[n / 2]) / 2;
+				check(m[k] == expected, "median", w);
+				check(a[k] == lround((double)sum / n), "moving average", w);
+			}
+		}
+	}
+	printf("median, moving average: windows 1..%u, %d samples each\n", IIS2MDC_FILTER_MAX_WINDOW, SAMPLES);
+}
+
+/*2nd order Butterworth low pass at 2 Hz for 100 Hz*/
+static const double B[3] = {0.0009446918438401619, 0.0018893836876803238, 0.0009446918438401619};
+static const double A[2] = {-1.911197067426073, 0.914975834801434};
+static const IIS2MDC_BiquadCoeffs_t Coeffs = {
+		IIS2MDC_BIQUAD_Q28(0.0009446918438401619), IIS2MDC_BIQUAD_Q28(0.0018893836876803238),
+		IIS2MDC_BIQUAD_Q28(0.0009446918438401619), IIS2MDC_BIQUAD_Q28(-1.911197067426073),
+		IIS2MDC_BIQUAD_Q28(0.914975834801434)
+};
+
+static void biquad(void){
+	static IIS2MDC_FilterStage_t stage;
+	IIS2MDC_Filter_InitBiquad(&stage, &Coeffs);
+	double x1[3] = {0}, x2[3] = {0}, y1[3] = {0}, y2[3] = {0};
+	long worst = 0;
+	for(int i = 0; i < 20000; i++){
+		int32_t s[3] = {(i / 500) % 2 ? 1000 : -1000, 7, lround(30000 * sin(i * 0.01)) + rand() % 200};
+		int32_t in[3] = {s[0], s[1], s[2]};
+		IIS2MDC_Filter_Apply(&stage, s);
+		for(int k = 0; k < 3; k++){
+			double y = B[0] * in[k] + B[1] * x1[k] + B[2] * x2[k] - A[0] * y1[k] - A[1] * y2[k];
+			x2[k] = x1[k];
+			x1[k] = in[k];
+			y2[k] = y1[k];
+			y1[k] = y;
+			long e = labs(s[k] - lround(y));
+			if(e > worst){
+				worst = e;
+			}
+		}
+	}
+	/*Output rounding is shaped by the error feedback, not removed, and the poles near 1 amplify it a little*/
+	check(worst <= 8, "biquad error against double", worst);
+
+	/*Error feedback: a step settles exactly instead of stopping in a dead band short of it*/
+	IIS2MDC_Filter_InitBiquad(&stage, &Coeffs);
+	int32_t s[3];
+	for(int i = 0; i < 2000; i++){
+		s[0] = 1000;
+		s[1] = -1000;
+		s[2] = 7;
+		IIS2MDC_Filter_Apply(&stage, s);
+	}
+	check(s[0] == 1000 && s[1] == -1000 && s[2] == 7, "biquad step settles", s[0]);
+	printf("biquad: max error %ld LSB against double, step settles to %d %d %d\n", worst, s[0], s[1], s[2]);
+}
+
+static void chain(void){
+	static IIS2MDC_FilterStage_t median, average;
+	IIS2MDC_Filter_InitMedian(&median, 3);
+	IIS2MDC_Filter_InitMovingAverage(&average, 2);
+	IIS2MDC_FilterStage_t *c = IIS2MDC_Filter_Append(NULL, &median);
+	c = IIS2MDC_Filter_Append(c, &average);
+
+	/*The median removes the spike before the average sees it*/
+	const int32_t input[5] = {10, 10, 5000, 10, 30};
+	const int32_t expected[5] = {10, 10, 10, 10, 20};
+	for(int i = 0; i < 5; i++){
+		int32_t s[3] = {input[i], input[i], input[i]};
+		IIS2MDC_Filter_Apply(c, s);
+		check(s[0] == expected[i] && s[2] == expected[i], "chain", i);
+	}
+
+	/*After a reset the history is gone, the first sample passes straight through*/
+	IIS2MDC_Filter_Reset(c);
+	int32_t s[3] = {-77, 0, 77};
+	IIS2MDC_Filter_Apply(c, s);
+	check(s[0] == -77 && s[1] == 0 && s[2] == 77, "reset", s[0]);
+
+	int32_t p[3] = {1, 2, 3};
+	IIS2MDC_Filter_Apply(NULL, p);
+	check(p[0] == 1 && p[1] == 2 && p[2] == 3, "empty chain", p[0]);
+}
+
+static void cost(void){
+	enum{CALLS = 2000000};
+	static IIS2MDC_FilterStage_t median, average, lowpass;
+	IIS2MDC_Filter_InitMedian(&median, 15);
+	IIS2MDC_Filter_InitMovingAverage(&average, 16);
+	IIS2MDC_Filter_InitBiquad(&lowpass, &Coeffs);
+	IIS2MDC_FilterStage_t *c = IIS2MDC_Filter_Append(NULL, &median);
+	c = IIS2MDC_Filter_Append(c, &average);
+	c = IIS2MDC_Filter_Append(c, &lowpass);
+
+	volatile int32_t sink = 0;
+	clock_t start = clock();
+	for(int i = 0; i < CALLS; i++){
+		int32_t s[3] = {rand() & 1023, i, -i};
+		IIS2MDC_Filter_Apply(c, s);
+		sink += s[0];
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("median 15 -> average 16 -> biquad: %.1f ns per XYZ sample on this host\n", seconds * 1e9 / CALLS);
+}
+
+int main(void){
+	srand(32);
+	windows();
+	biquad();
+	chain();
+	cost();
+	return test_result();
+}
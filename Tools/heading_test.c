@@ -0,0 +1,114 @@
+/*
+ * heading_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Heading: atan2 accuracy swept over 360000 angles at field strengths from 1 to 49151 mG, the
+ * axis and quadrant edges, sine/cosine against libm, heading wrap and declination. Also reports the cost per call.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/heading_test.c Core/Src/IIS2MDC_Heading.c -o heading_test -lm
+ * Run:
+ *   ./heading_test, exits non-zero on failure
+ */
+#include "IIS2MDC_Heading.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define STEPS 360000             /*0.001 deg*/
+#define MAX_ERROR_CENTIDEG 5.0   /*0.05 deg*/
+#define MAX_SIN_ERROR_Q15 3
+
+
+static double angle_error(double a, double b){
+	double e = fmod(fabs(a - b), 36000.0);
+	return e > 18000.0 ? 36000.0 - e : e;
+}
+
+static void atan2_sweep(void){
+	static const int32_t radius[] = {1, 20, 100, 300, 500, 5000, 49151};
+	for(unsigned r = 0; r < sizeof(radius) / sizeof(radius[0]); r++){
+		double worst = 0;
+		for(int k = 0; k < STEPS; k++){
+			double a = k * M_PI / (STEPS / 2);
+			int32_t x = lround(radius[r] * cos(a));
+			int32_t y = lround(radius[r] * sin(a));
+			if(x == 0 && y == 0){
+				continue;
+			}
+			/*Against the angle of the quantized vector, so only the approximation is measured*/
+			double e = angle_error(IIS2MDC_Atan2(y, x), atan2(y, x) * 18000.0 / M_PI);
+			if(e > worst){
+				worst = e;
+			}
+		}
+		check(worst <= MAX_ERROR_CENTIDEG, "atan2 error centidegrees", worst);
+		printf("atan2 |v| = %5d mG: max error %.3f deg\n", radius[r], worst / 100.0);
+	}
+}
+
+static void edges(void){
+	check(IIS2MDC_Atan2(0, 0) == 0, "atan2(0, 0)", IIS2MDC_Atan2(0, 0));
+	check(IIS2MDC_Atan2(0, 5) == 0, "atan2(0, +x)", IIS2MDC_Atan2(0, 5));
+	check(IIS2MDC_Atan2(5, 0) == 9000, "atan2(+y, 0)", IIS2MDC_Atan2(5, 0));
+	check(IIS2MDC_Atan2(0, -5) == 18000, "atan2(0, -x)", IIS2MDC_Atan2(0, -5));
+	check(IIS2MDC_Atan2(-5, 0) == -9000, "atan2(-y, 0)", IIS2MDC_Atan2(-5, 0));
+	check(abs(IIS2MDC_Atan2(65535, 65535) - 4500) <= MAX_ERROR_CENTIDEG, "atan2 diagonal full scale", IIS2MDC_Atan2(65535, 65535));
+	check(abs(IIS2MDC_Atan2(-65535, -65535) + 13500) <= MAX_ERROR_CENTIDEG, "atan2 third quadrant", IIS2MDC_Atan2(-65535, -65535));
+
+	check(IIS2MDC_WrapHeading(-1) == 35999, "wrap -1", IIS2MDC_WrapHeading(-1));
+	check(IIS2MDC_WrapHeading(36000) == 0, "wrap 36000", IIS2MDC_WrapHeading(36000));
+	check(IIS2MDC_WrapHeading(-72001) == 35999, "wrap -72001", IIS2MDC_WrapHeading(-72001));
+	check(IIS2MDC_WrapHeading(18000) == 18000, "wrap 18000", IIS2MDC_WrapHeading(18000));
+}
+
+static void sine(void){
+	int worst = 0;
+	for(int32_t a = -72000; a <= 72000; a++){
+		int s = abs(IIS2MDC_Sin(a) - (int)lround(32767.0 * sin(a * M_PI / 18000.0)));
+		int c = abs(IIS2MDC_Cos(a) - (int)lround(32767.0 * cos(a * M_PI / 18000.0)));
+		if(s > worst){
+			worst = s;
+		}
+		if(c > worst){
+			worst = c;
+		}
+	}
+	check(worst <= MAX_SIN_ERROR_Q15, "sin/cos error Q15", worst);
+	printf("sin/cos: max error %d Q15 LSB over -720..720 deg\n", worst);
+}
+
+static void heading(void){
+	IIS2MDC_Handle_t Dev = {0};
+	Dev.MagX = 0;
+	Dev.MagY = 400;
+	check(IIS2MDC_GetHeading(&Dev) == 9000, "heading east", IIS2MDC_GetHeading(&Dev));
+	IIS2MDC_SetDeclination(&Dev, -1250);
+	check(IIS2MDC_GetHeading(&Dev) == 7750, "heading with west declination", IIS2MDC_GetHeading(&Dev));
+	Dev.MagX = 400;
+	Dev.MagY = 0;
+	check(IIS2MDC_GetHeading(&Dev) == 34750, "heading wraps below north", IIS2MDC_GetHeading(&Dev));
+}
+
+static void cost(void){
+	enum{CALLS = 20000000};
+	volatile int32_t sink = 0;
+	clock_t start = clock();
+	for(int i = 0; i < CALLS; i++){
+		sink += IIS2MDC_Atan2((i & 0x7FFF) - 16384, 300 - (i & 511));
+	}
+	double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	printf("atan2: %.2f ns per call on this host\n", seconds * 1e9 / CALLS);
+}
+
+int main(void){
+	atan2_sweep();
+	edges();
+	sine();
+	heading();
+	cost();
+	return test_result();
+}
@@ -0,0 +1,113 @@
+/*
+ * i2c_timing_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for i2c_timing: TIMINGR values against the ones CubeMX generates, the SCL period they produce, and a sweep
+ * of kernel clocks and board edges where every accepted value is checked against the I2C-bus specification limits.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/i2c_timing_test.c Core/Src/i2c_timing.c -o i2c_timing_test
+ * Run:
+ *   ./i2c_timing_test, exits non-zero on failure
+ */
+#include "i2c_timing.h"
+#include "test_util.h"
+#include <stdio.h>
+
+/*CubeMX defaults: analog filter on, no digital filter, 0 ns rise and fall*/
+static const I2C_Bus_Edges_t cubemx_edges = {0, 0, 1, 0};
+
+typedef struct{
+	uint32_t kernel_hz;
+	I2C_Speed_t speed;
+	uint32_t timing;
+	uint32_t period_ns;
+}Reference_t;
+
+static const Reference_t references[] = {
+	{160000000U, i2c_speed_standard,  0x30909DECU, 10000}, /*MX_I2C2_Init*/
+	{80000000U,  i2c_speed_standard,  0x10909CECU, 10000}, /*STM32L4 at 80 MHz*/
+	{80000000U,  i2c_speed_fast,      0x00702991U, 2500},
+	{80000000U,  i2c_speed_fast_plus, 0x00300F33U, 1000},
+};
+
+/*Specification limits in ns, in I2C_Speed_t order*/
+static const struct{
+	uint32_t rate_hz, vddat_max, sudat_min, low_min, high_min;
+}spec[i2c_speed_count] = {
+	{100000U,  3450, 250, 4700, 4000},
+	{400000U,   900, 100, 1300,  600},
+	{1000000U,  450,  50,  500,  260},
+};
+
+static void cubemx(void){
+	for(unsigned i = 0; i < sizeof(references) / sizeof(references[0]); i++){
+		const Reference_t *r = &references[i];
+		uint32_t timing = 0;
+		check(i2c_timing_compute(r->kernel_hz, r->speed, &cubemx_edges, &timing) == 0, "reference computed", (long)i);
+		check(timing == r->timing, "CubeMX TIMINGR", (long)timing);
+		uint32_t period = i2c_timing_period_ns(r->kernel_hz, r->timing, &cubemx_edges);
+		check(period == r->period_ns, "CubeMX period", (long)period);
+		printf("%3lu MHz %7lu Hz: 0x%08lX, SCL period %lu ns\n", (unsigned long)(r->kernel_hz / 1000000U),
+				(unsigned long)spec[r->speed].rate_hz, (unsigned long)timing, (unsigned long)period);
+	}
+}
+
+/*Checks a computed value against the specification, times in ps*/
+static void within_spec(uint32_t kernel_hz, I2C_Speed_t speed, const I2C_Bus_Edges_t *edges, uint32_t timing){
+	const int64_t clk = (int64_t)(1000000000000ULL / kernel_hz);
+	const int64_t tpresc = (int64_t)((timing >> 28) + 1U) * clk;
+	const int64_t tsync = (edges->analog_filter ? 50000 : 0) + ((int64_t)edges->digital_filter + 2) * clk;
+	const int64_t tscldel = (int64_t)(((timing >> 20) & 0xFU) + 1U) * tpresc;
+	const int64_t tsdadel = (int64_t)((timing >> 16) & 0xFU) * tpresc;
+	const int64_t thigh = (int64_t)(((timing >> 8) & 0xFFU) + 1U) * tpresc + tsync;
+	const int64_t tlow = (int64_t)((timing & 0xFFU) + 1U) * tpresc + tsync;
+	const int64_t af_max = edges->analog_filter ? 260000 : 0;
+
+	check(tscldel >= ((int64_t)edges->rise_ns + spec[speed].sudat_min) * 1000, "data setup", (long)timing);
+	check(tsdadel + af_max + ((int64_t)edges->digital_filter + 4) * clk + (int64_t)edges->rise_ns * 1000 <=
+			(int64_t)spec[speed].vddat_max * 1000, "data valid", (long)timing);
+	check(thigh >= (int64_t)spec[speed].high_min * 1000, "SCL high", (long)timing);
+	check(tlow > (int64_t)spec[speed].low_min * 1000, "SCL low", (long)timing);
+
+	uint32_t rate = 1000000000U / i2c_timing_period_ns(kernel_hz, timing, edges);
+	check(rate * 10U >= spec[speed].rate_hz * 8U && rate * 10U <= spec[speed].rate_hz * 12U, "rate within 20 %", (long)rate);
+}
+
+static void sweep(void){
+	static const I2C_Bus_Edges_t boards[] = {
+		{0, 0, 1, 0},
+		{100, 10, 1, 0},  /*Discovery board I2C2*/
+		{300, 50, 1, 2},
+		{120, 120, 0, 0},
+	};
+	int computed = 0, refused = 0;
+	for(unsigned b = 0; b < sizeof(boards) / sizeof(boards[0]); b++){
+		for(uint32_t mhz = 4; mhz <= 160; mhz += 4){
+			for(int speed = 0; speed < i2c_speed_count; speed++){
+				uint32_t timing;
+				if(i2c_timing_compute(mhz * 1000000U, (I2C_Speed_t)speed, &boards[b], &timing) != 0){
+					refused++;
+					continue;
+				}
+				computed++;
+				within_spec(mhz * 1000000U, (I2C_Speed_t)speed, &boards[b], timing);
+			}
+		}
+	}
+	uint32_t timing;
+	check(i2c_timing_compute(160000000U, i2c_speed_fast_plus, &boards[1], &timing) == 0, "1 MHz from 160 MHz", 0);
+	check(i2c_timing_compute(16000000U, i2c_speed_standard, &boards[1], &timing) == 0, "100 kHz from HSI16", 0);
+	check(i2c_timing_compute(4000000U, i2c_speed_fast_plus, &boards[0], &timing) != 0, "1 MHz from 4 MHz refused", 0);
+	check(i2c_timing_compute(0, i2c_speed_standard, &boards[0], &timing) != 0, "no kernel clock", 0);
+	check(i2c_timing_compute(160000000U, i2c_speed_count, &boards[0], &timing) != 0, "unknown speed", 0);
+	check(i2c_timing_period_ns(0, 0x30909DECU, &boards[0]) == 0, "period without a kernel clock", 0);
+	printf("sweep: %d values within the specification, %d combinations refused\n", computed, refused);
+}
+
+int main(void){
+	cubemx();
+	sweep();
+	return test_result();
+}
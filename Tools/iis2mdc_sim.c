@@ -0,0 +1,275 @@
+/*
+ * iis2mdc_sim.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#include "iis2mdc_sim.h"
+#include "log.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CFG_A_SOFT_RST (1U << 5)
+#define CFG_A_MODE_MASK (0x03U)
+#define CFG_C_DRDY_ON_PIN (1U << 0)
+#define STATUS_NEW (0x0FU)      /*Zyxda | zda | yda | xda*/
+#define STATUS_OVERRUN (0xF0U)  /*Zyxor | zor | yor | xor*/
+
+sim_t sim;
+sim_t sim_second;
+static sim_t *const sensors[SIM_SENSORS] = {&sim, &sim_second};
+
+/*The driver's log goes here. SIM_VERBOSE in the environment prints it.*/
+void _log(Log_Subsystem_t subsystem, const char* msg, ...){
+	(void)subsystem;
+	sim.log_messages++;
+	if(getenv("SIM_VERBOSE") != NULL){
+		va_list args;
+		va_start(args, msg);
+		printf("[%8.3f ms] ", sim.now_us / 1000.0);
+		vprintf(msg, args);
+		printf("\n");
+		va_end(args);
+	}
+}
+
+static void reset_registers(sim_t *s){
+	memset(s->regs, 0, sizeof(s->regs));
+	s->regs[IIS2MDC_REG_WHO_AM_I] = 0x40;
+	s->regs[IIS2MDC_REG_CFG_REG_A] = 0x03;
+	s->regs[IIS2MDC_REG_INT_CTRL_REG] = 0xE0;
+	s->conversion_due_us = 0;
+}
+
+static uint8_t mode(const sim_t *s){
+	return s->regs[IIS2MDC_REG_CFG_REG_A] & CFG_A_MODE_MASK;
+}
+
+static uint32_t odr_hz(const sim_t *s){
+	static const uint32_t odr[4] = {10, 20, 50, 100};
+	return odr[(s->regs[IIS2MDC_REG_CFG_REG_A] >> 2) & 0x03U];
+}
+
+uint32_t sim_odr_hz(void){
+	return odr_hz(&sim);
+}
+
+static void convert(sim_t *s, uint64_t at_us){
+	int16_t field[3] = {0, 0, 0};
+	if(s->field != NULL){
+		s->field(at_us, field);
+	}
+	for(int a = 0; a < 3; a++){
+		s->regs[IIS2MDC_REG_OUTX_L_REG + 2 * a] = (uint8_t)((uint16_t)field[a] & 0xFFU);
+		s->regs[IIS2MDC_REG_OUTX_L_REG + 2 * a + 1] = (uint8_t)((uint16_t)field[a] >> 8);
+	}
+	uint8_t *status = &s->regs[IIS2MDC_REG_STATUS_REG];
+	if(*status & STATUS_NEW){
+		*status |= STATUS_OVERRUN;
+		s->overruns++;
+	}
+	*status |= STATUS_NEW;
+	s->samples++;
+	if((s->regs[IIS2MDC_REG_CFG_REG_C] & CFG_C_DRDY_ON_PIN) && s->drdy != NULL){
+		s->drdy();
+	}
+}
+
+/*Runs one sensor's conversions due up to until_us in time order*/
+static void advance(sim_t *s, uint64_t until_us){
+	for(;;){
+		uint64_t next = UINT64_MAX;
+		if(s->conversion_due_us != 0){
+			next = s->conversion_due_us;
+		}
+		if(mode(s) == 0 && s->next_sample_us < next){
+			next = s->next_sample_us;
+		}
+		if(next > until_us){
+			break;
+		}
+		s->now_us = next;
+		if(next == s->conversion_due_us){
+			s->conversion_due_us = 0;
+			s->regs[IIS2MDC_REG_CFG_REG_A] |= CFG_A_MODE_MASK; //One-shot falls back to idle
+		} else {
+			s->next_sample_us += 1000000U / odr_hz(s);
+		}
+		convert(s, next);
+	}
+	if(until_us > s->now_us){
+		s->now_us = until_us;
+	}
+}
+
+/*The clock is shared, every powered sensor converts up to until_us*/
+void sim_advance(uint64_t until_us){
+	for(uint32_t i = 0; i < SIM_SENSORS; i++){
+		if(sensors[i]->powered){
+			advance(sensors[i], until_us);
+		}
+	}
+}
+
+/*Boot starts at power on, at the current time of the shared clock*/
+void sim_power_on_sensor(sim_t *s){
+	uint64_t now = 0;
+	for(uint32_t i = 0; i < SIM_SENSORS; i++){
+		if(sensors[i] == s || sensors[i]->powered){
+			now = (sensors[i]->now_us > now) ? sensors[i]->now_us : now;
+		}
+	}
+	memset(s, 0, sizeof(*s));
+	s->powered = 1;
+	s->now_us = now;
+	s->boot_done_us = now + IIS2MDC_BOOT_MS * 1000U;
+	reset_registers(s);
+}
+
+void sim_power_on(void){
+	sim_power_on_sensor(&sim);
+}
+
+void sim_clear_log(void){
+	sim.log_count = 0;
+	sim.reads = 0;
+	sim.writes = 0;
+	sim.bytes = 0;
+}
+
+static sim_transfer_t* record(sim_t *s, char op, uint8_t reg, const uint8_t *pdata, uint8_t length, IIS2MDC_Status_t status){
+	if(s->log_count == SIM_LOG_LENGTH){
+		return NULL;
+	}
+	sim_transfer_t *t = &s->log[s->log_count++];
+	t->op = op;
+	t->reg = reg;
+	t->length = length;
+	t->status = status;
+	memcpy(t->data, pdata, length < sizeof(t->data) ? length : sizeof(t->data));
+	return t;
+}
+
+/*Common front of every transfer: bus time, boot, injected faults*/
+static IIS2MDC_Status_t begin(sim_t *s, uint8_t length){
+	if(s->stuck){
+		sim_advance(s->now_us + SIM_TIMEOUT_US);
+		return IIS2MDC_ErrorTimeout;
+	}
+	if(s->fail_next){
+		s->fail_next--;
+		sim_advance(s->now_us + (s->fail_status == IIS2MDC_ErrorTimeout ? SIM_TIMEOUT_US : SIM_TRANSFER_US));
+		return s->fail_status;
+	}
+	sim_advance(s->now_us + SIM_TRANSFER_US + SIM_BYTE_US * length);
+	if(s->now_us < s->boot_done_us){
+		s->early_accesses++;
+		return IIS2MDC_ErrorNack;
+	}
+	return IIS2MDC_Ok;
+}
+
+static IIS2MDC_Status_t read_reg(sim_t *s, uint8_t reg, uint8_t *pdata, uint8_t length){
+	IIS2MDC_Status_t status = begin(s, length);
+	if(status == IIS2MDC_Ok){
+		for(uint8_t i = 0; i < length; i++){
+			pdata[i] = s->regs[(reg + i) & 0x7FU];
+		}
+		if(reg <= IIS2MDC_REG_OUTZ_H_REG && reg + length > IIS2MDC_REG_OUTZ_H_REG){
+			s->regs[IIS2MDC_REG_STATUS_REG] = 0; //Reading the outputs clears the status and releases DRDY
+		}
+		s->reads++;
+		s->bytes += length;
+	}
+	record(s, 'r', reg, pdata, status == IIS2MDC_Ok ? length : 0, status);
+	return status;
+}
+
+static IIS2MDC_Status_t write_reg(sim_t *s, uint8_t reg, uint8_t *pdata, uint8_t length){
+	IIS2MDC_Status_t status = begin(s, length);
+	record(s, 'w', reg, pdata, length, status);
+	if(status != IIS2MDC_Ok){
+		return status;
+	}
+	s->writes++;
+	s->bytes += length;
+	uint8_t was = mode(s);
+	for(uint8_t i = 0; i < length; i++){
+		uint8_t r = (reg + i) & 0x7FU;
+		if(r == IIS2MDC_REG_CFG_REG_A && (pdata[i] & CFG_A_SOFT_RST)){
+			reset_registers(s);
+			continue;
+		}
+		if(r != IIS2MDC_REG_WHO_AM_I && r != IIS2MDC_REG_STATUS_REG && r != IIS2MDC_REG_INT_SOURCE_REG &&
+				(r < IIS2MDC_REG_OUTX_L_REG || r > IIS2MDC_REG_TEMP_OUT_H_REG)){
+			s->regs[r] = pdata[i];
+		}
+	}
+	if(reg <= IIS2MDC_REG_CFG_REG_A && reg + length > IIS2MDC_REG_CFG_REG_A){
+		if(mode(s) == 1){
+			s->conversion_due_us = s->now_us + SIM_CONVERSION_US;
+		} else if(mode(s) == 0 && was != 0){
+			s->next_sample_us = s->now_us + 1000000U / odr_hz(s);
+		}
+	}
+	return IIS2MDC_Ok;
+}
+
+static uint8_t ioctl(sim_t *s, IIS2MDC_Cmd_t cmd){
+	switch(cmd){
+	case IIS2MDC_ReadIntPin:
+		return (s->regs[IIS2MDC_REG_CFG_REG_C] & CFG_C_DRDY_ON_PIN) && (s->regs[IIS2MDC_REG_STATUS_REG] & STATUS_NEW);
+	case IIS2MDC_BusClear:
+		s->bus_clears++;
+		if(s->stuck && s->clear_fails){
+			s->clear_fails--;
+			return IIS2MDC_Error;
+		}
+		s->stuck = 0;
+		return IIS2MDC_Ok;
+	case IIS2MDC_BusReinit:
+		s->reinits++;
+		return IIS2MDC_Ok;
+	case IIS2MDC_BootRemaining:
+		return s->now_us >= s->boot_done_us ? 0 : (uint8_t)((s->boot_done_us - s->now_us + 999U) / 1000U);
+	case IIS2MDC_BootWait:
+		sim_advance(s->boot_done_us);
+		return s->boot_wait_fails ? IIS2MDC_Error : IIS2MDC_Ok;
+	case IIS2MDC_IRQEnable:
+		s->irq_enabled = 1;
+		return 0;
+	case IIS2MDC_IRQDisable:
+		s->irq_enabled = 0;
+		return 0;
+	case IIS2MDC_InterfaceBits:
+	default:
+		return 0;
+	}
+}
+
+static void io_init(void){
+}
+
+static void io_deinit(void){
+}
+
+/*The IO driver has no context argument, one set of entry points per sensor*/
+static IIS2MDC_Status_t read0(uint8_t reg, uint8_t *pdata, uint8_t length){ return read_reg(&sim, reg, pdata, length); }
+static IIS2MDC_Status_t read1(uint8_t reg, uint8_t *pdata, uint8_t length){ return read_reg(&sim_second, reg, pdata, length); }
+static IIS2MDC_Status_t write0(uint8_t reg, uint8_t *pdata, uint8_t length){ return write_reg(&sim, reg, pdata, length); }
+static IIS2MDC_Status_t write1(uint8_t reg, uint8_t *pdata, uint8_t length){ return write_reg(&sim_second, reg, pdata, length); }
+static uint8_t ioctl0(IIS2MDC_Cmd_t cmd){ return ioctl(&sim, cmd); }
+static uint8_t ioctl1(IIS2MDC_Cmd_t cmd){ return ioctl(&sim_second, cmd); }
+
+IIS2MDC_IO_Drv_t sim_driver_of(sim_t *s){
+	if(s == &sim_second){
+		return (IIS2MDC_IO_Drv_t){io_init, io_deinit, read1, write1, ioctl1, NULL};
+	}
+	return (IIS2MDC_IO_Drv_t){io_init, io_deinit, read0, write0, ioctl0, NULL};
+}
+
+IIS2MDC_IO_Drv_t sim_driver(void){
+	return sim_driver_of(&sim);
+}
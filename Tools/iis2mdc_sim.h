@@ -0,0 +1,79 @@
+/*
+ * iis2mdc_sim.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Simulated IIS2MDC behind an IIS2MDC_IO_Drv_t, shared by the host tests. Host only.
+ * Models the register file, boot time, one-shot and continuous conversions, STATUS/DRDY, and a virtual clock that
+ * every bus transfer advances. Transfers are logged so tests can assert the exact traffic, and faults can be injected.
+ * Most tests use the one sensor in sim. A second one, sim_second, shares its clock for tests that bring up two.
+ */
+
+#ifndef IIS2MDC_SIM_H_
+#define IIS2MDC_SIM_H_
+
+#include "IIS2MDC.h"
+#include <stdint.h>
+
+#define SIM_LOG_LENGTH 256U
+#define SIM_TRANSFER_US 60U          /*Start, address and register byte at 400 kHz*/
+#define SIM_BYTE_US 23U              /*Per data byte at 400 kHz*/
+#define SIM_TIMEOUT_US 1000U         /*What a transfer against a held bus costs before it gives up*/
+#define SIM_CONVERSION_US 9000U      /*One-shot conversion time*/
+#define SIM_SENSORS 2U
+
+typedef struct{
+	char op;                         /*'r' or 'w'*/
+	uint8_t reg;
+	uint8_t length;
+	uint8_t data[16];                /*Bytes written, or returned by a read*/
+	IIS2MDC_Status_t status;
+}sim_transfer_t;
+
+typedef struct{
+	uint8_t regs[0x80];
+	uint8_t powered;
+	uint8_t irq_enabled;             /*Pin interrupt, through the IRQEnable/IRQDisable ioctls*/
+	uint64_t now_us;                 /*Virtual clock, the same for every powered sensor*/
+	uint64_t boot_done_us;           /*The chip NACKs before this*/
+	uint32_t early_accesses;         /*Transfers tried before boot finished*/
+
+	/*Conversions*/
+	uint64_t conversion_due_us;      /*One-shot result time, 0 when none is running*/
+	uint64_t next_sample_us;         /*Continuous mode*/
+	void (*field)(uint64_t now_us, int16_t out[3]); /*Field source in LSB, NULL reads as 0*/
+	void (*drdy)(void);              /*Rising DRDY, like the EXTI handler*/
+	uint32_t samples;                /*Conversions completed*/
+	uint32_t overruns;               /*Conversions that overwrote unread data*/
+
+	/*Fault injection*/
+	uint32_t fail_next;              /*Transfers that fail with fail_status*/
+	IIS2MDC_Status_t fail_status;
+	uint8_t stuck;                   /*SDA held low: every transfer times out until a bus clear works*/
+	uint32_t clear_fails;            /*Bus clears that do not free SDA*/
+	uint8_t boot_wait_fails;         /*The transport can't be set up in the BootWait ioctl*/
+	uint32_t bus_clears;
+	uint32_t reinits;
+
+	/*Traffic*/
+	sim_transfer_t log[SIM_LOG_LENGTH];
+	uint32_t log_count;
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t bytes;
+	uint32_t log_messages;           /*_log calls from the driver*/
+}sim_t;
+
+extern sim_t sim;
+extern sim_t sim_second;
+
+void sim_power_on(void);
+void sim_power_on_sensor(sim_t *s);
+IIS2MDC_IO_Drv_t sim_driver(void);
+IIS2MDC_IO_Drv_t sim_driver_of(sim_t *s);
+void sim_advance(uint64_t until_us);
+void sim_clear_log(void);
+uint32_t sim_odr_hz(void);
+
+#endif /* IIS2MDC_SIM_H_ */
@@ -0,0 +1,164 @@
+/*
+ * lowpower_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_LowPower against the simulated sensor: trigger spacing, sleep fraction, elapsed time, the
+ * prescaler choice for long periods, out of range periods, and missed triggers when the period is shorter than a
+ * conversion. The low power timer is modelled on the simulator's clock.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/lowpower_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC_LowPower.c Core/Src/IIS2MDC.c \
+ *       Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o lowpower_test -lm
+ * Run:
+ *   ./lowpower_test, exits non-zero on failure. SIM_VERBOSE=1 prints the driver log.
+ */
+#include "iis2mdc_sim.h"
+#include "IIS2MDC_LowPower.h"
+#include "test_util.h"
+#include <stdio.h>
+
+#define LSE_HZ 32768U
+
+static IIS2MDC_Handle_t Dev;
+static IIS2MDC_LowPower_t LP;
+
+/*LPTIM model: free running counter of LSE_HZ >> prescaler, compare event every period*/
+static struct{
+	uint8_t prescaler;
+	uint16_t period;
+	uint64_t start_us;
+	uint64_t next_event;     /*In prescaled ticks since start*/
+	uint8_t running;
+}timer;
+
+static uint64_t ticks(void){
+	return ((sim.now_us - timer.start_us) * LSE_HZ / 1000000U) >> timer.prescaler;
+}
+
+static uint64_t tick_us(uint64_t t){
+	return timer.start_us + (((t << timer.prescaler) * 1000000U) + LSE_HZ - 1) / LSE_HZ;
+}
+
+/*What the timer interrupt does, whether the core is awake or asleep*/
+static void timer_poll(void){
+	if(timer.running && ticks() >= timer.next_event){
+		timer.next_event += timer.period;
+		IIS2MDC_LowPower_TimerEvent(&LP);
+	}
+}
+
+static void timer_init(void){
+}
+
+static void timer_start(uint8_t prescaler, uint16_t period){
+	timer.prescaler = prescaler;
+	timer.period = period;
+	timer.start_us = sim.now_us;
+	timer.next_event = period;
+	timer.running = 1;
+}
+
+static void timer_stop(void){
+	timer.running = 0;
+}
+
+static uint16_t timer_read(void){
+	return (uint16_t)ticks();
+}
+
+/*Stop 2 until the timer compare or DRDY*/
+static void sleep(void){
+	uint64_t wake = timer.running ? tick_us(timer.next_event) : UINT64_MAX;
+	if(sim.conversion_due_us != 0 && sim.conversion_due_us < wake){
+		wake = sim.conversion_due_us;
+	}
+	if(wake != UINT64_MAX){
+		sim_advance(wake);
+	}
+	timer_poll();
+}
+
+static void critical(void){
+}
+
+static void drdy(void){
+	Dev.DataReadyFlag = IIS2MDC_DataReady;
+}
+
+static const IIS2MDC_LowPower_Drv_t Drv = {timer_init, timer_start, timer_stop, timer_read, sleep, critical, critical, LSE_HZ};
+
+static void sensor_init(void){
+	sim_power_on();
+	sim.drdy = drdy;
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.OperatingMode = IIS2MDC_OneShotMode;
+	Settings.DrdyPinMode = IIS2MDC_DrdyOnPin;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+}
+
+/*Runs until count samples arrived or calls ran out, returns the time of each sample*/
+static uint32_t run(uint32_t count, uint64_t *at, uint32_t calls){
+	uint32_t n = 0;
+	while(n < count && calls--){
+		timer_poll();
+		if(IIS2MDC_LowPower_Process(&LP) == IIS2MDC_DataReady){
+			at[n++] = sim.now_us;
+		}
+	}
+	return n;
+}
+
+static void periodic(uint32_t period_ms, uint8_t prescaler, uint32_t count){
+	uint64_t at[32];
+	sensor_init();
+	check(IIS2MDC_LowPower_Init(&LP, &Dev, Drv, period_ms) == IIS2MDC_Ok, "init", period_ms);
+	check(LP.PrescalerLog2 == prescaler, "prescaler", LP.PrescalerLog2);
+	uint32_t n = run(count, at, 100 * count);
+	check(n == count, "samples", n);
+
+	/*Every sample lands one conversion after its trigger, so the spacing is the timer period exactly*/
+	uint64_t period_us = ((uint64_t)LP.PeriodTicks << LP.PrescalerLog2) * 1000000U / LSE_HZ;
+	for(uint32_t i = 1; i < n; i++){
+		long error = (long)(at[i] - at[i - 1]) - (long)period_us;
+		check(error >= -1 && error <= 1, "spacing error us", error);
+	}
+	check(LP.Stats.MissedTriggers == 0, "missed triggers", LP.Stats.MissedTriggers);
+	check(LP.Stats.Samples == n, "stats samples", LP.Stats.Samples);
+
+	/*The core sleeps through the conversion too, so a conversion plus the transfers bounds the awake time*/
+	uint16_t permille = IIS2MDC_LowPower_SleepPermille(&LP);
+	uint32_t awake_us = SIM_CONVERSION_US + 1000U;
+	check(permille >= 1000U - (awake_us * 1000U) / (period_ms * 1000U) - 1, "sleep permille", permille);
+
+	/*Counted in timer ticks, so it trails the clock by up to one tick*/
+	long tick_ms = (long)((1000U << LP.PrescalerLog2) / LSE_HZ) + 1;
+	long elapsed = (long)IIS2MDC_LowPower_ElapsedMs(&LP) - (long)((sim.now_us - timer.start_us) / 1000U);
+	check(elapsed >= -tick_ms && elapsed <= 1, "elapsed ms error", elapsed);
+	printf("%6lu ms: prescaler %u, %u samples, asleep %u permille, %lu bus bytes\n", (unsigned long)period_ms,
+			LP.PrescalerLog2, n, permille, (unsigned long)sim.bytes);
+	IIS2MDC_LowPower_DeInit(&LP);
+}
+
+int main(void){
+	periodic(100, 0, 30);
+	periodic(1000, 0, 20);
+	periodic(10000, 3, 5);
+	periodic(200000, 7, 3);
+
+	/*Longer than the timer reaches with the largest prescaler, and too short to be a tick*/
+	sensor_init();
+	check(IIS2MDC_LowPower_Init(&LP, &Dev, Drv, 300000) == IIS2MDC_Error, "300 s accepted", 0);
+	check(IIS2MDC_LowPower_Init(&LP, &Dev, Drv, 0) == IIS2MDC_Error, "0 ms accepted", 0);
+
+	/*A 5 ms period restarts the 9 ms conversion before it completes: every trigger after the first is missed*/
+	uint64_t at[1];
+	sensor_init();
+	check(IIS2MDC_LowPower_Init(&LP, &Dev, Drv, 5) == IIS2MDC_Ok, "init", 5);
+	uint32_t n = run(1, at, 200);
+	check(n == 0, "samples with a period shorter than a conversion", n);
+	check(LP.Stats.MissedTriggers >= 50, "missed triggers", LP.Stats.MissedTriggers);
+	printf("     5 ms: %u missed triggers, no samples\n", LP.Stats.MissedTriggers);
+
+	return test_result();
+}
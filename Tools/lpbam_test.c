@@ -0,0 +1,196 @@
+/*
+ * lpbam_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for lpbam: the linked list lpbam_i2c_read_build makes for the autonomous sensor reads, checked field by
+ * field against the GPDMA and I2C register definitions from the device header rather than lpbam.c's own copies. The
+ * list is walked the way the channel loads it, from lpbam_first_link, over two turns of the ring. Also covers the
+ * configurations it must refuse.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools -IDrivers/CMSIS/Device/ST/STM32U5xx/Include -IDrivers/CMSIS/Include Tools/lpbam_test.c \
+ *       Core/Src/lpbam.c -o lpbam_test
+ * Run:
+ *   ./lpbam_test, exits non-zero on failure
+ */
+#include "lpbam.h"
+#include "test_util.h"
+#include <stddef.h>
+#include <stdio.h>
+/*core_cm33.h casts register addresses to pointers, which a 64 bit host warns about. Only the defines are used here.*/
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
+#include "stm32u585xx.h"
+#pragma GCC diagnostic pop
+
+/*GPDMA1 request and trigger lines, from stm32u5xx_hal_dma.h / stm32u5xx_hal_dma_ex.h*/
+#define REQUEST_I2C2_RX 15U
+#define REQUEST_I2C2_TX 16U
+#define TRIGGER_LPTIM1_CH1 11U
+
+#define DEVICE_ADDRESS 0x3CU      /*IIS2MDC, 8 bit*/
+#define READ_REG 0x67U            /*STATUS_REG, then OUTX_L..OUTZ_H*/
+#define READ_LENGTH 7U
+#define LINEAR_UPDATE (DMA_CLLR_UT1 | DMA_CLLR_UT2 | DMA_CLLR_UB1 | DMA_CLLR_USA | DMA_CLLR_UDA | DMA_CLLR_ULL)
+
+static LPBAM_Table_t table;
+
+/*What IIS2MDC_Hardware.c and i2c2_autonomous_start hand to the builder, table and ring in SRAM4*/
+static LPBAM_I2C_Read_t board(void){
+	return (LPBAM_I2C_Read_t){
+		.cr2_address = I2C2_BASE_NS + offsetof(I2C_TypeDef, CR2),
+		.txdr_address = I2C2_BASE_NS + offsetof(I2C_TypeDef, TXDR),
+		.rxdr_address = I2C2_BASE_NS + offsetof(I2C_TypeDef, RXDR),
+		.request_tx = REQUEST_I2C2_TX,
+		.request_rx = REQUEST_I2C2_RX,
+		.request_tc = REQUEST_I2C2_TX,
+		.trigger = TRIGGER_LPTIM1_CH1,
+		.device_address = DEVICE_ADDRESS,
+		.reg = READ_REG,
+		.length = READ_LENGTH,
+		.slots = 16,
+		.slot_size = 8,
+		.wake_every = 8,
+		.ring_address = SRAM4_BASE_NS + 0x800U,
+		.table_address = SRAM4_BASE_NS
+	};
+}
+
+static uint32_t table_address(const LPBAM_I2C_Read_t *cfg, size_t offset){
+	return cfg->table_address + (uint32_t)offset;
+}
+
+/*The words the DMA copies into CR2 to start the register write and the read*/
+static void cr2_values(const LPBAM_I2C_Read_t *cfg){
+	check((table.cr2_write & I2C_CR2_SADD) == DEVICE_ADDRESS, "write address", (long)table.cr2_write);
+	check(((table.cr2_write & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos) == 1, "write one register byte", (long)table.cr2_write);
+	check((table.cr2_write & (I2C_CR2_RD_WRN | I2C_CR2_AUTOEND)) == 0, "write then repeated start", (long)table.cr2_write);
+	check((table.cr2_write & I2C_CR2_START) != 0, "write starts", (long)table.cr2_write);
+
+	check((table.cr2_read & I2C_CR2_SADD) == DEVICE_ADDRESS, "read address", (long)table.cr2_read);
+	check(((table.cr2_read & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos) == cfg->length, "read length", (long)table.cr2_read);
+	check((table.cr2_read & (I2C_CR2_RD_WRN | I2C_CR2_AUTOEND | I2C_CR2_START)) ==
+			(I2C_CR2_RD_WRN | I2C_CR2_AUTOEND | I2C_CR2_START), "read with stop", (long)table.cr2_read);
+	check(table.reg == cfg->reg, "register", (long)table.reg);
+}
+
+/*One node against what the channel must do at that step of a read*/
+static void expect_node(const LPBAM_Node_t *node, uint32_t read, uint8_t step, const LPBAM_I2C_Read_t *cfg){
+	const uint32_t word = DMA_CTR1_SDW_LOG2_1 | DMA_CTR1_DDW_LOG2_1;
+	uint32_t ctr1, ctr2, bytes, src, dst;
+	switch(step){
+	case 0: /*Trigger -> CR2, write the register address*/
+		ctr1 = word;
+		ctr2 = DMA_CTR2_SWREQ | (TRIGGER_LPTIM1_CH1 << DMA_CTR2_TRIGSEL_Pos) | DMA_CTR2_TRIGPOL_0 | DMA_CTR2_TCEM;
+		bytes = 4;
+		src = table_address(cfg, offsetof(LPBAM_Table_t, cr2_write));
+		dst = cfg->cr2_address;
+		break;
+	case 1: /*TXIS -> TXDR*/
+		ctr1 = 0;
+		ctr2 = (REQUEST_I2C2_TX << DMA_CTR2_REQSEL_Pos) | DMA_CTR2_DREQ | DMA_CTR2_TCEM;
+		bytes = 1;
+		src = table_address(cfg, offsetof(LPBAM_Table_t, reg));
+		dst = cfg->txdr_address;
+		break;
+	case 2: /*TC -> CR2, read with AUTOEND*/
+		ctr1 = word;
+		ctr2 = (REQUEST_I2C2_TX << DMA_CTR2_REQSEL_Pos) | DMA_CTR2_DREQ | DMA_CTR2_TCEM;
+		bytes = 4;
+		src = table_address(cfg, offsetof(LPBAM_Table_t, cr2_read));
+		dst = cfg->cr2_address;
+		break;
+	default: /*RXNE -> ring slot, the event on the last read of each block*/
+		ctr1 = DMA_CTR1_DINC;
+		ctr2 = (REQUEST_I2C2_RX << DMA_CTR2_REQSEL_Pos) | ((read + 1) % cfg->wake_every == 0 ? 0 : DMA_CTR2_TCEM);
+		bytes = cfg->length;
+		src = cfg->rxdr_address;
+		dst = cfg->ring_address + (read % cfg->slots) * cfg->slot_size;
+		break;
+	}
+	check(node->ctr1 == ctr1, "CTR1", (long)(read * 4 + step));
+	check(node->ctr2 == ctr2, "CTR2", (long)(read * 4 + step));
+	check((node->cbr1 & DMA_CBR1_BNDT) == bytes && (node->cbr1 & ~DMA_CBR1_BNDT) == 0, "CBR1", (long)(read * 4 + step));
+	check(node->csar == src, "CSAR", (long)(read * 4 + step));
+	check(node->cdar == dst, "CDAR", (long)(read * 4 + step));
+	check((node->cllr & LINEAR_UPDATE) == LINEAR_UPDATE && (node->cllr & ~(DMA_CLLR_LA | LINEAR_UPDATE)) == 0,
+			"CLLR reloads every register", (long)(read * 4 + step));
+}
+
+/*Follows the links from CLBAR/CLLR like the channel, over two turns of the ring*/
+static void walk(const LPBAM_I2C_Read_t *cfg, uint16_t count){
+	check(lpbam_base(cfg) == (cfg->table_address & DMA_CLBAR_LBA), "CLBAR", (long)lpbam_base(cfg));
+	uint32_t link = lpbam_first_link(cfg);
+	uint32_t events = 0;
+	for(uint32_t i = 0; i < 2U * count; i++){
+		uint32_t address = lpbam_base(cfg) | (link & DMA_CLLR_LA);
+		uint32_t offset = address - table_address(cfg, offsetof(LPBAM_Table_t, nodes));
+		check(offset % sizeof(LPBAM_Node_t) == 0 && offset / sizeof(LPBAM_Node_t) < count, "link inside the table", (long)i);
+		if(offset / sizeof(LPBAM_Node_t) != i % count){
+			check(0, "nodes in order", (long)i);
+			return;
+		}
+		const LPBAM_Node_t *node = &table.nodes[i % count];
+		expect_node(node, (i / LPBAM_NODES_PER_READ) % cfg->slots, (uint8_t)(i % LPBAM_NODES_PER_READ), cfg);
+		events += (node->ctr2 & DMA_CTR2_TCEM) == 0;
+		link = node->cllr;
+	}
+	check(events == 2U * cfg->slots / cfg->wake_every, "one wake up per block", (long)events);
+}
+
+static void sequence(void){
+	static const struct{
+		uint8_t slots, wake_every;
+	}shapes[] = {{16, 8}, {2, 1}, {4, 4}, {12, 3}};
+	for(unsigned i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++){
+		LPBAM_I2C_Read_t cfg = board();
+		cfg.slots = shapes[i].slots;
+		cfg.wake_every = shapes[i].wake_every;
+		uint16_t count = lpbam_i2c_read_build(&cfg, &table);
+		check(count == cfg.slots * LPBAM_NODES_PER_READ, "node count", count);
+		cr2_values(&cfg);
+		walk(&cfg, count);
+		printf("%2u slots, wake every %u: %u nodes, %u bytes of list\n", cfg.slots, cfg.wake_every, count,
+				(unsigned)(offsetof(LPBAM_Table_t, nodes) + count * sizeof(LPBAM_Node_t)));
+	}
+}
+
+static void refused(void){
+	LPBAM_I2C_Read_t cfg = board();
+	cfg.slots = 0;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "no slots", 0);
+	cfg.slots = LPBAM_MAX_SLOTS + 1;
+	cfg.wake_every = 1;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "too many slots", 0);
+
+	cfg = board();
+	cfg.length = 0;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "empty read", 0);
+	cfg = board();
+	cfg.slot_size = cfg.length - 1;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "slot smaller than the read", 0);
+	cfg = board();
+	cfg.wake_every = 0;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "no wake ups", 0);
+	cfg.wake_every = 5;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "block doesn't divide the ring", 0);
+	cfg = board();
+	cfg.table_address += 2;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "unaligned table", 0);
+
+	/*CLLR only holds the low 16 bits of a node address*/
+	cfg = board();
+	cfg.table_address = SRAM4_BASE_NS + 0x10000U - 0x400U;
+	check(lpbam_i2c_read_build(&cfg, &table) == 0, "table across a 64 KB page", 0);
+	cfg.slots = 8;
+	cfg.wake_every = 4;
+	check(lpbam_i2c_read_build(&cfg, &table) == 8 * LPBAM_NODES_PER_READ, "table up to the page end", 0);
+	walk(&cfg, 8 * LPBAM_NODES_PER_READ);
+}
+
+int main(void){
+	sequence();
+	refused();
+	return test_result();
+}
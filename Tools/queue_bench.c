@@ -0,0 +1,186 @@
+/*
+ * queue_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host benchmark for IIS2MDC_Queue: bytes moved per sample on the way from the bus to the consumer, for the
+ * IIS2MDC_ReadMagnetic path main.c uses by default and for the zero copy queue, on the simulated sensor. The queue's
+ * transport is modelled as a DMA that completes before the next conversion. Also checks the queue's promises: the
+ * slots hold exactly what came off the bus, the consumer reads them in place, and every slot is calibrated once no
+ * matter how many consumers ask.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/queue_bench.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC_Queue.c Core/Src/IIS2MDC.c \
+ *       Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o queue_bench -lm
+ * Run:
+ *   ./queue_bench, exits non-zero on failure
+ */
+#include "iis2mdc_sim.h"
+#include "IIS2MDC_Queue.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLES 4096U
+#define QUEUE_LENGTH 64U
+#define CONSUME_EVERY 16U  /*Samples per main loop wake up*/
+
+static IIS2MDC_Handle_t Dev;
+static IIS2MDC_Queue_t Queue;
+
+static int16_t raw[3 * QUEUE_LENGTH];
+static int16_t calibrated[3 * QUEUE_LENGTH];
+static uint32_t timestamps[QUEUE_LENGTH];
+static uint8_t epochs[QUEUE_LENGTH];
+
+/*Every conversion of the simulated sensor, to compare the slots against*/
+static int16_t produced[SAMPLES + 16][3];
+static uint32_t conversions;
+
+/*main.c's logs*/
+static float log_x[SAMPLES], log_y[SAMPLES], log_z[SAMPLES];
+
+/*One read in flight, landed by the "DMA" before the next conversion*/
+static struct{
+	uint8_t pending;
+	uint8_t reg;
+	uint8_t *target;
+	uint8_t length;
+	IIS2MDC_ReadDone_t done;
+	void *context;
+}dma;
+
+static void field(uint64_t now_us, int16_t out[3]){
+	uint32_t n = conversions++;
+	out[0] = (int16_t)(300 + (int32_t)(n % 97) - 48);
+	out[1] = (int16_t)(-200 + (int32_t)((n * 7U) % 89) - 44);
+	out[2] = (int16_t)(150 - (int32_t)((n * 13U) % 83));
+	(void)now_us;
+	if(n < sizeof(produced) / sizeof(produced[0])){
+		memcpy(produced[n], out, sizeof(produced[n]));
+	}
+}
+
+static IIS2MDC_Status_t read_async(uint8_t reg, uint8_t *pdata, uint8_t length, IIS2MDC_ReadDone_t Done, void *Context){
+	if(dma.pending){
+		return IIS2MDC_Error;
+	}
+	dma.pending = 1;
+	dma.reg = reg;
+	dma.target = pdata;
+	dma.length = length;
+	dma.done = Done;
+	dma.context = Context;
+	return IIS2MDC_Ok;
+}
+
+/*The transfer itself goes through the simulated bus straight into the target, like the DMA into the slot*/
+static void dma_complete(void){
+	if(dma.pending){
+		dma.pending = 0;
+		IIS2MDC_Status_t Status = sim_driver().ReadReg(dma.reg, dma.target, dma.length);
+		dma.done(dma.context, Status);
+	}
+}
+
+static void drdy(void){
+	IIS2MDC_Queue_Read(&Queue, (uint32_t)(sim.now_us / 1000U));
+}
+
+static void init(void){
+	static const IIS2MDC_Calibration_t identity = {
+		.Bias = {0, 0, 0},
+		.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.DrdyPinMode = IIS2MDC_DrdyOnPin;
+	Settings.Calibration = &identity;
+	sim_power_on();
+	sim.now_us += IIS2MDC_BOOT_MS * 1000U;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+	sim.field = field;
+	conversions = 0;
+}
+
+/*IIS2MDC_ReadMagnetic: bus into the driver's buffer, unpacked and calibrated into MagX/Y/Z, copied into the logs*/
+static void read_magnetic(void){
+	init();
+	uint32_t bus_bytes = sim.bytes;
+	uint32_t samples = 0, cpu_bytes = 0;
+	while(samples < SAMPLES){
+		sim_advance(sim.now_us + 1000000U / sim_odr_hz());
+		if(IIS2MDC_ReadMagnetic(&Dev) != IIS2MDC_DataReady){
+			continue;
+		}
+		cpu_bytes += sizeof(Dev.MagX) + sizeof(Dev.MagY) + sizeof(Dev.MagZ);
+		log_x[samples] = Dev.MagX;
+		log_y[samples] = Dev.MagY;
+		log_z[samples] = Dev.MagZ;
+		cpu_bytes += sizeof(log_x[0]) + sizeof(log_y[0]) + sizeof(log_z[0]);
+		samples++;
+	}
+	check(log_x[SAMPLES - 1] != 0, "logged", 0);
+	printf("IIS2MDC_ReadMagnetic: %4.1f bytes per sample off the bus (STATUS + outputs), %4.1f written by the CPU\n",
+			(double)(sim.bytes - bus_bytes) / samples, (double)cpu_bytes / samples);
+}
+
+/*The queue: bus into the slot, calibrated once on demand, read in place*/
+static void zero_copy(void){
+	init();
+	Dev.IIS2MDC_IO.ReadRegAsync = read_async;
+	IIS2MDC_QueueStorage_t Storage = {raw, calibrated, timestamps, epochs, QUEUE_LENGTH};
+	check(IIS2MDC_Queue_Init(&Queue, &Dev, Storage, NULL) == IIS2MDC_Ok, "queue init", 0);
+	IIS2MDC_ReadMagnetic(&Dev); //Release DRDY held since init, as the pin interrupt's first edge would
+	sim.drdy = drdy;
+	uint32_t bus_bytes = sim.bytes;
+	uint32_t first = conversions;
+
+	uint32_t consumed = 0;
+	int64_t sum = 0;
+	while(consumed < SAMPLES){
+		sim_advance(sim.next_sample_us); //DRDY starts the read
+		dma_complete();
+		if((uint16_t)(Queue.Head - Queue.Tail) < CONSUME_EVERY){
+			continue;
+		}
+
+		const int16_t *run;
+		const uint32_t *times;
+		uint16_t count;
+		while((count = IIS2MDC_Queue_Acquire(&Queue, &run, &times)) != 0){
+			check(run >= raw && run + 3 * count <= raw + 3 * QUEUE_LENGTH, "raw read in place", 0);
+			for(uint16_t i = 0; i < count; i++){
+				check(memcmp(&run[3 * i], produced[first + consumed + i], 3 * sizeof(int16_t)) == 0, "slot holds the bus bytes",
+						(long)(consumed + i));
+			}
+			/*Two consumers, e.g. the detector and the logger, ask for the same slots*/
+			const int16_t *a = IIS2MDC_Queue_Calibrated(&Queue, 0, count);
+			const int16_t *b = IIS2MDC_Queue_Calibrated(&Queue, 0, count);
+			check(a == b && a >= calibrated && a + 3 * count <= calibrated + 3 * QUEUE_LENGTH, "calibrated read in place", 0);
+			for(uint16_t i = 0; i < 3U * count; i++){
+				sum += a[i];
+			}
+			consumed += count;
+			IIS2MDC_Queue_Release(&Queue, count);
+		}
+	}
+	check(Queue.Stats.Conversions == Queue.Stats.Samples, "each slot calibrated once", (long)Queue.Stats.Conversions);
+	check(Queue.Stats.Dropped == 0 && Queue.Stats.Busy == 0 && Queue.Stats.Errors == 0, "no lost samples",
+			(long)Queue.Stats.Dropped);
+	check(sum != 0, "consumed", 0);
+
+	/*The only CPU stores into sample memory are the calibrated values, each slot written once*/
+	uint32_t cpu_bytes = Queue.Stats.Conversions * 3 * sizeof(int16_t);
+	printf("IIS2MDC_Queue:        %4.1f bytes per sample off the bus (outputs only),  %4.1f written by the CPU, raw copied 0 times\n",
+			(double)(sim.bytes - bus_bytes) / Queue.Stats.Samples, (double)cpu_bytes / Queue.Stats.Samples);
+	printf("  %u samples, %u conversions for two consumers per slot\n", Queue.Stats.Samples, Queue.Stats.Conversions);
+	sim.drdy = NULL;
+}
+
+int main(void){
+	read_magnetic();
+	zero_copy();
+	return test_result();
+}
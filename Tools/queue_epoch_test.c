@@ -0,0 +1,166 @@
+/*
+ * queue_epoch_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for the calibration epochs of IIS2MDC_Queue, on the simulated sensor. IIS2MDC_SetCalibration runs between
+ * DRDYs while the queue fills, and every calibrated slot is compared with IIS2MDC_ConvertBlockReference applied with the
+ * calibration that was current at its DRDY edge: across a run that spans several epochs, when the calibration changes
+ * between Acquire and Calibrated, and up to the point where the history no longer holds the slot's epoch and
+ * Stats.EpochExpired counts it.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/queue_epoch_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC_Queue.c Core/Src/IIS2MDC.c \
+ *       Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o queue_epoch_test -lm
+ * Run:
+ *   ./queue_epoch_test, exits non-zero on failure
+ */
+#include "iis2mdc_sim.h"
+#include "IIS2MDC_Queue.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SAMPLES 1024U
+#define QUEUE_LENGTH 64U
+#define CONSUME_EVERY 16U  /*Samples per main loop wake up*/
+#define SWAP_EVERY 6U      /*DRDYs between calibration changes, a consumed run spans up to 3 changes*/
+#define CALIBRATIONS (2U * IIS2MDC_CALIBRATION_HISTORY + 2U)
+
+static IIS2MDC_Handle_t Dev;
+static IIS2MDC_Queue_t Queue;
+
+static int16_t raw[3 * QUEUE_LENGTH];
+static int16_t calibrated[3 * QUEUE_LENGTH];
+static uint32_t timestamps[QUEUE_LENGTH];
+static uint8_t epochs[QUEUE_LENGTH];
+
+/*Distinct calibrations to swap between, each differs from the others in bias and gain*/
+static IIS2MDC_Calibration_t Cals[CALIBRATIONS];
+static uint32_t next_cal;
+
+/*Calibration current at each sample's DRDY edge, indexed by the free running slot count*/
+static const IIS2MDC_Calibration_t *captured_with[SAMPLES + QUEUE_LENGTH];
+
+static void field(uint64_t now_us, int16_t out[3]){
+	static uint32_t n;
+	n++;
+	out[0] = (int16_t)(300 + (int32_t)(n % 97) - 48);
+	out[1] = (int16_t)(-200 + (int32_t)((n * 7U) % 89) - 44);
+	out[2] = (int16_t)(150 - (int32_t)((n * 13U) % 83));
+	(void)now_us;
+}
+
+/*Blocking transport, the slot is committed inside the DRDY interrupt*/
+static void drdy(void){
+	if(Queue.Head < sizeof(captured_with) / sizeof(captured_with[0])){
+		captured_with[Queue.Head] = Dev.Calibration;
+	}
+	IIS2MDC_Queue_Read(&Queue, (uint32_t)(sim.now_us / 1000U));
+}
+
+static void swap_calibration(void){
+	const IIS2MDC_Calibration_t *Cal = &Cals[next_cal++ % CALIBRATIONS];
+	check(IIS2MDC_SetCalibration(&Dev, Cal) == IIS2MDC_Ok, "calibration swap", next_cal);
+}
+
+static void init(void){
+	for(uint32_t k = 0; k < CALIBRATIONS; k++){
+		Cals[k] = (IIS2MDC_Calibration_t){
+			.Bias = {(int16_t)(10 * k), (int16_t)(-7 * (int32_t)k), (int16_t)(3 * k)},
+			.Matrix = {{(int16_t)(IIS2MDC_CAL_Q14(0.5) + 1000 * k), 0, 0}, {0, IIS2MDC_CAL_Q14(1), (int16_t)(500 * k)},
+					{0, 0, (int16_t)(IIS2MDC_CAL_Q14(1.5) - 700 * k)}}
+		};
+	}
+	next_cal = 0;
+
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.DrdyPinMode = IIS2MDC_DrdyOnPin;
+	Settings.Calibration = &Cals[next_cal++];
+	sim_power_on();
+	sim.now_us += IIS2MDC_BOOT_MS * 1000U;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+	sim.field = field;
+	IIS2MDC_QueueStorage_t Storage = {raw, calibrated, timestamps, epochs, QUEUE_LENGTH};
+	check(IIS2MDC_Queue_Init(&Queue, &Dev, Storage, NULL) == IIS2MDC_Ok, "queue init", 0);
+	IIS2MDC_ReadMagnetic(&Dev); //Release DRDY held since init, as the pin interrupt's first edge would
+	sim.drdy = drdy;
+}
+
+/*Converts the acquired run and compares each slot with its own epoch's calibration, returns the slots that differ*/
+static uint32_t consume(const IIS2MDC_Calibration_t *expected_override){
+	uint32_t wrong = 0;
+	const int16_t *run;
+	const uint32_t *times;
+	uint16_t count;
+	while((count = IIS2MDC_Queue_Acquire(&Queue, &run, &times)) != 0){
+		const int16_t *out = IIS2MDC_Queue_Calibrated(&Queue, 0, count);
+		for(uint16_t i = 0; i < count; i++){
+			const IIS2MDC_Calibration_t *Cal = expected_override;
+			if(Cal == NULL){
+				Cal = captured_with[(uint16_t)(Queue.Tail + i)];
+			}
+			int16_t expected[3];
+			IIS2MDC_ConvertBlockReference(Cal, &run[3 * i], expected, 1);
+			wrong += memcmp(&out[3 * i], expected, sizeof(expected)) != 0;
+		}
+		IIS2MDC_Queue_Release(&Queue, count);
+	}
+	return wrong;
+}
+
+/*Calibration changes every few DRDYs, each consumed run holds slots of several epochs*/
+static void mid_run(void){
+	init();
+	uint32_t wrong = 0, drdys = 0, spanned = 0;
+	while(Queue.Stats.Samples < SAMPLES){
+		sim_advance(sim.next_sample_us);
+		if(++drdys % SWAP_EVERY == 0){
+			swap_calibration();
+		}
+		if((uint16_t)(Queue.Head - Queue.Tail) < CONSUME_EVERY){
+			continue;
+		}
+		spanned += captured_with[Queue.Tail] != captured_with[(uint16_t)(Queue.Head - 1U)];
+		wrong += consume(NULL);
+	}
+	check(wrong == 0, "each slot converted with its own epoch", wrong);
+	check(spanned > 0 && next_cal > IIS2MDC_CALIBRATION_HISTORY, "runs spanned calibration changes", spanned);
+	check(Queue.Stats.EpochExpired == 0, "no epoch expired", Queue.Stats.EpochExpired);
+	check(Queue.Stats.Conversions == Queue.Stats.Samples && Queue.Stats.Dropped == 0, "each slot converted once",
+			Queue.Stats.Conversions);
+	printf("%u samples over %u calibrations, each converted with its own epoch\n", Queue.Stats.Samples, next_cal);
+	sim.drdy = NULL;
+}
+
+/*Slots already captured keep their calibration when it changes after Acquire, until the history runs out*/
+static void expiry(void){
+	for(uint32_t swaps = 0; swaps <= IIS2MDC_CALIBRATION_HISTORY + 1U; swaps++){
+		init();
+		while(Queue.Stats.Samples < CONSUME_EVERY){
+			sim_advance(sim.next_sample_us);
+		}
+		sim.drdy = NULL; //Nothing new lands while the calibration changes
+		const int16_t *run;
+		const uint32_t *times;
+		uint16_t count = IIS2MDC_Queue_Acquire(&Queue, &run, &times);
+		check(count == CONSUME_EVERY, "captured", count);
+		for(uint32_t i = 0; i < swaps; i++){
+			swap_calibration();
+		}
+
+		int expired = swaps >= IIS2MDC_CALIBRATION_HISTORY;
+		uint32_t wrong = consume(expired ? Dev.Calibration : NULL);
+		check(wrong == 0, expired ? "expired slots use the current calibration" : "slots keep their epoch", swaps);
+		check(Queue.Stats.EpochExpired == (expired ? CONSUME_EVERY : 0U), "EpochExpired", Queue.Stats.EpochExpired);
+		check(Queue.Stats.Conversions == CONSUME_EVERY, "converted once", Queue.Stats.Conversions);
+	}
+}
+
+int main(void){
+	mid_run();
+	expiry();
+	return test_result();
+}
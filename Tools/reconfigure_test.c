@@ -0,0 +1,288 @@
+/*
+ * reconfigure_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Reconfigure and the single setting wrappers, on the simulated sensor. Every call is checked
+ * against the exact register transactions it should put on the bus: which registers, in which order, how many bytes
+ * and their values. Also covers settings that are already applied, the threshold ordering, a write that fails, the
+ * recovery that re-applies the kept settings, and the reads IIS2MDC_ServiceIRQ makes and the callbacks it runs for each
+ * way DRDY and INT can be routed to the pin.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/reconfigure_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC.c Core/Src/IIS2MDC_Convert.c \
+ *       Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o reconfigure_test -lm
+ * Run:
+ *   ./reconfigure_test, exits non-zero on failure. SIM_VERBOSE=1 prints the driver log.
+ */
+#include "iis2mdc_sim.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CFG_C_BDU (1U << 4)
+
+typedef struct{
+	char op;
+	uint8_t reg;
+	uint8_t length;
+	uint8_t data[6];
+}Expected_t;
+
+#define FIELD_LSB 100
+
+static IIS2MDC_Handle_t Dev;
+
+/*What the interrupt callbacks saw*/
+static struct{
+	uint32_t calls;
+	uint8_t source;
+}Seen[IIS2MDC_NumCallbacks];
+
+/*Compares the transfer log with the expected transactions, reads are only compared by register and length*/
+static void expect(const char *what, const Expected_t *expected, uint32_t count){
+	check(sim.log_count == count, what, (long)sim.log_count);
+	for(uint32_t i = 0; i < count && i < sim.log_count; i++){
+		const sim_transfer_t *t = &sim.log[i];
+		int same = t->op == expected[i].op && t->reg == expected[i].reg && t->length == expected[i].length &&
+				(t->op == 'r' || memcmp(t->data, expected[i].data, t->length) == 0);
+		check(same, what, (long)i);
+		if(!same){
+			fprintf(stderr, "  got %c 0x%02X x%u, expected %c 0x%02X x%u\n", t->op, t->reg, t->length, expected[i].op,
+					expected[i].reg, expected[i].length);
+		}
+	}
+	sim_clear_log();
+}
+
+static void init(void){
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_10Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	sim_power_on();
+	sim.now_us += IIS2MDC_BOOT_MS * 1000U;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+
+	/*Init writes every block in full, then reads the outputs once to release DRDY*/
+	const Expected_t sequence[] = {
+		{'r', IIS2MDC_REG_WHO_AM_I, 1, {0}},
+		{'w', IIS2MDC_REG_OFFSET_X_REG_L, 6, {0, 0, 0, 0, 0, 0}},
+		{'w', IIS2MDC_REG_INT_THS_L_REG, 2, {0, 0}},
+		{'w', IIS2MDC_REG_CFG_REG_A, 4, {0x00, 0x00, CFG_C_BDU, 0x00}},
+		{'r', IIS2MDC_REG_OUTX_L_REG, 6, {0}},
+	};
+	expect("init", sequence, 5);
+}
+
+static void setters(void){
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_50Hz) == IIS2MDC_Ok, "data rate", 0);
+	expect("data rate", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x08}}}, 1);
+
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_50Hz) == IIS2MDC_Ok, "same data rate", 0);
+	expect("same data rate", NULL, 0);
+
+	check(IIS2MDC_SetPowerMode(&Dev, IIS2MDC_LowPowerMode) == IIS2MDC_Ok, "power mode", 0);
+	expect("power mode", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x18}}}, 1);
+
+	check(IIS2MDC_SetTemperatureComp(&Dev, IIS2MDC_TemperatureCompEnabled) == IIS2MDC_Ok, "temperature compensation", 0);
+	expect("temperature compensation", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x98}}}, 1);
+
+	check(IIS2MDC_SetLowPassFilter(&Dev, IIS2MDC_LowPassFilterEnabled) == IIS2MDC_Ok, "low pass filter", 0);
+	expect("low pass filter", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_B, 1, {0x01}}}, 1);
+
+	check(IIS2MDC_SetOffsetCancellation(&Dev, IIS2MDC_OffsetCancellationEnabled, IIS2MDC_OffsetCancellationPulseEN) == IIS2MDC_Ok,
+			"offset cancellation", 0);
+	expect("offset cancellation", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_B, 1, {0x07}}}, 1);
+
+	/*The threshold goes out before the interrupt is enabled*/
+	check(IIS2MDC_SetIRQConfig(&Dev, IIS2MDC_IRQEnabled | IIS2MDC_XThresholdEnabled, 500) == IIS2MDC_Ok, "IRQ config", 0);
+	expect("IRQ config", (const Expected_t[]){
+		{'w', IIS2MDC_REG_INT_THS_L_REG, 2, {0xF4, 0x01}},
+		{'w', IIS2MDC_REG_INT_CTRL_REG, 1, {0x81}},
+	}, 2);
+
+	check(IIS2MDC_SetIRQConfig(&Dev, IIS2MDC_IRQEnabled | IIS2MDC_XThresholdEnabled, 501) == IIS2MDC_Ok, "threshold low byte", 0);
+	expect("threshold low byte", (const Expected_t[]){{'w', IIS2MDC_REG_INT_THS_L_REG, 1, {0xF5}}}, 1);
+
+	check(IIS2MDC_SetIRQConfig(&Dev, IIS2MDC_IRQEnabled | IIS2MDC_XThresholdEnabled, 757) == IIS2MDC_Ok, "threshold high byte", 0);
+	expect("threshold high byte", (const Expected_t[]){{'w', IIS2MDC_REG_INT_THS_H_REG, 1, {0x02}}}, 1);
+
+	static const IIS2MDC_Calibration_t Identity = {
+		.Bias = {0, 0, 0},
+		.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	check(IIS2MDC_SetCalibration(&Dev, &Identity) == IIS2MDC_Ok, "calibration", 0);
+	expect("calibration", NULL, 0);
+}
+
+static void reconfigure(void){
+	/*CFG_REG_A and INT_CTRL_REG differ, B and C ride along in the same burst*/
+	IIS2MDC_InitStruct_t Settings = Dev.Settings;
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.IRQConfig = IIS2MDC_IRQEnabled | IIS2MDC_YThresholdEnabled;
+	check(IIS2MDC_Reconfigure(&Dev, &Settings) == IIS2MDC_Ok, "reconfigure", 0);
+	expect("one burst over CFG_REG_A..INT_CTRL_REG", (const Expected_t[]){
+		{'w', IIS2MDC_REG_CFG_REG_A, 4, {0x9C, 0x07, CFG_C_BDU, 0x41}},
+	}, 1);
+
+	Settings.Offset_X = 100;
+	Settings.Offset_Z = -2;
+	check(IIS2MDC_Reconfigure(&Dev, &Settings) == IIS2MDC_Ok, "offsets", 0);
+	expect("offsets X to Z", (const Expected_t[]){
+		{'w', IIS2MDC_REG_OFFSET_X_REG_L, 6, {0x64, 0x00, 0x00, 0x00, 0xFE, 0xFF}},
+	}, 1);
+
+	Settings.Offset_Y = 1;
+	check(IIS2MDC_Reconfigure(&Dev, &Settings) == IIS2MDC_Ok, "offset Y", 0);
+	expect("offset Y", (const Expected_t[]){{'w', IIS2MDC_REG_OFFSET_Y_REG_L, 1, {0x01}}}, 1);
+
+	check(IIS2MDC_Reconfigure(&Dev, &Settings) == IIS2MDC_Ok, "nothing changed", 0);
+	expect("nothing changed", NULL, 0);
+	check(memcmp(&sim.regs[IIS2MDC_REG_CFG_REG_A], Dev.Shadow.Cfg, sizeof(Dev.Shadow.Cfg)) == 0, "shadow matches the chip", 0);
+}
+
+static void failed_write(void){
+	IIS2MDC_OutputDataRate_t Before = Dev.Settings.DataRate;
+	sim.fail_next = 3;
+	sim.fail_status = IIS2MDC_ErrorNack;
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_20Hz) != IIS2MDC_Ok, "failed data rate", 0);
+	expect("three attempts", (const Expected_t[]){
+		{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x94}},
+		{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x94}},
+		{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x94}},
+	}, 3);
+	check(Dev.Settings.DataRate == Before && Dev.BusState == IIS2MDC_BusClearPending, "settings kept", Dev.Settings.DataRate);
+
+	/*The calibration is not on the chip, changing it doesn't wait for the bus*/
+	static const IIS2MDC_Calibration_t Doubled = {
+		.Bias = {0, 0, 0},
+		.Matrix = {{IIS2MDC_CAL_Q14(2), 0, 0}, {0, IIS2MDC_CAL_Q14(2), 0}, {0, 0, IIS2MDC_CAL_Q14(2)}}
+	};
+	uint8_t Epoch = Dev.CalibrationEpoch;
+	check(IIS2MDC_SetCalibration(&Dev, &Doubled) == IIS2MDC_Ok, "calibration while faulted", 0);
+	expect("calibration while faulted", NULL, 0);
+	check(Dev.Calibration == &Doubled && Dev.Settings.Calibration == &Doubled, "calibration selected", 0);
+	check(Dev.CalibrationEpoch != Epoch, "new calibration epoch", Dev.CalibrationEpoch);
+	check(Dev.BusState == IIS2MDC_BusClearPending && sim.bus_clears == 0, "recovery left alone", Dev.BusState);
+
+	/*Recovery checks the device ID, then re-applies the kept settings in full*/
+	IIS2MDC_RecoverBus(&Dev);
+	IIS2MDC_RecoverBus(&Dev);
+	IIS2MDC_RecoverBus(&Dev);
+	check(Dev.BusState == IIS2MDC_BusOk && Dev.Calibration == &Doubled, "recovered", Dev.BusState);
+	expect("recovery writes", (const Expected_t[]){
+		{'r', IIS2MDC_REG_WHO_AM_I, 1, {0x40}},
+		{'w', IIS2MDC_REG_OFFSET_X_REG_L, 6, {0x64, 0x00, 0x01, 0x00, 0xFE, 0xFF}},
+		{'w', IIS2MDC_REG_INT_THS_L_REG, 2, {0xF5, 0x02}},
+		{'w', IIS2MDC_REG_CFG_REG_A, 4, {0x9C, 0x07, CFG_C_BDU, 0x41}},
+		{'r', IIS2MDC_REG_OUTX_L_REG, 6, {0}},
+	}, 5);
+
+	check(IIS2MDC_SetDataRate(&Dev, IIS2MDC_20Hz) == IIS2MDC_Ok, "data rate after recovery", 0);
+	expect("data rate after recovery", (const Expected_t[]){{'w', IIS2MDC_REG_CFG_REG_A, 1, {0x94}}}, 1);
+}
+
+static void seen_data_ready(IIS2MDC_Handle_t *Dev, uint8_t IntSource){
+	(void)Dev;
+	Seen[IIS2MDC_DataReadyCallback].calls++;
+	Seen[IIS2MDC_DataReadyCallback].source = IntSource;
+}
+
+static void seen_threshold(IIS2MDC_Handle_t *Dev, uint8_t IntSource){
+	(void)Dev;
+	Seen[IIS2MDC_ThresholdCallback].calls++;
+	Seen[IIS2MDC_ThresholdCallback].source = IntSource;
+}
+
+static void seen_overflow(IIS2MDC_Handle_t *Dev, uint8_t IntSource){
+	(void)Dev;
+	Seen[IIS2MDC_OverflowCallback].calls++;
+	Seen[IIS2MDC_OverflowCallback].source = IntSource;
+}
+
+static void constant_field(uint64_t now_us, int16_t out[3]){
+	(void)now_us;
+	out[0] = FIELD_LSB;
+	out[1] = -FIELD_LSB;
+	out[2] = 2 * FIELD_LSB;
+}
+
+/*Fresh sensor and handle with the given pin routing, a new sample waiting and the callbacks cleared*/
+static void routed(IIS2MDC_DrdyPinMode_t Drdy, IIS2MDC_IntPinMode_t Int){
+	static const IIS2MDC_Calibration_t Identity = {
+		.Bias = {0, 0, 0},
+		.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_10Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.DrdyPinMode = Drdy;
+	Settings.IntPinMode = Int;
+	Settings.Calibration = &Identity;
+	sim_power_on();
+	sim.field = constant_field;
+	sim.now_us += IIS2MDC_BOOT_MS * 1000U;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+	IIS2MDC_RegisterCallback(&Dev, IIS2MDC_DataReadyCallback, seen_data_ready);
+	IIS2MDC_RegisterCallback(&Dev, IIS2MDC_ThresholdCallback, seen_threshold);
+	IIS2MDC_RegisterCallback(&Dev, IIS2MDC_OverflowCallback, seen_overflow);
+	sim_advance(sim.next_sample_us);
+	sim_clear_log();
+	memset(Seen, 0, sizeof(Seen));
+}
+
+/*Runs ServiceIRQ with INT_SOURCE set to Source, checks the read it made and how often each callback ran*/
+static IIS2MDC_DataReadyStatus_t service(const char *what, uint8_t Source, const Expected_t *read, uint32_t DataReady,
+		uint32_t Threshold, uint32_t Overflow){
+	sim.regs[IIS2MDC_REG_INT_SOURCE_REG] = Source;
+	memset(Seen, 0, sizeof(Seen));
+	IIS2MDC_DataReadyStatus_t Result = IIS2MDC_ServiceIRQ(&Dev);
+	expect(what, read, 1);
+	check(Seen[IIS2MDC_DataReadyCallback].calls == DataReady, what, Seen[IIS2MDC_DataReadyCallback].calls);
+	check(Seen[IIS2MDC_ThresholdCallback].calls == Threshold, what, Seen[IIS2MDC_ThresholdCallback].calls);
+	check(Seen[IIS2MDC_OverflowCallback].calls == Overflow, what, Seen[IIS2MDC_OverflowCallback].calls);
+	return Result;
+}
+
+static void service_irq(void){
+	const Expected_t Outputs = {'r', IIS2MDC_REG_OUTX_L_REG, 6, {0}};
+	const Expected_t Source = {'r', IIS2MDC_REG_INT_SOURCE_REG, 1, {0}};
+	const Expected_t Burst = {'r', IIS2MDC_REG_INT_SOURCE_REG, IIS2MDC_REG_OUTZ_H_REG - IIS2MDC_REG_INT_SOURCE_REG + 1, {0}};
+	const uint8_t Threshold = IIS2MDC_IntActive | IIS2MDC_XPositiveThreshold;
+
+	/*DRDY only: the edge means new data, straight to the outputs without STATUS or INT_SOURCE*/
+	routed(IIS2MDC_DrdyOnPin, IIS2MDC_IntSignalDisabled);
+	check(service("DRDY only", Threshold, &Outputs, 1, 0, 0) == IIS2MDC_DataReady, "DRDY only sample", 0);
+	check(Dev.MagX == FIELD_LSB * 3 / 2 && Dev.MagY == -FIELD_LSB * 3 / 2 && Dev.MagZ == FIELD_LSB * 3, "DRDY only sample", Dev.MagX);
+	check(Dev.IntSource == 0 && Seen[IIS2MDC_DataReadyCallback].source == 0, "DRDY only source", Dev.IntSource);
+
+	/*INT only: one byte of INT_SOURCE, the outputs are left alone*/
+	routed(IIS2MDC_DrdySignalDisabled, IIS2MDC_IntOnPin);
+	check(service("INT only threshold", Threshold, &Source, 0, 1, 0) == IIS2MDC_DataNotReady, "INT only no sample", 0);
+	check(Dev.IntSource == Threshold && Seen[IIS2MDC_ThresholdCallback].source == Threshold, "threshold source", Dev.IntSource);
+	service("INT only negative thresholds", IIS2MDC_IntActive | IIS2MDC_YNegativeThreshold | IIS2MDC_ZNegativeThreshold, &Source,
+			0, 1, 0);
+	service("INT only overflow", IIS2MDC_IntActive | IIS2MDC_RangeOverflow, &Source, 0, 0, 1);
+	check(Seen[IIS2MDC_OverflowCallback].source == (IIS2MDC_IntActive | IIS2MDC_RangeOverflow), "overflow source",
+			Seen[IIS2MDC_OverflowCallback].source);
+	service("INT only threshold and overflow", Threshold | IIS2MDC_RangeOverflow, &Source, 0, 1, 1);
+	service("INT only threshold flags without IEA", IIS2MDC_XPositiveThreshold, &Source, 0, 0, 0);
+	service("INT only nothing", 0, &Source, 0, 0, 0);
+
+	/*Both: one burst from INT_SOURCE through OUTZ_H, data ready only when STATUS says all axes are new*/
+	routed(IIS2MDC_DrdyOnPin, IIS2MDC_IntOnPin);
+	check(service("both with a sample", Threshold, &Burst, 1, 1, 0) == IIS2MDC_DataReady, "both sample", 0);
+	check(Dev.MagX == FIELD_LSB * 3 / 2 && Dev.MagZ == FIELD_LSB * 3, "both sample", Dev.MagX);
+	check(Seen[IIS2MDC_ThresholdCallback].source == Threshold, "both threshold source", Seen[IIS2MDC_ThresholdCallback].source);
+	check(service("both without a sample", IIS2MDC_IntActive | IIS2MDC_RangeOverflow, &Burst, 0, 0, 1) == IIS2MDC_DataNotReady,
+			"both no sample", 0);
+}
+
+int main(void){
+	init();
+	setters();
+	reconfigure();
+	failed_write();
+	service_irq();
+	return test_result();
+}
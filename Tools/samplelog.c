@@ -0,0 +1,316 @@
+/*
+ * samplelog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ */
+#define _FILE_OFFSET_BITS 64
+#include "samplelog.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static uint64_t align_up(uint64_t value, uint64_t alignment){
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/*Column 0 is the timestamp, 1..3 are X, Y, Z. Offsets are from the chunk header.*/
+uint64_t samplelog_column_offset(uint32_t count, int column){
+	uint64_t offset = sizeof(samplelog_chunk_header_t);
+	if(column > 0){
+		offset = align_up(offset + (uint64_t)count * sizeof(uint32_t), 8);
+		offset += (uint64_t)(column - 1) * align_up((uint64_t)count * sizeof(int16_t), 8);
+	}
+	return offset;
+}
+
+uint64_t samplelog_chunk_bytes(uint32_t count){
+	return align_up(samplelog_column_offset(count, 3) + (uint64_t)count * sizeof(int16_t), SAMPLELOG_CHUNK_ALIGN);
+}
+
+static int write_at(FILE *f, uint64_t offset, const void *data, size_t length){
+	if(fseeko(f, (off_t)offset, SEEK_SET) != 0 || fwrite(data, 1, length, f) != length){
+		return -1;
+	}
+	return 0;
+}
+
+/*Writes the chunk being filled, columns padded with zeros to their boundaries*/
+static int flush_chunk(samplelog_writer_t *w){
+	static const uint8_t zeros[SAMPLELOG_CHUNK_ALIGN];
+	uint32_t n = w->count;
+	if(n == 0){
+		return 0;
+	}
+
+	samplelog_chunk_header_t chunk = {
+			.magic = SAMPLELOG_CHUNK_MAGIC,
+			.count = n,
+			.first_timestamp = w->timestamp[0],
+			.last_timestamp = w->timestamp[n - 1]
+	};
+	for(int a = 0; a < 3; a++){
+		chunk.min[a] = chunk.max[a] = w->axis[a][0];
+		for(uint32_t i = 1; i < n; i++){
+			if(w->axis[a][i] < chunk.min[a]){
+				chunk.min[a] = w->axis[a][i];
+			} else if(w->axis[a][i] > chunk.max[a]){
+				chunk.max[a] = w->axis[a][i];
+			}
+		}
+	}
+
+	if(w->header.chunk_count == w->index_capacity){
+		uint32_t capacity = w->index_capacity ? w->index_capacity * 2 : 64;
+		samplelog_index_t *index = realloc(w->index, capacity * sizeof(samplelog_index_t));
+		if(index == NULL){
+			return -1;
+		}
+		w->index = index;
+		w->index_capacity = capacity;
+	}
+
+	FILE *f = w->file;
+	if(write_at(f, w->offset, &chunk, sizeof(chunk)) != 0 || fwrite(w->timestamp, sizeof(uint32_t), n, f) != n){
+		return -1;
+	}
+	for(int a = 0; a < 3; a++){
+		uint64_t at = w->offset + samplelog_column_offset(n, a + 1);
+		uint64_t pad = at - (uint64_t)ftello(f);
+		if(fwrite(zeros, 1, pad, f) != pad || fwrite(w->axis[a], sizeof(int16_t), n, f) != n){
+			return -1;
+		}
+	}
+	uint64_t end = w->offset + samplelog_chunk_bytes(n);
+	uint64_t pad = end - (uint64_t)ftello(f);
+	if(fwrite(zeros, 1, pad, f) != pad){
+		return -1;
+	}
+
+	w->index[w->header.chunk_count++] = (samplelog_index_t){
+			.offset = w->offset,
+			.count = n,
+			.first_timestamp = chunk.first_timestamp,
+			.last_timestamp = chunk.last_timestamp
+	};
+	w->header.sample_count += n;
+	w->offset = end;
+	w->count = 0;
+	return 0;
+}
+
+static void writer_free(samplelog_writer_t *w){
+	free(w->timestamp);
+	for(int a = 0; a < 3; a++){
+		free(w->axis[a]);
+	}
+	free(w->index);
+	memset(w, 0, sizeof(*w));
+}
+
+/*Creates or truncates path. chunk_samples 0 selects SAMPLELOG_CHUNK_SAMPLES. Samples are taken as mG with ms
+ *timestamps, the firmware's units, until the header fields are changed before the first append.*/
+int samplelog_create(samplelog_writer_t *w, const char *path, uint32_t chunk_samples){
+	memset(w, 0, sizeof(*w));
+	if(chunk_samples == 0){
+		chunk_samples = SAMPLELOG_CHUNK_SAMPLES;
+	}
+	memcpy(w->header.magic, SAMPLELOG_MAGIC, sizeof(w->header.magic));
+	w->header.version = SAMPLELOG_VERSION;
+	w->header.header_bytes = SAMPLELOG_HEADER_BYTES;
+	w->header.chunk_samples = chunk_samples;
+	w->header.timestamp_us = 1000;
+	w->header.field_scale_q8 = 256;
+	w->offset = SAMPLELOG_HEADER_BYTES;
+
+	w->timestamp = malloc(chunk_samples * sizeof(uint32_t));
+	for(int a = 0; a < 3; a++){
+		w->axis[a] = malloc(chunk_samples * sizeof(int16_t));
+	}
+	if(w->timestamp == NULL || w->axis[0] == NULL || w->axis[1] == NULL || w->axis[2] == NULL){
+		writer_free(w);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	w->file = fopen(path, "w+b");
+	if(w->file == NULL || write_at(w->file, 0, &w->header, sizeof(w->header)) != 0){
+		int saved = errno;
+		if(w->file != NULL){
+			fclose(w->file);
+		}
+		writer_free(w);
+		errno = saved;
+		return -1;
+	}
+	return 0;
+}
+
+/*The header keeps the last snapshot set, written out on close*/
+void samplelog_set_config(samplelog_writer_t *w, const samplelog_config_t *config){
+	w->header.config = *config;
+	w->header.flags |= SAMPLELOG_HAS_CONFIG;
+}
+
+int samplelog_append(samplelog_writer_t *w, uint32_t timestamp, const int16_t field[3]){
+	w->timestamp[w->count] = timestamp;
+	for(int a = 0; a < 3; a++){
+		w->axis[a][w->count] = field[a];
+	}
+	if(++w->count == w->header.chunk_samples){
+		return flush_chunk(w);
+	}
+	return 0;
+}
+
+/*Writes the partial chunk, the index and the final header. The writer is released even on failure.*/
+int samplelog_close(samplelog_writer_t *w){
+	int result = flush_chunk(w);
+	if(result == 0){
+		w->header.index_offset = w->offset;
+		if(write_at(w->file, w->offset, w->index, w->header.chunk_count * sizeof(samplelog_index_t)) != 0 ||
+				write_at(w->file, 0, &w->header, sizeof(w->header)) != 0){
+			result = -1;
+		}
+	}
+	if(fclose(w->file) != 0){
+		result = -1;
+	}
+	writer_free(w);
+	return result;
+}
+
+static int chunk_valid(const samplelog_reader_t *r, uint64_t offset, uint32_t chunk_samples){
+	if(offset % SAMPLELOG_CHUNK_ALIGN != 0 || offset > r->size || r->size - offset < sizeof(samplelog_chunk_header_t)){
+		return 0;
+	}
+	const samplelog_chunk_header_t *chunk = (const samplelog_chunk_header_t*)(r->base + offset);
+	return chunk->magic == SAMPLELOG_CHUNK_MAGIC && chunk->count != 0 && chunk->count <= chunk_samples &&
+			r->size - offset >= samplelog_chunk_bytes(chunk->count);
+}
+
+/*An unfinished file has no index, rebuild one from the chunks that made it to disk*/
+static int rebuild_index(samplelog_reader_t *r){
+	uint32_t capacity = 0;
+	uint64_t offset = r->header->header_bytes;
+	r->chunk_count = 0;
+	r->sample_count = 0;
+	while(chunk_valid(r, offset, r->header->chunk_samples)){
+		const samplelog_chunk_header_t *chunk = (const samplelog_chunk_header_t*)(r->base + offset);
+		if(r->chunk_count == capacity){
+			capacity = capacity ? capacity * 2 : 64;
+			samplelog_index_t *index = realloc(r->rebuilt, capacity * sizeof(samplelog_index_t));
+			if(index == NULL){
+				return -1;
+			}
+			r->rebuilt = index;
+		}
+		r->rebuilt[r->chunk_count++] = (samplelog_index_t){
+				.offset = offset,
+				.count = chunk->count,
+				.first_timestamp = chunk->first_timestamp,
+				.last_timestamp = chunk->last_timestamp
+		};
+		r->sample_count += chunk->count;
+		offset += samplelog_chunk_bytes(chunk->count);
+	}
+	r->index = r->rebuilt;
+	return 0;
+}
+
+/*Maps path read only and checks the header and index. Chunks are checked as they are accessed.*/
+int samplelog_open(samplelog_reader_t *r, const char *path){
+	memset(r, 0, sizeof(*r));
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+		return -1;
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0){
+		close(fd);
+		return -1;
+	}
+	if((uint64_t)st.st_size < SAMPLELOG_HEADER_BYTES){
+		close(fd);
+		errno = EINVAL;
+		return -1;
+	}
+	r->size = (size_t)st.st_size;
+	void *base = mmap(NULL, r->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED){
+		return -1;
+	}
+	r->base = base;
+	r->header = (const samplelog_header_t*)base;
+
+	const samplelog_header_t *h = r->header;
+	int valid = memcmp(h->magic, SAMPLELOG_MAGIC, sizeof(h->magic)) == 0 && h->version == SAMPLELOG_VERSION &&
+			h->header_bytes >= SAMPLELOG_HEADER_BYTES && h->header_bytes % SAMPLELOG_CHUNK_ALIGN == 0 &&
+			h->chunk_samples != 0;
+	if(valid && h->index_offset != 0){
+		valid = h->index_offset % 8 == 0 && h->index_offset <= r->size &&
+				(r->size - h->index_offset) / sizeof(samplelog_index_t) >= h->chunk_count;
+		r->index = (const samplelog_index_t*)(r->base + h->index_offset);
+		r->chunk_count = h->chunk_count;
+		r->sample_count = h->sample_count;
+	} else if(valid && rebuild_index(r) != 0){
+		samplelog_release(r);
+		errno = ENOMEM;
+		return -1;
+	}
+	if(!valid){
+		samplelog_release(r);
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+/*Fills chunk with pointers into the mapping, valid until samplelog_release*/
+int samplelog_chunk(const samplelog_reader_t *r, uint32_t i, samplelog_chunk_t *chunk){
+	if(i >= r->chunk_count || !chunk_valid(r, r->index[i].offset, r->header->chunk_samples)){
+		errno = EINVAL;
+		return -1;
+	}
+	const uint8_t *base = r->base + r->index[i].offset;
+	const samplelog_chunk_header_t *h = (const samplelog_chunk_header_t*)base;
+	chunk->count = h->count;
+	chunk->first_timestamp = h->first_timestamp;
+	chunk->last_timestamp = h->last_timestamp;
+	chunk->min = h->min;
+	chunk->max = h->max;
+	chunk->timestamp = (const uint32_t*)(base + samplelog_column_offset(h->count, 0));
+	for(int a = 0; a < 3; a++){
+		chunk->axis[a] = (const int16_t*)(base + samplelog_column_offset(h->count, a + 1));
+	}
+	return 0;
+}
+
+/*First chunk ending at or after timestamp, chunk_count if there is none. Binary search over the index, so it
+ *assumes timestamps never go backwards (one run of the firmware, under 49 days).*/
+uint32_t samplelog_find(const samplelog_reader_t *r, uint32_t timestamp){
+	uint32_t lo = 0;
+	uint32_t hi = r->chunk_count;
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo) / 2;
+		if(r->index[mid].last_timestamp < timestamp){
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+void samplelog_release(samplelog_reader_t *r){
+	if(r->base != NULL){
+		munmap((void*)r->base, r->size);
+	}
+	free(r->rebuilt);
+	memset(r, 0, sizeof(*r));
+}
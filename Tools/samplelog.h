@@ -0,0 +1,143 @@
+/*
+ * samplelog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Columnar sample log for host side analysis. Host only: writes through stdio, reads through mmap (POSIX).
+ *
+ * File layout, little endian, offsets from the start of the file:
+ *   0       samplelog_header_t, SAMPLELOG_HEADER_BYTES
+ *   128     chunks back to back, each starting on a SAMPLELOG_CHUNK_ALIGN boundary:
+ *             samplelog_chunk_header_t (32 bytes)
+ *             uint32 timestamp[count]                  at +32
+ *             int16 x[count], y[count], z[count]       each starting on the next 8 byte boundary
+ *             zero padding up to the next chunk
+ *   index   samplelog_index_t[chunk_count] at header.index_offset, after the last chunk
+ *
+ * Timestamps are in units of header.timestamp_us microseconds, field values are header.field_scale_q8 / 256 mG per
+ * count. A chunk holds at most header.chunk_samples samples, only the last one may hold fewer.
+ * index_offset is 0 until the writer is closed. The chunks of such a file are still valid and a reader finds them by
+ * walking from the header, stopping at the first one that does not fit in the file.
+ * Every column is aligned for its type, so a mapped file gives arrays that can be used in place. From numpy, a chunk
+ * at offset o with n samples is np.frombuffer(m, '<u4', n, o + 32), then '<i2' columns at the offsets given by
+ * samplelog_column_offset.
+ */
+
+#ifndef SAMPLELOG_H_
+#define SAMPLELOG_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "samplelog maps files in place and needs a little endian host"
+#endif
+
+#define SAMPLELOG_MAGIC "IIS2MLOG"
+#define SAMPLELOG_VERSION 1U
+#define SAMPLELOG_HEADER_BYTES 128U
+#define SAMPLELOG_CHUNK_MAGIC 0x4B4E4843U   /*"CHNK"*/
+#define SAMPLELOG_CHUNK_ALIGN 64U
+#define SAMPLELOG_CHUNK_SAMPLES 4096U      /*Default chunk size, 40 s at 100 Hz*/
+#define SAMPLELOG_HAS_CONFIG 0x0001U       /*Header flag: config holds a snapshot from the device*/
+
+/*Sensor state the samples were taken with, as sent in IIS2MDC_TELEMETRY_TYPE_CONFIG frames*/
+typedef struct{
+	uint8_t registers[12];       /*IIS2MDC_RegisterImage_t: OFFSET_X_REG_L..OFFSET_Z_REG_H, CFG_REG_A..INT_CTRL_REG, INT_THS_L/H*/
+	int16_t bias[3];             /*Hard iron bias, raw LSB*/
+	int16_t matrix[3][3];        /*Soft iron matrix, Q1.14*/
+	int16_t declination;         /*Centidegrees, east positive*/
+	uint8_t calibration_epoch;
+	uint8_t reserved;
+}samplelog_config_t;
+
+typedef struct{
+	char magic[8];               /*SAMPLELOG_MAGIC, not terminated*/
+	uint16_t version;
+	uint16_t header_bytes;
+	uint32_t flags;
+	uint64_t sample_count;
+	uint64_t index_offset;       /*0 while the file is being written*/
+	uint32_t chunk_count;
+	uint32_t chunk_samples;
+	uint32_t timestamp_us;       /*1000 for the firmware's millisecond tick*/
+	int32_t field_scale_q8;      /*256 for samples in mG*/
+	samplelog_config_t config;   /*Last snapshot seen, valid with SAMPLELOG_HAS_CONFIG*/
+	uint8_t reserved[40];
+}samplelog_header_t;
+
+typedef struct{
+	uint32_t magic;              /*SAMPLELOG_CHUNK_MAGIC*/
+	uint32_t count;
+	uint32_t first_timestamp;
+	uint32_t last_timestamp;
+	int16_t min[3];              /*Per axis, lets a reader skip chunks without touching the columns*/
+	int16_t max[3];
+	uint32_t reserved;
+}samplelog_chunk_header_t;
+
+typedef struct{
+	uint64_t offset;             /*Of the chunk header*/
+	uint32_t count;
+	uint32_t first_timestamp;
+	uint32_t last_timestamp;
+	uint32_t reserved;
+}samplelog_index_t;
+
+_Static_assert(sizeof(samplelog_config_t) == 40, "samplelog_config_t layout");
+_Static_assert(sizeof(samplelog_header_t) == SAMPLELOG_HEADER_BYTES, "samplelog_header_t layout");
+_Static_assert(offsetof(samplelog_header_t, config) == 48, "samplelog_header_t layout");
+_Static_assert(sizeof(samplelog_chunk_header_t) == 32, "samplelog_chunk_header_t layout");
+_Static_assert(sizeof(samplelog_index_t) == 24, "samplelog_index_t layout");
+
+typedef struct{
+	FILE *file;
+	samplelog_header_t header;
+	uint32_t *timestamp;         /*Columns of the chunk being filled*/
+	int16_t *axis[3];
+	uint32_t count;
+	samplelog_index_t *index;
+	uint32_t index_capacity;
+	uint64_t offset;             /*Where the next chunk goes*/
+}samplelog_writer_t;
+
+/*Zero copy view of one chunk, pointers into the mapping*/
+typedef struct{
+	uint32_t count;
+	uint32_t first_timestamp;
+	uint32_t last_timestamp;
+	const int16_t *min;
+	const int16_t *max;
+	const uint32_t *timestamp;
+	const int16_t *axis[3];
+}samplelog_chunk_t;
+
+typedef struct{
+	const uint8_t *base;
+	size_t size;
+	const samplelog_header_t *header;
+	const samplelog_index_t *index;
+	samplelog_index_t *rebuilt;  /*Index found by walking an unfinished file, NULL otherwise*/
+	uint32_t chunk_count;
+	uint64_t sample_count;
+}samplelog_reader_t;
+
+/*Writer, functions return 0 or -1 with errno set*/
+int samplelog_create(samplelog_writer_t *w, const char *path, uint32_t chunk_samples);
+void samplelog_set_config(samplelog_writer_t *w, const samplelog_config_t *config);
+int samplelog_append(samplelog_writer_t *w, uint32_t timestamp, const int16_t field[3]);
+int samplelog_close(samplelog_writer_t *w);
+
+/*Reader*/
+int samplelog_open(samplelog_reader_t *r, const char *path);
+int samplelog_chunk(const samplelog_reader_t *r, uint32_t i, samplelog_chunk_t *chunk);
+uint32_t samplelog_find(const samplelog_reader_t *r, uint32_t timestamp);
+void samplelog_release(samplelog_reader_t *r);
+
+/*Layout*/
+uint64_t samplelog_column_offset(uint32_t count, int column);
+uint64_t samplelog_chunk_bytes(uint32_t count);
+
+#endif /* SAMPLELOG_H_ */
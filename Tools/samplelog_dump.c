@@ -0,0 +1,104 @@
+/*
+ * samplelog_dump.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Prints a sample log's header, configuration snapshot and chunk index, or its samples as CSV.
+ * Build from the repository root:
+ *   gcc -O2 -ITools Tools/samplelog_dump.c Tools/samplelog.c -o samplelog_dump
+ * Run:
+ *   ./samplelog_dump <log>                    summary
+ *   ./samplelog_dump -c [-t from to] <log>    "timestamp,x,y,z" lines, optionally only timestamps in [from, to]
+ */
+#include "samplelog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void summary(const samplelog_reader_t *r){
+	const samplelog_header_t *h = r->header;
+	printf("version %u, %llu samples in %u chunks of up to %u, %s\n", h->version, (unsigned long long)r->sample_count,
+			r->chunk_count, h->chunk_samples, h->index_offset ? "complete" : "unfinished, index rebuilt");
+	printf("timestamp unit %u us, field scale %.4f mG per count\n", h->timestamp_us, h->field_scale_q8 / 256.0);
+
+	if(h->flags & SAMPLELOG_HAS_CONFIG){
+		const samplelog_config_t *c = &h->config;
+		printf("registers");
+		for(size_t i = 0; i < sizeof(c->registers); i++){
+			printf(" %02X", c->registers[i]);
+		}
+		printf("\nbias %d %d %d LSB, declination %.2f deg, calibration epoch %u\n", c->bias[0], c->bias[1], c->bias[2],
+				c->declination / 100.0, c->calibration_epoch);
+		for(int i = 0; i < 3; i++){
+			printf("matrix %8.5f %8.5f %8.5f\n", c->matrix[i][0] / 16384.0, c->matrix[i][1] / 16384.0,
+					c->matrix[i][2] / 16384.0);
+		}
+	} else {
+		printf("no configuration snapshot\n");
+	}
+
+	for(uint32_t i = 0; i < r->chunk_count; i++){
+		samplelog_chunk_t chunk;
+		if(samplelog_chunk(r, i, &chunk) != 0){
+			printf("chunk %u: damaged\n", i);
+			continue;
+		}
+		printf("chunk %u: %u samples, t %u..%u, x %d..%d, y %d..%d, z %d..%d\n", i, chunk.count, chunk.first_timestamp,
+				chunk.last_timestamp, chunk.min[0], chunk.max[0], chunk.min[1], chunk.max[1], chunk.min[2], chunk.max[2]);
+	}
+}
+
+static void csv(const samplelog_reader_t *r, uint32_t from, uint32_t to){
+	for(uint32_t i = samplelog_find(r, from); i < r->chunk_count; i++){
+		samplelog_chunk_t chunk;
+		if(samplelog_chunk(r, i, &chunk) != 0){
+			fprintf(stderr, "chunk %u: damaged\n", i);
+			continue;
+		}
+		if(chunk.first_timestamp > to){
+			break;
+		}
+		for(uint32_t j = 0; j < chunk.count; j++){
+			if(chunk.timestamp[j] >= from && chunk.timestamp[j] <= to){
+				printf("%u,%d,%d,%d\n", chunk.timestamp[j], chunk.axis[0][j], chunk.axis[1][j], chunk.axis[2][j]);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv){
+	int as_csv = 0;
+	uint32_t from = 0;
+	uint32_t to = UINT32_MAX;
+	int arg = 1;
+	while(arg < argc - 1 && argv[arg][0] == '-'){
+		if(strcmp(argv[arg], "-c") == 0){
+			as_csv = 1;
+			arg++;
+		} else if(strcmp(argv[arg], "-t") == 0 && arg + 3 < argc){
+			from = (uint32_t)strtoul(argv[arg + 1], NULL, 0);
+			to = (uint32_t)strtoul(argv[arg + 2], NULL, 0);
+			arg += 3;
+		} else {
+			break;
+		}
+	}
+	if(argc - arg != 1){
+		fprintf(stderr, "usage: %s [-c [-t from to]] <log>\n", argv[0]);
+		return 2;
+	}
+
+	samplelog_reader_t r;
+	if(samplelog_open(&r, argv[arg]) != 0){
+		perror(argv[arg]);
+		return 1;
+	}
+	if(as_csv){
+		csv(&r, from, to);
+	} else {
+		summary(&r);
+	}
+	samplelog_release(&r);
+	return 0;
+}
@@ -0,0 +1,16 @@
+/*
+ * gpio.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host stand-in for Core/Inc/gpio.h, see stm32u5xx_hal.h in this directory.
+ */
+
+#ifndef TOOLS_SPI_STUB_GPIO_H_
+#define TOOLS_SPI_STUB_GPIO_H_
+
+void IIS2MDC_GPIO_Init(void);
+void IIS2MDC_SPI_GPIO_Init(void);
+
+#endif /* TOOLS_SPI_STUB_GPIO_H_ */
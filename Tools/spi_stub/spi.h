@@ -0,0 +1,19 @@
+/*
+ * spi.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host stand-in for Core/Inc/spi.h, see stm32u5xx_hal.h in this directory.
+ */
+
+#ifndef TOOLS_SPI_STUB_SPI_H_
+#define TOOLS_SPI_STUB_SPI_H_
+
+#include "stm32u5xx_hal.h"
+
+extern SPI_HandleTypeDef hspi2;
+
+void MX_SPI2_Init(void);
+
+#endif /* TOOLS_SPI_STUB_SPI_H_ */
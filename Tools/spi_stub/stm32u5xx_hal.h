@@ -0,0 +1,54 @@
+/*
+ * stm32u5xx_hal.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host stand-in for the parts of the HAL, CMSIS and main.h that IIS2MDC_Hardware_SPI.c uses. Tools/spi_test.c implements
+ * them on a register model of the sensor. Not for target builds.
+ */
+
+#ifndef TOOLS_SPI_STUB_STM32U5XX_HAL_H_
+#define TOOLS_SPI_STUB_STM32U5XX_HAL_H_
+
+#include <stdint.h>
+
+#define HAL_SPI_MODULE_ENABLED
+#define USE_HAL_SPI_REGISTER_CALLBACKS 1U
+
+typedef enum{HAL_OK, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT}HAL_StatusTypeDef;
+typedef enum{GPIO_PIN_RESET, GPIO_PIN_SET}GPIO_PinState;
+typedef enum{HAL_SPI_STATE_RESET, HAL_SPI_STATE_READY, HAL_SPI_STATE_BUSY}HAL_SPI_StateTypeDef;
+typedef enum{HAL_SPI_RX_COMPLETE_CB_ID, HAL_SPI_ERROR_CB_ID, HAL_SPI_CB_IDS}HAL_SPI_CallbackIDTypeDef;
+typedef struct{int Port;}GPIO_TypeDef;
+
+typedef struct __SPI_HandleTypeDef{
+	volatile HAL_SPI_StateTypeDef State;
+	void (*Callbacks[HAL_SPI_CB_IDS])(struct __SPI_HandleTypeDef *hspi);
+}SPI_HandleTypeDef;
+typedef void (*pSPI_CallbackTypeDef)(SPI_HandleTypeDef *hspi);
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_DeInit(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_RegisterCallback(SPI_HandleTypeDef *hspi, HAL_SPI_CallbackIDTypeDef CallbackID, pSPI_CallbackTypeDef pCallback);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin);
+uint32_t HAL_GetTick(void);
+void NVIC_EnableIRQ(int IRQn);
+void NVIC_DisableIRQ(int IRQn);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+
+extern GPIO_TypeDef stub_gpiob, stub_gpiod;
+#define IIS2MDC_SPI_CS_Pin 0x1000U
+#define IIS2MDC_SPI_CS_GPIO_Port (&stub_gpiob)
+#define IIS2MDC_IRQ_Pin 0x0400U
+#define IIS2MDC_IRQ_GPIO_Port (&stub_gpiod)
+#define IIS2MDC_IRQ_EXTI_IRQn 10
+
+#endif /* TOOLS_SPI_STUB_STM32U5XX_HAL_H_ */
@@ -0,0 +1,380 @@
+/*
+ * spi_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Hardware_SPI.c against a register model of the sensor behind stub HAL SPI calls
+ * (Tools/spi_stub). Checks the frame format, that I2C is disabled before any other access once the sensor has booted,
+ * non blocking DMA reads completed through the handle's registered callbacks, bus ownership between blocking and DMA
+ * reads, and that bus re-init registers the callbacks again and keeps the interface bits.
+ * Build from the repository root:
+ *   gcc -O2 -ITools/spi_stub -ICore/Inc -ITools Tools/spi_test.c Core/Src/IIS2MDC_Hardware_SPI.c Core/Src/IIS2MDC.c \
+ *       Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o spi_test -lm
+ * Run:
+ *   ./spi_test, exits non-zero on failure
+ */
+#include "stm32u5xx_hal.h"
+#include "spi.h"
+#include "gpio.h"
+#include "log.h"
+#include "IIS2MDC.h"
+#define TEST_UTIL_QUIET_LOG
+#include "test_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CFG_C_I2C_DIS 0x20U
+#define CALLS_PER_MS 8 /*HAL_GetTick calls per virtual millisecond, so polling loops see time pass*/
+
+
+/**************************************//**************************************//**************************************
+ * Register model behind the stub HAL
+ **************************************//**************************************//**************************************/
+SPI_HandleTypeDef hspi2;
+GPIO_TypeDef stub_gpiob, stub_gpiod;
+
+static struct{
+	uint8_t regs[0x80];
+	uint32_t calls;          //HAL_GetTick calls, the virtual clock
+	uint8_t cs;              //Pin level, 1 idle
+	uint8_t header_seen;
+	uint8_t read;
+	uint8_t address;
+	uint32_t frames;
+	uint32_t early_frames;   //Frames started before the boot time
+	uint32_t frames_as_i2c;  //Frames other than the I2C_DIS write while the I2C block was still on
+	uint32_t protocol_errors;
+	uint32_t busy_errors;    //HAL calls made while a DMA read still owned the peripheral
+	uint32_t inits;
+	uint32_t missed_callbacks;
+	uint8_t *dma_buffer;
+	uint16_t dma_length;
+}m;
+
+static struct{
+	uint32_t count;
+	IIS2MDC_Status_t status;
+	void *context;
+}done;
+
+static uint32_t now_ms(void){
+	return m.calls / CALLS_PER_MS;
+}
+
+static void power_on(void){
+	memset(&m, 0, sizeof(m));
+	m.cs = 1;
+	m.regs[IIS2MDC_REG_WHO_AM_I] = 0x40;
+	m.regs[IIS2MDC_REG_CFG_REG_A] = 0x03;
+	m.regs[IIS2MDC_REG_INT_CTRL_REG] = 0xE0;
+	memset(&hspi2, 0, sizeof(hspi2));
+}
+
+static uint8_t read_only(uint8_t reg){
+	return reg == IIS2MDC_REG_WHO_AM_I || reg == IIS2MDC_REG_INT_SOURCE_REG || reg >= IIS2MDC_REG_STATUS_REG;
+}
+
+static uint8_t frame_ok(void){
+	if(m.cs || hspi2.State == HAL_SPI_STATE_RESET){
+		m.protocol_errors++;
+		return 0;
+	}
+	if(hspi2.State == HAL_SPI_STATE_BUSY){
+		m.busy_errors++;
+		return 0;
+	}
+	return 1;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout){
+	(void)hspi;
+	(void)Timeout;
+	if(!frame_ok()){
+		return HAL_BUSY;
+	}
+	for(uint16_t i = 0; i < Size; i++){
+		if(!m.header_seen){
+			m.header_seen = 1;
+			m.read = pData[i] >> 7;
+			m.address = pData[i] & 0x7F;
+			uint8_t i2c_dis_write = !m.read && m.address == IIS2MDC_REG_CFG_REG_C && Size == 1;
+			if(!(m.regs[IIS2MDC_REG_CFG_REG_C] & CFG_C_I2C_DIS) && !i2c_dis_write){
+				m.frames_as_i2c++;
+			}
+		} else if(m.read){
+			m.protocol_errors++; //Data sent in a read frame
+		} else {
+			if(!read_only(m.address)){
+				m.regs[m.address] = pData[i];
+			}
+			m.address = (m.address + 1) & 0x7F;
+		}
+	}
+	return HAL_OK;
+}
+
+static void shift_out(uint8_t *pData, uint16_t Size){
+	for(uint16_t i = 0; i < Size; i++){
+		pData[i] = m.regs[m.address];
+		m.address = (m.address + 1) & 0x7F;
+	}
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout){
+	(void)hspi;
+	(void)Timeout;
+	if(!frame_ok()){
+		return HAL_BUSY;
+	}
+	if(!m.header_seen || !m.read){
+		m.protocol_errors++;
+		return HAL_ERROR;
+	}
+	shift_out(pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size){
+	if(!frame_ok()){
+		return HAL_BUSY;
+	}
+	if(!m.header_seen || !m.read){
+		m.protocol_errors++;
+		return HAL_ERROR;
+	}
+	hspi->State = HAL_SPI_STATE_BUSY;
+	m.dma_buffer = pData;
+	m.dma_length = Size;
+	return HAL_OK;
+}
+
+/*The DMA read in flight ends, as the SPI interrupt would report it*/
+static void dma_finish(uint8_t error){
+	if(m.dma_buffer == NULL){
+		m.protocol_errors++;
+		return;
+	}
+	if(!error){
+		shift_out(m.dma_buffer, m.dma_length);
+	}
+	m.dma_buffer = NULL;
+	hspi2.State = HAL_SPI_STATE_READY;
+	pSPI_CallbackTypeDef callback = hspi2.Callbacks[error ? HAL_SPI_ERROR_CB_ID : HAL_SPI_RX_COMPLETE_CB_ID];
+	if(callback == NULL){
+		m.missed_callbacks++; //Would have gone to the weak default
+		return;
+	}
+	callback(&hspi2);
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef *hspi){
+	m.dma_buffer = NULL;
+	if(hspi->State == HAL_SPI_STATE_BUSY){
+		hspi->State = HAL_SPI_STATE_READY;
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_DeInit(SPI_HandleTypeDef *hspi){
+	memset(hspi, 0, sizeof(*hspi));
+	return HAL_OK;
+}
+
+/*HAL_SPI_Init puts the registered callbacks back to the weak defaults*/
+void MX_SPI2_Init(void){
+	memset(&hspi2, 0, sizeof(hspi2));
+	hspi2.State = HAL_SPI_STATE_READY;
+	m.inits++;
+}
+
+HAL_StatusTypeDef HAL_SPI_RegisterCallback(SPI_HandleTypeDef *hspi, HAL_SPI_CallbackIDTypeDef CallbackID, pSPI_CallbackTypeDef pCallback){
+	if(hspi->State != HAL_SPI_STATE_READY || CallbackID >= HAL_SPI_CB_IDS){
+		return HAL_ERROR;
+	}
+	hspi->Callbacks[CallbackID] = pCallback;
+	return HAL_OK;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState){
+	if(GPIOx != IIS2MDC_SPI_CS_GPIO_Port || GPIO_Pin != IIS2MDC_SPI_CS_Pin){
+		return;
+	}
+	if(m.cs && PinState == GPIO_PIN_RESET){
+		m.frames++;
+		m.header_seen = 0;
+		if(now_ms() < IIS2MDC_BOOT_MS){
+			m.early_frames++;
+		}
+	}
+	m.cs = (PinState == GPIO_PIN_SET);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin){
+	(void)GPIOx;
+	(void)GPIO_Pin;
+	return GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin){
+	(void)GPIOx;
+	(void)GPIO_Pin;
+}
+
+uint32_t HAL_GetTick(void){
+	return m.calls++ / CALLS_PER_MS;
+}
+
+void NVIC_EnableIRQ(int IRQn){
+	(void)IRQn;
+}
+
+void NVIC_DisableIRQ(int IRQn){
+	(void)IRQn;
+}
+
+uint32_t __get_PRIMASK(void){
+	return 0;
+}
+
+void __set_PRIMASK(uint32_t priMask){
+	(void)priMask;
+}
+
+void __disable_irq(void){
+}
+
+void IIS2MDC_GPIO_Init(void){
+}
+
+void IIS2MDC_SPI_GPIO_Init(void){
+	m.cs = 1;
+}
+
+/**************************************//**************************************//**************************************
+ * Tests
+ **************************************//**************************************//**************************************/
+static void read_done(void *Context, IIS2MDC_Status_t Status){
+	done.count++;
+	done.status = Status;
+	done.context = Context;
+}
+
+static void init(IIS2MDC_Handle_t *Dev){
+	static const IIS2MDC_Calibration_t identity = {
+			.Bias = {0, 0, 0},
+			.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_50Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.DrdyPinMode = IIS2MDC_DrdyOnPin;
+	Settings.Calibration = &identity;
+	power_on();
+	IIS2MDC_Init(Settings, Dev, IIS2MDC_Hardware_SPI_Drv);
+
+	check(Dev->BusState == IIS2MDC_BusOk, "bus state after init", Dev->BusState);
+	check(m.early_frames == 0, "frames before the boot time", m.early_frames);
+	check(m.frames_as_i2c == 0, "frames before I2C was disabled", m.frames_as_i2c);
+	check(m.regs[IIS2MDC_REG_CFG_REG_C] == 0x31, "CFG_REG_C is I2C_DIS | BDU | DRDY_ON_PIN", m.regs[IIS2MDC_REG_CFG_REG_C]);
+	check(m.regs[IIS2MDC_REG_CFG_REG_A] == 0x08, "CFG_REG_A 50 Hz continuous", m.regs[IIS2MDC_REG_CFG_REG_A]);
+	check(m.cs == 1 && m.protocol_errors == 0, "frames closed", m.protocol_errors);
+	printf("init: %u frames, first after %u ms of boot time, CFG_REG_C %02X\n", m.frames, IIS2MDC_BOOT_MS,
+			m.regs[IIS2MDC_REG_CFG_REG_C]);
+}
+
+static void set_sample(int16_t x, int16_t y, int16_t z){
+	const int16_t v[3] = {x, y, z};
+	for(int i = 0; i < 3; i++){
+		m.regs[IIS2MDC_REG_OUTX_L_REG + 2 * i] = (uint8_t)v[i];
+		m.regs[IIS2MDC_REG_OUTX_L_REG + 2 * i + 1] = (uint8_t)((uint16_t)v[i] >> 8);
+	}
+	m.regs[IIS2MDC_REG_STATUS_REG] = 0x0F;
+}
+
+static void blocking(IIS2MDC_Handle_t *Dev){
+	set_sample(272, -16, -32768);
+	uint32_t frames = m.frames;
+	check(IIS2MDC_ReadMagnetic(Dev) == IIS2MDC_DataReady, "blocking sample", 0);
+	check(Dev->MagX == 408 && Dev->MagY == -24 && Dev->MagZ == -49152, "sample in mG", Dev->MagX);
+	check(m.frames - frames <= 2, "status and data in at most two frames", m.frames - frames);
+	check(hspi2.State == HAL_SPI_STATE_READY && m.dma_buffer == NULL, "blocking reads are polled", hspi2.State);
+}
+
+static void async(IIS2MDC_Handle_t *Dev){
+	const IIS2MDC_IO_Drv_t *IO = &Dev->IIS2MDC_IO;
+	check(IO->ReadRegAsync != NULL, "SPI driver has a non blocking read", 0);
+
+	/*Every length goes through DMA, even a single byte*/
+	static const uint8_t lengths[] = {1, 6, 16};
+	for(unsigned k = 0; k < sizeof(lengths); k++){
+		uint8_t buffer[16] = {0};
+		uint8_t expected[16];
+		memcpy(expected, &m.regs[IIS2MDC_REG_CFG_REG_A], lengths[k]);
+		done.count = 0;
+		check(IO->ReadRegAsync(IIS2MDC_REG_CFG_REG_A, buffer, lengths[k], read_done, &done) == IIS2MDC_Ok, "async start", lengths[k]);
+		check(m.dma_buffer == buffer && m.cs == 0 && done.count == 0, "returns with DMA running and CS low", lengths[k]);
+		dma_finish(0);
+		check(done.count == 1 && done.status == IIS2MDC_Ok && done.context == &done, "done callback", lengths[k]);
+		check(memcmp(buffer, expected, lengths[k]) == 0, "async data", lengths[k]);
+		check(m.cs == 1, "CS raised on completion", lengths[k]);
+	}
+
+	/*The bus belongs to the read in flight: a second async read is refused and a blocking one times out*/
+	uint8_t buffer[6], other[1];
+	set_sample(1, 2, 3);
+	done.count = 0;
+	IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, buffer, 6, read_done, NULL);
+	check(IO->ReadRegAsync(IIS2MDC_REG_WHO_AM_I, other, 1, read_done, NULL) == IIS2MDC_Error, "second async read refused", 0);
+	uint32_t start = now_ms();
+	check(IO->ReadReg(IIS2MDC_REG_WHO_AM_I, other, 1) == IIS2MDC_ErrorTimeout, "blocking read while DMA owns the bus", 0);
+	check(now_ms() - start <= 4, "blocking read gives up after its timeout", (long)(now_ms() - start));
+	check(m.busy_errors == 0 && m.cs == 0, "DMA read left undisturbed", m.busy_errors);
+	dma_finish(0);
+	check(done.count == 1 && buffer[0] == 1 && buffer[2] == 2 && buffer[4] == 3, "read in flight completed", buffer[0]);
+	check(IO->ReadReg(IIS2MDC_REG_WHO_AM_I, other, 1) == IIS2MDC_Ok && other[0] == 0x40, "blocking read after DMA", other[0]);
+
+	/*A DMA error still ends the frame and is reported to Done*/
+	done.count = 0;
+	IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, buffer, 6, read_done, NULL);
+	dma_finish(1);
+	check(done.count == 1 && done.status == IIS2MDC_Error && m.cs == 1, "DMA error reported", done.status);
+	check(IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, buffer, 6, read_done, NULL) == IIS2MDC_Ok, "bus free after an error", 0);
+	dma_finish(0);
+	printf("async: 1, 6 and 16 byte DMA reads, bus ownership and DMA errors\n");
+}
+
+static void reinit(IIS2MDC_Handle_t *Dev){
+	const IIS2MDC_IO_Drv_t *IO = &Dev->IIS2MDC_IO;
+	uint8_t buffer[6];
+
+	/*Re-init while a DMA read hangs: the read is dropped, the callbacks and I2C_DIS come back*/
+	IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, buffer, 6, read_done, NULL);
+	m.regs[IIS2MDC_REG_CFG_REG_C] = 0; //The sensor was reset as well
+	uint32_t inits = m.inits;
+	check(IO->ioctl(IIS2MDC_BusReinit) == IIS2MDC_Ok, "bus re-init", 0);
+	check(m.inits == inits + 1, "peripheral initialized again", m.inits);
+	check(hspi2.Callbacks[HAL_SPI_RX_COMPLETE_CB_ID] != NULL && hspi2.Callbacks[HAL_SPI_ERROR_CB_ID] != NULL,
+			"callbacks registered again", 0);
+	check(m.regs[IIS2MDC_REG_CFG_REG_C] & CFG_C_I2C_DIS, "I2C disabled again", m.regs[IIS2MDC_REG_CFG_REG_C]);
+	done.count = 0;
+	check(IO->ReadRegAsync(IIS2MDC_REG_OUTX_L_REG, buffer, 6, read_done, NULL) == IIS2MDC_Ok, "async after re-init", 0);
+	dma_finish(0);
+	check(done.count == 1 && m.missed_callbacks == 0, "completion reaches the driver", m.missed_callbacks);
+
+	/*The device layer keeps the interface bits whenever it rewrites CFG_REG_C*/
+	IIS2MDC_InitStruct_t Settings = Dev->Settings;
+	Settings.DrdyPinMode = IIS2MDC_DrdySignalDisabled;
+	check(IIS2MDC_Reconfigure(Dev, &Settings) == IIS2MDC_Ok, "reconfigure", 0);
+	check(m.regs[IIS2MDC_REG_CFG_REG_C] == 0x30, "CFG_REG_C keeps I2C_DIS", m.regs[IIS2MDC_REG_CFG_REG_C]);
+	check(m.protocol_errors == 0 && m.busy_errors == 0, "protocol", m.protocol_errors);
+}
+
+int main(void){
+	IIS2MDC_Handle_t Dev;
+	init(&Dev);
+	blocking(&Dev);
+	async(&Dev);
+	reinit(&Dev);
+	return test_result();
+}
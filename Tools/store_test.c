@@ -0,0 +1,183 @@
+/*
+ * store_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Store. Every drained sample is compared with what was appended: field and absolute time.
+ * Covers the wrap and its Overwritten count (time marks don't count as lost samples), gaps at and past
+ * IIS2MDC_STORE_TIME_MARK, Init on a valid store (records kept, the new run starts with a mark), Init on corrupted
+ * headers (formatted), and Drain with Max below Count.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/store_test.c Core/Src/IIS2MDC_Store.c -o store_test
+ * Run:
+ *   ./store_test, exits non-zero on failure
+ */
+#include "IIS2MDC_Store.h"
+#include "test_util.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define APPENDED_MAX (2U * IIS2MDC_STORE_CAPACITY)
+
+static IIS2MDC_Store_t Store;
+
+/*Everything appended since the last Clear, oldest first*/
+static IIS2MDC_StoreSample_t appended[APPENDED_MAX];
+static uint32_t appended_count;
+
+static void clear(void){
+	IIS2MDC_Store_Clear(&Store);
+	appended_count = 0;
+}
+
+static void append(int32_t x, int32_t y, int32_t z, uint32_t timestamp){
+	const int32_t field[3] = {x, y, z};
+	IIS2MDC_Store_Append(&Store, field, timestamp);
+	if(appended_count < APPENDED_MAX){
+		appended[appended_count++] = (IIS2MDC_StoreSample_t){{(int16_t)x, (int16_t)y, (int16_t)z}, timestamp};
+	}
+}
+
+/*Drains Max at a time and checks the samples against the appended ones from expected_first on, in order. Returns the
+ *samples drained.*/
+static uint32_t drain_all(uint16_t max, uint32_t expected_first){
+	static IIS2MDC_StoreSample_t out[APPENDED_MAX + 1];
+	uint32_t total = 0, wrong = 0;
+	uint16_t n;
+	do{
+		out[max] = (IIS2MDC_StoreSample_t){{0x5A5A, 0x5A5A, 0x5A5A}, 0x5A5A5A5AU};
+		n = IIS2MDC_Store_Drain(&Store, out, max);
+		check(n <= max && out[max].Timestamp == 0x5A5A5A5AU, "drain stays within Max", n);
+		for(uint16_t i = 0; i < n; i++){
+			const IIS2MDC_StoreSample_t *e = &appended[expected_first + total + i];
+			wrong += memcmp(out[i].Field, e->Field, sizeof(e->Field)) != 0 || out[i].Timestamp != e->Timestamp;
+		}
+		total += n;
+	}while(n == max && max != 0);
+	check(wrong == 0, "drained samples match what was appended", wrong);
+	check(Store.Header.Count == 0, "store empty after draining", Store.Header.Count);
+	return total;
+}
+
+/*Filling past capacity drops the oldest samples and counts them, a lost time mark is not counted*/
+static void wrap(void){
+	clear();
+	const uint32_t extra = 100;
+	for(uint32_t i = 0; i < IIS2MDC_STORE_CAPACITY + extra; i++){
+		append((int32_t)i, -(int32_t)i, (int32_t)(i * 3U), 1000U + 10U * i);
+	}
+	check(Store.Header.Count == IIS2MDC_STORE_CAPACITY, "full", Store.Header.Count);
+	check(Store.Header.Overwritten == extra, "overwritten", Store.Header.Overwritten);
+	check(Store.Header.TailTime == appended[extra].Timestamp, "tail time after the wrap", Store.Header.TailTime);
+	check(drain_all(IIS2MDC_STORE_CAPACITY, extra) == IIS2MDC_STORE_CAPACITY, "wrapped drain", 0);
+
+	/*A gap puts a mark in the ring, when the wrap reaches it only the samples are counted as lost*/
+	clear();
+	uint32_t time = 0;
+	for(uint32_t i = 0; i < IIS2MDC_STORE_CAPACITY + extra; i++){
+		time += (i == 10) ? 2U * IIS2MDC_STORE_TIME_MARK : 10U;
+		append((int32_t)i, 1, -1, time);
+	}
+	check(Store.Header.Overwritten == extra, "marks are not lost samples", Store.Header.Overwritten);
+	check(drain_all(IIS2MDC_STORE_CAPACITY, extra) == IIS2MDC_STORE_CAPACITY, "drain past the overwritten mark", 0);
+}
+
+/*A delta that doesn't fit a record takes a time mark, one that does doesn't*/
+static void gaps(void){
+	clear();
+	append(1, 2, 3, 1000);
+	append(4, 5, 6, 1000 + IIS2MDC_STORE_TIME_MARK - 1U);                        //Largest delta a record holds
+	check(Store.Header.Count == 2, "no mark below IIS2MDC_STORE_TIME_MARK", Store.Header.Count);
+	append(7, 8, 9, appended[1].Timestamp + IIS2MDC_STORE_TIME_MARK);             //Exactly the mark value
+	check(Store.Header.Count == 4, "mark at IIS2MDC_STORE_TIME_MARK", Store.Header.Count);
+	append(10, 11, 12, 0x89ABCDEFU);                                              //Both halves of the mark used
+	check(Store.Header.Count == 6, "mark after a long gap", Store.Header.Count);
+	append(13, 14, 15, 0x89ABCDEFU + 1U);
+	append(-40000, 40000, 0, 0x89ABCDEFU + 2U);                                   //Saturated to int16
+	appended[appended_count - 1].Field[0] = INT16_MIN;
+	appended[appended_count - 1].Field[1] = INT16_MAX;
+	check(Store.Header.Count == 8, "samples after the mark", Store.Header.Count);
+	check(drain_all(16, 0) == 6, "gap drain", 0);
+}
+
+/*A reset leaves a valid store in retained memory: Init keeps it, the next run starts with a mark*/
+static void init_valid(void){
+	clear();
+	for(uint32_t i = 0; i < 20; i++){
+		append((int32_t)i, 0, 0, 500000U + 50U * i);
+	}
+	IIS2MDC_StoreHeader_t Before = Store.Header;
+
+	check(IIS2MDC_Store_Init(&Store) == 20, "records recovered", Store.Header.Count);
+	check(Store.Header.Head == Before.Head && Store.Header.TailTime == Before.TailTime && Store.Header.LastTime == Before.LastTime,
+			"header kept", Store.Header.Head);
+	check(Store.Header.Flags & IIS2MDC_STORE_NEED_MARK, "mark pending", Store.Header.Flags);
+	append(100, 0, 0, 20); //The new run's clock restarted, a delta from the old time would be garbage
+	check(Store.Header.Count == 22, "new run starts with a mark", Store.Header.Count);
+	append(101, 0, 0, 30);
+	check(Store.Header.Count == 23, "one mark per run", Store.Header.Count);
+	check(IIS2MDC_Store_Init(&Store) == 23, "init again", Store.Header.Count);
+	append(200, 0, 0, 5);
+	check(Store.Header.Count == 25, "every run gets its mark", Store.Header.Count);
+	check(drain_all(IIS2MDC_STORE_CAPACITY, 0) == 23, "recovered drain", 0);
+
+	/*Init on an empty valid store has nothing to mark*/
+	clear();
+	check(IIS2MDC_Store_Init(&Store) == 0, "empty store", Store.Header.Count);
+	append(1, 1, 1, 7);
+	check(Store.Header.Count == 1, "first sample of an empty store is not marked", Store.Header.Count);
+}
+
+/*Noise in any header field formats the store instead of draining garbage*/
+static void init_corrupted(void){
+	static const size_t fields[] = {
+		offsetof(IIS2MDC_StoreHeader_t, Magic), offsetof(IIS2MDC_StoreHeader_t, Capacity), offsetof(IIS2MDC_StoreHeader_t, Head),
+		offsetof(IIS2MDC_StoreHeader_t, Count), offsetof(IIS2MDC_StoreHeader_t, Flags), offsetof(IIS2MDC_StoreHeader_t, LastTime),
+		offsetof(IIS2MDC_StoreHeader_t, TailTime), offsetof(IIS2MDC_StoreHeader_t, Overwritten), offsetof(IIS2MDC_StoreHeader_t, Check),
+	};
+	for(unsigned f = 0; f < sizeof(fields) / sizeof(fields[0]); f++){
+		clear();
+		for(uint32_t i = 0; i < 30; i++){
+			append((int32_t)i, 0, 0, 10U * i);
+		}
+		((uint8_t*)&Store.Header)[fields[f]] ^= 0x01U;
+		check(IIS2MDC_Store_Init(&Store) == 0, "corrupted header formats", (double)fields[f]);
+		check(Store.Header.Count == 0 && Store.Header.Head == 0 && Store.Header.Overwritten == 0 &&
+				Store.Header.Magic == IIS2MDC_STORE_MAGIC, "formatted header", (double)fields[f]);
+		append(1, 2, 3, 4);
+		check(IIS2MDC_Store_Init(&Store) == 1, "formatted store is valid", (double)fields[f]);
+	}
+
+	/*Power up noise*/
+	memset(&Store, 0xA5, sizeof(Store));
+	check(IIS2MDC_Store_Init(&Store) == 0 && Store.Header.Count == 0, "power up noise formats", 0);
+}
+
+/*Drain hands out Max at a time, oldest first, with marks skipped and not counted against Max*/
+static void partial_drain(void){
+	clear();
+	uint32_t time = 0;
+	for(uint32_t i = 0; i < 50; i++){
+		time += (i % 17 == 16) ? IIS2MDC_STORE_TIME_MARK + 5U : 20U;
+		append((int32_t)i, (int32_t)(i * 2U), 3, time);
+	}
+	check(Store.Header.Count == 52, "two marks", Store.Header.Count);
+
+	IIS2MDC_StoreSample_t out[8];
+	check(IIS2MDC_Store_Drain(&Store, out, 0) == 0 && Store.Header.Count == 52, "Max 0 drains nothing", Store.Header.Count);
+	check(IIS2MDC_Store_Drain(&Store, out, 7) == 7 && Store.Header.Count == 45, "first 7", Store.Header.Count);
+	check(out[0].Field[0] == 0 && out[6].Field[0] == 6 && out[6].Timestamp == appended[6].Timestamp, "oldest first",
+			out[6].Field[0]);
+	check(drain_all(7, 7) == 43, "rest in blocks of 7", 0);
+}
+
+int main(void){
+	wrap();
+	gaps();
+	init_valid();
+	init_corrupted();
+	partial_drain();
+	return test_result();
+}
@@ -0,0 +1,228 @@
+/*
+ * telemetry_ingest.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Reads the USART1 telemetry stream (see telemetry.h and IIS2MDC_Telemetry.h) live or from a raw UART dump and
+ * writes the samples to a sample log (see samplelog.h).
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/telemetry_ingest.c Tools/samplelog.c Core/Src/telemetry.c Core/Src/IIS2MDC_Compress.c -o telemetry_ingest
+ * Run:
+ *   ./telemetry_ingest [-b baud] [-c chunk samples] <serial port | capture file | -> <output file>
+ * With -b a serial port is set to raw 8N1 at that baud (921600 for the board). Log text sent between frames is
+ * echoed to stderr. Ctrl-C stops reading and still closes the log. The log header gets the last configuration
+ * frame received.
+ */
+#include "telemetry.h"
+#include "IIS2MDC_Compress.h"
+#include "samplelog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define TYPE_SAMPLES 0x01U      /*IIS2MDC_TELEMETRY_TYPE_SAMPLES*/
+#define TYPE_CONFIG 0x02U       /*IIS2MDC_TELEMETRY_TYPE_CONFIG*/
+#define CONFIG_BYTES 39U        /*IIS2MDC_TELEMETRY_CONFIG_BYTES*/
+#define MAX_SEGMENT 8192U       /*Longer runs without a delimiter are line noise*/
+
+typedef struct{
+	uint32_t frames;
+	uint32_t samples;
+	uint32_t bad_frames;
+	uint32_t lost_frames;     /*Sequence gaps*/
+	uint32_t unknown_frames;
+	uint32_t config_frames;
+	uint32_t text_bytes;
+}stats_t;
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig){
+	(void)sig;
+	stop = 1;
+}
+
+static speed_t baud_constant(long baud){
+	switch(baud){
+	case 115200: return B115200;
+	case 230400: return B230400;
+	case 460800: return B460800;
+	case 921600: return B921600;
+	default: return 0;
+	}
+}
+
+static int configure_port(int fd, long baud){
+	struct termios tio;
+	speed_t speed = baud_constant(baud);
+	if(speed == 0 || tcgetattr(fd, &tio) != 0){
+		return -1;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	return tcsetattr(fd, TCSANOW, &tio);
+}
+
+static int16_t get16(const uint8_t *p){
+	return (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+}
+
+/*Payload layout is documented in IIS2MDC_Telemetry.h*/
+static void parse_config(const uint8_t *payload, samplelog_config_t *config){
+	memset(config, 0, sizeof(*config));
+	memcpy(config->registers, payload, sizeof(config->registers));
+	payload += sizeof(config->registers);
+	for(int i = 0; i < 3; i++, payload += 2){
+		config->bias[i] = get16(payload);
+	}
+	for(int i = 0; i < 9; i++, payload += 2){
+		config->matrix[i / 3][i % 3] = get16(payload);
+	}
+	config->declination = get16(payload);
+	config->calibration_epoch = payload[2];
+}
+
+/*Anything between delimiters that is not a frame is assumed to be log text if it reads as text*/
+static int segment(uint8_t *data, uint32_t length, samplelog_writer_t *log, stats_t *s, int *expected){
+	uint8_t type;
+	uint8_t sequence;
+	const uint8_t *payload;
+	uint32_t payload_length;
+	uint8_t copy[MAX_SEGMENT];
+	memcpy(copy, data, length);
+
+	if(telemetry_frame_decode(data, length, &type, &sequence, &payload, &payload_length) != telemetry_ok){
+		uint32_t printable = 0;
+		for(uint32_t i = 0; i < length; i++){
+			printable += isprint(copy[i]) || isspace(copy[i]);
+		}
+		if(printable == length){
+			fwrite(copy, 1, length, stderr);
+			s->text_bytes += length;
+		} else {
+			s->bad_frames++;
+		}
+		return 0;
+	}
+
+	if(*expected >= 0 && sequence != (uint8_t)*expected){
+		s->lost_frames += (uint8_t)(sequence - *expected);
+	}
+	*expected = (uint8_t)(sequence + 1U);
+	s->frames++;
+
+	if(type == TYPE_CONFIG && payload_length == CONFIG_BYTES){
+		samplelog_config_t config;
+		parse_config(payload, &config);
+		samplelog_set_config(log, &config);
+		s->config_frames++;
+		return 0;
+	} else if(type != TYPE_SAMPLES){
+		s->unknown_frames++;
+		return 0;
+	}
+	IIS2MDC_Decoder_t decoder;
+	int16_t field[3];
+	uint32_t timestamp;
+	IIS2MDC_Decoder_Init(&decoder, payload, payload_length);
+	while(IIS2MDC_Decoder_Decode(&decoder, field, &timestamp) == IIS2MDC_DecodeSample){
+		if(samplelog_append(log, timestamp, field) != 0){
+			return -1;
+		}
+		s->samples++;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv){
+	long baud = 0;
+	long chunk = 0;
+	int arg = 1;
+	while(argc - arg > 2 && argv[arg][0] == '-' && argv[arg][1] != 0){
+		if(strcmp(argv[arg], "-b") == 0){
+			baud = strtol(argv[arg + 1], NULL, 10);
+		} else if(strcmp(argv[arg], "-c") == 0){
+			chunk = strtol(argv[arg + 1], NULL, 10);
+		} else {
+			break;
+		}
+		arg += 2;
+	}
+	if(argc - arg != 2 || chunk < 0 || chunk > 1L << 24){
+		fprintf(stderr, "usage: %s [-b baud] [-c chunk samples] <serial port | capture file | -> <output file>\n", argv[0]);
+		return 2;
+	}
+
+	int fd = (strcmp(argv[arg], "-") == 0) ? STDIN_FILENO : open(argv[arg], O_RDONLY | O_NOCTTY);
+	if(fd < 0){
+		perror(argv[arg]);
+		return 1;
+	}
+	if(baud != 0 && configure_port(fd, baud) != 0){
+		fprintf(stderr, "%s: can't set %ld baud\n", argv[arg], baud);
+		return 1;
+	}
+
+	struct sigaction sa = {0};
+	sa.sa_handler = on_signal;
+	sigaction(SIGINT, &sa, NULL); //No SA_RESTART: read returns so the output still gets written
+	sigaction(SIGTERM, &sa, NULL);
+
+	samplelog_writer_t log;
+	if(samplelog_create(&log, argv[arg + 1], (uint32_t)chunk) != 0){
+		perror(argv[arg + 1]);
+		return 1;
+	}
+	stats_t stats = {0};
+	int failed = 0;
+	static uint8_t pending[MAX_SEGMENT];
+	uint32_t pending_length = 0;
+	uint8_t overflow = 0;
+	int expected = -1;
+	uint8_t buffer[4096];
+
+	while(!stop && !failed){
+		ssize_t n = read(fd, buffer, sizeof(buffer));
+		if(n <= 0){
+			break;
+		}
+		for(ssize_t i = 0; i < n; i++){
+			if(buffer[i] == TELEMETRY_DELIMITER){
+				if(overflow){
+					stats.bad_frames++;
+				} else if(pending_length != 0){
+					failed = segment(pending, pending_length, &log, &stats, &expected) != 0;
+				}
+				pending_length = 0;
+				overflow = 0;
+			} else if(pending_length < MAX_SEGMENT){
+				pending[pending_length++] = buffer[i];
+			} else {
+				overflow = 1;
+			}
+		}
+	}
+	if(!failed && !overflow && pending_length != 0){ //Log text after the last frame has no delimiter behind it
+		failed = segment(pending, pending_length, &log, &stats, &expected) != 0;
+	}
+
+	if(samplelog_close(&log) != 0 || failed){
+		perror(argv[arg + 1]);
+		return 1;
+	}
+	fprintf(stderr, "frames %u, samples %u, config frames %u, lost frames %u, bad frames %u, unknown frames %u, log text %u bytes\n",
+			stats.frames, stats.samples, stats.config_frames, stats.lost_frames, stats.bad_frames, stats.unknown_frames,
+			stats.text_bytes);
+	return 0;
+}
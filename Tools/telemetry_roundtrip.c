@@ -0,0 +1,287 @@
+/*
+ * telemetry_roundtrip.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Round trip test for the telemetry stream: IIS2MDC_Telemetry produces frames as the firmware does, they go through a
+ * PTY standing in for the serial port and then through a pipe, and telemetry_ingest turns them into a sample log.
+ * The log must hold exactly the samples of the frames that arrived intact, with the last configuration in its header.
+ * The stream carries log text between frames, a frame the link had no room for, a frame hit by line noise, and is
+ * written in pieces that split frames across reads.
+ * Build from the repository root, after telemetry_ingest:
+ *   gcc -O2 -ICore/Inc -ITools Tools/telemetry_roundtrip.c Tools/samplelog.c Core/Src/IIS2MDC_Telemetry.c \
+ *       Core/Src/telemetry.c Core/Src/IIS2MDC_Compress.c -o telemetry_roundtrip
+ * Run:
+ *   ./telemetry_roundtrip ./telemetry_ingest, exits non-zero on failure
+ */
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+#include "IIS2MDC_Telemetry.h"
+#include "samplelog.h"
+#include "log.h"
+#define TEST_UTIL_QUIET_LOG
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+#define SAMPLES 1000U
+#define SAMPLES_PER_FRAME 16U
+#define DROPPED_FRAME 5U       /*Sample frames, counted from 1*/
+#define CORRUPTED_FRAME 9U
+#define TEXT "Debug Subsystem IIS2MDC: Event loop: 500 samples.\r\n"
+#define PIECE 97U              /*Write size, splits frames across reads*/
+
+static int out_fd;
+
+/*What was appended, and whether its frame reached the wire intact*/
+static struct{
+	uint32_t timestamp;
+	int16_t field[3];
+	uint8_t delivered;
+}sent[SAMPLES];
+static uint32_t appended, framed;
+static uint32_t sample_frames, text_bytes;
+
+static void put(const uint8_t *data, uint32_t length){
+	while(length > 0){
+		ssize_t n = write(out_fd, data, length < PIECE ? length : PIECE);
+		if(n <= 0){
+			check(0, "write", (long)n);
+			return;
+		}
+		data += n;
+		length -= (uint32_t)n;
+	}
+}
+
+/*The link: drops one sample frame, corrupts another, and lets log text through after every third frame*/
+static uint8_t link_write(const uint8_t *frame, uint16_t length){
+	uint8_t copy[IIS2MDC_TELEMETRY_FRAME_BYTES];
+	uint8_t type, sequence;
+	const uint8_t *payload;
+	uint32_t payload_length;
+	memcpy(copy, frame, length);
+	check(telemetry_frame_decode(&copy[1], length - 2U, &type, &sequence, &payload, &payload_length) == telemetry_ok,
+			"frame decodes", length);
+
+	uint8_t intact = 1;
+	if(type == IIS2MDC_TELEMETRY_TYPE_SAMPLES){
+		sample_frames++;
+		intact = sample_frames != DROPPED_FRAME && sample_frames != CORRUPTED_FRAME;
+		for(; framed < appended; framed++){
+			sent[framed].delivered = intact;
+		}
+		if(sample_frames == DROPPED_FRAME){
+			return 0;
+		}
+	}
+
+	memcpy(copy, frame, length);
+	if(type == IIS2MDC_TELEMETRY_TYPE_SAMPLES && sample_frames == CORRUPTED_FRAME){
+		uint16_t at = length / 2U;
+		copy[at] ^= (copy[at] == 0x10U) ? 0x20U : 0x10U; //Never turns into a delimiter
+	}
+	put(copy, length);
+	if(sample_frames % 3U == 0){
+		put((const uint8_t*)TEXT, sizeof(TEXT) - 1U);
+		text_bytes += sizeof(TEXT) - 1U;
+	}
+	return 1;
+}
+
+/*Runs a firmware-like telemetry session into fd*/
+static void generate(int fd){
+	static IIS2MDC_Handle_t Dev;
+	static IIS2MDC_Calibration_t Calibration = {{-12, 34, -56}, {{16384, 10, -20}, {30, 16000, -40}, {50, -60, 16500}}};
+	for(int i = 0; i < 6; i++){
+		Dev.Shadow.Offset[i] = (uint8_t)i;
+	}
+	Dev.Shadow.Cfg[0] = 0x8C;
+	Dev.Shadow.Cfg[2] = 0x01;
+	Dev.Shadow.Threshold[1] = 0x7F;
+	Dev.Calibration = &Calibration;
+	Dev.Declination = -345;
+	Dev.CalibrationEpoch = 3;
+
+	out_fd = fd;
+	appended = framed = sample_frames = text_bytes = 0;
+	IIS2MDC_Telemetry_t T;
+	IIS2MDC_Telemetry_Drv_t Link = {.Write = link_write};
+	check(IIS2MDC_Telemetry_Init(&T, Link, SAMPLES_PER_FRAME) == IIS2MDC_Ok, "telemetry init", 0);
+	IIS2MDC_Telemetry_AttachSensor(&T, &Dev);
+	srand(2);
+	for(uint32_t i = 0; i < SAMPLES; i++){
+		int32_t field[3] = {300 + rand() % 7, -200 + rand() % 7, (i == 500) ? 40000 : 450 + rand() % 7};
+		if(i == 700){ //New calibration, the header must end up with this one
+			Dev.CalibrationEpoch = 4;
+			Calibration.Bias[0] = 99;
+		}
+		sent[i].timestamp = 1000U + i * 100U + (uint32_t)(rand() % 2);
+		for(int a = 0; a < 3; a++){
+			sent[i].field[a] = (int16_t)(field[a] > INT16_MAX ? INT16_MAX : field[a]);
+		}
+		appended++;
+		IIS2MDC_Telemetry_Append(&T, field, sent[i].timestamp);
+	}
+	IIS2MDC_Telemetry_Flush(&T); //1000 is not a multiple of the frame, as in main.c
+	check(T.Stats.Samples == SAMPLES && T.Stats.Dropped == 1, "generator", (long)T.Stats.Dropped);
+}
+
+/*Runs telemetry_ingest on input, its stderr goes to errors. The child must not hold the writing end open.*/
+static pid_t ingest(const char *tool, const char *input, int stdin_fd, int writer_fd, const char *output, const char *errors){
+	pid_t pid = fork();
+	if(pid == 0){
+		close(writer_fd);
+		int err = open(errors, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		dup2(err, STDERR_FILENO);
+		if(stdin_fd >= 0){
+			dup2(stdin_fd, STDIN_FILENO);
+		}
+		if(strcmp(input, "-") == 0){
+			execl(tool, tool, "-c", "100", "-", output, (char*)NULL);
+		} else {
+			execl(tool, tool, "-b", "921600", "-c", "100", input, output, (char*)NULL);
+		}
+		_exit(127);
+	}
+	return pid;
+}
+
+/*The log against what was delivered, the summary line against what the link did*/
+static void verify(const char *name, const char *output, const char *errors){
+	samplelog_reader_t r;
+	if(samplelog_open(&r, output) != 0){
+		check(0, name, 0);
+		return;
+	}
+	const samplelog_config_t *config = &r.header->config;
+	check((r.header->flags & SAMPLELOG_HAS_CONFIG) && config->calibration_epoch == 4 && config->bias[0] == 99 &&
+			config->bias[2] == -56 && config->matrix[2][2] == 16500 && config->declination == -345 &&
+			config->registers[5] == 5 && config->registers[6] == 0x8C, "configuration in the header", config->bias[0]);
+
+	uint32_t expected = 0, mismatches = 0;
+	uint32_t chunk_index = 0;
+	samplelog_chunk_t chunk = {0};
+	uint32_t in_chunk = 0;
+	for(uint32_t i = 0; i < SAMPLES; i++){
+		if(!sent[i].delivered){
+			continue;
+		}
+		if(in_chunk == chunk.count){
+			if(chunk_index >= r.chunk_count || samplelog_chunk(&r, chunk_index++, &chunk) != 0){
+				break;
+			}
+			in_chunk = 0;
+		}
+		mismatches += chunk.timestamp[in_chunk] != sent[i].timestamp || chunk.axis[0][in_chunk] != sent[i].field[0] ||
+				chunk.axis[1][in_chunk] != sent[i].field[1] || chunk.axis[2][in_chunk] != sent[i].field[2];
+		in_chunk++;
+		expected++;
+	}
+	check(r.sample_count == expected, "samples in the log", (long)r.sample_count);
+	check(mismatches == 0, "samples match", (long)mismatches);
+	check(expected == SAMPLES - 2 * SAMPLES_PER_FRAME, "two frames lost", (long)expected);
+	samplelog_release(&r);
+
+	char line[512] = "";
+	FILE *f = fopen(errors, "r");
+	uint32_t text_seen = 0;
+	while(f != NULL && fgets(line, sizeof(line), f) != NULL){
+		text_seen += strstr(line, "Event loop: 500 samples.") != NULL;
+	}
+	if(f != NULL){
+		fclose(f);
+	}
+	unsigned frames, samples, configs, lost, bad, unknown, text;
+	int parsed = sscanf(line, "frames %u, samples %u, config frames %u, lost frames %u, bad frames %u, unknown frames %u, "
+			"log text %u bytes", &frames, &samples, &configs, &lost, &bad, &unknown, &text);
+	check(parsed == 7, "summary line", parsed);
+	check(samples == expected && lost == 2 && bad == 1 && unknown == 0 && configs == 2, "summary counts", (long)lost);
+	check(text == text_bytes && text_seen == text_bytes / (sizeof(TEXT) - 1U), "log text echoed", (long)text);
+	printf("%s: %u frames, %u samples, %u config frames, %u lost, %u bad, %u bytes of log text\n", name, frames, samples,
+			configs, lost, bad, text);
+}
+
+static void through_pty(const char *tool, const char *dir){
+	char output[256], errors[256];
+	snprintf(output, sizeof(output), "%s/pty.log", dir);
+	snprintf(errors, sizeof(errors), "%s/pty.err", dir);
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+		check(0, "pty", 0);
+		return;
+	}
+	/*Raw before anything is written: the line discipline processes bytes as they arrive, not when they are read*/
+	int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+	struct termios tio;
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	pid_t pid = ingest(tool, ptsname(master), -1, master, output, errors);
+	generate(master);
+	/*A closed master hangs up the slave with input still queued, so wait for the reader to take it all*/
+	int queued;
+	for(int i = 0; i < 2000 && ioctl(slave, FIONREAD, &queued) == 0 && queued > 0; i++){
+		usleep(1000);
+	}
+	usleep(50000);
+	kill(pid, SIGINT);
+	int status;
+	waitpid(pid, &status, 0);
+	check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "ingest from the pty", status);
+	close(slave);
+	close(master);
+	verify("pty", output, errors);
+}
+
+static void through_pipe(const char *tool, const char *dir){
+	char output[256], errors[256];
+	snprintf(output, sizeof(output), "%s/pipe.log", dir);
+	snprintf(errors, sizeof(errors), "%s/pipe.err", dir);
+	int fds[2];
+	if(pipe(fds) != 0){
+		check(0, "pipe", 0);
+		return;
+	}
+	pid_t pid = ingest(tool, "-", fds[0], fds[1], output, errors);
+	close(fds[0]);
+	generate(fds[1]);
+	close(fds[1]);
+	int status;
+	waitpid(pid, &status, 0);
+	check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "ingest from the pipe", status);
+	verify("pipe", output, errors);
+}
+
+int main(int argc, char **argv){
+	if(argc != 2){
+		fprintf(stderr, "usage: %s <telemetry_ingest>\n", argv[0]);
+		return 2;
+	}
+	char dir[] = "/tmp/telemetry_roundtrip.XXXXXX";
+	if(mkdtemp(dir) == NULL){
+		perror(dir);
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+	through_pty(argv[1], dir);
+	through_pipe(argv[1], dir);
+
+	const char *files[] = {"pty.log", "pty.err", "pipe.log", "pipe.err"};
+	for(unsigned i = 0; i < sizeof(files) / sizeof(files[0]); i++){
+		char path[256];
+		snprintf(path, sizeof(path), "%s/%s", dir, files[i]);
+		unlink(path);
+	}
+	rmdir(dir);
+	return test_result();
+}
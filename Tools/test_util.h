@@ -0,0 +1,47 @@
+/*
+ * test_util.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Checks and the pass/fail report shared by the host tests. Host only.
+ * Each test includes this once, from the file holding main(). Tests that don't link iis2mdc_sim.c define
+ * TEST_UTIL_QUIET_LOG before including it to get a _log that drops the driver's messages.
+ */
+
+#ifndef TEST_UTIL_H_
+#define TEST_UTIL_H_
+
+#include <stdio.h>
+
+#define TEST_UTIL_REPORTED 10U /*Failures printed, the rest are only counted*/
+
+static int failures;
+
+/*Counts a failed check, value is printed with the first ones to help find it*/
+static void check(int ok, const char *what, double value){
+	if(!ok && (unsigned)failures++ < TEST_UTIL_REPORTED){
+		fprintf(stderr, "FAIL %s: %.12g\n", what, value);
+	}
+}
+
+/*Prints the outcome, returns the exit status for main*/
+static int test_result(void){
+	if(failures){
+		printf("%d failures\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
+
+#ifdef TEST_UTIL_QUIET_LOG
+#include "log.h"
+
+void _log(Log_Subsystem_t subsystem, const char* msg, ...){
+	(void)subsystem;
+	(void)msg;
+}
+#endif
+
+#endif /* TEST_UTIL_H_ */
@@ -0,0 +1,160 @@
+/*
+ * tilt_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: evanl
+ *
+ * Host test for IIS2MDC_Tilt: a synthetic attitude sweep (every 7 deg of heading, roll and pitch to +-60 deg) checks
+ * heading, roll and pitch against the attitude the readings were generated from, then IIS2MDC_Tilt_ReadMagnetic runs
+ * against the simulated sensor with declination and a failing accelerometer.
+ * Build from the repository root:
+ *   gcc -O2 -ICore/Inc -ITools Tools/tilt_test.c Tools/iis2mdc_sim.c Core/Src/IIS2MDC_Tilt.c Core/Src/IIS2MDC_Heading.c \
+ *       Core/Src/IIS2MDC.c Core/Src/IIS2MDC_Convert.c Core/Src/IIS2MDC_Filter.c Core/Src/IIS2MDC_Decimator.c -o tilt_test -lm
+ * Run:
+ *   ./tilt_test, exits non-zero on failure
+ */
+#include "iis2mdc_sim.h"
+#include "IIS2MDC_Tilt.h"
+#include "IIS2MDC_Heading.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <math.h>
+
+#define HORIZONTAL_MG 220.0      /*Field at mid northern latitudes*/
+#define VERTICAL_MG 420.0
+#define ONE_G 1000.0             /*Accelerometer in mg*/
+#define MAX_HEADING_ERROR 0.5    /*deg, readings are rounded to 1 mG / 1 mg, which matters most at 60 deg of tilt*/
+#define MAX_ANGLE_ERROR 0.15
+
+
+static double wrap180(double deg){
+	deg = fmod(deg, 360.0);
+	if(deg > 180.0){
+		deg -= 360.0;
+	} else if(deg < -180.0){
+		deg += 360.0;
+	}
+	return deg;
+}
+
+/*World to body: pitch about Y, then roll about X. X forward, Y left, Z up.*/
+static void to_body(double pitch, double roll, double v[3]){
+	double c = cos(pitch), s = sin(pitch), x = v[0], z = v[2];
+	v[0] = c * x - s * z;
+	v[2] = s * x + c * z;
+	c = cos(roll);
+	s = sin(roll);
+	double y = v[1];
+	z = v[2];
+	v[1] = c * y + s * z;
+	v[2] = -s * y + c * z;
+}
+
+/*Readings of a device at the given attitude, heading measured from X towards Y like IIS2MDC_Atan2(MagY, MagX)*/
+static void reading(double heading, double pitch, double roll, int32_t mag[3], int32_t accel[3]){
+	double h = heading * M_PI / 180.0, p = pitch * M_PI / 180.0, r = roll * M_PI / 180.0;
+	double m[3] = {HORIZONTAL_MG * cos(h), HORIZONTAL_MG * sin(h), -VERTICAL_MG};
+	double a[3] = {0, 0, ONE_G};
+	to_body(p, r, m);
+	to_body(p, r, a);
+	for(int i = 0; i < 3; i++){
+		mag[i] = lround(m[i]);
+		accel[i] = lround(a[i]);
+	}
+}
+
+static void sweep(void){
+	double heading_error = 0, roll_error = 0, pitch_error = 0;
+	for(int heading = 0; heading < 360; heading += 7){
+		for(int pitch = -60; pitch <= 60; pitch += 5){
+			for(int roll = -60; roll <= 60; roll += 5){
+				int32_t mag[3], accel[3];
+				int16_t r, p;
+				reading(heading, pitch, roll, mag, accel);
+				uint16_t h = IIS2MDC_TiltCompensate(mag, accel, &r, &p);
+				heading_error = fmax(heading_error, fabs(wrap180(h / 100.0 - heading)));
+				roll_error = fmax(roll_error, fabs(r / 100.0 - roll));
+				pitch_error = fmax(pitch_error, fabs(p / 100.0 - pitch));
+			}
+		}
+	}
+	check(heading_error <= MAX_HEADING_ERROR, "heading error deg", heading_error);
+	check(roll_error <= MAX_ANGLE_ERROR, "roll error deg", roll_error);
+	check(pitch_error <= MAX_ANGLE_ERROR, "pitch error deg", pitch_error);
+	printf("sweep: max error heading %.3f, roll %.3f, pitch %.3f deg\n", heading_error, roll_error, pitch_error);
+
+	/*Uncompensated, 30 deg of pitch alone moves the heading by tens of degrees*/
+	int32_t mag[3], accel[3];
+	reading(90, 30, 0, mag, accel);
+	double level = wrap180(IIS2MDC_Atan2(mag[1], mag[0]) / 100.0 - 90);
+	check(fabs(level) > 10, "uncompensated heading error deg", level);
+}
+
+/*Readings the simulated sensor and accelerometer return*/
+static int32_t body_mag[3], body_accel[3];
+static uint8_t accel_fails;
+
+static void accel_init(void){
+}
+
+static IIS2MDC_Status_t accel_read(int32_t *x, int32_t *y, int32_t *z){
+	if(accel_fails){
+		return IIS2MDC_Error;
+	}
+	*x = body_accel[0];
+	*y = body_accel[1];
+	*z = body_accel[2];
+	return IIS2MDC_Ok;
+}
+
+static void field(uint64_t now_us, int16_t out[3]){
+	(void)now_us;
+	for(int i = 0; i < 3; i++){
+		out[i] = (int16_t)lround(body_mag[i] / 1.5); //1.5 mG per LSB
+	}
+}
+
+static void driver(void){
+	IIS2MDC_Handle_t Dev;
+	IIS2MDC_Tilt_t Tilt;
+	IIS2MDC_InitStruct_t Settings = {0};
+	Settings.DataRate = IIS2MDC_100Hz;
+	Settings.OperatingMode = IIS2MDC_ContinuousMode;
+	Settings.Declination = 250;
+	const IIS2MDC_Calibration_t identity = { //The default calibration is a particular board's soft iron
+			.Bias = {0, 0, 0},
+			.Matrix = {{IIS2MDC_CAL_Q14(1), 0, 0}, {0, IIS2MDC_CAL_Q14(1), 0}, {0, 0, IIS2MDC_CAL_Q14(1)}}
+	};
+	Settings.Calibration = &identity;
+	reading(135, 20, 10, body_mag, body_accel);
+
+	sim_power_on();
+	sim.field = field;
+	IIS2MDC_Init(Settings, &Dev, sim_driver());
+	IIS2MDC_Tilt_Init(&Tilt, &Dev, (IIS2MDC_Accel_Drv_t){accel_init, accel_read});
+
+	check(IIS2MDC_Tilt_ReadMagnetic(&Tilt) == IIS2MDC_DataNotReady, "read before a sample", 0);
+	sim_advance(sim.now_us + 10000);
+	check(IIS2MDC_Tilt_ReadMagnetic(&Tilt) == IIS2MDC_DataReady, "read after a sample", 0);
+	double error = wrap180(Tilt.Heading / 100.0 - 137.5);
+	check(fabs(error) <= MAX_HEADING_ERROR, "heading with declination", error);
+	check(fabs(Tilt.Pitch / 100.0 - 20) <= MAX_ANGLE_ERROR, "pitch", Tilt.Pitch);
+	check(fabs(Tilt.Roll / 100.0 - 10) <= MAX_ANGLE_ERROR, "roll", Tilt.Roll);
+	printf("driver: heading %.2f deg (135 + 2.5 declination), pitch %.2f, roll %.2f\n", Tilt.Heading / 100.0,
+			Tilt.Pitch / 100.0, Tilt.Roll / 100.0);
+
+	/*A failed accelerometer read still delivers the field and keeps the last attitude*/
+	uint16_t last = Tilt.Heading;
+	reading(200, 0, 0, body_mag, body_accel);
+	accel_fails = 1;
+	sim_advance(sim.now_us + 10000);
+	check(IIS2MDC_Tilt_ReadMagnetic(&Tilt) == IIS2MDC_DataReady, "read with accelerometer failing", 0);
+	check(Tilt.Heading == last, "heading kept", Tilt.Heading);
+	check(Dev.MagX < -200, "field updated", Dev.MagX);
+}
+
+int main(void){
+	sweep();
+	driver();
+	return test_result();
+}